@@ -0,0 +1,21 @@
+/*
+ * This file contains small helpers shared by the benchmark programs in this
+ * directory.  Files that include it must define _POSIX_C_SOURCE (199309L or
+ * later) before including any system headers so clock_gettime() is visible.
+ */
+
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#include <time.h>
+
+/*
+ * Returns the current value of a monotonic clock in seconds.
+ */
+static inline double bench_now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#endif
@@ -0,0 +1,132 @@
+/*
+ * This program compares the B+-tree with the balanced BST on random keys,
+ * at sizes from 100K keys up to max_keys, growing tenfold.  For each it
+ * reports the tree's height and, in millions per second, insertions,
+ * lookups (of every key, in another random order), keys summed by range
+ * sums over 100 keys and keys visited by a full pass of an iterator.
+ *
+ * The balanced BST takes about 64 bytes per key, so it is skipped above
+ * bst_max keys (marked -).  Run with max_keys 100000000 for 100M keys.
+ *
+ * Usage: ./bench_bptree [max_keys] [bst_max]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bst.h"
+#include "bptree.h"
+#include "bench.h"
+
+#define RANGE_KEYS 100
+#define NUM_RANGES 1000000
+
+/*
+ * Fills keys with 0 .. n - 1 in a random order.
+ */
+static void shuffle(int* keys, int n) {
+  for (int i = 0; i < n; i++) {
+    keys[i] = i;
+  }
+  for (int i = n - 1; i > 0; i--) {
+    int j = (int)(((long)rand() * RAND_MAX + rand()) % (i + 1));
+    int t = keys[i];
+    keys[i] = keys[j];
+    keys[j] = t;
+  }
+}
+
+int main(int argc, char** argv) {
+  int max_keys = argc > 1 ? atoi(argv[1]) : 10000000;
+  int bst_max = argc > 2 ? atoi(argv[2]) : 10000000;
+
+  srand(0);
+  int* keys = malloc(max_keys * sizeof(int));
+  int* lookups = malloc(max_keys * sizeof(int));
+
+  printf("%-10s %-6s %7s %10s %10s %10s %10s\n", "keys", "tree", "height",
+    "Mins/s", "Mget/s", "Mrange/s", "Miter/s");
+  for (long n = 100000; n <= max_keys; n *= 10) {
+    shuffle(keys, n);
+    shuffle(lookups, n);
+    for (int is_bpt = 0; is_bpt < 2; is_bpt++) {
+      if (!is_bpt && n > bst_max) {
+        printf("%-10ld %-6s %7s %10s %10s %10s %10s\n", n, "bst", "-", "-",
+          "-", "-", "-");
+        continue;
+      }
+      struct bst* bst = is_bpt ? NULL : bst_create_balanced();
+      struct bpt* bpt = is_bpt ? bpt_create() : NULL;
+
+      double start = bench_now();
+      for (int i = 0; i < n; i++) {
+        if (is_bpt) {
+          bpt_insert(bpt, keys[i], &keys[i]);
+        } else {
+          bst_insert(bst, keys[i], &keys[i]);
+        }
+      }
+      double insert_time = bench_now() - start;
+
+      int found = 0;
+      start = bench_now();
+      for (int i = 0; i < n; i++) {
+        found += (is_bpt ? bpt_get(bpt, lookups[i]) :
+          bst_get(bst, lookups[i])) != NULL;
+      }
+      double get_time = bench_now() - start;
+
+      /*
+       * Range sums are checked against the sum of RANGE_KEYS consecutive
+       * keys.
+       */
+      int wrong = 0;
+      start = bench_now();
+      for (int i = 0; i < NUM_RANGES; i++) {
+        int lower = lookups[i % n] % (n - RANGE_KEYS);
+        int upper = lower + RANGE_KEYS - 1;
+        int sum = is_bpt ? bpt_range_sum(bpt, lower, upper) :
+          bst_range_sum(bst, lower, upper);
+        wrong += sum != (int)((long long)(lower + upper) * RANGE_KEYS / 2);
+      }
+      double range_time = bench_now() - start;
+
+      long visited = 0;
+      void* value;
+      start = bench_now();
+      if (is_bpt) {
+        struct bpt_iterator* iter = bpt_iterator_create(bpt);
+        while (bpt_iterator_has_next(iter)) {
+          visited += bpt_iterator_next(iter, &value) >= 0;
+        }
+        bpt_iterator_free(iter);
+      } else {
+        struct bst_iterator* iter = bst_iterator_create(bst);
+        while (bst_iterator_has_next(iter)) {
+          visited += bst_iterator_next(iter, &value) >= 0;
+        }
+        bst_iterator_free(iter);
+      }
+      double iter_time = bench_now() - start;
+
+      printf("%-10ld %-6s %7d %10.2f %10.2f %10.1f %10.1f%s\n", n,
+        is_bpt ? "bptree" : "bst", is_bpt ? bpt_height(bpt) :
+        bst_height(bst), n / insert_time * 1e-6, n / get_time * 1e-6,
+        (double)NUM_RANGES * RANGE_KEYS / range_time * 1e-6,
+        visited / iter_time * 1e-6,
+        found == n && visited == n && !wrong ? "" : "  !");
+      if (is_bpt) {
+        bpt_free(bpt);
+      } else {
+        bst_free(bst);
+      }
+    }
+  }
+  printf("\n! = a lookup, range sum or iterator pass gave a wrong result\n");
+
+  free(keys);
+  free(lookups);
+  return 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * This program compares the plain BST from bst_create() with the balanced
+ * (AVL) BST from bst_create_balanced() on keys inserted in sorted, reverse
+ * sorted and random order.  For each, it reports the tree's height and how
+ * many insertions and lookups (of every key, in random order) it does per
+ * second.
+ *
+ * Sorted keys turn the plain BST into a linked list, where inserting n keys
+ * takes O(n^2) time, so it only gets the first plain_max of them.
+ *
+ * Usage: ./bench_bst [n_keys] [plain_max]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bst.h"
+#include "bench.h"
+
+/*
+ * Fills keys with 0 .. n - 1 in a random order.
+ */
+static void shuffle(int* keys, int n) {
+  for (int i = 0; i < n; i++) {
+    keys[i] = i;
+  }
+  for (int i = n - 1; i > 0; i--) {
+    int j = (int)(((long)rand() * RAND_MAX + rand()) % (i + 1));
+    int t = keys[i];
+    keys[i] = keys[j];
+    keys[j] = t;
+  }
+}
+
+int main(int argc, char** argv) {
+  int n = argc > 1 ? atoi(argv[1]) : 10000000;
+  int plain_max = argc > 2 ? atoi(argv[2]) : 20000;
+  const char* orders[] = {"sorted", "reverse", "random"};
+
+  srand(0);
+  int* keys = malloc(n * sizeof(int));
+  int* lookups = malloc(n * sizeof(int));
+
+  printf("%-8s %-9s %10s %7s %10s %10s\n", "order", "tree", "keys",
+    "height", "Mins/s", "Mget/s");
+  for (int order = 0; order < 3; order++) {
+    if (order == 2) {
+      shuffle(keys, n);
+    } else {
+      for (int i = 0; i < n; i++) {
+        keys[i] = order == 0 ? i : n - 1 - i;
+      }
+    }
+
+    for (int balanced = 0; balanced < 2; balanced++) {
+      int count = !balanced && order < 2 && plain_max < n ? plain_max : n;
+      struct bst* bst = balanced ? bst_create_balanced() : bst_create();
+      double start = bench_now();
+      for (int i = 0; i < count; i++) {
+        bst_insert(bst, keys[i], &keys[i]);
+      }
+      double insert_time = bench_now() - start;
+
+      /*
+       * Look up the keys that were inserted, in a different random order.
+       */
+      shuffle(lookups, count);
+      int found = 0;
+      start = bench_now();
+      for (int i = 0; i < count; i++) {
+        found += bst_get(bst, keys[lookups[i]]) != NULL;
+      }
+      double get_time = bench_now() - start;
+
+      printf("%-8s %-9s %10d %7d %10.2f %10.2f%s\n", orders[order],
+        balanced ? "balanced" : "plain", count, bst_height(bst),
+        count / insert_time * 1e-6, found / get_time * 1e-6,
+        found == count ? "" : "  !");
+      bst_free(bst);
+    }
+  }
+  printf("\n! = some inserted keys were not found\n");
+
+  free(keys);
+  free(lookups);
+  return 0;
+}
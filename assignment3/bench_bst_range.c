@@ -0,0 +1,96 @@
+/*
+ * This program compares range sums over a BST computed from the key sums
+ * kept in its nodes, which is what bst_range_sum() does, with an in-order
+ * walk of every key, which is what it used to do.  The walk uses a BST
+ * iterator, which keeps the same stack the old bst_range_sum() did.
+ *
+ * Both plain and balanced BSTs of n random keys are measured, with ranges
+ * covering about 0.01%, 1% and 50% of the keys.  Every walk's sum is
+ * checked against bst_range_sum().
+ *
+ * Usage: ./bench_bst_range [n_keys] [n_walks] [n_queries]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bst.h"
+#include "bench.h"
+
+/*
+ * Sums the keys between lower and upper by visiting every key in order.
+ */
+static long long walk_range_sum(struct bst* bst, int lower, int upper) {
+  long long sum = 0;
+  struct bst_iterator* iter = bst_iterator_create(bst);
+  while (bst_iterator_has_next(iter)) {
+    void* value;
+    int key = bst_iterator_next(iter, &value);
+    if (key >= lower && key <= upper) {
+      sum += key;
+    }
+  }
+  bst_iterator_free(iter);
+  return sum;
+}
+
+int main(int argc, char** argv) {
+  int n = argc > 1 ? atoi(argv[1]) : 1000000;
+  int n_walks = argc > 2 ? atoi(argv[2]) : 10;
+  int n_queries = argc > 3 ? atoi(argv[3]) : 1000000;
+  const double widths[] = {0.0001, 0.01, 0.5};
+
+  /*
+   * Random distinct keys, spread over 0 .. 4n.
+   */
+  srand(0);
+  int* keys = malloc(n * sizeof(int));
+  for (int i = 0; i < n; i++) {
+    keys[i] = 4 * i + rand() % 4;
+  }
+  for (int i = n - 1; i > 0; i--) {
+    int j = (int)(((long)rand() * RAND_MAX + rand()) % (i + 1));
+    int t = keys[i];
+    keys[i] = keys[j];
+    keys[j] = t;
+  }
+
+  printf("%d keys\n\n", n);
+  printf("%-9s %7s %12s %12s %10s\n", "tree", "width", "walk us",
+    "sums us", "speedup");
+  for (int balanced = 0; balanced < 2; balanced++) {
+    struct bst* bst = balanced ? bst_create_balanced() : bst_create();
+    for (int i = 0; i < n; i++) {
+      bst_insert(bst, keys[i], NULL);
+    }
+    for (int w = 0; w < 3; w++) {
+      int width = (int)(widths[w] * 4 * n);
+      int wrong = 0;
+      double start = bench_now();
+      for (int q = 0; q < n_walks; q++) {
+        int lower = rand() % (4 * n - width);
+        long long sum = walk_range_sum(bst, lower, lower + width);
+        wrong += (int)sum != bst_range_sum(bst, lower, lower + width);
+      }
+      double walk_time = (bench_now() - start) / n_walks;
+
+      start = bench_now();
+      for (int q = 0; q < n_queries; q++) {
+        int lower = rand() % (4 * n - width);
+        bst_range_sum(bst, lower, lower + width);
+      }
+      double sums_time = (bench_now() - start) / n_queries;
+
+      printf("%-9s %6.2f%% %12.1f %12.3f %9.0fx%s\n",
+        balanced ? "balanced" : "plain", widths[w] * 100, walk_time * 1e6,
+        sums_time * 1e6, walk_time / sums_time, wrong ? "  !" : "");
+    }
+    bst_free(bst);
+  }
+  printf("\n! = a walk's sum differed from bst_range_sum()\n");
+
+  free(keys);
+  return 0;
+}
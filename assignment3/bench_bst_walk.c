@@ -0,0 +1,94 @@
+/*
+ * This program measures how fast the BST functions that visit every node
+ * go, in millions of nodes per second: a full pass of an iterator,
+ * bst_height() and bst_path_sum() of a sum no path has (which walk the
+ * whole tree in a plain BST) and bst_free().
+ *
+ * Both plain and balanced BSTs of n random keys are measured, each walk
+ * repeated n_walks times.  (bst_height() of a balanced BST is O(1), so it
+ * has no rate.)
+ *
+ * Usage: ./bench_bst_walk [n_keys] [n_walks]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bst.h"
+#include "bench.h"
+
+int main(int argc, char** argv) {
+  int n = argc > 1 ? atoi(argv[1]) : 1000000;
+  int n_walks = argc > 2 ? atoi(argv[2]) : 10;
+
+  srand(0);
+  int* keys = malloc(n * sizeof(int));
+  for (int i = 0; i < n; i++) {
+    keys[i] = i;
+  }
+  for (int i = n - 1; i > 0; i--) {
+    int j = (int)(((long)rand() * RAND_MAX + rand()) % (i + 1));
+    int t = keys[i];
+    keys[i] = keys[j];
+    keys[j] = t;
+  }
+
+  printf("%d keys, Mnodes/s\n\n", n);
+  printf("%-9s %10s %10s %10s %10s\n", "tree", "iterator", "height",
+    "path sum", "free");
+  for (int balanced = 0; balanced < 2; balanced++) {
+    struct bst* bst = balanced ? bst_create_balanced() : bst_create();
+    for (int i = 0; i < n; i++) {
+      bst_insert(bst, keys[i], NULL);
+    }
+
+    long long visited = 0;
+    double start = bench_now();
+    for (int w = 0; w < n_walks; w++) {
+      struct bst_iterator* iter = bst_iterator_create(bst);
+      void* value;
+      while (bst_iterator_has_next(iter)) {
+        visited += bst_iterator_next(iter, &value) >= 0;
+      }
+      bst_iterator_free(iter);
+    }
+    double iter_time = bench_now() - start;
+
+    start = bench_now();
+    int height = 0;
+    for (int w = 0; w < n_walks; w++) {
+      height += bst_height(bst);
+    }
+    double height_time = bench_now() - start;
+
+    /*
+     * Keys are non-negative, so no path sums to -1.
+     */
+    start = bench_now();
+    int found = 0;
+    for (int w = 0; w < n_walks; w++) {
+      found += bst_path_sum(bst, -1);
+    }
+    double path_time = bench_now() - start;
+
+    start = bench_now();
+    bst_free(bst);
+    double free_time = bench_now() - start;
+
+    char height_rate[32];
+    snprintf(height_rate, sizeof(height_rate), "%.1f",
+      (double)n * n_walks / height_time * 1e-6);
+    printf("%-9s %10.1f %10s %10.1f %10.1f%s\n",
+      balanced ? "balanced" : "plain", visited / iter_time * 1e-6,
+      balanced ? "-" : height_rate,
+      (double)n * n_walks / path_time * 1e-6, n / free_time * 1e-6,
+      visited == (long long)n * n_walks && !found && height > 0 ? "" :
+      "  !");
+  }
+  printf("\n! = a walk missed nodes or found a path it should not have\n");
+
+  free(keys);
+  return 0;
+}
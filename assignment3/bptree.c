@@ -0,0 +1,617 @@
+/*
+ * This file contains an implementation of a B+-tree, an ordered map from int
+ * keys to values with the same operations as the BST in bst.c.  Where a BST
+ * node holds one key and two child pointers, a B+-tree node holds up to
+ * BPT_MAX_KEYS keys side by side, so a lookup touches a few cache lines per
+ * level instead of one node per level, and there are log_64(n) levels
+ * instead of log_2(n).
+ *
+ * Values are only stored in the leaves, which are all at the same depth and
+ * linked together in key order, so iterators and range sums scan the leaves
+ * without going back up the tree.  Internal nodes only hold separator keys
+ * to find the way down.
+ *
+ * Unlike the BST, a B+-tree is a map: inserting a key that is already there
+ * replaces its value.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "bptree.h"
+
+/*
+ * The number of bytes of keys in each node.  256 bytes (4 cache lines, 64
+ * keys) keeps nodes wide enough that trees of 100M keys are 5 levels deep,
+ * while the scan of a node's keys stays cheap.  It can be changed with
+ * -DBPT_NODE_BYTES=..., down to 16 bytes (4 keys), which makes small trees
+ * deep enough to test splits and merges with.
+ */
+#ifndef BPT_NODE_BYTES
+#define BPT_NODE_BYTES 256
+#endif
+
+#if BPT_NODE_BYTES < 16
+#error "BPT_NODE_BYTES must be at least 16"
+#endif
+
+/*
+ * The most keys a node can hold, and the fewest any node but the root may
+ * hold.  Merging a node with one key too few and a sibling with the fewest
+ * (and, in an internal node, the separator between them) always fits.
+ */
+#define BPT_MAX_KEYS ((int)(BPT_NODE_BYTES / sizeof(int)))
+#define BPT_MIN_KEYS (BPT_MAX_KEYS / 2)
+
+/*
+ * This structure represents a node of a B+-tree.  Its `n_keys` keys are kept
+ * sorted at the start of `keys`.
+ *
+ * An internal node has n_keys + 1 children.  Every key in children[i] is at
+ * least keys[i - 1] (if i > 0) and less than keys[i] (if i < n_keys).
+ *
+ * A leaf holds values[i] for each keys[i], and a pointer to the next leaf in
+ * key order, NULL for the last one.
+ */
+struct bpt_node {
+    int is_leaf;
+    int n_keys;
+    int keys[BPT_MAX_KEYS];
+    union {
+        struct bpt_node* children[BPT_MAX_KEYS + 1];
+        struct {
+            void* values[BPT_MAX_KEYS];
+            struct bpt_node* next;
+        } leaf;
+    } u;
+};
+
+/*
+ * This structure represents an entire B+-tree: its root, which is a leaf
+ * (possibly empty) until the first split, the number of keys in it and the
+ * number of levels below the root.
+ */
+struct bpt {
+    struct bpt_node* root;
+    int size;
+    int height;
+};
+
+/*
+ * Allocates an empty node.  Its keys are zeroed, since searches read the
+ * slots past n_keys too (and ignore them).
+ */
+static struct bpt_node* node_create(int is_leaf) {
+    struct bpt_node* node = malloc(sizeof(struct bpt_node));
+    assert(node);
+    node->is_leaf = is_leaf;
+    node->n_keys = 0;
+    memset(node->keys, 0, sizeof(node->keys));
+    if (is_leaf) {
+        node->u.leaf.next = NULL;
+    }
+    return node;
+}
+
+/*
+ * These functions search the sorted keys of a node.  Instead of a binary
+ * search, whose branches are unpredictable, they count the keys on one side
+ * of `key`.  The loop always runs over all BPT_MAX_KEYS slots, masking off
+ * those past n_keys, so it has a fixed trip count and no branches, and gcc
+ * vectorizes it even at -O2: with 64 keys, that is 16 SSE compares, which
+ * beats both a scalar count and a binary search.
+ *
+ *   count_less - the number of keys less than `key`, which is where `key`
+ *     is or would go in a leaf.
+ *   count_at_most - the number of keys at most `key`, which is the child of
+ *     an internal node to follow to find `key`.
+ */
+static int count_less(const int* keys, int n_keys, int key) {
+    int count = 0;
+    for (int i = 0; i < BPT_MAX_KEYS; i++) {
+        count += (keys[i] < key) & (i < n_keys);
+    }
+    return count;
+}
+
+static int count_at_most(const int* keys, int n_keys, int key) {
+    int count = 0;
+    for (int i = 0; i < BPT_MAX_KEYS; i++) {
+        count += (keys[i] <= key) & (i < n_keys);
+    }
+    return count;
+}
+
+/*
+ * Walks down from the root to the leaf where a key is or would go.
+ */
+static struct bpt_node* find_leaf(struct bpt* bpt, int key) {
+    struct bpt_node* node = bpt->root;
+    while (!node->is_leaf) {
+        node = node->u.children[count_at_most(node->keys, node->n_keys, key)];
+    }
+    return node;
+}
+
+/*
+ * This function allocates and initializes a new, empty B+-tree.
+ *
+ * Return:
+ *   Returns the new B+-tree, which should be freed with bpt_free().
+ */
+struct bpt* bpt_create() {
+    struct bpt* bpt = malloc(sizeof(struct bpt));
+    assert(bpt);
+    bpt->root = node_create(1);
+    bpt->size = 0;
+    bpt->height = 0;
+    return bpt;
+}
+
+/*
+ * Frees a node and everything below it.  The recursion is only as deep as
+ * the tree, which is a handful of levels.
+ */
+static void node_free(struct bpt_node* node) {
+    if (!node->is_leaf) {
+        for (int i = 0; i <= node->n_keys; i++) {
+            node_free(node->u.children[i]);
+        }
+    }
+    free(node);
+}
+
+/*
+ * This function frees the memory associated with a B+-tree.  Like
+ * bst_free(), it does not free the values stored in it.
+ *
+ * Params:
+ *   bpt - the B+-tree to be destroyed.  May not be NULL.
+ */
+void bpt_free(struct bpt* bpt) {
+    assert(bpt);
+    node_free(bpt->root);
+    free(bpt);
+}
+
+/*
+ * This function returns the number of keys in a B+-tree.
+ */
+int bpt_size(struct bpt* bpt) {
+    assert(bpt);
+    return bpt->size;
+}
+
+/*
+ * This function returns the height of a B+-tree: the number of edges from
+ * the root down to any leaf, which are all at the same depth.  A tree that
+ * fits in a single leaf has height 0.
+ */
+int bpt_height(struct bpt* bpt) {
+    assert(bpt);
+    return bpt->height;
+}
+
+/*****************************************************************************
+ **
+ ** Insertion
+ **
+ *****************************************************************************/
+
+/*
+ * This function inserts a key into the subtree below a node.  A full node is
+ * split in two, with the upper half of its keys moved into a new node to its
+ * right, which the caller must then add to the parent.  To do that, the
+ * node's keys and the new one are first lined up in arrays one entry larger
+ * than a node.
+ *
+ * Params:
+ *   node - the root of the subtree.
+ *   key, value - the key and value to insert.
+ *   added - set to 0 if the key was already there and only its value was
+ *     replaced.
+ *   split_key - if the node was split, set to the smallest key in the
+ *     subtree of the new node.
+ *
+ * Return:
+ *   Returns the new node to the right of `node` if it was split, or NULL.
+ */
+static struct bpt_node* insert(struct bpt_node* node, int key, void* value,
+        int* added, int* split_key) {
+    int keys[BPT_MAX_KEYS + 1];
+    int n = node->n_keys;
+
+    if (node->is_leaf) {
+        int i = count_less(node->keys, n, key);
+        if (i < n && node->keys[i] == key) {
+            node->u.leaf.values[i] = value;
+            *added = 0;
+            return NULL;
+        }
+        if (n < BPT_MAX_KEYS) {
+            memmove(&node->keys[i + 1], &node->keys[i], (n - i) * sizeof(int));
+            memmove(&node->u.leaf.values[i + 1], &node->u.leaf.values[i],
+                (n - i) * sizeof(void*));
+            node->keys[i] = key;
+            node->u.leaf.values[i] = value;
+            node->n_keys++;
+            return NULL;
+        }
+
+        void* values[BPT_MAX_KEYS + 1];
+        memcpy(keys, node->keys, i * sizeof(int));
+        memcpy(values, node->u.leaf.values, i * sizeof(void*));
+        keys[i] = key;
+        values[i] = value;
+        memcpy(&keys[i + 1], &node->keys[i], (n - i) * sizeof(int));
+        memcpy(&values[i + 1], &node->u.leaf.values[i],
+            (n - i) * sizeof(void*));
+
+        struct bpt_node* right = node_create(1);
+        int left_n = (n + 1) / 2;
+        node->n_keys = left_n;
+        right->n_keys = n + 1 - left_n;
+        memcpy(node->keys, keys, left_n * sizeof(int));
+        memcpy(node->u.leaf.values, values, left_n * sizeof(void*));
+        memcpy(right->keys, &keys[left_n], right->n_keys * sizeof(int));
+        memcpy(right->u.leaf.values, &values[left_n],
+            right->n_keys * sizeof(void*));
+        right->u.leaf.next = node->u.leaf.next;
+        node->u.leaf.next = right;
+        *split_key = right->keys[0];
+        return right;
+    }
+
+    int c = count_at_most(node->keys, n, key);
+    int child_split_key;
+    struct bpt_node* new_child = insert(node->u.children[c], key, value,
+        added, &child_split_key);
+    if (new_child == NULL) {
+        return NULL;
+    }
+    if (n < BPT_MAX_KEYS) {
+        memmove(&node->keys[c + 1], &node->keys[c], (n - c) * sizeof(int));
+        memmove(&node->u.children[c + 2], &node->u.children[c + 1],
+            (n - c) * sizeof(struct bpt_node*));
+        node->keys[c] = child_split_key;
+        node->u.children[c + 1] = new_child;
+        node->n_keys++;
+        return NULL;
+    }
+
+    /*
+     * The middle key of the n + 1 moves up to the parent instead of into
+     * either half.
+     */
+    struct bpt_node* children[BPT_MAX_KEYS + 2];
+    memcpy(keys, node->keys, c * sizeof(int));
+    memcpy(children, node->u.children, (c + 1) * sizeof(struct bpt_node*));
+    keys[c] = child_split_key;
+    children[c + 1] = new_child;
+    memcpy(&keys[c + 1], &node->keys[c], (n - c) * sizeof(int));
+    memcpy(&children[c + 2], &node->u.children[c + 1],
+        (n - c) * sizeof(struct bpt_node*));
+
+    struct bpt_node* right = node_create(0);
+    int left_n = (n + 1) / 2;
+    node->n_keys = left_n;
+    right->n_keys = n - left_n;
+    memcpy(node->keys, keys, left_n * sizeof(int));
+    memcpy(node->u.children, children,
+        (left_n + 1) * sizeof(struct bpt_node*));
+    memcpy(right->keys, &keys[left_n + 1], right->n_keys * sizeof(int));
+    memcpy(right->u.children, &children[left_n + 1],
+        (right->n_keys + 1) * sizeof(struct bpt_node*));
+    *split_key = keys[left_n];
+    return right;
+}
+
+/*
+ * This function inserts a new key/value pair into a B+-tree, or replaces the
+ * value of a key that is already there.  When the root splits, a new root
+ * is made above the two halves, which is the only way the tree grows taller.
+ *
+ * Params:
+ *   bpt - the B+-tree into which to insert.  May not be NULL.
+ *   key - the key to insert.
+ *   value - the value to store with the key.
+ */
+void bpt_insert(struct bpt* bpt, int key, void* value) {
+    assert(bpt);
+    int added = 1, split_key;
+    struct bpt_node* right = insert(bpt->root, key, value, &added,
+        &split_key);
+    if (right != NULL) {
+        struct bpt_node* root = node_create(0);
+        root->n_keys = 1;
+        root->keys[0] = split_key;
+        root->u.children[0] = bpt->root;
+        root->u.children[1] = right;
+        bpt->root = root;
+        bpt->height++;
+    }
+    bpt->size += added;
+}
+
+/*****************************************************************************
+ **
+ ** Removal
+ **
+ *****************************************************************************/
+
+/*
+ * This function brings the child at index c of an internal node back up to
+ * BPT_MIN_KEYS keys after a removal left it one short.  If a sibling next to
+ * it has keys to spare, one moves over (in an internal node, by way of the
+ * separator in the parent).  Otherwise, the child and a sibling are merged
+ * into one node and their separator removed from the parent, which may leave
+ * the parent short in turn.
+ */
+static void fix_child(struct bpt_node* parent, int c) {
+    struct bpt_node* child = parent->u.children[c];
+    struct bpt_node* left = c > 0 ? parent->u.children[c - 1] : NULL;
+    struct bpt_node* right = c < parent->n_keys ?
+        parent->u.children[c + 1] : NULL;
+    int n = child->n_keys;
+
+    if (left != NULL && left->n_keys > BPT_MIN_KEYS) {
+        int last = left->n_keys - 1;
+        memmove(&child->keys[1], child->keys, n * sizeof(int));
+        if (child->is_leaf) {
+            memmove(&child->u.leaf.values[1], child->u.leaf.values,
+                n * sizeof(void*));
+            child->keys[0] = left->keys[last];
+            child->u.leaf.values[0] = left->u.leaf.values[last];
+            parent->keys[c - 1] = child->keys[0];
+        } else {
+            memmove(&child->u.children[1], child->u.children,
+                (n + 1) * sizeof(struct bpt_node*));
+            child->keys[0] = parent->keys[c - 1];
+            child->u.children[0] = left->u.children[last + 1];
+            parent->keys[c - 1] = left->keys[last];
+        }
+        child->n_keys++;
+        left->n_keys--;
+        return;
+    }
+
+    if (right != NULL && right->n_keys > BPT_MIN_KEYS) {
+        int rn = right->n_keys;
+        if (child->is_leaf) {
+            child->keys[n] = right->keys[0];
+            child->u.leaf.values[n] = right->u.leaf.values[0];
+            memmove(right->u.leaf.values, &right->u.leaf.values[1],
+                (rn - 1) * sizeof(void*));
+            memmove(right->keys, &right->keys[1], (rn - 1) * sizeof(int));
+            parent->keys[c] = right->keys[0];
+        } else {
+            child->keys[n] = parent->keys[c];
+            child->u.children[n + 1] = right->u.children[0];
+            parent->keys[c] = right->keys[0];
+            memmove(right->u.children, &right->u.children[1],
+                rn * sizeof(struct bpt_node*));
+            memmove(right->keys, &right->keys[1], (rn - 1) * sizeof(int));
+        }
+        child->n_keys++;
+        right->n_keys--;
+        return;
+    }
+
+    /*
+     * Merge the pair at indices i and i + 1 into the one at i.
+     */
+    int i = left != NULL ? c - 1 : c;
+    struct bpt_node* a = parent->u.children[i];
+    struct bpt_node* b = parent->u.children[i + 1];
+    int an = a->n_keys, bn = b->n_keys;
+    if (a->is_leaf) {
+        memcpy(&a->keys[an], b->keys, bn * sizeof(int));
+        memcpy(&a->u.leaf.values[an], b->u.leaf.values, bn * sizeof(void*));
+        a->n_keys = an + bn;
+        a->u.leaf.next = b->u.leaf.next;
+    } else {
+        a->keys[an] = parent->keys[i];
+        memcpy(&a->keys[an + 1], b->keys, bn * sizeof(int));
+        memcpy(&a->u.children[an + 1], b->u.children,
+            (bn + 1) * sizeof(struct bpt_node*));
+        a->n_keys = an + 1 + bn;
+    }
+    free(b);
+    int pn = parent->n_keys;
+    memmove(&parent->keys[i], &parent->keys[i + 1],
+        (pn - i - 1) * sizeof(int));
+    memmove(&parent->u.children[i + 1], &parent->u.children[i + 2],
+        (pn - i - 1) * sizeof(struct bpt_node*));
+    parent->n_keys--;
+}
+
+/*
+ * This function removes a key from the subtree below a node, fixing any
+ * child left short on the way back up.
+ *
+ * Return:
+ *   Returns 1 if the key was found and removed, 0 if it was not there.
+ */
+static int remove_key(struct bpt_node* node, int key) {
+    int n = node->n_keys;
+    if (node->is_leaf) {
+        int i = count_less(node->keys, n, key);
+        if (i == n || node->keys[i] != key) {
+            return 0;
+        }
+        memmove(&node->keys[i], &node->keys[i + 1], (n - i - 1) * sizeof(int));
+        memmove(&node->u.leaf.values[i], &node->u.leaf.values[i + 1],
+            (n - i - 1) * sizeof(void*));
+        node->n_keys--;
+        return 1;
+    }
+
+    int c = count_at_most(node->keys, n, key);
+    int removed = remove_key(node->u.children[c], key);
+    if (removed && node->u.children[c]->n_keys < BPT_MIN_KEYS) {
+        fix_child(node, c);
+    }
+    return removed;
+}
+
+/*
+ * This function removes a key and its value from a B+-tree, if the key is
+ * there.  When merges below leave the root with a single child, that child
+ * becomes the root, which is the only way the tree gets shorter.
+ *
+ * Params:
+ *   bpt - the B+-tree from which to remove.  May not be NULL.
+ *   key - the key to remove.
+ */
+void bpt_remove(struct bpt* bpt, int key) {
+    assert(bpt);
+    if (!remove_key(bpt->root, key)) {
+        return;
+    }
+    bpt->size--;
+    if (!bpt->root->is_leaf && bpt->root->n_keys == 0) {
+        struct bpt_node* root = bpt->root;
+        bpt->root = root->u.children[0];
+        bpt->height--;
+        free(root);
+    }
+}
+
+/*****************************************************************************
+ **
+ ** Lookups and range sums
+ **
+ *****************************************************************************/
+
+/*
+ * This function returns the value associated with a key in a B+-tree.
+ *
+ * Params:
+ *   bpt - the B+-tree to search.  May not be NULL.
+ *   key - the key whose value is to be returned.
+ *
+ * Return:
+ *   Returns the value stored with `key`, or NULL if `key` is not in `bpt`.
+ */
+void* bpt_get(struct bpt* bpt, int key) {
+    assert(bpt);
+    struct bpt_node* leaf = find_leaf(bpt, key);
+    int i = count_less(leaf->keys, leaf->n_keys, key);
+    if (i < leaf->n_keys && leaf->keys[i] == key) {
+        return leaf->u.leaf.values[i];
+    }
+    return NULL;
+}
+
+/*
+ * This function computes the sum of all keys in a B+-tree between a lower
+ * and an upper bound, both inclusive, like bst_range_sum().  It walks down
+ * to the leaf holding `lower`, then scans keys along the linked leaves until
+ * it passes `upper`, so it takes O(log n + k) time for k keys in range, with
+ * the keys read one contiguous array at a time.
+ *
+ * Params:
+ *   bpt - the B+-tree within which to compute a range sum.  May not be NULL.
+ *   lower - the inclusive lower bound of the range.
+ *   upper - the inclusive upper bound of the range.
+ *
+ * Return:
+ *   Returns the sum of all keys in `bpt` between `lower` and `upper`.
+ */
+int bpt_range_sum(struct bpt* bpt, int lower, int upper) {
+    assert(bpt);
+    long long sum = 0;
+    struct bpt_node* leaf = find_leaf(bpt, lower);
+    int i = count_less(leaf->keys, leaf->n_keys, lower);
+    while (leaf != NULL) {
+        for (; i < leaf->n_keys; i++) {
+            if (leaf->keys[i] > upper) {
+                return (int)sum;
+            }
+            sum += leaf->keys[i];
+        }
+        leaf = leaf->u.leaf.next;
+        i = 0;
+    }
+    return (int)sum;
+}
+
+/*****************************************************************************
+ **
+ ** B+-tree iterator
+ **
+ *****************************************************************************/
+
+/*
+ * Structure used to represent a B+-tree iterator: the leaf and the index in
+ * it of the next key to visit.  `leaf` is NULL once every key is visited.
+ */
+struct bpt_iterator {
+    struct bpt_node* leaf;
+    int index;
+};
+
+/*
+ * This function allocates an iterator over the keys of a B+-tree, which
+ * visits them in order.  The tree must not be changed while it is in use.
+ *
+ * Params:
+ *   bpt - the B+-tree to iterate over.  May not be NULL.
+ *
+ * Return:
+ *   Returns the new iterator, which should be freed with
+ *   bpt_iterator_free().
+ */
+struct bpt_iterator* bpt_iterator_create(struct bpt* bpt) {
+    assert(bpt);
+    struct bpt_iterator* iter = malloc(sizeof(struct bpt_iterator));
+    assert(iter);
+    struct bpt_node* node = bpt->root;
+    while (!node->is_leaf) {
+        node = node->u.children[0];
+    }
+    iter->leaf = node->n_keys > 0 ? node : NULL;
+    iter->index = 0;
+    return iter;
+}
+
+/*
+ * This function frees a B+-tree iterator, but not the tree.
+ */
+void bpt_iterator_free(struct bpt_iterator* iter) {
+    assert(iter);
+    free(iter);
+}
+
+/*
+ * This function returns 1 if a B+-tree iterator has more keys to visit, or
+ * 0 if it does not.
+ */
+int bpt_iterator_has_next(struct bpt_iterator* iter) {
+    assert(iter);
+    return iter->leaf != NULL;
+}
+
+/*
+ * This function returns the next key of a B+-tree iterator and advances it,
+ * like bst_iterator_next().
+ *
+ * Params:
+ *   iter - the iterator.  It must have a next key.
+ *   value - the value stored with the key is stored here.
+ *
+ * Return:
+ *   Returns the next key.
+ */
+int bpt_iterator_next(struct bpt_iterator* iter, void** value) {
+    assert(iter && iter->leaf);
+    struct bpt_node* leaf = iter->leaf;
+    int key = leaf->keys[iter->index];
+    *value = leaf->u.leaf.values[iter->index];
+    if (++iter->index == leaf->n_keys) {
+        iter->leaf = leaf->u.leaf.next;
+        iter->index = 0;
+    }
+    return key;
+}
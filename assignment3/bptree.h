@@ -0,0 +1,43 @@
+/*
+ * This file contains the definition of the interface for the B+-tree, an
+ * ordered map from int keys to values with the same operations as the BST.
+ * You can find descriptions of the B+-tree functions, including their
+ * parameters and their return values, in bptree.c.
+ */
+
+#ifndef __BPTREE_H
+#define __BPTREE_H
+
+/*
+ * Structure used to represent a B+-tree.
+ */
+struct bpt;
+
+/*
+ * B+-tree interface function prototypes.  Refer to bptree.c for
+ * documentation about each of these functions.
+ */
+struct bpt* bpt_create();
+void bpt_free(struct bpt* bpt);
+int bpt_size(struct bpt* bpt);
+int bpt_height(struct bpt* bpt);
+void bpt_insert(struct bpt* bpt, int key, void* value);
+void bpt_remove(struct bpt* bpt, int key);
+void* bpt_get(struct bpt* bpt, int key);
+int bpt_range_sum(struct bpt* bpt, int lower, int upper);
+
+/*
+ * Structure used to represent a B+-tree iterator.
+ */
+struct bpt_iterator;
+
+/*
+ * B+-tree iterator interface prototypes.  Refer to bptree.c for
+ * documentation about each of these functions.
+ */
+struct bpt_iterator* bpt_iterator_create(struct bpt* bpt);
+void bpt_iterator_free(struct bpt_iterator* iter);
+int bpt_iterator_has_next(struct bpt_iterator* iter);
+int bpt_iterator_next(struct bpt_iterator* iter, void** value);
+
+#endif
@@ -10,9 +10,9 @@
  */
 
 #include <stdlib.h>
+#include <assert.h>
 
 #include "bst.h"
-#include "stack.h"
 
 /*
  * This structure represents a single node in a BST.  In addition to containing
@@ -22,26 +22,47 @@
  * node.  Nodes in the BST should be ordered based on this `key` field.  The
  * `value` field stores data associated with the key.
  *
- * You should not modify this structure.
+ * `parent` points back up to the node's parent (NULL for the root), so the
+ * functions that visit every node can walk the tree without a stack.
+ *
+ * `size` is the number of nodes in the subtree rooted at this node and `sum`
+ * is the sum of their keys.  They make bst_size() O(1) and let bst_select(),
+ * bst_rank() and the range queries skip whole subtrees.  In a balanced BST,
+ * `height` is the number of nodes on the longest path from this node down to
+ * a leaf (so a leaf has height 1).  It is set to 1 and never updated in an
+ * unbalanced BST.
  */
 struct bst_node {
   int key;
   void* value;
   struct bst_node* left;
   struct bst_node* right;
+  struct bst_node* parent;
+  int size;
+  int height;
+  long long sum;
 };
 
 
 /*
  * This structure represents an entire BST.  It specifically contains a
- * reference to the root node of the tree.
- *
- * You should not modify this structure.
+ * reference to the root node of the tree and whether the tree keeps itself
+ * balanced (see bst_create_balanced()).
  */
 struct bst {
   struct bst_node* root;
+  int balanced;
 };
 
+/*
+ * A balanced BST is an AVL tree, whose height is at most 1.44 * log2(n + 2),
+ * so it is under 46 for any number of nodes an int can count.  Insertion and
+ * removal record the links they follow down a balanced tree in an array of
+ * this size, to walk back up it: unlike parent pointers, these say which of
+ * the parent's child pointers to rotate.
+ */
+#define BST_MAX_DEPTH 64
+
 /*
  * This function should allocate and initialize a new, empty, BST and return
  * a pointer to it.
@@ -50,10 +71,166 @@ struct bst* bst_create() {
     struct bst* new_bst = malloc(sizeof(struct bst));
     if (new_bst != NULL) {
  	new_bst->root = NULL;
+ 	new_bst->balanced = 0;
+    }
+    return new_bst;
+}
+
+/*
+ * This function allocates and initializes a new, empty BST that keeps itself
+ * balanced.  It is used through the same functions as a BST from
+ * bst_create(), but it is an AVL tree: after each insertion or removal, the
+ * nodes on the path back up to the root are rotated where needed so that the
+ * heights of the two subtrees of every node differ by at most one.  This
+ * keeps bst_insert(), bst_remove() and bst_get() O(log n) even when keys
+ * arrive in sorted order, which turns an unbalanced BST into a linked list.
+ *
+ * Equal keys may end up on either side of each other after a rotation, so
+ * with duplicate keys, bst_get() and bst_remove() find one of them but not
+ * necessarily the one inserted first.
+ *
+ * Return:
+ *   Returns the new BST, which should be freed with bst_free().
+ */
+struct bst* bst_create_balanced() {
+    struct bst* new_bst = bst_create();
+    if (new_bst != NULL) {
+        new_bst->balanced = 1;
     }
     return new_bst;
 }
 
+/*****************************************************************************
+ **
+ ** AVL rebalancing
+ **
+ *****************************************************************************/
+
+/*
+ * Returns the height of a subtree of a balanced BST, 0 for an empty one.
+ */
+static int node_height(struct bst_node* node) {
+    return node != NULL ? node->height : 0;
+}
+
+/*
+ * Returns the number of nodes in a subtree, 0 for an empty one.
+ */
+static int node_size(struct bst_node* node) {
+    return node != NULL ? node->size : 0;
+}
+
+/*
+ * Returns the sum of the keys in a subtree, 0 for an empty one.
+ */
+static long long node_sum(struct bst_node* node) {
+    return node != NULL ? node->sum : 0;
+}
+
+/*
+ * Recomputes the height, size and key sum of a node from those of its
+ * children.
+ */
+static void update_node(struct bst_node* node) {
+    int left = node_height(node->left), right = node_height(node->right);
+    node->height = 1 + (left > right ? left : right);
+    node->size = 1 + node_size(node->left) + node_size(node->right);
+    node->sum = node->key + node_sum(node->left) + node_sum(node->right);
+}
+
+/*
+ * These functions rotate the subtree hanging from a link (the root pointer
+ * or a child pointer of the parent) and store the subtree's new root back
+ * into the link:
+ *
+ *       n            l                 n                r
+ *      / \          / \               / \              / \
+ *     l   c   ->   a   n             a   r     ->     n   c
+ *    / \              / \                / \         / \
+ *   a   b            b   c              b   c       a   b
+ *
+ *   rotate_right             rotate_left
+ *
+ * Only n and its child change subtrees, so only their heights, sizes and sums
+ * need to be recomputed, and only they and b change parents.
+ */
+static void rotate_right(struct bst_node** link) {
+    struct bst_node* n = *link;
+    struct bst_node* l = n->left;
+    n->left = l->right;
+    if (n->left != NULL) {
+        n->left->parent = n;
+    }
+    l->right = n;
+    l->parent = n->parent;
+    n->parent = l;
+    update_node(n);
+    update_node(l);
+    *link = l;
+}
+
+static void rotate_left(struct bst_node** link) {
+    struct bst_node* n = *link;
+    struct bst_node* r = n->right;
+    n->right = r->left;
+    if (n->right != NULL) {
+        n->right->parent = n;
+    }
+    r->left = n;
+    r->parent = n->parent;
+    n->parent = r;
+    update_node(n);
+    update_node(r);
+    *link = r;
+}
+
+/*
+ * This function restores the AVL property at the subtree hanging from a
+ * link, whose two subtrees are themselves balanced but may differ in height
+ * by two after an insertion or removal below.  The taller side is rotated up,
+ * with a rotation of that child first when its inner subtree is the taller
+ * one.  Otherwise, the node's height is just recomputed.
+ */
+static void rebalance(struct bst_node** link) {
+    struct bst_node* n = *link;
+    int balance = node_height(n->left) - node_height(n->right);
+    if (balance > 1) {
+        if (node_height(n->left->left) < node_height(n->left->right)) {
+            rotate_left(&n->left);
+        }
+        rotate_right(link);
+    } else if (balance < -1) {
+        if (node_height(n->right->right) < node_height(n->right->left)) {
+            rotate_right(&n->right);
+        }
+        rotate_left(link);
+    } else {
+        update_node(n);
+    }
+}
+
+/*
+ * This function walks back up a balanced BST after an insertion or removal,
+ * rebalancing each node on the way.  It stops at the first node whose height
+ * did not change, since nothing above it changed either.  (Sizes and sums are
+ * updated on the way down, so they are already right above that node.)
+ *
+ * Params:
+ *   path - the links followed from the root down to the parent of the node
+ *     that was inserted or removed.  Rotations only change the nodes below
+ *     a link, so the links higher up stay valid.
+ *   depth - the number of links in path.
+ */
+static void retrace(struct bst_node*** path, int depth) {
+    while (depth-- > 0) {
+        int old_height = (*path[depth])->height;
+        rebalance(path[depth]);
+        if ((*path[depth])->height == old_height) {
+            return;
+        }
+    }
+}
+
 /*
  * This function should free the memory associated with a BST.  While this
  * function should up all memory used in the BST itself, it should not free
@@ -65,51 +242,37 @@ struct bst* bst_create() {
  */
 void bst_free(struct bst* bst) {
     if (bst == NULL) return;
-    // Traverse the tree in post-order and free each node
-    struct stack* nodeStack = stack_create();
+    /*
+     * Rotate left children up until the node at the top has none, then free
+     * it and carry on with its right subtree.  Each rotation moves one node
+     * onto that right spine for good, so this takes O(n) time and no extra
+     * memory.
+     */
     struct bst_node* current = bst->root;
-    while (!stack_isempty(nodeStack) || current != NULL) {
-        if (current != NULL) {
-            stack_push(nodeStack, current);
-            current = current->left;
+    while (current != NULL) {
+        if (current->left != NULL) {
+            struct bst_node* left = current->left;
+            current->left = left->right;
+            left->right = current;
+            current = left;
         } else {
-            current = stack_pop(nodeStack);
             struct bst_node* temp = current;
             current = current->right;
             free(temp);
         }
     }
-    stack_free(nodeStack);
     free(bst);
 }
 
 /*
  * This function should return the total number of elements stored in a given
- * BST.
+ * BST.  This is the size kept in the root node, so it takes O(1) time.
  *
  * Params:
  *   bst - the BST whose elements are to be counted.  May not be NULL.
  */
 int bst_size(struct bst* bst) {
-  if (bst == NULL || bst->root == NULL) return 0;
-    int count = 0;
-    struct stack* nodeStack = stack_create();
-    struct bst_node* node = bst->root;
-
-    while (!stack_isempty(nodeStack) || node != NULL) {
-        if (node != NULL) {
-            stack_push(nodeStack, node);
-            node = node->left;
-        } else {
-            node = stack_pop(nodeStack);
-            count++;
-            node = node->right;
-        }
-    }
-
-    stack_free(nodeStack);
-    return count;
-  
+    return bst != NULL ? node_size(bst->root) : 0;
 }
 
 /*
@@ -128,9 +291,19 @@ int bst_size(struct bst* bst) {
  *     which means that a pointer of any type can be passed.
  */
 void bst_insert(struct bst* bst, int key, void* value) {
+   struct bst_node** path[BST_MAX_DEPTH];
+   int depth = 0;
    struct bst_node **node = &bst->root;
+   struct bst_node* parent = NULL;
 
     while (*node != NULL) {
+        if (bst->balanced) {
+            assert(depth < BST_MAX_DEPTH);
+            path[depth++] = node;
+        }
+        (*node)->size++;
+        (*node)->sum += key;
+        parent = *node;
         if (key < (*node)->key) {
             node = &(*node)->left;
         } else {
@@ -139,11 +312,17 @@ void bst_insert(struct bst* bst, int key, void* value) {
     }
 
     *node = malloc(sizeof(struct bst_node));
-    if (*node != NULL) {
-        (*node)->key = key;
-        (*node)->value = value;
-        (*node)->left = NULL;
-        (*node)->right = NULL;
+    assert(*node);
+    (*node)->key = key;
+    (*node)->value = value;
+    (*node)->left = NULL;
+    (*node)->right = NULL;
+    (*node)->parent = parent;
+    (*node)->size = 1;
+    (*node)->height = 1;
+    (*node)->sum = key;
+    if (bst->balanced) {
+        retrace(path, depth);
     }
 }
 
@@ -159,30 +338,76 @@ void bst_insert(struct bst* bst, int key, void* value) {
  *   key - the key of the key/value pair to be removed from the BST.
  */
 void bst_remove(struct bst* bst, int key) {
+    struct bst_node** path[BST_MAX_DEPTH];
+    int depth = 0;
     struct bst_node** node = &bst->root;
+
+    /*
+     * The size of every node on the way down drops by one and its sum by the
+     * key, but only if the key is there, so look for it first.
+     */
+    struct bst_node* current = bst->root;
+    while (current != NULL && key != current->key) {
+        current = key < current->key ? current->left : current->right;
+    }
+    if (current == NULL) {
+        return;
+    }
+
     while (*node != NULL) {
         if (key == (*node)->key) {
-            if (!(*node)->left) {
-                struct bst_node* temp = *node;
-                *node = (*node)->right;
-                free(temp);
-            } else if (!(*node)->right) {
+            if (!(*node)->left || !(*node)->right) {
                 struct bst_node* temp = *node;
-                *node = (*node)->left;
+                *node = temp->left ? temp->left : temp->right;
+                if (*node != NULL) {
+                    (*node)->parent = temp->parent;
+                }
                 free(temp);
             } else {
+                /*
+                 * The nodes down to the successor lose its key rather than
+                 * this one, so find it first.
+                 */
+                struct bst_node* min = (*node)->right;
+                while (min->left) {
+                    min = min->left;
+                }
                 struct bst_node** succ = &(*node)->right;
+                if (bst->balanced) {
+                    path[depth++] = node;
+                }
+                (*node)->size--;
+                (*node)->sum -= key;
                 while ((*succ)->left) {
+                    if (bst->balanced) {
+                        assert(depth < BST_MAX_DEPTH);
+                        path[depth++] = succ;
+                    }
+                    (*succ)->size--;
+                    (*succ)->sum -= min->key;
                     succ = &(*succ)->left;
                 }
                 (*node)->key = (*succ)->key;
                 (*node)->value = (*succ)->value;
                 struct bst_node* temp = *succ;
-                *succ = (*succ)->right;
+                *succ = temp->right;
+                if (*succ != NULL) {
+                    (*succ)->parent = temp->parent;
+                }
                 free(temp);
             }
+            if (bst->balanced) {
+                retrace(path, depth);
+            }
             return;
-        } else if (key < (*node)->key) {
+        }
+        if (bst->balanced) {
+            assert(depth < BST_MAX_DEPTH);
+            path[depth++] = node;
+        }
+        (*node)->size--;
+        (*node)->sum -= key;
+        if (key < (*node)->key) {
             node = &(*node)->left;
         } else {
             node = &(*node)->right;
@@ -221,12 +446,137 @@ void* bst_get(struct bst* bst, int key) {
     return NULL;
 }
 
+/*****************************************************************************
+ **
+ ** Order statistics
+ **
+ *****************************************************************************/
+
+/*
+ * This function finds the k-th smallest key in a BST.  The size of each
+ * node's left subtree says how many keys come before it, so this follows a
+ * single path down the tree, taking O(log n) time in a balanced BST.  For
+ * example, the median of a BST is bst_select(bst, bst_size(bst) / 2).
+ *
+ * Params:
+ *   bst - the BST to search.  May not be NULL.
+ *   k - the rank of the key to find, from 0 for the smallest key to
+ *     bst_size(bst) - 1 for the largest.
+ *   value - if not NULL, the value stored with the key is stored here.
+ *
+ * Return:
+ *   Returns the key with k smaller keys (counting equal keys in the order
+ *   an iterator visits them).
+ */
+int bst_select(struct bst* bst, int k, void** value) {
+    assert(bst && k >= 0 && k < bst_size(bst));
+    struct bst_node* node = bst->root;
+    while (k != node_size(node->left)) {
+        if (k < node_size(node->left)) {
+            node = node->left;
+        } else {
+            k -= node_size(node->left) + 1;
+            node = node->right;
+        }
+    }
+    if (value != NULL) {
+        *value = node->value;
+    }
+    return node->key;
+}
+
+/*
+ * This function counts and sums the keys in a BST below a bound, following a
+ * single path down the tree: each time it goes right, the node and its whole
+ * left subtree are below the bound, and their count and sum are in the node.
+ *
+ * Params:
+ *   bst - the BST to search.  May not be NULL.
+ *   bound - the bound.  It does not need to be in the BST.
+ *   inclusive - 1 to include keys equal to `bound`, 0 not to.
+ *   sum - if not NULL, the sum of the keys is stored here.
+ *
+ * Return:
+ *   Returns the number of keys below `bound`.
+ */
+static int prefix(struct bst* bst, int bound, int inclusive, long long* sum) {
+    int count = 0;
+    long long total = 0;
+    struct bst_node* node = bst->root;
+    while (node != NULL) {
+        if (bound < node->key || (bound == node->key && !inclusive)) {
+            node = node->left;
+        } else {
+            count += node_size(node->left) + 1;
+            total += node_sum(node->left) + node->key;
+            node = node->right;
+        }
+    }
+    if (sum != NULL) {
+        *sum = total;
+    }
+    return count;
+}
+
+/*
+ * This function counts the keys in a BST that are smaller than a given key,
+ * which is the rank at which bst_select() would find it.  Like bst_select(),
+ * it follows a single path down the tree.
+ *
+ * Params:
+ *   bst - the BST to search.  May not be NULL.
+ *   key - the key to rank.  It does not need to be in the BST.
+ *
+ * Return:
+ *   Returns the number of keys in `bst` smaller than `key`.
+ */
+int bst_rank(struct bst* bst, int key) {
+    assert(bst);
+    return prefix(bst, key, 0, NULL);
+}
+
 /*****************************************************************************
  **
  ** BST puzzle functions
  **
  *****************************************************************************/
 
+/*
+ * These two functions visit the leaves of a BST in order by following child
+ * and parent pointers, with no stack.  Along the way, they keep the depth of
+ * the current node and the sum of the keys on the path down to it.
+ *
+ * first_leaf() walks down from a node to the first leaf below it, going left
+ * where it can and right where it must.  next_leaf() climbs up from a leaf
+ * to the first ancestor with a right subtree it has not been into yet, and
+ * walks down to that subtree's first leaf.  It returns NULL after the last
+ * leaf.
+ */
+static struct bst_node* first_leaf(struct bst_node* node, int* depth,
+        long long* path_sum) {
+    *path_sum += node->key;
+    while (node->left != NULL || node->right != NULL) {
+        node = node->left != NULL ? node->left : node->right;
+        (*depth)++;
+        *path_sum += node->key;
+    }
+    return node;
+}
+
+static struct bst_node* next_leaf(struct bst_node* node, int* depth,
+        long long* path_sum) {
+    while (node->parent != NULL) {
+        struct bst_node* parent = node->parent;
+        *path_sum -= node->key;
+        if (node == parent->left && parent->right != NULL) {
+            return first_leaf(parent->right, depth, path_sum);
+        }
+        node = parent;
+        (*depth)--;
+    }
+    return NULL;
+}
+
 /*
  * This function should return the height of a given BST, which is the maximum
  * depth of any node in the tree (i.e. the number of edges in the path from
@@ -241,24 +591,21 @@ void* bst_get(struct bst* bst, int key) {
  */
 int bst_height(struct bst* bst) {
     if (bst == NULL || bst->root == NULL) return -1;
-    int max_height = -1, current_depth = 0;
-    struct stack* stack = stack_create();
-    struct bst_node* node = bst->root;
-    while (!stack_isempty(stack) || node != NULL) {
-        if (node != NULL) {
-            stack_push(stack, node);
-            node = node->left;
-            current_depth++;
-            if (current_depth > max_height) {
-                max_height = current_depth;
-            }
-        } else {
-            node = stack_pop(stack);
-            node = node->right;
-            current_depth--;
+    if (bst->balanced) {
+        return bst->root->height - 1;
+    }
+    /*
+     * The deepest node is a leaf, so only the leaves' depths matter.
+     */
+    int max_height = 0, depth = 0;
+    long long path_sum = 0;
+    struct bst_node* leaf = first_leaf(bst->root, &depth, &path_sum);
+    while (leaf != NULL) {
+        if (depth > max_height) {
+            max_height = depth;
         }
+        leaf = next_leaf(leaf, &depth, &path_sum);
     }
-    stack_free(stack);
     return max_height;
 }
 
@@ -278,42 +625,15 @@ int bst_height(struct bst* bst) {
  */
 int bst_path_sum(struct bst* bst, int sum) {
     if (bst == NULL || bst->root == NULL) return 0;
-
-    struct stack* stack = stack_create();
-    struct bst_node* node = bst->root;
-    int current_sum = 0;
-
-    // to handle the path sums correctly, we need to also keep track of the sums at each node.
-    struct stack* sums_stack = stack_create();
-
-    while (!stack_isempty(stack) || node != NULL) {
-        while (node != NULL) {
-            stack_push(stack, node);
-            current_sum += node->key;
-            stack_push(sums_stack, (void*)(long)current_sum);  // Cast current_sum to void* to store in stack
-
-            // Move to the left child
-            node = node->left;
-        }
-
-        if (!stack_isempty(stack)) {
-            node = stack_pop(stack);
-            current_sum = (int)(long)stack_pop(sums_stack);  // Retrieve the current sum when this node was pushed
-
-            // Check if it's a leaf node and if the current path sum equals the target sum
-            if (node->left == NULL && node->right == NULL && current_sum == sum) {
-                stack_free(stack);
-                stack_free(sums_stack);
-                return 1;
-            }
-
-            // Move to the right child
-            node = node->right;
+    int depth = 0;
+    long long path_sum = 0;
+    struct bst_node* leaf = first_leaf(bst->root, &depth, &path_sum);
+    while (leaf != NULL) {
+        if (path_sum == sum) {
+            return 1;
         }
+        leaf = next_leaf(leaf, &depth, &path_sum);
     }
-
-    stack_free(stack);
-    stack_free(sums_stack);
     return 0;
 }
 
@@ -332,46 +652,69 @@ int bst_path_sum(struct bst* bst, int sum) {
  *     should be considered an *inclusive* bound; in other words a key that's
  *     equal to this bound should be included in the sum
  *
+ * Nodes keep the sums of their subtrees' keys, so rather than visiting the
+ * keys in range, this takes the sum of the keys up to `upper` and subtracts
+ * the sum of those below `lower`, each found along one path down the tree.
+ * This takes O(log n) time in a balanced BST.
+ *
  * Return:
  *   Should return the sum of all keys in `bst` between `lower` and `upper`.
  */
 int bst_range_sum(struct bst* bst, int lower, int upper) {
-    int range_sum = 0;
-    struct bst_node* node = bst->root;
-    struct stack* stack = stack_create();
-    while (!stack_isempty(stack) || node != NULL) {
-        if (node != NULL) {
-            stack_push(stack, node);
-            node = node->left;
-        } else {
-            node = stack_pop(stack);
-            if (node->key >= lower && node->key <= upper) {
-                range_sum += node->key;
-            }
-            node = node->right;
-        }
+    if (lower > upper) {
+        return 0;
     }
-    stack_free(stack);
-    return range_sum;
-  return 0;
+    long long below_lower, up_to_upper;
+    prefix(bst, lower, 0, &below_lower);
+    prefix(bst, upper, 1, &up_to_upper);
+    return (int)(up_to_upper - below_lower);
 }
+
 /*
- * This function should compute a range sum in a given BST.  Specifically, it
- * should compute the sum of all keys in the BST between a given lower bound
- * and a given upper bound.  For full credit, you should not process any subtree
- * whose keys cannot be included in the range sum.
+ * This function counts the keys in a BST between a lower and an upper bound,
+ * in O(log n) time in a balanced BST, the same way as bst_range_sum().
  *
  * Params:
- *   bst - the BST within which to compute a range sum
- *   lower - the lower bound of the range over which to compute a sum; this
- *     should be considered an *inclusive* bound; in other words a key that's
- *     equal to this bound should be included in the sum
- *   upper - the upper bound of the range over which to compute a sum; this
- *     should be considered an *inclusive* bound; in other words a key that's
- *     equal to this bound should be included in the sum
+ *   bst - the BST within which to count keys.  May not be NULL.
+ *   lower - the inclusive lower bound of the range.
+ *   upper - the inclusive upper bound of the range.
  *
  * Return:
- *   Should return the sum of a}
+ *   Returns the number of keys in `bst` between `lower` and `upper`.
+ */
+int bst_range_count(struct bst* bst, int lower, int upper) {
+    assert(bst);
+    if (lower > upper) {
+        return 0;
+    }
+    return prefix(bst, upper, 1, NULL) - prefix(bst, lower, 0, NULL);
+}
+
+/*
+ * This function computes the average of the keys in a BST between a lower
+ * and an upper bound, in O(log n) time in a balanced BST.  The sum is kept
+ * in a long long, so unlike bst_range_sum() it does not overflow.
+ *
+ * Params:
+ *   bst - the BST within which to average keys.  May not be NULL.
+ *   lower - the inclusive lower bound of the range.
+ *   upper - the inclusive upper bound of the range.
+ *
+ * Return:
+ *   Returns the average of the keys in `bst` between `lower` and `upper`, or
+ *   0 if there are none (which bst_range_count() can tell apart).
+ */
+double bst_range_average(struct bst* bst, int lower, int upper) {
+    assert(bst);
+    if (lower > upper) {
+        return 0;
+    }
+    long long below_lower, up_to_upper;
+    int count = prefix(bst, upper, 1, &up_to_upper) -
+        prefix(bst, lower, 0, &below_lower);
+    return count > 0 ? (double)(up_to_upper - below_lower) / count : 0;
+}
+
 /*****************************************************************************
  **
  ** BST iterator definition (extra credit only)
@@ -380,14 +723,24 @@ int bst_range_sum(struct bst* bst, int lower, int upper) {
 
 /*
  * Structure used to represent a binary search tree iterator.  It contains
- * only a reference to a stack to be used to implement the iterator.
- *
- * You should not modify this structure.
+ * only the node to be visited next, or NULL when there are none left.  Each
+ * node's successor is found from its right subtree or, failing that, its
+ * parent pointers, so the iterator needs no stack.
  */
 struct bst_iterator {
-  struct stack* stack;
+  struct bst_node* next;
 };
 
+/*
+ * Returns the leftmost node of a subtree, which holds its smallest key.
+ */
+static struct bst_node* leftmost(struct bst_node* node) {
+    while (node->left != NULL) {
+        node = node->left;
+    }
+    return node;
+}
+
 /*
  * This function should allocate and initialize an iterator over a specified
  * BST and return a pointer to that iterator.
@@ -398,12 +751,7 @@ struct bst_iterator {
 struct bst_iterator* bst_iterator_create(struct bst* bst) {
   struct bst_iterator* iter = malloc(sizeof(struct bst_iterator));
   if (iter) {
-        iter->stack = stack_create();
-        struct bst_node* node = bst->root;
-        while (node != NULL) {
-            stack_push(iter->stack, node);
-            node = node->left;
-        }
+        iter->next = bst->root != NULL ? leftmost(bst->root) : NULL;
     }
     return iter;
 }
@@ -417,12 +765,7 @@ struct bst_iterator* bst_iterator_create(struct bst* bst) {
  *   iter - the BST iterator to be destroyed.  May not be NULL.
  */
 void bst_iterator_free(struct bst_iterator* iter) {
-  if (iter != NULL) {
-       // Assuming that stack_free also frees all elements inside the stack.
-       // If stack elements need explicit freeing, that would have to be handled here as well.
-       stack_free(iter->stack);
-       free(iter);
-     }  
+  free(iter);
 }
 /*
  * This function should indicate whether a given BST iterator has more nodes
@@ -435,7 +778,7 @@ void bst_iterator_free(struct bst_iterator* iter) {
  *     not be NULL.
  */
 int bst_iterator_has_next(struct bst_iterator* iter) {
-  return !stack_isempty(iter->stack);  // Returns 1 if there is at least one node left 
+  return iter->next != NULL;
 }
 
 /*
@@ -464,21 +807,25 @@ int bst_iterator_has_next(struct bst_iterator* iter) {
  *   pointed to by `iter`.
  */
 int bst_iterator_next(struct bst_iterator* iter, void** value) {
-     if (iter == NULL || stack_isempty(iter->stack)) {
+     if (iter == NULL || iter->next == NULL) {
           *value = NULL;
           return 0; 
      }
 
-     struct bst_node* node = stack_pop(iter->stack);
+     struct bst_node* node = iter->next;
      *value = node->value;
      int key = node->key;
- 
-     // Push the right subtree of the node onto the stack
-     node = node->right;
-     while (node != NULL) {
-         stack_push(iter->stack, node);
-         node = node->left;
+
+     // The successor is the leftmost node of the right subtree or, if there
+     // is none, the first ancestor this node is in the left subtree of
+     if (node->right != NULL) {
+         iter->next = leftmost(node->right);
+     } else {
+         while (node->parent != NULL && node == node->parent->right) {
+             node = node->parent;
+         }
+         iter->next = node->parent;
      }
 
      return key;  // Returning the key of the current node
-} 
+}
@@ -18,11 +18,14 @@ struct bst;
  * documentation about each of these functions.
  */
 struct bst* bst_create();
+struct bst* bst_create_balanced();
 void bst_free(struct bst* bst);
 int bst_size(struct bst* bst);
 void bst_insert(struct bst* bst, int key, void* value);
 void bst_remove(struct bst* bst, int key);
 void* bst_get(struct bst* bst, int key);
+int bst_select(struct bst* bst, int k, void** value);
+int bst_rank(struct bst* bst, int key);
 
 /*
  * Binary search tree "puzzle" function prototypes.  Refer to bst.c for
@@ -31,6 +34,8 @@ void* bst_get(struct bst* bst, int key);
 int bst_height(struct bst* bst);
 int bst_path_sum(struct bst* bst, int sum);
 int bst_range_sum(struct bst* bst, int lower, int upper);
+int bst_range_count(struct bst* bst, int lower, int upper);
+double bst_range_average(struct bst* bst, int lower, int upper);
 
 /*
  * Structure used to represent a binary search tree iterator.
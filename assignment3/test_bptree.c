@@ -0,0 +1,197 @@
+/*
+ * This file contains executable code for testing the B+-tree.  The Makefile
+ * builds it twice: test_bptree uses the normal node size, and
+ * test_bptree_small uses nodes of 4 keys, so that the same keys make a much
+ * deeper tree with many more splits, borrows and merges.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bptree.h"
+
+/*
+ * This is the same data and the same range sums as in test_bst.c.
+ */
+#define NUM_TEST_DATA 13
+const int TEST_DATA[NUM_TEST_DATA] =
+  {64, 32, 96, 16, 48, 80, 112, 8, 24, 56, 88, 104, 120};
+
+#define NUM_RANGE_SUMS 10
+const int RANGE_SUMS[NUM_RANGE_SUMS][3] = {
+  {8, 120, 848},
+  {0, 200, 848},
+  {2, 40, 80},
+  {24, 60, 160},
+  {30, 90, 368},
+  {60, 70, 64},
+  {60, 112, 544},
+  {84, 110, 288},
+  {96, 96, 96},
+  {125, 200, 0}
+};
+
+/*
+ * The random test inserts and removes keys below NUM_KEYS, NUM_OPS times,
+ * checking the whole tree every CHECK_EVERY operations.
+ */
+#define NUM_KEYS 20000
+#define NUM_OPS 200000
+#define CHECK_EVERY 20000
+#define NUM_RANGES 100
+
+/*
+ * Checks a B+-tree against an array of flags saying which keys below
+ * NUM_KEYS it should contain, with each key's value its address in the
+ * array.  Returns 1 if every key is found or not found as expected, its size
+ * is right, an iterator visits the keys in order and random range sums are
+ * right.
+ */
+int check(struct bpt* bpt, int* present) {
+  int n = 0, ok = 1;
+  for (int k = 0; k < NUM_KEYS; k++) {
+    void* value = bpt_get(bpt, k);
+    ok &= present[k] ? value == &present[k] : value == NULL;
+    n += present[k];
+  }
+  ok &= bpt_size(bpt) == n;
+
+  struct bpt_iterator* iter = bpt_iterator_create(bpt);
+  int last = -1, visited = 0;
+  while (bpt_iterator_has_next(iter)) {
+    void* value;
+    int key = bpt_iterator_next(iter, &value);
+    ok &= key > last && present[key] && value == &present[key];
+    last = key;
+    visited++;
+  }
+  bpt_iterator_free(iter);
+
+  for (int r = 0; r < NUM_RANGES; r++) {
+    int lower = rand() % (NUM_KEYS + 10) - 5;
+    int upper = lower + rand() % (NUM_KEYS / 10);
+    int sum = 0;
+    for (int k = lower < 0 ? 0 : lower; k <= upper && k < NUM_KEYS; k++) {
+      sum += present[k] ? k : 0;
+    }
+    ok &= bpt_range_sum(bpt, lower, upper) == sum;
+  }
+  return ok && visited == n;
+}
+
+int main(int argc, char** argv) {
+  printf("== Empty tree\n");
+  struct bpt* bpt = bpt_create();
+  struct bpt_iterator* iter = bpt_iterator_create(bpt);
+  printf("  - size, height (expect 0 0): %d %d\n", bpt_size(bpt),
+    bpt_height(bpt));
+  printf("  - get 5 is NULL (expect 1): %d\n", bpt_get(bpt, 5) == NULL);
+  printf("  - range sum (expect 0): %d\n", bpt_range_sum(bpt, 0, 100));
+  printf("  - iterator has next (expect 0): %d\n",
+    bpt_iterator_has_next(iter));
+  bpt_iterator_free(iter);
+  bpt_remove(bpt, 5);
+  printf("  - size after removing an absent key (expect 0): %d\n",
+    bpt_size(bpt));
+
+  printf("\n== Test data\n");
+  for (int i = 0; i < NUM_TEST_DATA; i++) {
+    bpt_insert(bpt, TEST_DATA[i], (void*)&TEST_DATA[i]);
+  }
+  printf("  - size (expect %d): %d\n", NUM_TEST_DATA, bpt_size(bpt));
+  int found = 0;
+  for (int i = 0; i < NUM_TEST_DATA; i++) {
+    int* value = bpt_get(bpt, TEST_DATA[i]);
+    found += value != NULL && *value == TEST_DATA[i];
+  }
+  printf("  - keys found with their values (expect %d): %d\n", NUM_TEST_DATA,
+    found);
+  int wrong = 0;
+  for (int i = 0; i < NUM_RANGE_SUMS; i++) {
+    wrong += bpt_range_sum(bpt, RANGE_SUMS[i][0], RANGE_SUMS[i][1]) !=
+      RANGE_SUMS[i][2];
+  }
+  printf("  - wrong range sums (expect 0): %d\n", wrong);
+  printf("  - reversed bounds, range sum (expect 0): %d\n",
+    bpt_range_sum(bpt, 90, 30));
+  int other = 7;
+  bpt_insert(bpt, 64, &other);
+  int* value = bpt_get(bpt, 64);
+  printf("  - inserting 64 again replaces its value (expect 7 %d): %d %d\n",
+    NUM_TEST_DATA, *value, bpt_size(bpt));
+  bpt_remove(bpt, 64);
+  bpt_remove(bpt, 8);
+  bpt_remove(bpt, 9);
+  printf("  - after removing 64, 8 and 9 (absent), size (expect %d): %d\n",
+    NUM_TEST_DATA - 2, bpt_size(bpt));
+  printf("  - 64 is gone (expect 1): %d\n", bpt_get(bpt, 64) == NULL);
+  bpt_free(bpt);
+
+  /*
+   * Sorted keys always go into the last leaf, and removing them in reverse
+   * always empties the last leaf, so they split and merge the same nodes
+   * over and over.
+   */
+  printf("\n== Sorted keys\n");
+  bpt = bpt_create();
+  for (int k = 0; k < NUM_KEYS; k++) {
+    bpt_insert(bpt, k, NULL);
+  }
+  iter = bpt_iterator_create(bpt);
+  int in_order = 0;
+  while (bpt_iterator_has_next(iter)) {
+    void* v;
+    in_order += bpt_iterator_next(iter, &v) == in_order;
+  }
+  bpt_iterator_free(iter);
+  printf("  - keys visited in order (expect %d): %d\n", NUM_KEYS, in_order);
+  printf("  - range sum 100..199 (expect 14950): %d\n",
+    bpt_range_sum(bpt, 100, 199));
+  int height = bpt_height(bpt);
+  for (int k = NUM_KEYS - 1; k >= 0; k--) {
+    bpt_remove(bpt, k);
+  }
+  printf("  - grew taller, then back to height 0 (expect 1 0): %d %d\n",
+    height > 1, bpt_height(bpt));
+  bpt_free(bpt);
+
+  /*
+   * Random insertions and removals, checked against an array of flags, then
+   * every key removed in random order.
+   */
+  printf("\n== Random insertions and removals\n");
+  int* present = calloc(NUM_KEYS, sizeof(int));
+  int failures = 0;
+  bpt = bpt_create();
+  srand(0);
+  for (int i = 0; i < NUM_OPS; i++) {
+    int k = rand() % NUM_KEYS;
+    if (present[k] && rand() % 3 == 0) {
+      bpt_remove(bpt, k);
+      present[k] = 0;
+    } else {
+      bpt_insert(bpt, k, &present[k]);
+      present[k] = 1;
+    }
+    if (i % CHECK_EVERY == 0) {
+      failures += !check(bpt, present);
+    }
+  }
+  failures += !check(bpt, present);
+  for (int i = 0; i < 4 * NUM_KEYS; i++) {
+    int k = rand() % NUM_KEYS;
+    bpt_remove(bpt, k);
+    present[k] = 0;
+  }
+  failures += !check(bpt, present);
+  for (int k = 0; k < NUM_KEYS; k++) {
+    bpt_remove(bpt, k);
+  }
+  printf("  - failed checks (expect 0): %d\n", failures);
+  printf("  - all removed, size and height (expect 0 0): %d %d\n",
+    bpt_size(bpt), bpt_height(bpt));
+  free(present);
+  bpt_free(bpt);
+
+  return 0;
+}
@@ -0,0 +1,153 @@
+/*
+ * This file contains executable code for testing the balanced (AVL) BST from
+ * bst_create_balanced().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "bst.h"
+
+/*
+ * This is the same data as in test_bst.c.  Inserted in this order, it fills
+ * a tree of height 3 level by level, so no rotations should happen.
+ */
+#define NUM_TEST_DATA 13
+const int TEST_DATA[NUM_TEST_DATA] =
+  {64, 32, 96, 16, 48, 80, 112, 8, 24, 56, 88, 104, 120};
+
+/*
+ * Inserting 2^k - 1 keys in sorted order into an AVL tree gives a perfectly
+ * balanced tree of height k - 1.
+ */
+#define NUM_SORTED 1023
+#define SORTED_HEIGHT 9
+
+/*
+ * The random test inserts and removes keys below NUM_KEYS, NUM_OPS times.
+ */
+#define NUM_KEYS 5000
+#define NUM_OPS 50000
+
+/*
+ * Returns the largest height an AVL tree with n nodes can have.
+ */
+int avl_max_height(int n) {
+  return (int)(1.4405 * log2(n + 2) - 0.3277) - 1;
+}
+
+/*
+ * Checks a BST against an array of flags saying which keys below NUM_KEYS
+ * it should contain, with each key's value its address in the array.
+ * Returns 1 if every key is found or not found as expected, its size is
+ * right and an iterator visits the keys in sorted order.
+ */
+int check(struct bst* bst, int* present) {
+  int n = 0, ok = 1;
+  for (int k = 0; k < NUM_KEYS; k++) {
+    void* value = bst_get(bst, k);
+    ok &= present[k] ? value == &present[k] : value == NULL;
+    n += present[k];
+  }
+  ok &= bst_size(bst) == n;
+
+  struct bst_iterator* iter = bst_iterator_create(bst);
+  int last = -1, visited = 0;
+  while (bst_iterator_has_next(iter)) {
+    void* value;
+    int key = bst_iterator_next(iter, &value);
+    ok &= key > last && present[key];
+    last = key;
+    visited++;
+  }
+  bst_iterator_free(iter);
+  return ok && visited == n;
+}
+
+int main(int argc, char** argv) {
+  printf("== Test data\n");
+  struct bst* bst = bst_create_balanced();
+  for (int i = 0; i < NUM_TEST_DATA; i++) {
+    bst_insert(bst, TEST_DATA[i], (void*)&TEST_DATA[i]);
+  }
+  printf("  - size (expect %d): %d\n", NUM_TEST_DATA, bst_size(bst));
+  printf("  - height (expect 3): %d\n", bst_height(bst));
+  printf("  - path sum 392 (expect 1): %d\n", bst_path_sum(bst, 392));
+  printf("  - range sum 30..90 (expect 368): %d\n",
+    bst_range_sum(bst, 30, 90));
+  int* value = bst_get(bst, 104);
+  printf("  - get 104 (expect 104): %d\n", value ? *value : -1);
+  bst_remove(bst, 64);
+  bst_remove(bst, 8);
+  bst_remove(bst, 24);
+  printf("  - height after removing 64, 8, 24 (expect 3): %d\n",
+    bst_height(bst));
+
+  /*
+   * Removing 16 leaves 32 with only 48 -> 56 on its right, which is rotated
+   * up into 48 with children 32 and 56, making 80 -> 48 -> 32 a path.
+   */
+  bst_remove(bst, 16);
+  printf("  - path sum 160 after removing 16 (expect 1): %d\n",
+    bst_path_sum(bst, 160));
+  printf("  - size (expect %d): %d\n", NUM_TEST_DATA - 4, bst_size(bst));
+  bst_free(bst);
+
+  printf("\n== Sorted keys\n");
+  bst = bst_create_balanced();
+  for (int i = 0; i < NUM_SORTED; i++) {
+    bst_insert(bst, i, NULL);
+  }
+  printf("  - ascending, height (expect %d): %d\n", SORTED_HEIGHT,
+    bst_height(bst));
+  bst_free(bst);
+  bst = bst_create_balanced();
+  for (int i = NUM_SORTED - 1; i >= 0; i--) {
+    bst_insert(bst, i, NULL);
+  }
+  printf("  - descending, height (expect %d): %d\n", SORTED_HEIGHT,
+    bst_height(bst));
+  for (int i = 0; i < NUM_SORTED; i += 2) {
+    bst_remove(bst, i);
+  }
+  printf("  - every other key removed, size (expect %d): %d\n",
+    NUM_SORTED / 2, bst_size(bst));
+  printf("  - height within AVL bound (expect 1): %d\n",
+    bst_height(bst) <= avl_max_height(NUM_SORTED / 2));
+  bst_free(bst);
+
+  /*
+   * Random insertions and removals, checked against an array of flags.  The
+   * height is checked after every operation.
+   */
+  printf("\n== Random insertions and removals\n");
+  int* present = calloc(NUM_KEYS, sizeof(int));
+  int n = 0, too_tall = 0, failures = 0;
+  bst = bst_create_balanced();
+  srand(0);
+  for (int i = 0; i < NUM_OPS; i++) {
+    int k = rand() % NUM_KEYS;
+    if (present[k]) {
+      bst_remove(bst, k);
+      present[k] = 0;
+      n--;
+    } else {
+      bst_insert(bst, k, &present[k]);
+      present[k] = 1;
+      n++;
+    }
+    too_tall += bst_height(bst) > avl_max_height(n);
+    if (i % 5000 == 0) {
+      failures += !check(bst, present);
+    }
+  }
+  failures += !check(bst, present);
+  printf("  - operations leaving the tree too tall (expect 0): %d\n",
+    too_tall);
+  printf("  - failed checks (expect 0): %d\n", failures);
+  free(present);
+  bst_free(bst);
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * This file contains executable code for testing the range queries that use
+ * the key sums kept in BST nodes: bst_range_sum(), bst_range_count() and
+ * bst_range_average(), on both plain and balanced BSTs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#include "bst.h"
+
+/*
+ * This is the same data and the same range sums as in test_bst.c, with the
+ * number of keys in each range added: {lower, upper, sum, count}.
+ */
+#define NUM_TEST_DATA 13
+const int TEST_DATA[NUM_TEST_DATA] =
+  {64, 32, 96, 16, 48, 80, 112, 8, 24, 56, 88, 104, 120};
+
+#define NUM_RANGE_SUMS 10
+const int RANGE_SUMS[NUM_RANGE_SUMS][4] = {
+  {8, 120, 848, 13},
+  {0, 200, 848, 13},
+  {2, 40, 80, 4},
+  {24, 60, 160, 4},
+  {30, 90, 368, 6},
+  {60, 70, 64, 1},
+  {60, 112, 544, 6},
+  {84, 110, 288, 3},
+  {96, 96, 96, 1},
+  {125, 200, 0, 0}
+};
+
+/*
+ * The random test inserts and removes keys between -NUM_KEYS / 2 and
+ * NUM_KEYS / 2, NUM_OPS times, up to twice each, and checks NUM_QUERIES
+ * random ranges every CHECK_EVERY operations.
+ */
+#define NUM_KEYS 2000
+#define NUM_OPS 20000
+#define NUM_QUERIES 200
+#define CHECK_EVERY 1000
+
+/*
+ * Checks random ranges of a BST against counts of how many times each key
+ * is in it.  Returns the number of ranges with a wrong sum or count.
+ */
+int check(struct bst* bst, int* counts) {
+  int wrong = 0;
+  for (int q = 0; q < NUM_QUERIES; q++) {
+    int lower = rand() % (NUM_KEYS + 20) - NUM_KEYS / 2 - 10;
+    int upper = lower + rand() % (NUM_KEYS / 4);
+    long long sum = 0;
+    int count = 0;
+    for (int k = lower; k <= upper; k++) {
+      int i = k + NUM_KEYS / 2;
+      if (i >= 0 && i < NUM_KEYS) {
+        sum += (long long)k * counts[i];
+        count += counts[i];
+      }
+    }
+    wrong += bst_range_sum(bst, lower, upper) != sum ||
+      bst_range_count(bst, lower, upper) != count;
+  }
+  return wrong;
+}
+
+int main(int argc, char** argv) {
+  for (int balanced = 0; balanced < 2; balanced++) {
+    printf("%s== %s BST\n", balanced ? "\n" : "", balanced ? "Balanced" :
+      "Plain");
+    struct bst* bst = balanced ? bst_create_balanced() : bst_create();
+    printf("  - empty, sum and count (expect 0 0): %d %d\n",
+      bst_range_sum(bst, 0, 10), bst_range_count(bst, 0, 10));
+    for (int i = 0; i < NUM_TEST_DATA; i++) {
+      bst_insert(bst, TEST_DATA[i], (void*)&TEST_DATA[i]);
+    }
+    int wrong = 0;
+    for (int i = 0; i < NUM_RANGE_SUMS; i++) {
+      int lower = RANGE_SUMS[i][0], upper = RANGE_SUMS[i][1];
+      wrong += bst_range_sum(bst, lower, upper) != RANGE_SUMS[i][2] ||
+        bst_range_count(bst, lower, upper) != RANGE_SUMS[i][3];
+    }
+    printf("  - wrong range sums or counts (expect 0): %d\n", wrong);
+    printf("  - average 30..90 (expect 61.33): %.2f\n",
+      bst_range_average(bst, 30, 90));
+    printf("  - average 125..200 (expect 0.00): %.2f\n",
+      bst_range_average(bst, 125, 200));
+    printf("  - reversed bounds, sum and count (expect 0 0): %d %d\n",
+      bst_range_sum(bst, 90, 30), bst_range_count(bst, 90, 30));
+    printf("  - whole int range, count (expect 13): %d\n",
+      bst_range_count(bst, INT_MIN, INT_MAX));
+    bst_remove(bst, 64);
+    bst_remove(bst, 48);
+    bst_remove(bst, 100);
+    printf("  - after removing 64, 48 and 100 (absent), sum 30..90 "
+      "(expect 256): %d\n", bst_range_sum(bst, 30, 90));
+    bst_free(bst);
+
+    /*
+     * Large keys, whose sum needs more than an int.
+     */
+    bst = balanced ? bst_create_balanced() : bst_create();
+    for (int i = 0; i < 4; i++) {
+      bst_insert(bst, INT_MAX - i, NULL);
+    }
+    printf("  - average of the 4 largest ints (expect %.1f): %.1f\n",
+      INT_MAX - 1.5, bst_range_average(bst, 0, INT_MAX));
+    bst_free(bst);
+
+    /*
+     * Random insertions and removals of negative and positive keys, with
+     * duplicates.
+     */
+    int* counts = calloc(NUM_KEYS, sizeof(int));
+    int failures = 0;
+    bst = balanced ? bst_create_balanced() : bst_create();
+    srand(balanced);
+    for (int i = 0; i < NUM_OPS; i++) {
+      int k = rand() % NUM_KEYS;
+      if (counts[k] == 2 || (counts[k] == 1 && rand() % 2)) {
+        bst_remove(bst, k - NUM_KEYS / 2);
+        counts[k]--;
+      } else {
+        bst_insert(bst, k - NUM_KEYS / 2, NULL);
+        counts[k]++;
+      }
+      if (i % CHECK_EVERY == 0) {
+        failures += check(bst, counts);
+      }
+    }
+    failures += check(bst, counts);
+    printf("  - wrong random ranges (expect 0): %d\n", failures);
+    free(counts);
+    bst_free(bst);
+  }
+
+  return 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * This file contains executable code for testing the subtree sizes kept in
+ * BST nodes: bst_size(), bst_select() and bst_rank(), on both plain and
+ * balanced BSTs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bst.h"
+
+/*
+ * This is the same data as in test_bst.c.
+ */
+#define NUM_TEST_DATA 13
+const int TEST_DATA[NUM_TEST_DATA] =
+  {64, 32, 96, 16, 48, 80, 112, 8, 24, 56, 88, 104, 120};
+
+/*
+ * The random test inserts and removes keys below NUM_KEYS, NUM_OPS times.
+ * Keys are inserted up to twice, to check duplicates are counted.
+ */
+#define NUM_KEYS 2000
+#define NUM_OPS 20000
+
+/*
+ * Checks the sizes of a BST against counts of how many times each key below
+ * NUM_KEYS is in it.  Returns 1 if bst_size() is right, bst_select() finds
+ * every key at every rank it should and bst_rank() of every key (and of
+ * NUM_KEYS) is the number of smaller keys.
+ */
+int check(struct bst* bst, int* counts) {
+  int ok = 1, rank = 0;
+  for (int k = 0; k <= NUM_KEYS; k++) {
+    ok &= bst_rank(bst, k) == rank;
+    for (int i = 0; k < NUM_KEYS && i < counts[k]; i++) {
+      ok &= bst_select(bst, rank++, NULL) == k;
+    }
+  }
+  return ok && bst_size(bst) == rank;
+}
+
+int main(int argc, char** argv) {
+  int sorted[NUM_TEST_DATA];
+  for (int balanced = 0; balanced < 2; balanced++) {
+    printf("%s== %s BST\n", balanced ? "\n" : "", balanced ? "Balanced" :
+      "Plain");
+    struct bst* bst = balanced ? bst_create_balanced() : bst_create();
+    printf("  - empty, size (expect 0): %d\n", bst_size(bst));
+    printf("  - empty, rank of 5 (expect 0): %d\n", bst_rank(bst, 5));
+    for (int i = 0; i < NUM_TEST_DATA; i++) {
+      bst_insert(bst, TEST_DATA[i], (void*)&TEST_DATA[i]);
+    }
+    printf("  - size (expect %d): %d\n", NUM_TEST_DATA, bst_size(bst));
+
+    /*
+     * The test data is 8, 16, ..., 120 with 40 and 72 missing.
+     */
+    int n = 0;
+    for (int k = 8; k <= 120; k += 8) {
+      if (k != 40 && k != 72) {
+        sorted[n++] = k;
+      }
+    }
+    int selected = 0;
+    for (int i = 0; i < NUM_TEST_DATA; i++) {
+      int* value;
+      int key = bst_select(bst, i, (void**)&value);
+      selected += key == sorted[i] && *value == key;
+    }
+    printf("  - keys selected at the right ranks (expect %d): %d\n",
+      NUM_TEST_DATA, selected);
+    printf("  - median (expect 64): %d\n",
+      bst_select(bst, bst_size(bst) / 2, NULL));
+    printf("  - rank of 8, 64, 72, 120, 121 (expect 0 6 7 12 13): %d %d %d "
+      "%d %d\n", bst_rank(bst, 8), bst_rank(bst, 64), bst_rank(bst, 72),
+      bst_rank(bst, 120), bst_rank(bst, 121));
+
+    bst_remove(bst, 64);
+    bst_remove(bst, 72);
+    bst_remove(bst, 8);
+    printf("  - size after removing 64, 72 (absent) and 8 (expect %d): %d\n",
+      NUM_TEST_DATA - 2, bst_size(bst));
+    printf("  - smallest, largest (expect 16 120): %d %d\n",
+      bst_select(bst, 0, NULL), bst_select(bst, bst_size(bst) - 1, NULL));
+    printf("  - rank of 80 (expect 5): %d\n", bst_rank(bst, 80));
+    bst_free(bst);
+
+    /*
+     * Random insertions and removals, with duplicates, checked against
+     * counts of each key.
+     */
+    int* counts = calloc(NUM_KEYS, sizeof(int));
+    int failures = 0;
+    bst = balanced ? bst_create_balanced() : bst_create();
+    srand(balanced);
+    for (int i = 0; i < NUM_OPS; i++) {
+      int k = rand() % NUM_KEYS;
+      if (counts[k] == 2 || (counts[k] == 1 && rand() % 2)) {
+        bst_remove(bst, k);
+        counts[k]--;
+      } else {
+        bst_insert(bst, k, NULL);
+        counts[k]++;
+      }
+      if (i % 2000 == 0) {
+        failures += !check(bst, counts);
+      }
+    }
+    failures += !check(bst, counts);
+    printf("  - failed random checks (expect 0): %d\n", failures);
+    free(counts);
+    bst_free(bst);
+  }
+
+  return 0;
+}
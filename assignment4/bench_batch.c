@@ -0,0 +1,87 @@
+/*
+ * This program measures the throughput of sssp_batch() in sources per second
+ * for increasing numbers of threads.  The distance matrix is written to a
+ * temporary file that is removed afterwards.
+ *
+ * Without a graph file, a random graph with uniformly random edges and
+ * weights in [1, 1000] is used.  Thread counts above the number of online
+ * CPUs are marked as oversubscribed.
+ *
+ * Usage: ./bench_batch [file|-] [max_threads] [n_sources] [n_nodes] [n_edges]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "graph.h"
+#include "sssp.h"
+#include "bench.h"
+
+static struct graph* random_graph(int n, int m) {
+  int* sources = malloc(m * sizeof(int));
+  int* targets = malloc(m * sizeof(int));
+  int* weights = malloc(m * sizeof(int));
+  for (int i = 0; i < m; i++) {
+    sources[i] = rand() % n;
+    targets[i] = rand() % n;
+    weights[i] = 1 + rand() % 1000;
+  }
+  struct graph* graph = graph_from_edges(n, m, sources, targets, weights);
+  free(sources);
+  free(targets);
+  free(weights);
+  return graph;
+}
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : "-";
+  int max_threads = argc > 2 ? atoi(argv[2]) : 8;
+  int n_sources = argc > 3 ? atoi(argv[3]) : 64;
+  int n = argc > 4 ? atoi(argv[4]) : 100000;
+  int m = argc > 5 ? atoi(argv[5]) : 8 * n;
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  srand(0);
+  struct graph* graph = strcmp(path, "-") ? graph_open(path, 0) :
+    random_graph(n, m);
+  if (graph == NULL) {
+    return EXIT_FAILURE;
+  }
+  n = graph->n_nodes;
+  int* sources = malloc(n_sources * sizeof(int));
+  for (int i = 0; i < n_sources; i++) {
+    sources[i] = rand() % n;
+  }
+
+  char output[] = "/tmp/bench_batch_XXXXXX";
+  int fd = mkstemp(output);
+  if (fd < 0) {
+    perror("mkstemp");
+    return EXIT_FAILURE;
+  }
+  close(fd);
+
+  printf("%d nodes, %d edges, %d sources, %ld CPUs\n", n, graph->n_edges,
+    n_sources, cpus);
+  printf("matrix: %.1f MB\n\n", (double)n_sources * n * sizeof(dist_t) / 1e6);
+  printf("%8s  %10s  %12s\n", "threads", "time", "sources/s");
+  for (int t = 1; t <= max_threads; t *= 2) {
+    double start = bench_now();
+    if (sssp_batch(graph, sources, n_sources, t, output) != 0) {
+      break;
+    }
+    double elapsed = bench_now() - start;
+    printf("%7d%s  %8.3f s  %12.1f\n", t, t > cpus ? "*" : " ", elapsed,
+      n_sources / elapsed);
+  }
+  printf("\n* = oversubscribed\n");
+
+  unlink(output);
+  free(sources);
+  graph_free(graph);
+  return 0;
+}
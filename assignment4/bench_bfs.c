@@ -0,0 +1,141 @@
+/*
+ * This program measures breadth-first search throughput in edges per second:
+ * the number of edges out of the nodes a search reaches, divided by its
+ * time, as in the Graph500 benchmark.  It compares:
+ *
+ *   - a plain queue-based search with a calloc'd int per node for visited,
+ *     the way dijkstra.c kept its visited set;
+ *   - bfs.c searching top-down only, with bitsets;
+ *   - bfs.c switching between top-down and bottom-up, with 1, 2, 4, ...
+ *     threads.
+ *
+ * Without a graph file, an R-MAT graph of 2^scale nodes and 16 edges per
+ * node is generated, since power-law graphs are where bottom-up steps help
+ * most.  Every search's depths are checked against the plain search.
+ *
+ * Usage: ./bench_bfs [file|-] [max_threads] [scale] [n_sources]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bfs.h"
+#include "gen.h"
+#include "graph.h"
+#include "bench.h"
+
+/*
+ * The baseline: a queue of nodes and an int per node for visited.
+ */
+static void plain_bfs(struct graph* graph, int source, int* depth,
+    int* queue) {
+  int n = graph->n_nodes;
+  int* visited = calloc(n, sizeof(int));
+  for (int v = 0; v < n; v++) {
+    depth[v] = -1;
+  }
+  int head = 0, tail = 0;
+  visited[source] = 1;
+  depth[source] = 0;
+  queue[tail++] = source;
+  while (head < tail) {
+    int u = queue[head++];
+    for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+      int v = graph->targets[e];
+      if (!visited[v]) {
+        visited[v] = 1;
+        depth[v] = depth[u] + 1;
+        queue[tail++] = v;
+      }
+    }
+  }
+  free(visited);
+}
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : "-";
+  int max_threads = argc > 2 ? atoi(argv[2]) : 8;
+  int scale = argc > 3 ? atoi(argv[3]) : 20;
+  int n_sources = argc > 4 ? atoi(argv[4]) : 8;
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  struct graph* graph = strcmp(path, "-") ? graph_open(path, 0) :
+    gen_rmat(scale, 16 << scale, 1, 1);
+  if (graph == NULL) {
+    return EXIT_FAILURE;
+  }
+  int n = graph->n_nodes;
+  printf("%d nodes, %d edges, %ld CPUs\n\n", n, graph->n_edges, cpus);
+
+  /*
+   * Pick sources with out-edges, and count the edges each search reaches.
+   */
+  int* sources = malloc(n_sources * sizeof(int));
+  int** expected = malloc(n_sources * sizeof(int*));
+  int* depth = malloc(n * sizeof(int));
+  int* queue = malloc(n * sizeof(int));
+  long edges = 0;
+  double elapsed = 0;
+  srand(0);
+  for (int i = 0; i < n_sources; i++) {
+    do {
+      sources[i] = rand() % n;
+    } while (graph->offsets[sources[i]] == graph->offsets[sources[i] + 1]);
+    expected[i] = malloc(n * sizeof(int));
+    double start = bench_now();
+    plain_bfs(graph, sources[i], expected[i], queue);
+    elapsed += bench_now() - start;
+    for (int v = 0; v < n; v++) {
+      if (expected[i][v] >= 0) {
+        edges += graph->offsets[v + 1] - graph->offsets[v];
+      }
+    }
+  }
+  printf("%-20s %10s %12s %10s\n", "search", "ms/search", "Medges/s",
+    "bottom-up");
+  printf("%-20s %10.2f %12.1f %10s\n", "plain", elapsed / n_sources * 1e3,
+    edges / elapsed * 1e-6, "-");
+
+  struct bfs* bfs = bfs_create(graph);
+  for (int t = 0; t <= max_threads; t = t ? 2 * t : 1) {
+    int mode = t ? BFS_DIRECTION_OPTIMIZING : BFS_TOP_DOWN;
+    int wrong = 0, levels = 0, bottom_up = 0;
+    elapsed = 0;
+    for (int i = 0; i < n_sources; i++) {
+      double start = bench_now();
+      bfs_run(bfs, sources[i], mode, t ? t : 1, depth, NULL);
+      elapsed += bench_now() - start;
+      int up;
+      levels += bfs_last_levels(bfs, &up);
+      bottom_up += up;
+      wrong += memcmp(depth, expected[i], n * sizeof(int)) != 0;
+    }
+    char name[32], share[32];
+    if (t) {
+      snprintf(name, sizeof(name), "optimizing %dthr%s", t,
+        t > cpus ? "*" : "");
+    } else {
+      snprintf(name, sizeof(name), "top-down");
+    }
+    snprintf(share, sizeof(share), "%d/%d", bottom_up, levels);
+    printf("%-20s %10.2f %12.1f %10s%s\n", name, elapsed / n_sources * 1e3,
+      edges / elapsed * 1e-6, share, wrong ? "  !" : "");
+  }
+  printf("\nbottom-up = levels searched bottom-up / all levels\n"
+    "* = oversubscribed, ! = depths differ from the plain search\n");
+
+  bfs_free(bfs);
+  for (int i = 0; i < n_sources; i++) {
+    free(expected[i]);
+  }
+  free(expected);
+  free(sources);
+  free(depth);
+  free(queue);
+  graph_free(graph);
+  return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ * This program measures contraction hierarchies on generated grid and random
+ * geometric graphs.  For each graph it reports the preprocessing time, the
+ * number of shortcuts, the size of the index, and the average number of
+ * nodes settled and time per query for:
+ *
+ *   - full Dijkstra from s (for a few queries only);
+ *   - bidirectional Dijkstra (query.c);
+ *   - the contraction hierarchy.
+ *
+ * Every answer is checked against bidirectional Dijkstra.
+ *
+ * Usage: ./bench_ch [grid_side] [geometric_nodes] [n_queries]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ch.h"
+#include "gen.h"
+#include "graph.h"
+#include "query.h"
+#include "sssp.h"
+#include "bench.h"
+
+#define FULL_QUERIES 10
+
+static void run(const char* name, struct graph* graph, int n_queries) {
+  int n = graph->n_nodes;
+  printf("== %s: %d nodes, %d edges\n", name, n, graph->n_edges);
+
+  int* from = malloc(n_queries * sizeof(int));
+  int* to = malloc(n_queries * sizeof(int));
+  dist_t* expected = malloc(n_queries * sizeof(dist_t));
+  dist_t* dist = malloc(n * sizeof(dist_t));
+  for (int q = 0; q < n_queries; q++) {
+    from[q] = rand() % n;
+    to[q] = rand() % n;
+  }
+
+  double start = bench_now();
+  struct ch* ch = ch_build(graph);
+  double build = bench_now() - start;
+  printf("  preprocessing: %.2f s, %ld shortcuts, index %.1f MB "
+    "(graph %.1f MB)\n\n", build, ch_num_shortcuts(ch),
+    ch_index_bytes(ch) / 1e6,
+    ((n + 1) + 2.0 * graph->n_edges) * sizeof(int) / 1e6);
+
+  printf("  %-16s %12s %12s %8s\n", "engine", "settled/q", "us/q", "wrong");
+  long settled = 0;
+  int full = n_queries < FULL_QUERIES ? n_queries : FULL_QUERIES;
+  start = bench_now();
+  for (int q = 0; q < full; q++) {
+    sssp_dijkstra(graph, from[q], dist, NULL);
+  }
+  double elapsed = bench_now() - start;
+  for (int v = 0; v < n; v++) {
+    settled += dist[v] != DIST_INF;
+  }
+  printf("  %-16s %12ld %12.1f %8s\n", "dijkstra", settled,
+    elapsed / full * 1e6, "-");
+
+  struct sp* sp = sp_create(graph, 0);
+  settled = 0;
+  start = bench_now();
+  for (int q = 0; q < n_queries; q++) {
+    expected[q] = sp_query(sp, from[q], to[q]);
+    settled += sp_last_settled(sp);
+  }
+  elapsed = bench_now() - start;
+  printf("  %-16s %12.0f %12.1f %8s\n", "bidirectional",
+    (double)settled / n_queries, elapsed / n_queries * 1e6, "-");
+  sp_free(sp);
+
+  int wrong = 0;
+  settled = 0;
+  start = bench_now();
+  for (int q = 0; q < n_queries; q++) {
+    wrong += ch_query(ch, from[q], to[q]) != expected[q];
+    settled += ch_last_settled(ch);
+  }
+  elapsed = bench_now() - start;
+  printf("  %-16s %12.0f %12.1f %8d\n\n", "ch",
+    (double)settled / n_queries, elapsed / n_queries * 1e6, wrong);
+
+  ch_free(ch);
+  free(from);
+  free(to);
+  free(expected);
+  free(dist);
+}
+
+int main(int argc, char** argv) {
+  int side = argc > 1 ? atoi(argv[1]) : 300;
+  int n_geometric = argc > 2 ? atoi(argv[2]) : 100000;
+  int n_queries = argc > 3 ? atoi(argv[3]) : 1000;
+  srand(0);
+
+  struct graph* graph = gen_grid(side, side, 100, 1);
+  run("grid", graph, n_queries);
+  graph_free(graph);
+
+  graph = gen_geometric(n_geometric, 6, 1);
+  run("geometric", graph, n_queries);
+  graph_free(graph);
+  return 0;
+}
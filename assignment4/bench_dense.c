@@ -0,0 +1,154 @@
+/*
+ * This program compares the dense-graph engine with the matrix loops in
+ * dijkstra.c on nearly complete random graphs.  For each size it reports
+ * the average time per run of:
+ *
+ *   - matrix: the loops from dijkstra.c, with one malloc() per matrix row
+ *     and an int visited[] array;
+ *   - scalar: dense_dijkstra_scalar(), on one aligned block with no
+ *     visited array;
+ *   - simd: dense_dijkstra(), the same with AVX2 (if available).
+ *
+ * Every run is checked against the matrix loops, predecessors included.
+ * Each graph has an edge between about 95% of the ordered pairs of nodes.
+ *
+ * Usage: ./bench_dense [runs] [sizes...]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sssp.h"
+#include "dense.h"
+#include "bench.h"
+
+#define DENSITY 95
+
+/*
+ * Returns the weight of the edge u -> v of the graph of size n, or
+ * DENSE_NO_EDGE, from a hash of the pair so that both matrices can be
+ * filled in without storing an edge list.
+ */
+static int edge_weight(int n, int u, int v) {
+  unsigned long long x = (unsigned long long)u * n + v + 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  if (u == v) {
+    return 0;
+  }
+  return x % 100 < DENSITY ? 1 + (int)((x >> 8) % 1000) : DENSE_NO_EDGE;
+}
+
+/*
+ * The loops from dijkstra.c, on a matrix with one allocation per row.
+ */
+static void matrix_dijkstra(int** graph, int n_nodes, int start,
+    dist_t* distances, int* previous) {
+  int* visited = calloc(n_nodes, sizeof(int));
+  for (int i = 0; i < n_nodes; i++) {
+    distances[i] = DIST_INF;
+    previous[i] = -1;
+  }
+  distances[start] = 0;
+  previous[start] = start;
+
+  for (int i = 0; i < n_nodes; i++) {
+    int u = -1;
+    for (int j = 0; j < n_nodes; j++) {
+      if (!visited[j] && (u == -1 || distances[j] < distances[u])) {
+        u = j;
+      }
+    }
+    if (distances[u] == DIST_INF) {
+      break;
+    }
+    visited[u] = 1;
+    for (int v = 0; v < n_nodes; v++) {
+      if (graph[u][v] == INT_MAX) {
+        continue;
+      }
+      dist_t d = dist_add(distances[u], graph[u][v]);
+      if (d < distances[v]) {
+        distances[v] = d;
+        previous[v] = u;
+      }
+    }
+  }
+  free(visited);
+}
+
+int main(int argc, char** argv) {
+  int runs = argc > 1 ? atoi(argv[1]) : 3;
+  int default_sizes[] = {1000, 4000, 16000};
+  int n_sizes = argc > 2 ? argc - 2 : 3;
+
+  int simd = dense_simd_available();
+  printf("AVX2 %s, %d runs per size\n\n", simd ? "available" : "unavailable",
+    runs);
+  printf("%8s %12s %12s %12s %10s %8s\n", "nodes", "matrix ms", "scalar ms",
+    "simd ms", "speedup", "wrong");
+
+  for (int i = 0; i < n_sizes; i++) {
+    int n = argc > 2 ? atoi(argv[i + 2]) : default_sizes[i];
+    int** matrix = malloc(n * sizeof(int*));
+    struct dense_graph* dense = dense_create(n);
+    if (matrix == NULL || dense == NULL) {
+      fprintf(stderr, "%d nodes: not enough memory\n", n);
+      return EXIT_FAILURE;
+    }
+    for (int u = 0; u < n; u++) {
+      matrix[u] = malloc(n * sizeof(int));
+      if (matrix[u] == NULL) {
+        fprintf(stderr, "%d nodes: not enough memory\n", n);
+        return EXIT_FAILURE;
+      }
+      for (int v = 0; v < n; v++) {
+        matrix[u][v] = dense->weights[(size_t)u * dense->stride + v] =
+          edge_weight(n, u, v);
+      }
+    }
+
+    dist_t* d_ref = malloc(n * sizeof(dist_t));
+    dist_t* d = malloc(n * sizeof(dist_t));
+    int* p_ref = malloc(n * sizeof(int));
+    int* p = malloc(n * sizeof(int));
+    double elapsed[3] = {0, 0, 0};
+    int wrong = 0;
+    for (int r = 0; r < runs; r++) {
+      int source = (int)((long long)r * 7919 % n);
+      double start = bench_now();
+      matrix_dijkstra(matrix, n, source, d_ref, p_ref);
+      elapsed[0] += bench_now() - start;
+
+      for (int engine = 1; engine < 3; engine++) {
+        start = bench_now();
+        if (engine == 1) {
+          dense_dijkstra_scalar(dense, source, d, p);
+        } else {
+          dense_dijkstra(dense, source, d, p);
+        }
+        elapsed[engine] += bench_now() - start;
+        wrong += memcmp(d, d_ref, n * sizeof(dist_t)) ||
+          memcmp(p, p_ref, n * sizeof(int));
+      }
+    }
+    printf("%8d %12.1f %12.1f %12.1f %9.1fx %8d\n", n,
+      elapsed[0] / runs * 1e3, elapsed[1] / runs * 1e3,
+      elapsed[2] / runs * 1e3, elapsed[0] / elapsed[2], wrong);
+
+    for (int u = 0; u < n; u++) {
+      free(matrix[u]);
+    }
+    free(matrix);
+    dense_free(dense);
+    free(d_ref);
+    free(d);
+    free(p_ref);
+    free(p);
+  }
+  return 0;
+}
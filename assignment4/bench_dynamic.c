@@ -0,0 +1,139 @@
+/*
+ * This program compares repairing a shortest-path tree after a batch of edge
+ * changes with computing it again from scratch.  For batches of 1, 10, 100
+ * and 1000 random changes (a third deletions, a third insertions and a third
+ * new weights for existing edges, heavier or lighter), it reports the
+ * average time per batch for:
+ *
+ *   - repair with dyn_tree_repair();
+ *   - recomputing the tree on the dynamic graph (dyn_tree_recompute());
+ *   - taking a CSR snapshot and running sssp_dijkstra() on it, which is what
+ *     rebuilding from scratch costs with the static code.
+ *
+ * Every repaired tree is checked against the recomputed one.
+ *
+ * Usage: ./bench_dynamic [file|-] [rounds] [n_nodes] [n_edges]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "graph.h"
+#include "sssp.h"
+#include "dynamic.h"
+#include "bench.h"
+
+static struct graph* random_graph(int n, int m) {
+  int* sources = malloc(m * sizeof(int));
+  int* targets = malloc(m * sizeof(int));
+  int* weights = malloc(m * sizeof(int));
+  for (int i = 0; i < m; i++) {
+    sources[i] = rand() % n;
+    targets[i] = rand() % n;
+    weights[i] = 1 + rand() % 1000;
+  }
+  struct graph* graph = graph_from_edges(n, m, sources, targets, weights);
+  free(sources);
+  free(targets);
+  free(weights);
+  return graph;
+}
+
+/*
+ * Makes one random change to the graph.
+ */
+static void random_change(struct dyn_graph* dyn, struct graph* graph) {
+  int n = graph->n_nodes;
+  int kind = rand() % 3;
+  if (kind == 0 || graph->n_edges == 0) {
+    dyn_graph_set_edge(dyn, rand() % n, rand() % n, 1 + rand() % 1000);
+    return;
+  }
+
+  /*
+   * Pick an edge of the original graph; it may have been deleted already,
+   * in which case this is an insertion after all.
+   */
+  int e = rand() % graph->n_edges;
+  int u = 0, lo = 0, hi = n;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (graph->offsets[mid + 1] <= e) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  u = lo;
+  if (kind == 1) {
+    dyn_graph_remove_edge(dyn, u, graph->targets[e]);
+  } else {
+    dyn_graph_set_edge(dyn, u, graph->targets[e], 1 + rand() % 1000);
+  }
+}
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : "-";
+  int rounds = argc > 2 ? atoi(argv[2]) : 10;
+  int n = argc > 3 ? atoi(argv[3]) : 1000000;
+  int m = argc > 4 ? atoi(argv[4]) : 4 * n;
+
+  srand(0);
+  struct graph* graph = strcmp(path, "-") ? graph_open(path, 0) :
+    random_graph(n, m);
+  if (graph == NULL) {
+    return EXIT_FAILURE;
+  }
+  n = graph->n_nodes;
+  printf("%d nodes, %d edges, %d rounds\n\n", n, graph->n_edges, rounds);
+
+  struct dyn_graph* dyn = dyn_graph_create(graph);
+  struct dyn_tree* tree = dyn_tree_create(dyn, 0);
+  struct dyn_tree* fresh = dyn_tree_create(dyn, 0);
+  dist_t* dist = malloc(n * sizeof(dist_t));
+
+  printf("%8s %12s %12s %12s %12s %10s %8s\n", "changes", "redone/batch",
+    "repair ms", "recompute ms", "rebuild ms", "speedup", "wrong");
+  int sizes[] = {1, 10, 100, 1000};
+  for (int i = 0; i < 4; i++) {
+    double repair = 0, recompute = 0, rebuild = 0;
+    long redone = 0;
+    int wrong = 0;
+    for (int r = 0; r < rounds; r++) {
+      for (int c = 0; c < sizes[i]; c++) {
+        random_change(dyn, graph);
+      }
+
+      double start = bench_now();
+      redone += dyn_tree_repair(tree);
+      repair += bench_now() - start;
+
+      start = bench_now();
+      dyn_tree_recompute(fresh);
+      recompute += bench_now() - start;
+
+      start = bench_now();
+      struct graph* snapshot = dyn_graph_snapshot(dyn);
+      sssp_dijkstra(snapshot, 0, dist, NULL);
+      graph_free(snapshot);
+      rebuild += bench_now() - start;
+
+      wrong += memcmp(dyn_tree_dist(tree), dyn_tree_dist(fresh),
+        n * sizeof(dist_t)) != 0;
+    }
+    printf("%8d %12.0f %12.3f %12.3f %12.3f %9.1fx %8d\n", sizes[i],
+      (double)redone / rounds, repair / rounds * 1e3,
+      recompute / rounds * 1e3, rebuild / rounds * 1e3, recompute / repair,
+      wrong);
+  }
+
+  free(dist);
+  dyn_tree_free(tree);
+  dyn_tree_free(fresh);
+  dyn_graph_free(dyn);
+  graph_free(graph);
+  return 0;
+}
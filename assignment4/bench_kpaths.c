@@ -0,0 +1,93 @@
+/*
+ * This program measures Yen's K-shortest-paths algorithm on medium graphs.
+ * For K from 1 to 100 it reports the average time per query, the number of
+ * Dijkstra searches per query, and how far the K-th path is from the
+ * shortest, for random pairs of nodes on:
+ *
+ *   - a random geometric graph, which is shaped like a road network and
+ *     has long paths with many near-equal alternatives;
+ *   - a uniform random graph, where paths are a few hops long.
+ *
+ * Usage: ./bench_kpaths [n_queries] [n_nodes]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+#include "sssp.h"
+#include "gen.h"
+#include "kpaths.h"
+#include "bench.h"
+
+static struct graph* random_graph(int n, int m) {
+  int* sources = malloc(m * sizeof(int));
+  int* targets = malloc(m * sizeof(int));
+  int* weights = malloc(m * sizeof(int));
+  for (int i = 0; i < m; i++) {
+    sources[i] = rand() % n;
+    targets[i] = rand() % n;
+    weights[i] = 1 + rand() % 1000;
+  }
+  struct graph* graph = graph_from_edges(n, m, sources, targets, weights);
+  free(sources);
+  free(targets);
+  free(weights);
+  return graph;
+}
+
+int main(int argc, char** argv) {
+  int n_queries = argc > 1 ? atoi(argv[1]) : 5;
+  int n = argc > 2 ? atoi(argv[2]) : 10000;
+
+  srand(0);
+  struct graph* graphs[] = {gen_geometric(n, 6, 1), random_graph(n, 4 * n)};
+  const char* names[] = {"geometric", "random"};
+  int ks[] = {1, 2, 5, 10, 20, 50, 100};
+
+  for (int g = 0; g < 2; g++) {
+    struct graph* graph = graphs[g];
+    printf("%s: %d nodes, %d edges, %d queries\n\n", names[g],
+      graph->n_nodes, graph->n_edges, n_queries);
+    printf("%6s %12s %14s %14s %12s\n", "K", "ms/query", "searches/q",
+      "us/search", "K-th/first");
+
+    struct ksp* ksp = ksp_create(graph);
+    int* from = malloc(n_queries * sizeof(int));
+    int* to = malloc(n_queries * sizeof(int));
+    for (int q = 0; q < n_queries; q++) {
+      from[q] = rand() % graph->n_nodes;
+      to[q] = rand() % graph->n_nodes;
+    }
+
+    for (int i = 0; i < 7; i++) {
+      int k = ks[i];
+      long searches = 0;
+      double stretch = 0;
+      int answered = 0;
+      double start = bench_now();
+      for (int q = 0; q < n_queries; q++) {
+        int found = ksp_find(ksp, from[q], to[q], k);
+        searches += ksp_last_searches(ksp);
+        if (found > 0 && ksp_length(ksp, 0) > 0) {
+          stretch += (double)ksp_length(ksp, found - 1) / ksp_length(ksp, 0);
+          answered++;
+        }
+      }
+      double elapsed = bench_now() - start;
+      printf("%6d %12.2f %14.1f %14.1f %12.3f\n", k,
+        elapsed / n_queries * 1e3, (double)searches / n_queries,
+        searches ? elapsed / searches * 1e6 : 0,
+        answered ? stretch / answered : 0);
+    }
+    printf("\n");
+
+    free(from);
+    free(to);
+    ksp_free(ksp);
+    graph_free(graph);
+  }
+  return 0;
+}
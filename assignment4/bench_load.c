@@ -0,0 +1,155 @@
+/*
+ * This program measures how fast a graph in the `airports.dat` text format can
+ * be loaded, comparing the original one-fscanf()-per-edge path with the
+ * memory-mapped parallel loader in graph.c at several thread counts.  Load
+ * throughput is reported in MB of input text per second.
+ *
+ * The graph is then saved as a binary graph file, and the time to open that
+ * with graph_load_binary() is reported, both on its own (which is all a
+ * program needs before it starts using the graph) and including a first pass
+ * over every array.
+ *
+ * If no file is given, a random graph is written to a temporary file first.
+ * The file is read once before timing so every loader sees a warm page cache.
+ *
+ * Usage: ./bench_load [file] [max_threads]
+ *        ./bench_load - [max_threads] [n_nodes] [n_edges]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "graph.h"
+#include "bench.h"
+
+/*
+ * Writes a random graph with the given size to a new temporary file and
+ * returns its path, which the caller should unlink() and free().
+ */
+static char* write_random_graph(int n_nodes, int n_edges) {
+  char* path = strdup("/tmp/bench_load_XXXXXX");
+  int fd = mkstemp(path);
+  FILE* file = fd >= 0 ? fdopen(fd, "w") : NULL;
+  if (file == NULL) {
+    perror("mkstemp");
+    exit(EXIT_FAILURE);
+  }
+
+  srand(0);
+  fprintf(file, "%d\n%d\n", n_nodes, n_edges);
+  for (int i = 0; i < n_edges; i++) {
+    fprintf(file, "%d %d %d\n", rand() % n_nodes, rand() % n_nodes,
+      1 + rand() % 1000);
+  }
+  fclose(file);
+  return path;
+}
+
+/*
+ * Returns 1 if two graphs have identical CSR arrays.
+ */
+static int same_graph(struct graph* a, struct graph* b) {
+  return a->n_nodes == b->n_nodes && a->n_edges == b->n_edges &&
+    !memcmp(a->offsets, b->offsets, (a->n_nodes + 1) * sizeof(int)) &&
+    !memcmp(a->targets, b->targets, a->n_edges * sizeof(int)) &&
+    !memcmp(a->weights, b->weights, a->n_edges * sizeof(int));
+}
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : "-";
+  int max_threads = argc > 2 ? atoi(argv[2]) :
+    (int)sysconf(_SC_NPROCESSORS_ONLN);
+  char* temp = NULL;
+  if (strcmp(path, "-") == 0) {
+    int n_nodes = argc > 3 ? atoi(argv[3]) : 1000000;
+    int n_edges = argc > 4 ? atoi(argv[4]) : 5000000;
+    printf("== Writing random graph with %d nodes and %d edges\n", n_nodes,
+      n_edges);
+    path = temp = write_random_graph(n_nodes, n_edges);
+  }
+
+  struct stat st;
+  if (stat(path, &st) < 0) {
+    perror(path);
+    return EXIT_FAILURE;
+  }
+  double mb = st.st_size / 1e6;
+
+  /*
+   * Warm the page cache.
+   */
+  FILE* file = fopen(path, "r");
+  char buf[1 << 16];
+  while (file && fread(buf, 1, sizeof(buf), file) > 0) {
+  }
+  if (file) {
+    fclose(file);
+  }
+
+  printf("== Loading %s (%.1f MB)\n", path, mb);
+  double start = bench_now();
+  struct graph* reference = graph_load_fscanf(path);
+  double elapsed = bench_now() - start;
+  if (reference == NULL) {
+    return EXIT_FAILURE;
+  }
+  printf("  %-20s %9.3f s %9.1f MB/s\n", "fscanf()", elapsed, mb / elapsed);
+
+  int ok = 1;
+  for (int t = 1; t <= max_threads; t *= 2) {
+    start = bench_now();
+    struct graph* graph = graph_load(path, t);
+    elapsed = bench_now() - start;
+    if (graph == NULL) {
+      return EXIT_FAILURE;
+    }
+    char label[32];
+    snprintf(label, sizeof(label), "graph_load(), %d thr", t);
+    printf("  %-20s %9.3f s %9.1f MB/s%s\n", label, elapsed, mb / elapsed,
+      same_graph(graph, reference) ? "" : "  ** graph differs **");
+    ok = ok && same_graph(graph, reference);
+    graph_free(graph);
+  }
+
+  /*
+   * Convert to the binary format and time opening it.
+   */
+  char* binary = strdup("/tmp/bench_load_bin_XXXXXX");
+  int fd = mkstemp(binary);
+  if (fd < 0 || graph_save_binary(reference, binary) != 0) {
+    return EXIT_FAILURE;
+  }
+  close(fd);
+  stat(binary, &st);
+
+  start = bench_now();
+  struct graph* mapped = graph_load_binary(binary);
+  elapsed = bench_now() - start;
+  if (mapped == NULL) {
+    return EXIT_FAILURE;
+  }
+  printf("  %-20s %9.6f s  (%.1f MB binary file)\n", "graph_load_binary()",
+    elapsed, st.st_size / 1e6);
+
+  start = bench_now();
+  int same = same_graph(mapped, reference);
+  elapsed += bench_now() - start;
+  printf("  %-20s %9.3f s%s\n", "  + first full pass", elapsed,
+    same ? "" : "  ** graph differs **");
+  ok = ok && same;
+  graph_free(mapped);
+  unlink(binary);
+  free(binary);
+
+  graph_free(reference);
+  if (temp) {
+    unlink(temp);
+    free(temp);
+  }
+  return ok ? 0 : EXIT_FAILURE;
+}
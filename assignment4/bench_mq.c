@@ -0,0 +1,256 @@
+/*
+ * This program measures how a MultiQueue scales with the number of threads,
+ * compared with a single pq protected by one mutex.  For each thread count it
+ * reports:
+ *
+ *   - throughput: every thread repeatedly removes an element and inserts a
+ *     new one with a slightly larger priority (a "hold" workload, as in a
+ *     discrete-event scheduler).
+ *   - rank error: the queue is filled with distinct priorities and then
+ *     drained by all threads at once.  The rank of a removal is the number of
+ *     elements still in the queue with a smaller priority at that moment
+ *     (0 for an exact priority queue).
+ *
+ * Rows with more threads than online CPUs are marked as oversubscribed.  In
+ * that case a thread can be descheduled while holding a sub-queue lock, and
+ * the other threads skip that sub-queue for a whole time slice, which
+ * inflates the rank error far beyond what a MultiQueue shows on real cores.
+ *
+ * Usage: ./bench_mq [max_threads] [queues_per_thread] [ops_per_thread]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "mq.h"
+#include "pq.h"
+#include "bench.h"
+
+#define PREFILL (1 << 18)
+
+/*
+ * A pq behind one global mutex, which is the baseline being replaced.
+ */
+struct locked_pq {
+  pthread_mutex_t lock;
+  struct pq* pq;
+};
+
+static struct locked_pq* locked_create() {
+  struct locked_pq* lpq = malloc(sizeof(struct locked_pq));
+  pthread_mutex_init(&lpq->lock, NULL);
+  lpq->pq = pq_create();
+  return lpq;
+}
+
+static void locked_free(struct locked_pq* lpq) {
+  pthread_mutex_destroy(&lpq->lock);
+  pq_free(lpq->pq);
+  free(lpq);
+}
+
+static void locked_insert(struct locked_pq* lpq, int priority) {
+  pthread_mutex_lock(&lpq->lock);
+  pq_insert(lpq->pq, NULL, priority);
+  pthread_mutex_unlock(&lpq->lock);
+}
+
+static int locked_remove(struct locked_pq* lpq, int* priority) {
+  pthread_mutex_lock(&lpq->lock);
+  int ok = !pq_isempty(lpq->pq);
+  if (ok) {
+    *priority = pq_first_priority(lpq->pq);
+    pq_remove_first(lpq->pq);
+  }
+  pthread_mutex_unlock(&lpq->lock);
+  return ok;
+}
+
+/*
+ * Shared state for one benchmark run.  Exactly one of `mq` and `lpq` is set.
+ */
+struct run {
+  struct mq* mq;
+  struct locked_pq* lpq;
+  int ops;
+  unsigned long ticket;
+  int* removed;
+};
+
+static int run_remove(struct run* run, int* priority) {
+  if (run->mq) {
+    return mq_remove_first(run->mq, NULL, priority);
+  }
+  return locked_remove(run->lpq, priority);
+}
+
+static void run_insert(struct run* run, int priority) {
+  if (run->mq) {
+    mq_insert(run->mq, NULL, priority);
+  } else {
+    locked_insert(run->lpq, priority);
+  }
+}
+
+/*
+ * Thread body for the throughput test.
+ */
+static void* hold_worker(void* arg) {
+  struct run* run = arg;
+  unsigned int seed = (unsigned int)(unsigned long)&seed;
+  for (int i = 0; i < run->ops; i++) {
+    int priority = 0;
+    run_remove(run, &priority);
+    seed = seed * 1103515245 + 12345;
+    run_insert(run, priority + (int)((seed >> 16) & 1023));
+  }
+  return NULL;
+}
+
+/*
+ * Thread body for the rank-error test.  Every removal takes a ticket from a
+ * shared counter, so the removals can be replayed in (approximately) the
+ * order they happened.
+ */
+static void* drain_worker(void* arg) {
+  struct run* run = arg;
+  int priority;
+  while (run_remove(run, &priority)) {
+    unsigned long t = __atomic_fetch_add(&run->ticket, 1, __ATOMIC_RELAXED);
+    run->removed[t] = priority;
+  }
+  return NULL;
+}
+
+static void run_threads(struct run* run, int n_threads, void* (*fn)(void*)) {
+  pthread_t* threads = malloc(n_threads * sizeof(pthread_t));
+  for (int t = 0; t < n_threads; t++) {
+    pthread_create(&threads[t], NULL, fn, run);
+  }
+  for (int t = 0; t < n_threads; t++) {
+    pthread_join(threads[t], NULL);
+  }
+  free(threads);
+}
+
+/*
+ * Replays the removals recorded in run->removed using a Fenwick tree over the
+ * priorities 0..PREFILL-1 and reports the mean and maximum rank error.
+ */
+static void rank_error(struct run* run, double* mean, int* max) {
+  int* tree = calloc(PREFILL + 1, sizeof(int));
+  for (int i = 1; i <= PREFILL; i++) {
+    tree[i]++;
+    if (i + (i & -i) <= PREFILL) {
+      tree[i + (i & -i)] += tree[i];
+    }
+  }
+
+  long total = 0;
+  *max = 0;
+  for (int r = 0; r < PREFILL; r++) {
+    int p = run->removed[r];
+    int rank = 0;
+    for (int i = p; i > 0; i -= i & -i) {
+      rank += tree[i];
+    }
+    for (int i = p + 1; i <= PREFILL; i += i & -i) {
+      tree[i]--;
+    }
+    total += rank;
+    if (rank > *max) {
+      *max = rank;
+    }
+  }
+  *mean = (double)total / PREFILL;
+  free(tree);
+}
+
+/*
+ * Runs both tests for one configuration and prints a row of the results
+ * table.  `c` == 0 selects the single locked pq.
+ */
+static void bench(int n_threads, int c, int ops) {
+  struct run run = {0};
+  int* shuffled = malloc(PREFILL * sizeof(int));
+  for (int i = 0; i < PREFILL; i++) {
+    shuffled[i] = i;
+  }
+  for (int i = PREFILL - 1; i > 0; i--) {
+    int j = rand() % (i + 1);
+    int temp = shuffled[i];
+    shuffled[i] = shuffled[j];
+    shuffled[j] = temp;
+  }
+
+  if (c > 0) {
+    run.mq = mq_create(n_threads, c);
+  } else {
+    run.lpq = locked_create();
+  }
+  for (int i = 0; i < PREFILL; i++) {
+    run_insert(&run, shuffled[i]);
+  }
+  run.ops = ops;
+  double start = bench_now();
+  run_threads(&run, n_threads, hold_worker);
+  double elapsed = bench_now() - start;
+
+  /*
+   * Start again from a fresh queue for the rank-error test.
+   */
+  if (c > 0) {
+    mq_free(run.mq);
+    run.mq = mq_create(n_threads, c);
+  } else {
+    locked_free(run.lpq);
+    run.lpq = locked_create();
+  }
+  for (int i = 0; i < PREFILL; i++) {
+    run_insert(&run, shuffled[i]);
+  }
+  run.removed = malloc(PREFILL * sizeof(int));
+  run_threads(&run, n_threads, drain_worker);
+
+  double mean;
+  int max;
+  rank_error(&run, &mean, &max);
+
+  printf("  %-12s %7d %12.2f %12.2f %10d%s\n",
+    c > 0 ? "multiqueue" : "locked pq", n_threads,
+    2.0 * ops * n_threads / elapsed / 1e6, mean, max,
+    n_threads > sysconf(_SC_NPROCESSORS_ONLN) ? "  (oversubscribed)" : "");
+
+  if (c > 0) {
+    mq_free(run.mq);
+  } else {
+    locked_free(run.lpq);
+  }
+  free(run.removed);
+  free(shuffled);
+}
+
+int main(int argc, char** argv) {
+  int max_threads = argc > 1 ? atoi(argv[1]) : 8;
+  int c = argc > 2 ? atoi(argv[2]) : 2;
+  int ops = argc > 3 ? atoi(argv[3]) : 200000;
+  if (max_threads <= 0 || c <= 0 || ops <= 0) {
+    fprintf(stderr, "usage: %s [max_threads] [queues_per_thread] "
+      "[ops_per_thread]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  srand(0);
+  printf("== %d queues per thread, %d prefilled elements\n", c, PREFILL);
+  printf("  %-12s %7s %12s %12s %10s\n", "queue", "threads", "Mops/s",
+    "mean rank", "max rank");
+  for (int t = 1; t <= max_threads; t *= 2) {
+    bench(t, 0, ops);
+    bench(t, c, ops);
+  }
+  return 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * This program compares the minimum spanning tree algorithms: the O(n^2)
+ * Prim baseline, Prim with a rank-pairing heap, and Kruskal and Borůvka with
+ * 1, 2, 4, ... threads.  Speedups are relative to the baseline, and every
+ * tree's weight is checked against Prim's.
+ *
+ * Without a graph file, a uniformly random graph with weights in [1, 1000]
+ * is generated.  The baseline is skipped on graphs with more than
+ * NAIVE_MAX_NODES nodes, where it would take minutes.  Thread counts above
+ * the number of online CPUs are marked as oversubscribed.
+ *
+ * Usage: ./bench_mst [file|-] [max_threads] [n_nodes] [n_edges]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gen.h"
+#include "graph.h"
+#include "mst.h"
+#include "bench.h"
+
+#define NAIVE_MAX_NODES 100000
+
+/*
+ * Prints one row of the table.
+ */
+static void report(const char* name, double elapsed, double baseline,
+    int ok) {
+  char speedup[16] = "-";
+  if (baseline > 0) {
+    snprintf(speedup, sizeof(speedup), "%.1fx", baseline / elapsed);
+  }
+  printf("%-16s %8.3f s %9s%s\n", name, elapsed, speedup, ok ? "" : "  !");
+}
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : "-";
+  int max_threads = argc > 2 ? atoi(argv[2]) : 8;
+  int n = argc > 3 ? atoi(argv[3]) : 50000;
+  int m = argc > 4 ? atoi(argv[4]) : 20 * n;
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  struct graph* graph = strcmp(path, "-") ? graph_open(path, 0) :
+    gen_random(n, m, 1000, 1);
+  if (graph == NULL) {
+    return EXIT_FAILURE;
+  }
+  n = graph->n_nodes;
+  printf("%d nodes, %d edges, %ld CPUs\n\n", n, graph->n_edges, cpus);
+
+  struct mst_edge* tree = malloc(n * sizeof(struct mst_edge));
+  double start = bench_now();
+  int count = mst_prim(graph, tree);
+  double prim = bench_now() - start;
+  long long expected = mst_weight(tree, count);
+  printf("%d tree edges, weight %lld\n\n", count, expected);
+
+  printf("%-16s %10s %9s\n", "algorithm", "time", "speedup");
+  double baseline = 0;
+  if (n <= NAIVE_MAX_NODES) {
+    start = bench_now();
+    count = mst_naive(graph, tree);
+    baseline = bench_now() - start;
+    report("naive", baseline, baseline,
+      mst_weight(tree, count) == expected);
+  } else {
+    printf("%-16s %10s\n", "naive", "skipped");
+  }
+  report("prim", prim, baseline, 1);
+
+  for (int a = 0; a < 2; a++) {
+    for (int t = 1; t <= max_threads; t *= 2) {
+      start = bench_now();
+      count = a ? mst_boruvka(graph, t, tree) : mst_kruskal(graph, t, tree);
+      double elapsed = bench_now() - start;
+      char name[32];
+      snprintf(name, sizeof(name), "%s %dthr%s", a ? "boruvka" : "kruskal",
+        t, t > cpus ? "*" : "");
+      report(name, elapsed, baseline, mst_weight(tree, count) == expected);
+    }
+  }
+  printf("\n* = oversubscribed, ! = tree weight differs from prim\n");
+
+  free(tree);
+  graph_free(graph);
+  return 0;
+}
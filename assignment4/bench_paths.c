@@ -0,0 +1,216 @@
+/*
+ * This program measures how fast shortest paths can be written out.  It
+ * computes trees from a few sources and then dumps paths to random targets,
+ * one line of node numbers per path, in two ways:
+ *
+ *   - naive: each path is collected into a freshly allocated array by
+ *     following predecessors, and its nodes are printed with fprintf();
+ *   - buffered: sssp_path() writes each path into one reused buffer, and
+ *     the numbers are formatted by hand into a large output buffer that is
+ *     written with fwrite() when full.
+ *
+ * Both write identical output, which is checked when it goes to a file.
+ *
+ * Usage: ./bench_paths [file|-] [n_paths] [output] [n_nodes] [n_edges]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "graph.h"
+#include "sssp.h"
+#include "bench.h"
+
+#define N_TREES 16
+#define OUT_SIZE (1 << 20)
+
+static struct graph* random_graph(int n, int m) {
+  int* sources = malloc(m * sizeof(int));
+  int* targets = malloc(m * sizeof(int));
+  int* weights = malloc(m * sizeof(int));
+  for (int i = 0; i < m; i++) {
+    sources[i] = rand() % n;
+    targets[i] = rand() % n;
+    weights[i] = 1 + rand() % 1000;
+  }
+  struct graph* graph = graph_from_edges(n, m, sources, targets, weights);
+  free(sources);
+  free(targets);
+  free(weights);
+  return graph;
+}
+
+/*
+ * Writes every path the naive way.  Returns the number of nodes written.
+ */
+static long dump_naive(FILE* out, int** prev, int* sources, int* from,
+    int* to, int n_paths) {
+  long total = 0;
+  for (int q = 0; q < n_paths; q++) {
+    int* tree = prev[from[q]];
+    int source = sources[from[q]];
+    if (tree[to[q]] < 0 && to[q] != source) {
+      fprintf(out, "-\n");
+      continue;
+    }
+    int length = 0, capacity = 16;
+    int* path = malloc(capacity * sizeof(int));
+    for (int v = to[q]; ; v = tree[v]) {
+      if (length == capacity) {
+        capacity *= 2;
+        path = realloc(path, capacity * sizeof(int));
+      }
+      path[length++] = v;
+      if (v == source) {
+        break;
+      }
+    }
+    for (int i = length - 1; i >= 0; i--) {
+      fprintf(out, i > 0 ? "%d " : "%d\n", path[i]);
+    }
+    total += length;
+    free(path);
+  }
+  return total;
+}
+
+/*
+ * Writes every path with sssp_path() and hand formatting.  Returns the
+ * number of nodes written.
+ */
+static long dump_buffered(FILE* out, int** prev, int* sources, int* from,
+    int* to, int n_paths, int n) {
+  int* path = malloc(n * sizeof(int));
+  char* buffer = malloc(OUT_SIZE);
+  size_t used = 0;
+  long total = 0;
+  for (int q = 0; q < n_paths; q++) {
+    int length = sssp_path(prev[from[q]], sources[from[q]], to[q], path, n);
+    if (length < 0) {
+      if (used + 2 > OUT_SIZE) {
+        fwrite(buffer, 1, used, out);
+        used = 0;
+      }
+      buffer[used++] = '-';
+      buffer[used++] = '\n';
+      continue;
+    }
+    for (int i = 0; i < length; i++) {
+      if (used + 12 > OUT_SIZE) {
+        fwrite(buffer, 1, used, out);
+        used = 0;
+      }
+      char digits[12];
+      int k = 0;
+      unsigned int v = path[i];
+      do {
+        digits[k++] = '0' + v % 10;
+        v /= 10;
+      } while (v > 0);
+      while (k > 0) {
+        buffer[used++] = digits[--k];
+      }
+      buffer[used++] = i + 1 < length ? ' ' : '\n';
+    }
+    total += length;
+  }
+  fwrite(buffer, 1, used, out);
+  free(buffer);
+  free(path);
+  return total;
+}
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : "-";
+  int n_paths = argc > 2 ? atoi(argv[2]) : 1000000;
+  const char* output = argc > 3 ? argv[3] : "/dev/null";
+  int n = argc > 4 ? atoi(argv[4]) : 1000000;
+  int m = argc > 5 ? atoi(argv[5]) : 4 * n;
+
+  srand(0);
+  struct graph* graph = strcmp(path, "-") ? graph_open(path, 0) :
+    random_graph(n, m);
+  if (graph == NULL) {
+    return EXIT_FAILURE;
+  }
+  n = graph->n_nodes;
+  printf("%d nodes, %d edges, %d paths from %d sources to %s\n\n", n,
+    graph->n_edges, n_paths, N_TREES, output);
+
+  int sources[N_TREES];
+  int* prev[N_TREES];
+  dist_t* dist = malloc(n * sizeof(dist_t));
+  double start = bench_now();
+  for (int i = 0; i < N_TREES; i++) {
+    sources[i] = rand() % n;
+    prev[i] = malloc(n * sizeof(int));
+    sssp_dijkstra(graph, sources[i], dist, prev[i]);
+  }
+  printf("trees: %.2f s\n\n", bench_now() - start);
+
+  int* from = malloc(n_paths * sizeof(int));
+  int* to = malloc(n_paths * sizeof(int));
+  for (int q = 0; q < n_paths; q++) {
+    from[q] = rand() % N_TREES;
+    to[q] = rand() % n;
+  }
+
+  printf("%-10s %10s %12s %12s %10s\n", "method", "seconds", "paths/s",
+    "nodes/path", "MB");
+  const char* names[] = {"naive", "buffered"};
+  long sizes[2];
+  for (int method = 0; method < 2; method++) {
+    char name[4096];
+    snprintf(name, sizeof(name), "%s%s", output,
+      strcmp(output, "/dev/null") && method ? ".buffered" : "");
+    FILE* out = fopen(name, "w");
+    if (out == NULL) {
+      perror(name);
+      return EXIT_FAILURE;
+    }
+    start = bench_now();
+    long nodes = method ?
+      dump_buffered(out, prev, sources, from, to, n_paths, n) :
+      dump_naive(out, prev, sources, from, to, n_paths);
+    fflush(out);
+    double elapsed = bench_now() - start;
+    sizes[method] = ftell(out);
+    fclose(out);
+    printf("%-10s %10.3f %12.0f %12.2f %10.1f\n", names[method], elapsed,
+      n_paths / elapsed, (double)nodes / n_paths, sizes[method] / 1e6);
+  }
+
+  /*
+   * Compare the two dumps, then leave only the first.
+   */
+  if (strcmp(output, "/dev/null")) {
+    char name[4096];
+    snprintf(name, sizeof(name), "%s.buffered", output);
+    FILE* a = fopen(output, "r");
+    FILE* b = fopen(name, "r");
+    int same = sizes[0] == sizes[1];
+    while (same) {
+      int x = getc(a), y = getc(b);
+      same = x == y;
+      if (x == EOF) {
+        break;
+      }
+    }
+    fclose(a);
+    fclose(b);
+    remove(name);
+    printf("\noutputs identical: %s\n", same ? "yes" : "NO");
+  }
+
+  for (int i = 0; i < N_TREES; i++) {
+    free(prev[i]);
+  }
+  free(dist);
+  free(from);
+  free(to);
+  graph_free(graph);
+  return 0;
+}
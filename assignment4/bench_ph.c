@@ -0,0 +1,227 @@
+/*
+ * This program compares the rank-pairing heap in ph.c with the array heap in
+ * pq.c on two workloads:
+ *
+ *   merge - several per-worker queues are filled and then periodically merged
+ *     into one global queue, from which half of the elements are consumed.
+ *     The array heap has to drain each worker queue and re-insert its
+ *     elements into the global one; the rank-pairing heap melds in O(1).
+ *   decrease - elements are inserted and then have their priorities lowered
+ *     many times before the queue is drained.  The array heap has no
+ *     decrease-key, so it uses the usual lazy scheme of inserting a duplicate
+ *     entry and skipping stale ones when they reach the front.
+ *
+ * Usage: ./bench_ph [workers] [rounds] [per_round]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pq.h"
+#include "ph.h"
+#include "bench.h"
+
+/*
+ * Merge workload using array heaps.  Returns a checksum of the consumed
+ * priorities so the two implementations can be compared.
+ */
+static unsigned long merge_pq(int workers, int rounds, int per_round,
+    int* values) {
+  struct pq* global = pq_create();
+  struct pq** local = malloc(workers * sizeof(struct pq*));
+  void** batch_values = malloc(per_round * sizeof(void*));
+  int* batch_priorities = malloc(per_round * sizeof(int));
+  unsigned long checksum = 0;
+  int next = 0;
+
+  for (int w = 0; w < workers; w++) {
+    local[w] = pq_create();
+  }
+  for (int r = 0; r < rounds; r++) {
+    for (int w = 0; w < workers; w++) {
+      for (int i = 0; i < per_round; i++, next++) {
+        pq_insert(local[w], &values[next], values[next]);
+      }
+    }
+    for (int w = 0; w < workers; w++) {
+      int count = 0;
+      while (!pq_isempty(local[w])) {
+        batch_priorities[count] = pq_first_priority(local[w]);
+        batch_values[count++] = pq_remove_first(local[w]);
+      }
+      pq_insert_many(global, batch_values, batch_priorities, count);
+    }
+    for (int i = 0; i < workers * per_round / 2; i++) {
+      checksum = checksum * 31 + pq_first_priority(global);
+      pq_remove_first(global);
+    }
+  }
+
+  for (int w = 0; w < workers; w++) {
+    pq_free(local[w]);
+  }
+  pq_free(global);
+  free(local);
+  free(batch_values);
+  free(batch_priorities);
+  return checksum;
+}
+
+/*
+ * Merge workload using rank-pairing heaps.
+ */
+static unsigned long merge_ph(int workers, int rounds, int per_round,
+    int* values) {
+  struct ph* global = ph_create();
+  struct ph** local = malloc(workers * sizeof(struct ph*));
+  unsigned long checksum = 0;
+  int next = 0;
+
+  for (int w = 0; w < workers; w++) {
+    local[w] = ph_create();
+  }
+  for (int r = 0; r < rounds; r++) {
+    for (int w = 0; w < workers; w++) {
+      for (int i = 0; i < per_round; i++, next++) {
+        ph_insert(local[w], &values[next], values[next]);
+      }
+    }
+    for (int w = 0; w < workers; w++) {
+      ph_meld(global, local[w]);
+    }
+    for (int i = 0; i < workers * per_round / 2; i++) {
+      checksum = checksum * 31 + ph_first_priority(global);
+      ph_remove_first(global);
+    }
+  }
+
+  for (int w = 0; w < workers; w++) {
+    ph_free(local[w]);
+  }
+  ph_free(global);
+  free(local);
+  return checksum;
+}
+
+/*
+ * Decrease-key workload using an array heap with lazy duplicate entries.
+ * `current` holds the live priority of each element, and `done` marks
+ * elements whose live entry has already been removed.
+ */
+static unsigned long decrease_pq(int n, int n_updates, int* targets,
+    int* amounts) {
+  int* current = malloc(n * sizeof(int));
+  char* done = calloc(n, sizeof(char));
+  struct pq* pq = pq_create();
+  unsigned long checksum = 0;
+
+  for (int i = 0; i < n; i++) {
+    current[i] = 1 << 30;
+    pq_insert(pq, &current[i], current[i]);
+  }
+  for (int i = 0; i < n_updates; i++) {
+    int t = targets[i];
+    current[t] -= amounts[i];
+    pq_insert(pq, &current[t], current[t]);
+  }
+  while (!pq_isempty(pq)) {
+    int p = pq_first_priority(pq);
+    int* elem = pq_remove_first(pq);
+    if (!done[elem - current] && p == *elem) {
+      done[elem - current] = 1;
+      checksum = checksum * 31 + p;
+    }
+  }
+
+  pq_free(pq);
+  free(done);
+  free(current);
+  return checksum;
+}
+
+/*
+ * Decrease-key workload using a rank-pairing heap with real decrease-key.
+ */
+static unsigned long decrease_ph(int n, int n_updates, int* targets,
+    int* amounts) {
+  int* current = malloc(n * sizeof(int));
+  struct ph_node** handles = malloc(n * sizeof(struct ph_node*));
+  struct ph* ph = ph_create();
+  unsigned long checksum = 0;
+
+  for (int i = 0; i < n; i++) {
+    current[i] = 1 << 30;
+    handles[i] = ph_insert(ph, &current[i], current[i]);
+  }
+  for (int i = 0; i < n_updates; i++) {
+    int t = targets[i];
+    current[t] -= amounts[i];
+    ph_decrease_priority(ph, handles[t], current[t]);
+  }
+  while (!ph_isempty(ph)) {
+    checksum = checksum * 31 + ph_first_priority(ph);
+    ph_remove_first(ph);
+  }
+
+  ph_free(ph);
+  free(handles);
+  free(current);
+  return checksum;
+}
+
+int main(int argc, char** argv) {
+  int workers = argc > 1 ? atoi(argv[1]) : 16;
+  int rounds = argc > 2 ? atoi(argv[2]) : 50;
+  int per_round = argc > 3 ? atoi(argv[3]) : 2000;
+  if (workers <= 0 || rounds <= 0 || per_round <= 0) {
+    fprintf(stderr, "usage: %s [workers] [rounds] [per_round]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  srand(0);
+  int total = workers * rounds * per_round;
+  int* values = malloc(total * sizeof(int));
+  for (int i = 0; i < total; i++) {
+    values[i] = rand();
+  }
+
+  printf("== merge: %d workers, %d rounds, %d inserts per worker per round\n",
+    workers, rounds, per_round);
+  double start = bench_now();
+  unsigned long sum_pq = merge_pq(workers, rounds, per_round, values);
+  double t_pq = bench_now() - start;
+  start = bench_now();
+  unsigned long sum_ph = merge_ph(workers, rounds, per_round, values);
+  double t_ph = bench_now() - start;
+  printf("  array heap:   %8.2f ms\n", t_pq * 1e3);
+  printf("  rank-pairing: %8.2f ms (%.2fx)%s\n", t_ph * 1e3, t_pq / t_ph,
+    sum_pq == sum_ph ? "" : "  ** results differ **");
+
+  int n = total / 8;
+  int n_updates = total;
+  int* targets = malloc(n_updates * sizeof(int));
+  int* amounts = malloc(n_updates * sizeof(int));
+  for (int i = 0; i < n_updates; i++) {
+    targets[i] = rand() % n;
+    amounts[i] = rand() % 1000;
+  }
+
+  printf("== decrease: %d elements, %d decrease-key operations\n", n,
+    n_updates);
+  start = bench_now();
+  sum_pq = decrease_pq(n, n_updates, targets, amounts);
+  t_pq = bench_now() - start;
+  start = bench_now();
+  sum_ph = decrease_ph(n, n_updates, targets, amounts);
+  t_ph = bench_now() - start;
+  printf("  array heap:   %8.2f ms (lazy re-insert)\n", t_pq * 1e3);
+  printf("  rank-pairing: %8.2f ms (%.2fx)%s\n", t_ph * 1e3, t_pq / t_ph,
+    sum_pq == sum_ph ? "" : "  ** results differ **");
+
+  free(values);
+  free(targets);
+  free(amounts);
+  return 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * This program measures how long it takes to load a large batch of elements
+ * into a priority queue at startup.  It compares inserting the elements one
+ * at a time with pq_insert(), building the queue in one shot with
+ * pq_create_from(), and adding a second batch with pq_insert_many().
+ *
+ * Usage: ./bench_pq_build [n]    (default n = 500000)
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pq.h"
+#include "bench.h"
+
+/*
+ * Removes every element from `pq`, checking that priorities come out in
+ * non-decreasing order, and then frees it.  Returns the number of elements
+ * removed.
+ */
+static int drain_and_check(struct pq* pq) {
+  int count = 0, last = 0;
+  while (!pq_isempty(pq)) {
+    int p = pq_first_priority(pq);
+    if (count > 0 && p < last) {
+      fprintf(stderr, "heap order violated: %d after %d\n", p, last);
+      exit(EXIT_FAILURE);
+    }
+    last = p;
+    pq_remove_first(pq);
+    count++;
+  }
+  pq_free(pq);
+  return count;
+}
+
+/*
+ * Times the three ways of loading `n` elements with the given priorities
+ * and prints the results under the heading `label`.
+ */
+static void run(void** values, int* priorities, int n, const char* label) {
+  printf("== Loading %d elements with %s priorities\n", n, label);
+
+  /*
+   * All three queues are kept alive until every load has been timed, so that
+   * each one gets fresh memory from malloc() instead of recycling nodes freed
+   * by a previous drain in scrambled order.
+   */
+  double start = bench_now();
+  struct pq* inserted = pq_create();
+  for (int i = 0; i < n; i++) {
+    pq_insert(inserted, values[i], priorities[i]);
+  }
+  double t_insert = bench_now() - start;
+
+  start = bench_now();
+  struct pq* created = pq_create_from(values, priorities, n);
+  double t_create_from = bench_now() - start;
+
+  /*
+   * Load half with pq_create_from() and the other half as a single batch,
+   * which is large enough that pq_insert_many() rebuilds the heap.
+   */
+  int half = n / 2;
+  struct pq* batched = pq_create_from(values, priorities, half);
+  start = bench_now();
+  pq_insert_many(batched, values + half, priorities + half, n - half);
+  double t_insert_many = bench_now() - start;
+
+  if (drain_and_check(inserted) != n || drain_and_check(created) != n ||
+      drain_and_check(batched) != n) {
+    fprintf(stderr, "priority queue lost elements\n");
+    exit(EXIT_FAILURE);
+  }
+
+  printf("  pq_insert() x %d:       %8.2f ms\n", n, t_insert * 1e3);
+  printf("  pq_create_from():        %8.2f ms (%.2fx)\n",
+    t_create_from * 1e3, t_insert / t_create_from);
+  printf("  pq_insert_many() x %d:  %8.2f ms (into heap of %d)\n",
+    n - half, t_insert_many * 1e3, half);
+}
+
+int main(int argc, char** argv) {
+  int n = argc > 1 ? atoi(argv[1]) : 500000;
+  if (n <= 0) {
+    fprintf(stderr, "usage: %s [n]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  void** values = malloc(n * sizeof(void*));
+  int* priorities = malloc(n * sizeof(int));
+  for (int i = 0; i < n; i++) {
+    values[i] = &priorities[i];
+  }
+
+  /*
+   * Random priorities are the friendly case for pq_insert(), since a new
+   * element only sifts up O(1) levels on average.  Descending priorities
+   * (e.g. timers loaded latest-deadline first) make every insert sift all the
+   * way to the root.
+   */
+  srand(0);
+  for (int i = 0; i < n; i++) {
+    priorities[i] = rand();
+  }
+  run(values, priorities, n, "random");
+
+  for (int i = 0; i < n; i++) {
+    priorities[i] = n - i;
+  }
+  run(values, priorities, n, "descending");
+
+  free(values);
+  free(priorities);
+  return 0;
+}
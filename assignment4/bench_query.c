@@ -0,0 +1,131 @@
+/*
+ * This program compares point-to-point queries with full runs of Dijkstra's
+ * algorithm.  For random pairs of nodes, it reports the average number of
+ * nodes settled and the average time per query for:
+ *
+ *   - full Dijkstra from s (settling every reachable node);
+ *   - bidirectional Dijkstra;
+ *   - bidirectional A* with 4, 8 and 16 landmarks (ALT).
+ *
+ * Setup time for the landmarks is reported separately.  Every answer is
+ * checked against full Dijkstra.  Landmark bounds are tight on graphs with
+ * long shortest paths, such as road networks and grids; on the default
+ * random graph, where any two nodes are a few hops apart, they help little.
+ *
+ * Usage: ./bench_query [file|-] [n_queries] [n_nodes] [n_edges]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "graph.h"
+#include "query.h"
+#include "sssp.h"
+#include "bench.h"
+
+/*
+ * Full Dijkstra is slow enough that it is only run for this many queries.
+ */
+#define FULL_QUERIES 20
+
+static struct graph* random_graph(int n, int m) {
+  int* sources = malloc(m * sizeof(int));
+  int* targets = malloc(m * sizeof(int));
+  int* weights = malloc(m * sizeof(int));
+  for (int i = 0; i < m; i++) {
+    sources[i] = rand() % n;
+    targets[i] = rand() % n;
+    weights[i] = 1 + rand() % 1000;
+  }
+  struct graph* graph = graph_from_edges(n, m, sources, targets, weights);
+  free(sources);
+  free(targets);
+  free(weights);
+  return graph;
+}
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : "-";
+  int n_queries = argc > 2 ? atoi(argv[2]) : 1000;
+  int n = argc > 3 ? atoi(argv[3]) : 1000000;
+  int m = argc > 4 ? atoi(argv[4]) : 4 * n;
+
+  srand(0);
+  struct graph* graph = strcmp(path, "-") ? graph_open(path, 0) :
+    random_graph(n, m);
+  if (graph == NULL) {
+    return EXIT_FAILURE;
+  }
+  n = graph->n_nodes;
+  printf("%d nodes, %d edges, %d queries\n\n", n, graph->n_edges, n_queries);
+
+  int* from = malloc(n_queries * sizeof(int));
+  int* to = malloc(n_queries * sizeof(int));
+  dist_t* expected = malloc(n_queries * sizeof(dist_t));
+  dist_t* dist = malloc(n * sizeof(dist_t));
+  for (int q = 0; q < n_queries; q++) {
+    from[q] = rand() % n;
+    to[q] = rand() % n;
+  }
+
+  /*
+   * The expected answers come from the first engine, bidirectional Dijkstra,
+   * and are checked against full Dijkstra on the first few queries.
+   */
+  printf("%-16s %10s %12s %12s %10s\n", "engine", "setup", "settled/q",
+    "us/q", "wrong");
+  long settled = 0;
+  int full = n_queries < FULL_QUERIES ? n_queries : FULL_QUERIES;
+  double elapsed = 0;
+  for (int q = 0; q < full; q++) {
+    double start = bench_now();
+    sssp_dijkstra(graph, from[q], dist, NULL);
+    elapsed += bench_now() - start;
+    expected[q] = dist[to[q]];
+    for (int v = 0; v < n; v++) {
+      settled += dist[v] != DIST_INF;
+    }
+  }
+  printf("%-16s %10s %12.0f %12.1f %10s\n", "dijkstra", "-",
+    (double)settled / full, elapsed / full * 1e6, "-");
+
+  int landmarks[] = {0, 4, 8, 16};
+  for (int i = 0; i < 4; i++) {
+    double start = bench_now();
+    struct sp* sp = sp_create(graph, landmarks[i]);
+    double setup = bench_now() - start;
+
+    int wrong = 0;
+    settled = 0;
+    start = bench_now();
+    for (int q = 0; q < n_queries; q++) {
+      dist_t d = sp_query(sp, from[q], to[q]);
+      settled += sp_last_settled(sp);
+      if (i == 0 && q >= full) {
+        expected[q] = d;
+      }
+      wrong += d != expected[q];
+    }
+    elapsed = bench_now() - start;
+
+    char name[32];
+    if (landmarks[i] == 0) {
+      snprintf(name, sizeof(name), "bidirectional");
+    } else {
+      snprintf(name, sizeof(name), "alt-%d", landmarks[i]);
+    }
+    printf("%-16s %8.2f s %12.0f %12.1f %10d\n", name, setup,
+      (double)settled / n_queries, elapsed / n_queries * 1e6, wrong);
+    sp_free(sp);
+  }
+
+  free(from);
+  free(to);
+  free(expected);
+  free(dist);
+  graph_free(graph);
+  return 0;
+}
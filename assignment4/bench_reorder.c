@@ -0,0 +1,191 @@
+/*
+ * This program measures what renumbering a graph's nodes does to
+ * shortest-path runs.  The graph's nodes are first shuffled, as in inputs
+ * whose node numbers carry no meaning, and then renumbered with
+ * reorder_bfs() and reorder_rcm().  For each numbering it reports the time
+ * to compute it, the bandwidth, and the wall time and hardware cache misses
+ * of Dijkstra runs from the same sources.
+ *
+ * Cache misses are counted with perf_event_open(), the interface behind
+ * `perf stat -e cache-misses`.  Where hardware counters aren't available
+ * (outside Linux, in many containers and VMs, or with a high
+ * perf_event_paranoid setting) they are reported as n/a and only wall time
+ * is measured.
+ *
+ * The default graph is a random geometric graph, which has the locality of
+ * a road network for the passes to recover.
+ *
+ * Usage: ./bench_reorder [file|-] [runs] [n_nodes] [degree]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "graph.h"
+#include "sssp.h"
+#include "gen.h"
+#include "reorder.h"
+#include "bench.h"
+
+/*
+ * Opens a counter of hardware cache misses for this thread, returning its
+ * file descriptor or -1 if there is none.
+ */
+static int open_cache_misses() {
+#ifdef __linux__
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = PERF_COUNT_HW_CACHE_MISSES;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+  return -1;
+#endif
+}
+
+static void start_counter(int fd) {
+#ifdef __linux__
+  if (fd >= 0) {
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+#endif
+}
+
+/*
+ * Stops a counter and returns its value, or -1 if there is no counter.
+ */
+static long long stop_counter(int fd) {
+  long long count = -1;
+#ifdef __linux__
+  if (fd >= 0) {
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd, &count, sizeof(count)) != sizeof(count)) {
+      count = -1;
+    }
+  }
+#endif
+  return count;
+}
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : "-";
+  int runs = argc > 2 ? atoi(argv[2]) : 5;
+  int n = argc > 3 ? atoi(argv[3]) : 1000000;
+  double degree = argc > 4 ? atof(argv[4]) : 6;
+
+  srand(0);
+  struct graph* input = strcmp(path, "-") ? graph_open(path, 0) :
+    gen_geometric(n, degree, 1);
+  if (input == NULL) {
+    return EXIT_FAILURE;
+  }
+  n = input->n_nodes;
+  if (n == 0) {
+    fprintf(stderr, "%s: empty graph\n", path);
+    return EXIT_FAILURE;
+  }
+
+  int* shuffle = malloc(n * sizeof(int));
+  for (int i = 0; i < n; i++) {
+    shuffle[i] = i;
+  }
+  for (int i = n - 1; i > 0; i--) {
+    int j = rand() % (i + 1);
+    int v = shuffle[i];
+    shuffle[i] = shuffle[j];
+    shuffle[j] = v;
+  }
+  struct graph* graph = graph_permute(input, shuffle);
+  graph_free(input);
+  free(shuffle);
+
+  int counter = open_cache_misses();
+  printf("%d nodes, %d edges, %d runs, cache-miss counter %s\n\n", n,
+    graph->n_edges, runs, counter >= 0 ? "available" : "unavailable");
+
+  int* sources = malloc(runs * sizeof(int));
+  for (int r = 0; r < runs; r++) {
+    sources[r] = rand() % n;
+  }
+  dist_t* expected = malloc((long)runs * n * sizeof(dist_t));
+  dist_t* dist = malloc(n * sizeof(dist_t));
+  int* rank = malloc(n * sizeof(int));
+
+  printf("%-10s %10s %12s %12s %14s %10s\n", "order", "reorder s",
+    "bandwidth", "ms/run", "misses/run", "wrong");
+  const char* names[] = {"shuffled", "bfs", "rcm"};
+  for (int pass = 0; pass < 3; pass++) {
+    double start = bench_now();
+    int* order = NULL;
+    struct graph* permuted = graph;
+    if (pass > 0) {
+      order = pass == 1 ? reorder_bfs(graph) : reorder_rcm(graph);
+      permuted = graph_permute(graph, order);
+    }
+    double setup = bench_now() - start;
+    for (int i = 0; i < n; i++) {
+      rank[order ? order[i] : i] = i;
+    }
+
+    int wrong = 0;
+    double elapsed = 0;
+    long long misses = 0;
+    for (int r = 0; r < runs; r++) {
+      start = bench_now();
+      start_counter(counter);
+      sssp_dijkstra(permuted, rank[sources[r]], dist, NULL);
+      long long count = stop_counter(counter);
+      elapsed += bench_now() - start;
+      misses = count < 0 || misses < 0 ? -1 : misses + count;
+
+      dist_t* row = expected + (long)r * n;
+      for (int v = 0; v < n; v++) {
+        if (pass == 0) {
+          row[v] = dist[v];
+        } else if (dist[rank[v]] != row[v]) {
+          wrong++;
+          break;
+        }
+      }
+    }
+
+    char misses_text[32];
+    if (misses < 0) {
+      snprintf(misses_text, sizeof(misses_text), "n/a");
+    } else {
+      snprintf(misses_text, sizeof(misses_text), "%lld", misses / runs);
+    }
+    printf("%-10s %10.2f %12d %12.1f %14s %10d\n", names[pass], setup,
+      reorder_bandwidth(permuted), elapsed / runs * 1e3, misses_text, wrong);
+    if (order) {
+      free(order);
+      graph_free(permuted);
+    }
+  }
+
+  if (counter >= 0) {
+    close(counter);
+  }
+  free(sources);
+  free(expected);
+  free(dist);
+  free(rank);
+  graph_free(graph);
+  return 0;
+}
@@ -0,0 +1,190 @@
+/*
+ * This program is a load generator for the query server.  It starts the
+ * server in-process on a Unix domain socket, connects several clients that
+ * each send DIST requests one at a time, and reports throughput and the
+ * median and 99th percentile latency, with and without the tree cache.
+ *
+ * Sources are drawn from a hot set of nodes (the first `hot` ones), the
+ * way repeated queries from a few popular origins would look, and targets
+ * are random.  Without the cache every request runs Dijkstra from scratch.
+ *
+ * Usage: ./bench_server [file|-] [n_clients] [requests_per_client] [hot]
+ *          [n_nodes] [n_edges]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "graph.h"
+#include "cache.h"
+#include "server.h"
+#include "bench.h"
+
+static struct graph* random_graph(int n, int m) {
+  int* sources = malloc(m * sizeof(int));
+  int* targets = malloc(m * sizeof(int));
+  int* weights = malloc(m * sizeof(int));
+  for (int i = 0; i < m; i++) {
+    sources[i] = rand() % n;
+    targets[i] = rand() % n;
+    weights[i] = 1 + rand() % 1000;
+  }
+  struct graph* graph = graph_from_edges(n, m, sources, targets, weights);
+  free(sources);
+  free(targets);
+  free(weights);
+  return graph;
+}
+
+struct server_args {
+  struct tree_cache* cache;
+  const char* path;
+};
+
+static void* run_server(void* arg) {
+  struct server_args* args = arg;
+  server_run_socket(args->cache, args->path);
+  return NULL;
+}
+
+/*
+ * Connects to the server, retrying while it is still starting up.
+ */
+static FILE* connect_server(const char* path) {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+  for (int attempt = 0; attempt < 1000; attempt++) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connect(fd, (struct sockaddr*)&address, sizeof(address)) == 0) {
+      return fdopen(fd, "r+");
+    }
+    close(fd);
+    struct timespec pause = {0, 1000000};
+    nanosleep(&pause, NULL);
+  }
+  fprintf(stderr, "%s: can't connect\n", path);
+  exit(EXIT_FAILURE);
+}
+
+struct client_args {
+  const char* path;
+  int n_nodes;
+  int hot;
+  int n_requests;
+  unsigned seed;
+  double* latencies;
+};
+
+static void* run_client(void* arg) {
+  struct client_args* args = arg;
+  FILE* server = connect_server(args->path);
+  char response[64];
+  for (int i = 0; i < args->n_requests; i++) {
+    int s = rand_r(&args->seed) % args->hot;
+    int t = rand_r(&args->seed) % args->n_nodes;
+    double start = bench_now();
+    fprintf(server, "DIST %d %d\n", s, t);
+    fflush(server);
+    if (fgets(response, sizeof(response), server) == NULL) {
+      fprintf(stderr, "server closed the connection\n");
+      exit(EXIT_FAILURE);
+    }
+    args->latencies[i] = bench_now() - start;
+  }
+  fprintf(server, "QUIT\n");
+  fclose(server);
+  return NULL;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+  double x = *(const double*)a, y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : "-";
+  int n_clients = argc > 2 ? atoi(argv[2]) : 4;
+  int n_requests = argc > 3 ? atoi(argv[3]) : 100;
+  int hot = argc > 4 ? atoi(argv[4]) : 32;
+  int n = argc > 5 ? atoi(argv[5]) : 100000;
+  int m = argc > 6 ? atoi(argv[6]) : 4 * n;
+
+  srand(0);
+  struct graph* graph = strcmp(path, "-") ? graph_open(path, 0) :
+    random_graph(n, m);
+  if (graph == NULL) {
+    return EXIT_FAILURE;
+  }
+  n = graph->n_nodes;
+  if (hot > n) {
+    hot = n;
+  }
+  printf("%d nodes, %d edges, %d clients x %d requests, %d hot sources\n\n",
+    n, graph->n_edges, n_clients, n_requests, hot);
+
+  char socket_path[64];
+  snprintf(socket_path, sizeof(socket_path), "/tmp/bench_server.%d",
+    (int)getpid());
+  int total = n_clients * n_requests;
+  double* latencies = malloc(total * sizeof(double));
+  pthread_t* clients = malloc(n_clients * sizeof(pthread_t));
+  struct client_args* args = malloc(n_clients * sizeof(struct client_args));
+
+  printf("%-12s %12s %12s %12s %10s\n", "cache", "requests/s", "p50 us",
+    "p99 us", "hit rate");
+  int capacities[] = {0, 2 * hot};
+  for (int c = 0; c < 2; c++) {
+    struct tree_cache* cache = tree_cache_create(graph, capacities[c]);
+    struct server_args server_args = {cache, socket_path};
+    pthread_t server;
+    pthread_create(&server, NULL, run_server, &server_args);
+
+    double start = bench_now();
+    for (int i = 0; i < n_clients; i++) {
+      args[i].path = socket_path;
+      args[i].n_nodes = n;
+      args[i].hot = hot;
+      args[i].n_requests = n_requests;
+      args[i].seed = i + 1;
+      args[i].latencies = latencies + i * n_requests;
+      pthread_create(&clients[i], NULL, run_client, &args[i]);
+    }
+    for (int i = 0; i < n_clients; i++) {
+      pthread_join(clients[i], NULL);
+    }
+    double elapsed = bench_now() - start;
+
+    FILE* control = connect_server(socket_path);
+    fprintf(control, "SHUTDOWN\n");
+    fflush(control);
+    fclose(control);
+    pthread_join(server, NULL);
+
+    long hits, misses;
+    int size;
+    tree_cache_stats(cache, &hits, &misses, &size);
+    qsort(latencies, total, sizeof(double), compare_doubles);
+    char name[32];
+    snprintf(name, sizeof(name), "%d trees", capacities[c]);
+    printf("%-12s %12.0f %12.1f %12.1f %9.1f%%\n", name, total / elapsed,
+      latencies[total / 2] * 1e6, latencies[total * 99 / 100] * 1e6,
+      100.0 * hits / (hits + misses));
+    tree_cache_free(cache);
+  }
+
+  free(latencies);
+  free(clients);
+  free(args);
+  graph_free(graph);
+  return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * This program measures how delta-stepping scales with the number of threads
+ * and with the bucket width delta, compared with the sequential heap-based
+ * Dijkstra.  Every run is checked against Dijkstra's distances.
+ *
+ * Without a graph file, a random graph with uniformly random edges and
+ * weights in [1, 1000] is used.  Thread counts above the number of online
+ * CPUs are marked as oversubscribed, since threads then wait at every
+ * barrier for a time slice instead of for each other.
+ *
+ * Usage: ./bench_sssp [file|-] [max_threads] [n_nodes] [n_edges]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "graph.h"
+#include "sssp.h"
+#include "bench.h"
+
+#define MAX_WEIGHT 1000
+
+static struct graph* random_graph(int n, int m) {
+  int* sources = malloc(m * sizeof(int));
+  int* targets = malloc(m * sizeof(int));
+  int* weights = malloc(m * sizeof(int));
+  for (int i = 0; i < m; i++) {
+    sources[i] = rand() % n;
+    targets[i] = rand() % n;
+    weights[i] = 1 + rand() % MAX_WEIGHT;
+  }
+  struct graph* graph = graph_from_edges(n, m, sources, targets, weights);
+  free(sources);
+  free(targets);
+  free(weights);
+  return graph;
+}
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : "-";
+  int max_threads = argc > 2 ? atoi(argv[2]) : 8;
+  int n = argc > 3 ? atoi(argv[3]) : 1000000;
+  int m = argc > 4 ? atoi(argv[4]) : 8 * n;
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  srand(0);
+  struct graph* graph = strcmp(path, "-") ? graph_open(path, 0) :
+    random_graph(n, m);
+  if (graph == NULL) {
+    return EXIT_FAILURE;
+  }
+  n = graph->n_nodes;
+  printf("%d nodes, %d edges, %ld CPUs\n\n", n, graph->n_edges, cpus);
+
+  dist_t* expected = malloc(n * sizeof(dist_t));
+  dist_t* dist = malloc(n * sizeof(dist_t));
+  double start = bench_now();
+  sssp_dijkstra(graph, 0, expected, NULL);
+  printf("heap dijkstra: %.3f s\n\n", bench_now() - start);
+
+  int best = sssp_default_delta(graph);
+  int deltas[] = {best / 16, best / 4, best, 4 * best, 16 * best};
+  printf("%8s", "delta");
+  for (int t = 1; t <= max_threads; t *= 2) {
+    printf("  %7d thr%s", t, t > cpus ? "*" : " ");
+  }
+  printf("\n");
+  for (int i = 0; i < 5; i++) {
+    int delta = deltas[i] > 0 ? deltas[i] : 1;
+    printf("%8d", delta);
+    for (int t = 1; t <= max_threads; t *= 2) {
+      start = bench_now();
+      sssp_delta_stepping(graph, 0, delta, t, dist, NULL);
+      double elapsed = bench_now() - start;
+      int ok = !memcmp(dist, expected, n * sizeof(dist_t));
+      printf("  %9.3f s%s", elapsed, ok ? " " : "!");
+    }
+    printf("%s\n", deltas[i] == best ? "   (default)" : "");
+  }
+  printf("\n* = oversubscribed, ! = distances differ from dijkstra\n");
+
+  free(expected);
+  free(dist);
+  graph_free(graph);
+  return 0;
+}
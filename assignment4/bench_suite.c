@@ -0,0 +1,167 @@
+/*
+ * This program runs the single-source shortest-path engines over a fixed
+ * set of synthetic graphs and prints one table, so runs on different
+ * machines or different versions of the code can be compared line by line.
+ * It is what `make bench` runs.
+ *
+ * Every graph comes from gen.c with a fixed seed: uniformly random, grid,
+ * R-MAT and geometric graphs of about 10K, 100K and 1M nodes.  Each engine
+ * is timed from the same few sources and its distances are checked against
+ * the heap-based Dijkstra.  The dense engine is only run on graphs small
+ * enough for its matrix.
+ *
+ * Usage: ./bench_suite [max_nodes] [n_sources]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gen.h"
+#include "graph.h"
+#include "sssp.h"
+#include "dense.h"
+#include "bench.h"
+
+#define SEED 261
+#define MAX_WEIGHT 1000
+
+/*
+ * Graphs with more nodes than this are skipped by the dense engine.
+ */
+#define DENSE_MAX_NODES 10000
+
+/*
+ * Generates the graph of a shape at size step 0, 1 or 2 (about 10K, 100K
+ * and 1M nodes), or returns NULL if it would have more than max_nodes nodes.
+ */
+static struct graph* make_graph(const char* shape, int step, int max_nodes) {
+  static const int nodes[] = {10000, 100000, 1000000};
+  static const int sides[] = {100, 316, 1000};
+  static const int scales[] = {13, 17, 20};
+  if (!strcmp(shape, "grid") ? sides[step] * sides[step] > max_nodes :
+      !strcmp(shape, "rmat") ? 1 << scales[step] > max_nodes :
+      nodes[step] > max_nodes) {
+    return NULL;
+  }
+  if (!strcmp(shape, "random")) {
+    return gen_random(nodes[step], 4 * nodes[step], MAX_WEIGHT, SEED);
+  } else if (!strcmp(shape, "grid")) {
+    return gen_grid(sides[step], sides[step], MAX_WEIGHT, SEED);
+  } else if (!strcmp(shape, "rmat")) {
+    return gen_rmat(scales[step], 8 << scales[step], MAX_WEIGHT, SEED);
+  }
+  return gen_geometric(nodes[step], 6, SEED);
+}
+
+/*
+ * Times one engine from every source and returns the average time in
+ * milliseconds, counting the sources whose distances differ from
+ * `expected` in *wrong.
+ */
+static double run(struct graph* graph, struct dense_graph* dense,
+    int engine, int n_threads, int* sources, int n_sources,
+    dist_t** expected, dist_t* dist, int* prev, int* wrong) {
+  int n = graph->n_nodes;
+  double elapsed = 0;
+  *wrong = 0;
+  for (int i = 0; i < n_sources; i++) {
+    double start = bench_now();
+    if (engine == 0) {
+      sssp_dijkstra(graph, sources[i], dist, NULL);
+    } else if (engine == 1) {
+      sssp_delta_stepping(graph, sources[i], 0, n_threads, dist, NULL);
+    } else {
+      dense_dijkstra(dense, sources[i], dist, prev);
+    }
+    elapsed += bench_now() - start;
+    if (engine == 0) {
+      memcpy(expected[i], dist, n * sizeof(dist_t));
+    } else {
+      *wrong += memcmp(expected[i], dist, n * sizeof(dist_t)) != 0;
+    }
+  }
+  return elapsed / n_sources * 1e3;
+}
+
+int main(int argc, char** argv) {
+  int max_nodes = argc > 1 ? atoi(argv[1]) : 1 << 20;
+  int n_sources = argc > 2 ? atoi(argv[2]) : 3;
+  int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  const char* shapes[] = {"random", "grid", "rmat", "geometric"};
+
+  printf("seed %d, %d sources per graph, %d CPUs\n\n", SEED, n_sources,
+    cpus);
+  printf("%-10s %9s %10s  %-14s %12s %6s\n", "graph", "nodes", "edges",
+    "engine", "ms/source", "wrong");
+  for (int step = 0; step < 3; step++) {
+    for (int s = 0; s < 4; s++) {
+      struct graph* graph = make_graph(shapes[s], step, max_nodes);
+      if (graph == NULL) {
+        continue;
+      }
+      int n = graph->n_nodes;
+
+      unsigned long long state = SEED;
+      int* sources = malloc(n_sources * sizeof(int));
+      dist_t** expected = malloc(n_sources * sizeof(dist_t*));
+      for (int i = 0; i < n_sources; i++) {
+        /*
+         * Skip nodes without out-edges, which R-MAT graphs have many of, so
+         * every run explores some of the graph.
+         */
+        do {
+          state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+          sources[i] = (int)((state >> 33) % n);
+        } while (graph->offsets[sources[i]] == graph->offsets[sources[i] + 1]);
+        expected[i] = malloc(n * sizeof(dist_t));
+      }
+      dist_t* dist = malloc(n * sizeof(dist_t));
+      int* prev = malloc(n * sizeof(int));
+      struct dense_graph* dense = n <= DENSE_MAX_NODES ?
+        dense_from_graph(graph) : NULL;
+
+      int engines[] = {0, 1, 1, 2};
+      int threads[] = {1, 1, cpus, 1};
+      for (int i = 0; i < 4; i++) {
+        if ((i == 2 && cpus == 1) || (engines[i] == 2 && dense == NULL)) {
+          continue;
+        }
+        char name[32];
+        if (engines[i] == 0) {
+          snprintf(name, sizeof(name), "dijkstra");
+        } else if (engines[i] == 1) {
+          snprintf(name, sizeof(name), "delta %dthr", threads[i]);
+        } else {
+          snprintf(name, sizeof(name), "dense");
+        }
+        int wrong;
+        double ms = run(graph, dense, engines[i], threads[i], sources,
+          n_sources, expected, dist, prev, &wrong);
+        char checked[16] = "-";
+        if (engines[i]) {
+          snprintf(checked, sizeof(checked), "%d", wrong);
+        }
+        printf("%-10s %9d %10d  %-14s %12.2f %6s\n", shapes[s], n,
+          graph->n_edges, name, ms, checked);
+      }
+      fflush(stdout);
+
+      if (dense) {
+        dense_free(dense);
+      }
+      for (int i = 0; i < n_sources; i++) {
+        free(expected[i]);
+      }
+      free(expected);
+      free(sources);
+      free(dist);
+      free(prev);
+      graph_free(graph);
+    }
+  }
+  return 0;
+}
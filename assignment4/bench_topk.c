@@ -0,0 +1,155 @@
+/*
+ * This program measures finding the K smallest values of a long stream of
+ * pseudo-random ints.  It compares:
+ *
+ *   - insert-all: pq_insert() every value into an ordinary pq, then remove K.
+ *     This needs memory for the whole stream, so it is run on at most the
+ *     first BASELINE_MAX values.
+ *   - pq_offer(): a bounded pq of size K, offering one value at a time.
+ *   - pq_offer_many(): a bounded pq of size K, offering a chunk at a time.
+ *
+ * The stream is generated in chunks so that it never has to be stored.  The
+ * time taken just to generate the stream is reported as a reference; it is
+ * included in the times of the other methods.
+ *
+ * Usage: ./bench_topk [n] [k]    (default n = 100000000, k = 100)
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pq.h"
+#include "bench.h"
+
+#define CHUNK 65536
+#define BASELINE_MAX 10000000
+
+/*
+ * Fills `chunk` with the next `count` values of the stream, using a
+ * xorshift generator whose state is kept in `state`.
+ */
+static void generate(int* chunk, int count, unsigned int* state) {
+  unsigned int x = *state;
+  for (int i = 0; i < count; i++) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    chunk[i] = (int)(x >> 1);
+  }
+  *state = x;
+}
+
+/*
+ * Stream methods.  Each one consumes `n` stream values and leaves the K
+ * smallest, in descending order, in `result`.
+ */
+enum method { GENERATE_ONLY, INSERT_ALL, OFFER, OFFER_MANY };
+
+/*
+ * Keeps the compiler from optimizing away the generate-only loop.
+ */
+static volatile int sink;
+
+static void drain(struct pq* pq, int* result, int k) {
+  for (int i = 0; i < k && !pq_isempty(pq); i++) {
+    result[i] = pq_first_priority(pq);
+    pq_remove_first(pq);
+  }
+}
+
+static double run(enum method method, long n, int k, int* result) {
+  int* chunk = malloc(CHUNK * sizeof(int));
+  unsigned int state = 2463534242u;
+  struct pq* pq = NULL;
+  if (method == INSERT_ALL) {
+    pq = pq_create();
+  } else if (method != GENERATE_ONLY) {
+    pq = pq_create_bounded(k);
+  }
+
+  double start = bench_now();
+  for (long done = 0; done < n; done += CHUNK) {
+    int count = n - done < CHUNK ? (int)(n - done) : CHUNK;
+    generate(chunk, count, &state);
+    switch (method) {
+      case GENERATE_ONLY:
+        sink = chunk[count - 1];
+        break;
+      case INSERT_ALL:
+        for (int i = 0; i < count; i++) {
+          pq_insert(pq, NULL, chunk[i]);
+        }
+        break;
+      case OFFER:
+        for (int i = 0; i < count; i++) {
+          pq_offer(pq, NULL, chunk[i]);
+        }
+        break;
+      case OFFER_MANY:
+        pq_offer_many(pq, NULL, chunk, count);
+        break;
+    }
+  }
+
+  if (method == INSERT_ALL) {
+    /*
+     * The ordinary pq returns the smallest first; reverse to match the
+     * bounded queues.
+     */
+    int* ascending = malloc(k * sizeof(int));
+    drain(pq, ascending, k);
+    for (int i = 0; i < k; i++) {
+      result[i] = ascending[k - 1 - i];
+    }
+    free(ascending);
+  } else if (pq) {
+    drain(pq, result, k);
+  }
+  double elapsed = bench_now() - start;
+
+  if (pq) {
+    pq_free(pq);
+  }
+  free(chunk);
+  return elapsed;
+}
+
+static void report(const char* name, long n, double elapsed) {
+  printf("  %-16s %12ld %10.3f s %10.1f M values/s %8.2f ns/value\n",
+    name, n, elapsed, n / elapsed / 1e6, elapsed / n * 1e9);
+}
+
+int main(int argc, char** argv) {
+  long n = argc > 1 ? atol(argv[1]) : 100000000L;
+  int k = argc > 2 ? atoi(argv[2]) : 100;
+  if (n <= 0 || k <= 0 || k > n) {
+    fprintf(stderr, "usage: %s [n] [k]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  int* offer_result = malloc(k * sizeof(int));
+  int* many_result = malloc(k * sizeof(int));
+  int* baseline_result = malloc(k * sizeof(int));
+  long baseline_n = n < BASELINE_MAX ? n : BASELINE_MAX;
+
+  printf("== K = %d smallest of a stream of %ld ints\n", k, n);
+  report("generate only", n, run(GENERATE_ONLY, n, k, NULL));
+  report("insert-all", baseline_n,
+    run(INSERT_ALL, baseline_n, k, baseline_result));
+  report("pq_offer()", n, run(OFFER, n, k, offer_result));
+  report("pq_offer_many()", n, run(OFFER_MANY, n, k, many_result));
+
+  int same = memcmp(offer_result, many_result, k * sizeof(int)) == 0;
+  if (baseline_n == n) {
+    same = same && memcmp(offer_result, baseline_result, k * sizeof(int)) == 0;
+  }
+  printf("  results agree: %s\n", same ? "yes" : "NO");
+
+  free(offer_result);
+  free(many_result);
+  free(baseline_result);
+  return same ? 0 : EXIT_FAILURE;
+}
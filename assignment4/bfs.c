@@ -0,0 +1,399 @@
+/*
+ * This file contains a parallel breadth-first search for the CSR graphs from
+ * graph.h.  Edge weights are ignored, so the depth of each node is its
+ * shortest-path distance when every edge has weight 1.
+ *
+ * The search goes level by level, in one of two directions (Beamer, Asanović
+ * and Patterson, "Direction-Optimizing Breadth-First Search"):
+ *
+ *   - Top-down: the frontier is a list of nodes, and threads take blocks of
+ *     it and visit the unvisited targets of their out-edges, claiming each
+ *     with an atomic bit set so it joins the next frontier once.
+ *   - Bottom-up: the frontier is a bitset, and each thread takes a range of
+ *     the unvisited nodes and looks through their in-edges for one from the
+ *     frontier, stopping at the first.  Threads own whole words of the
+ *     bitsets, so they need no atomics.
+ *
+ * Top-down is cheap while the frontier is small.  Once the frontier's edges
+ * outnumber a fraction of the edges still unexplored, most of them would
+ * lead to nodes already visited, and bottom-up, which stops at the first
+ * parent found, does much less work; once the frontier shrinks again,
+ * top-down takes over.  Visited, frontier and next-frontier sets are
+ * bitsets, so on large graphs they stay in cache where int arrays would
+ * not, and the size of a bitset frontier is a popcount.
+ *
+ * Like delta-stepping in sssp.c, all threads run one loop and meet at a
+ * barrier between levels, where thread 0 picks the next direction.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "bfs.h"
+#include "bitset.h"
+
+/*
+ * Frontier nodes are handed to threads in blocks of this many, and each
+ * thread collects up to this many new nodes before adding them to the next
+ * frontier.
+ */
+#define BFS_BLOCK 256
+
+/*
+ * Switch to bottom-up when the frontier has more than 1/ALPHA of the
+ * unexplored edges, and back to top-down when it has fewer than 1/BETA of
+ * the nodes and is shrinking.  These are the values from the paper.
+ */
+#define ALPHA 14
+#define BETA 24
+
+struct bfs {
+    struct graph* graph;
+    struct graph* transpose;
+    struct bitset* visited;
+    struct bitset* front;
+    struct bitset* next;
+
+    /*
+     * The frontier as a list while searching top-down, and the next one.
+     */
+    int* queue;
+    int queue_size;
+    int* next_queue;
+    int next_size;
+    int next_item;
+
+    /*
+     * The search in progress.  frontier_edges counts the out-edges of the
+     * nodes found on this level, and unexplored_edges those of the nodes
+     * not yet found.
+     */
+    int* depth;
+    int* parent;
+    int mode;
+    int n_threads;
+    int bottom_up;
+    int level;
+    int frontier_nodes;
+    long frontier_edges;
+    long unexplored_edges;
+    int reached;
+    int bottom_up_levels;
+    int done;
+    pthread_barrier_t barrier;
+};
+
+struct bfs_thread {
+    struct bfs* bfs;
+    int id;
+};
+
+/*
+ * This function allocates the scratch space for breadth-first searches on a
+ * graph, including its transpose for bottom-up steps.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.  It must stay alive and unchanged
+ *     until the search state is freed.
+ *
+ * Return:
+ *   Returns the new search state, which should be freed with bfs_free().
+ */
+struct bfs* bfs_create(struct graph* graph) {
+    assert(graph);
+    int n = graph->n_nodes;
+    struct bfs* bfs = malloc(sizeof(struct bfs));
+    assert(bfs);
+    bfs->graph = graph;
+    bfs->transpose = graph_transpose(graph);
+    bfs->visited = bitset_create(n);
+    bfs->front = bitset_create(n);
+    bfs->next = bitset_create(n);
+    bfs->queue = malloc((n > 0 ? n : 1) * sizeof(int));
+    bfs->next_queue = malloc((n > 0 ? n : 1) * sizeof(int));
+    assert(bfs->queue && bfs->next_queue);
+    bfs->level = 0;
+    bfs->bottom_up_levels = 0;
+    return bfs;
+}
+
+/*
+ * This function frees the scratch space for breadth-first searches.
+ *
+ * Params:
+ *   bfs - the search state to be destroyed.  May not be NULL.
+ */
+void bfs_free(struct bfs* bfs) {
+    assert(bfs);
+    graph_free(bfs->transpose);
+    bitset_free(bfs->visited);
+    bitset_free(bfs->front);
+    bitset_free(bfs->next);
+    free(bfs->queue);
+    free(bfs->next_queue);
+    free(bfs);
+}
+
+/*
+ * Helper function to record that v was found on the next level from u.
+ */
+static void found(struct bfs* bfs, int v, int u) {
+    if (bfs->depth) {
+        bfs->depth[v] = bfs->level + 1;
+    }
+    if (bfs->parent) {
+        bfs->parent[v] = u;
+    }
+}
+
+/*
+ * One top-down step: visit the unvisited targets of every frontier node.
+ */
+static void top_down(struct bfs_thread* t) {
+    struct bfs* bfs = t->bfs;
+    struct graph* graph = bfs->graph;
+    int buffer[BFS_BLOCK];
+    int size = 0, i;
+    long edges = 0;
+    while ((i = __atomic_fetch_add(&bfs->next_item, BFS_BLOCK,
+            __ATOMIC_RELAXED)) < bfs->queue_size) {
+        int end = i + BFS_BLOCK < bfs->queue_size ? i + BFS_BLOCK :
+            bfs->queue_size;
+        for (; i < end; i++) {
+            int u = bfs->queue[i];
+            for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+                int v = graph->targets[e];
+                if (!bitset_set_atomic(bfs->visited, v)) {
+                    continue;
+                }
+                found(bfs, v, u);
+                edges += graph->offsets[v + 1] - graph->offsets[v];
+                if (size == BFS_BLOCK) {
+                    int at = __atomic_fetch_add(&bfs->next_size, size,
+                        __ATOMIC_RELAXED);
+                    memcpy(bfs->next_queue + at, buffer, size * sizeof(int));
+                    size = 0;
+                }
+                buffer[size++] = v;
+            }
+        }
+    }
+    int at = __atomic_fetch_add(&bfs->next_size, size, __ATOMIC_RELAXED);
+    memcpy(bfs->next_queue + at, buffer, size * sizeof(int));
+    __atomic_fetch_add(&bfs->frontier_edges, edges, __ATOMIC_RELAXED);
+}
+
+/*
+ * One bottom-up step: find a frontier node among the in-neighbors of every
+ * unvisited node in this thread's share of the words.
+ */
+static void bottom_up(struct bfs_thread* t) {
+    struct bfs* bfs = t->bfs;
+    struct graph* graph = bfs->graph;
+    struct graph* transpose = bfs->transpose;
+    struct bitset* visited = bfs->visited;
+    long lo = visited->n_words * t->id / bfs->n_threads;
+    long hi = visited->n_words * (t->id + 1) / bfs->n_threads;
+    long edges = 0;
+    for (long w = lo; w < hi; w++) {
+        unsigned long long unvisited = ~visited->words[w];
+        if (w == visited->n_words - 1 && visited->n_bits % 64) {
+            unvisited &= (1ULL << (visited->n_bits % 64)) - 1;
+        }
+        while (unvisited) {
+            int v = (int)(w * 64 + __builtin_ctzll(unvisited));
+            unvisited &= unvisited - 1;
+            for (int e = transpose->offsets[v]; e < transpose->offsets[v + 1];
+                    e++) {
+                int u = transpose->targets[e];
+                if (bitset_test(bfs->front, u)) {
+                    bitset_set(visited, v);
+                    bitset_set(bfs->next, v);
+                    found(bfs, v, u);
+                    edges += graph->offsets[v + 1] - graph->offsets[v];
+                    break;
+                }
+            }
+        }
+    }
+    __atomic_fetch_add(&bfs->frontier_edges, edges, __ATOMIC_RELAXED);
+}
+
+/*
+ * Helper function, run by thread 0 alone, to finish a level and set up the
+ * next one, choosing its direction, or to set bfs->done if nothing new was
+ * found.
+ */
+static void advance_level(struct bfs* bfs) {
+    int previous = bfs->frontier_nodes;
+    bfs->frontier_nodes = bfs->bottom_up ? (int)bitset_count(bfs->next) :
+        bfs->next_size;
+    bfs->reached += bfs->frontier_nodes;
+    bfs->unexplored_edges -= bfs->frontier_edges;
+    bfs->level++;
+    if (bfs->frontier_nodes == 0) {
+        bfs->done = 1;
+        return;
+    }
+
+    if (!bfs->bottom_up && bfs->mode == BFS_DIRECTION_OPTIMIZING &&
+            bfs->frontier_edges > bfs->unexplored_edges / ALPHA) {
+        bitset_clear(bfs->front);
+        for (int i = 0; i < bfs->next_size; i++) {
+            bitset_set(bfs->front, bfs->next_queue[i]);
+        }
+        bitset_clear(bfs->next);
+        bfs->bottom_up = 1;
+    } else if (bfs->bottom_up && bfs->frontier_nodes < previous &&
+            bfs->frontier_nodes < bfs->graph->n_nodes / BETA) {
+        int size = 0;
+        for (long v = bitset_next(bfs->next, 0); v >= 0;
+                v = bitset_next(bfs->next, v + 1)) {
+            bfs->queue[size++] = (int)v;
+        }
+        bfs->queue_size = size;
+        bfs->bottom_up = 0;
+    } else if (bfs->bottom_up) {
+        struct bitset* t = bfs->front;
+        bfs->front = bfs->next;
+        bfs->next = t;
+        bitset_clear(bfs->next);
+    } else {
+        int* t = bfs->queue;
+        bfs->queue = bfs->next_queue;
+        bfs->next_queue = t;
+        bfs->queue_size = bfs->next_size;
+    }
+    bfs->bottom_up_levels += bfs->bottom_up;
+    bfs->next_size = 0;
+    bfs->next_item = 0;
+    bfs->frontier_edges = 0;
+}
+
+/*
+ * Thread body for the search.
+ */
+static void* bfs_thread(void* arg) {
+    struct bfs_thread* t = arg;
+    struct bfs* bfs = t->bfs;
+    while (!bfs->done) {
+        if (bfs->bottom_up) {
+            bottom_up(t);
+        } else {
+            top_down(t);
+        }
+        pthread_barrier_wait(&bfs->barrier);
+        if (t->id == 0) {
+            advance_level(bfs);
+        }
+        pthread_barrier_wait(&bfs->barrier);
+    }
+    return NULL;
+}
+
+/*
+ * This function runs a breadth-first search from one node.
+ *
+ * Params:
+ *   bfs - the search state.  May not be NULL.
+ *   source - the node to start from.
+ *   mode - BFS_TOP_DOWN to search top-down only, or
+ *     BFS_DIRECTION_OPTIMIZING to switch directions as described above.
+ *   n_threads - the number of threads to use.
+ *   depth - array of graph->n_nodes entries that receives the number of
+ *     edges on a shortest path to each node, or -1 for unreachable nodes.
+ *     May be NULL.
+ *   parent - array of graph->n_nodes entries that receives the node before
+ *     each node on such a path, with the source its own parent and -1 for
+ *     unreachable nodes.  Which of several equally short paths it follows
+ *     depends on thread timing.  May be NULL.
+ *
+ * Return:
+ *   Returns the number of nodes reached, including the source.
+ */
+int bfs_run(struct bfs* bfs, int source, int mode, int n_threads, int* depth,
+        int* parent) {
+    assert(bfs);
+    struct graph* graph = bfs->graph;
+    assert(source >= 0 && source < graph->n_nodes);
+    if (n_threads < 1) {
+        n_threads = 1;
+    }
+
+    for (int v = 0; depth && v < graph->n_nodes; v++) {
+        depth[v] = -1;
+    }
+    for (int v = 0; parent && v < graph->n_nodes; v++) {
+        parent[v] = -1;
+    }
+    if (depth) {
+        depth[source] = 0;
+    }
+    if (parent) {
+        parent[source] = source;
+    }
+    bitset_clear(bfs->visited);
+    bitset_set(bfs->visited, source);
+
+    bfs->depth = depth;
+    bfs->parent = parent;
+    bfs->mode = mode;
+    bfs->n_threads = n_threads;
+    bfs->queue[0] = source;
+    bfs->queue_size = 1;
+    bfs->next_size = 0;
+    bfs->next_item = 0;
+    bfs->bottom_up = 0;
+    bfs->level = 0;
+    bfs->frontier_nodes = 1;
+    bfs->frontier_edges = 0;
+    bfs->unexplored_edges = graph->n_edges -
+        (graph->offsets[source + 1] - graph->offsets[source]);
+    bfs->reached = 1;
+    bfs->bottom_up_levels = 0;
+    bfs->done = 0;
+
+    struct bfs_thread* threads = malloc(n_threads * sizeof(struct bfs_thread));
+    assert(threads);
+    pthread_t* ids = malloc(n_threads * sizeof(pthread_t));
+    assert(ids);
+    pthread_barrier_init(&bfs->barrier, NULL, n_threads);
+    for (int i = 0; i < n_threads; i++) {
+        threads[i].bfs = bfs;
+        threads[i].id = i;
+        if (i > 0) {
+            pthread_create(&ids[i], NULL, bfs_thread, &threads[i]);
+        }
+    }
+    bfs_thread(&threads[0]);
+    for (int i = 1; i < n_threads; i++) {
+        pthread_join(ids[i], NULL);
+    }
+    pthread_barrier_destroy(&bfs->barrier);
+    free(ids);
+    free(threads);
+    return bfs->reached;
+}
+
+/*
+ * This function reports the shape of the last search.
+ *
+ * Params:
+ *   bfs - the search state.  May not be NULL.
+ *   bottom_up - if not NULL, receives the number of levels searched
+ *     bottom-up.
+ *
+ * Return:
+ *   Returns the number of levels searched, i.e. the greatest depth plus 1.
+ */
+int bfs_last_levels(struct bfs* bfs, int* bottom_up) {
+    assert(bfs);
+    if (bottom_up) {
+        *bottom_up = bfs->bottom_up_levels;
+    }
+    return bfs->level;
+}
@@ -0,0 +1,34 @@
+/*
+ * This file contains the definition of the interface for breadth-first
+ * search.  You can find descriptions of the functions, including their
+ * parameters and their return values, in bfs.c.
+ */
+
+#ifndef __BFS_H
+#define __BFS_H
+
+#include "graph.h"
+
+/*
+ * Search directions for bfs_run().
+ */
+#define BFS_TOP_DOWN 0
+#define BFS_DIRECTION_OPTIMIZING 1
+
+/*
+ * Structure used to hold the scratch space for breadth-first searches on
+ * one graph.
+ */
+struct bfs;
+
+/*
+ * Breadth-first search interface function prototypes.  Refer to bfs.c for
+ * documentation about each of these functions.
+ */
+struct bfs* bfs_create(struct graph* graph);
+void bfs_free(struct bfs* bfs);
+int bfs_run(struct bfs* bfs, int source, int mode, int n_threads, int* depth,
+  int* parent);
+int bfs_last_levels(struct bfs* bfs, int* bottom_up);
+
+#endif
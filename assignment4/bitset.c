@@ -0,0 +1,141 @@
+/*
+ * This file contains an implementation of a fixed-size bitset, used for the
+ * visited and frontier sets of graph traversals.  One bit per node instead
+ * of an int keeps these sets 32 times smaller, so on large graphs they stay
+ * in cache, and whole words of 64 nodes can be tested, combined and counted
+ * at once.
+ *
+ * The operations on whole bitsets work a word at a time.  None of them are
+ * atomic; only bitset_set_atomic() in bitset.h may be used by several
+ * threads on the same word at once.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "bitset.h"
+
+/*
+ * This function allocates a bitset with every bit 0.
+ *
+ * Params:
+ *   n_bits - the number of bits.  Must not be negative.
+ *
+ * Return:
+ *   Returns the new bitset, which should be freed with bitset_free().
+ */
+struct bitset* bitset_create(long n_bits) {
+    assert(n_bits >= 0);
+    struct bitset* b = malloc(sizeof(struct bitset));
+    assert(b);
+    b->n_bits = n_bits;
+    b->n_words = (n_bits + 63) / 64;
+    b->words = calloc(b->n_words > 0 ? b->n_words : 1,
+        sizeof(unsigned long long));
+    assert(b->words);
+    return b;
+}
+
+/*
+ * This function frees a bitset.
+ *
+ * Params:
+ *   b - the bitset to be destroyed.  May not be NULL.
+ */
+void bitset_free(struct bitset* b) {
+    assert(b);
+    free(b->words);
+    free(b);
+}
+
+/*
+ * This function sets every bit of a bitset to 0.
+ */
+void bitset_clear(struct bitset* b) {
+    assert(b);
+    memset(b->words, 0, b->n_words * sizeof(unsigned long long));
+}
+
+/*
+ * This function sets every bit of a bitset to 1.
+ */
+void bitset_fill(struct bitset* b) {
+    assert(b);
+    memset(b->words, 0xff, b->n_words * sizeof(unsigned long long));
+    if (b->n_bits % 64) {
+        b->words[b->n_words - 1] = (1ULL << (b->n_bits % 64)) - 1;
+    }
+}
+
+/*
+ * This function returns the number of bits set in a bitset.
+ */
+long bitset_count(struct bitset* b) {
+    assert(b);
+    long count = 0;
+    for (long w = 0; w < b->n_words; w++) {
+        count += __builtin_popcountll(b->words[w]);
+    }
+    return count;
+}
+
+/*
+ * These functions combine two bitsets of the same size, a word at a time,
+ * and store the result in the first one:
+ *
+ *   bitset_or - dst = dst | src
+ *   bitset_and - dst = dst & src
+ *   bitset_andnot - dst = dst & ~src, which removes src's bits from dst
+ */
+void bitset_or(struct bitset* dst, struct bitset* src) {
+    assert(dst && src && dst->n_bits == src->n_bits);
+    for (long w = 0; w < dst->n_words; w++) {
+        dst->words[w] |= src->words[w];
+    }
+}
+
+void bitset_and(struct bitset* dst, struct bitset* src) {
+    assert(dst && src && dst->n_bits == src->n_bits);
+    for (long w = 0; w < dst->n_words; w++) {
+        dst->words[w] &= src->words[w];
+    }
+}
+
+void bitset_andnot(struct bitset* dst, struct bitset* src) {
+    assert(dst && src && dst->n_bits == src->n_bits);
+    for (long w = 0; w < dst->n_words; w++) {
+        dst->words[w] &= ~src->words[w];
+    }
+}
+
+/*
+ * This function finds the first set bit at or after a position.  Words of
+ * zeros are skipped whole, so walking all the set bits of a sparse bitset
+ * with it costs little more than one pass over its words.
+ *
+ * Params:
+ *   b - the bitset.  May not be NULL.
+ *   i - the position to start from.
+ *
+ * Return:
+ *   Returns the position of the first set bit at or after i, or -1 if there
+ *   is none.
+ */
+long bitset_next(struct bitset* b, long i) {
+    assert(b && i >= 0);
+    if (i >= b->n_bits) {
+        return -1;
+    }
+    long w = i >> 6;
+    unsigned long long word = b->words[w] & (~0ULL << (i & 63));
+    while (word == 0) {
+        if (++w == b->n_words) {
+            return -1;
+        }
+        word = b->words[w];
+    }
+    return w * 64 + __builtin_ctzll(word);
+}
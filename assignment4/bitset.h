@@ -0,0 +1,71 @@
+/*
+ * This file contains the definition of the interface for a fixed-size
+ * bitset.  The single-bit operations are defined here so they can be
+ * inlined; you can find descriptions of the other functions, including their
+ * parameters and their return values, in bitset.c.
+ */
+
+#ifndef __BITSET_H
+#define __BITSET_H
+
+/*
+ * Structure used to represent a bitset of n_bits bits, packed 64 to a word.
+ * Bits past n_bits in the last word are always 0.
+ */
+struct bitset {
+  long n_bits;
+  long n_words;
+  unsigned long long* words;
+};
+
+/*
+ * Returns bit i of a bitset.
+ */
+static inline int bitset_test(struct bitset* b, long i) {
+  return (int)(b->words[i >> 6] >> (i & 63) & 1);
+}
+
+/*
+ * Sets bit i of a bitset to 1.
+ */
+static inline void bitset_set(struct bitset* b, long i) {
+  b->words[i >> 6] |= 1ULL << (i & 63);
+}
+
+/*
+ * Sets bit i of a bitset to 0.
+ */
+static inline void bitset_unset(struct bitset* b, long i) {
+  b->words[i >> 6] &= ~(1ULL << (i & 63));
+}
+
+/*
+ * Sets bit i of a bitset to 1 atomically, so several threads may set bits
+ * in the same word at once.  Returns 1 if this call changed the bit, or 0
+ * if it was already set, so exactly one of several threads setting the same
+ * bit gets 1.
+ */
+static inline int bitset_set_atomic(struct bitset* b, long i) {
+  unsigned long long mask = 1ULL << (i & 63);
+  if (__atomic_load_n(&b->words[i >> 6], __ATOMIC_RELAXED) & mask) {
+    return 0;
+  }
+  return !(__atomic_fetch_or(&b->words[i >> 6], mask, __ATOMIC_RELAXED) &
+    mask);
+}
+
+/*
+ * Bitset interface function prototypes.  Refer to bitset.c for
+ * documentation about each of these functions.
+ */
+struct bitset* bitset_create(long n_bits);
+void bitset_free(struct bitset* b);
+void bitset_clear(struct bitset* b);
+void bitset_fill(struct bitset* b);
+long bitset_count(struct bitset* b);
+void bitset_or(struct bitset* dst, struct bitset* src);
+void bitset_and(struct bitset* dst, struct bitset* src);
+void bitset_andnot(struct bitset* dst, struct bitset* src);
+long bitset_next(struct bitset* b, long i);
+
+#endif
@@ -0,0 +1,274 @@
+/*
+ * This file contains an implementation of a least-recently-used cache of
+ * shortest-path trees, keyed by source node.
+ *
+ * Cached trees are kept in a hash table for lookup and in a doubly-linked
+ * list from most to least recently used.  When the cache is over capacity,
+ * the tree at the old end of the list is evicted.  Each tree is reference
+ * counted, so a tree that is evicted while a thread is still reading it is
+ * only freed once that thread releases it.
+ *
+ * One mutex protects the table and the list.  It is never held while a tree
+ * is computed: a thread that misses computes the tree on its own and then
+ * inserts it, and if another thread inserted the same source in the
+ * meantime, the second copy is thrown away.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "cache.h"
+
+/*
+ * A cached tree.  The public part comes first, so a struct sp_tree* handed
+ * to callers can be turned back into the entry.
+ */
+struct entry {
+    struct sp_tree tree;
+    int refs;
+    int cached;
+    struct entry* newer;
+    struct entry* older;
+    struct entry* next;
+};
+
+struct tree_cache {
+    struct graph* graph;
+    int capacity;
+    int size;
+    struct entry** buckets;
+    int n_buckets;
+    struct entry* newest;
+    struct entry* oldest;
+    long hits;
+    long misses;
+    pthread_mutex_t lock;
+};
+
+/*
+ * This function creates a tree cache.
+ *
+ * Params:
+ *   graph - the graph the trees are computed in.  May not be NULL.  It must
+ *     stay alive and unchanged until the cache is freed.
+ *   capacity - the largest number of trees to keep.  With 0, every tree is
+ *     computed on demand and freed when released.
+ *
+ * Return:
+ *   Returns the new cache, which should be freed with tree_cache_free().
+ */
+struct tree_cache* tree_cache_create(struct graph* graph, int capacity) {
+    assert(graph && capacity >= 0);
+    struct tree_cache* cache = malloc(sizeof(struct tree_cache));
+    assert(cache);
+    cache->graph = graph;
+    cache->capacity = capacity;
+    cache->size = 0;
+    cache->n_buckets = 16;
+    while (cache->n_buckets < 2 * capacity) {
+        cache->n_buckets *= 2;
+    }
+    cache->buckets = calloc(cache->n_buckets, sizeof(struct entry*));
+    assert(cache->buckets);
+    cache->newest = cache->oldest = NULL;
+    cache->hits = cache->misses = 0;
+    pthread_mutex_init(&cache->lock, NULL);
+    return cache;
+}
+
+static void entry_free(struct entry* entry) {
+    free(entry->tree.dist);
+    free(entry->tree.prev);
+    free(entry);
+}
+
+/*
+ * This function frees a tree cache and every tree in it.  No tree from it
+ * may still be in use.
+ *
+ * Params:
+ *   cache - the cache to be destroyed.  May not be NULL.
+ */
+void tree_cache_free(struct tree_cache* cache) {
+    assert(cache);
+    struct entry* entry = cache->newest;
+    while (entry) {
+        struct entry* older = entry->older;
+        assert(entry->refs == 0);
+        entry_free(entry);
+        entry = older;
+    }
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->buckets);
+    free(cache);
+}
+
+/*
+ * This function returns the graph a cache computes trees in.
+ */
+struct graph* tree_cache_graph(struct tree_cache* cache) {
+    assert(cache);
+    return cache->graph;
+}
+
+/*
+ * Helper functions to maintain the recency list.  The caller must hold the
+ * lock.
+ */
+static void list_remove(struct tree_cache* cache, struct entry* entry) {
+    if (entry->newer) {
+        entry->newer->older = entry->older;
+    } else {
+        cache->newest = entry->older;
+    }
+    if (entry->older) {
+        entry->older->newer = entry->newer;
+    } else {
+        cache->oldest = entry->newer;
+    }
+}
+
+static void list_push_newest(struct tree_cache* cache, struct entry* entry) {
+    entry->newer = NULL;
+    entry->older = cache->newest;
+    if (cache->newest) {
+        cache->newest->newer = entry;
+    } else {
+        cache->oldest = entry;
+    }
+    cache->newest = entry;
+}
+
+/*
+ * Helper function to return the hash table slot for a source.
+ */
+static struct entry** bucket(struct tree_cache* cache, int source) {
+    unsigned int h = (unsigned int)source * 2654435761u;
+    return &cache->buckets[h & (cache->n_buckets - 1)];
+}
+
+/*
+ * Helper function to drop the least recently used tree from the table and
+ * list.  It is freed now if no one is using it, or otherwise by the last
+ * tree_cache_release().  The caller must hold the lock.
+ */
+static void evict_oldest(struct tree_cache* cache) {
+    struct entry* entry = cache->oldest;
+    struct entry** link = bucket(cache, entry->tree.source);
+    while (*link != entry) {
+        link = &(*link)->next;
+    }
+    *link = entry->next;
+    list_remove(cache, entry);
+    cache->size--;
+    entry->cached = 0;
+    if (entry->refs == 0) {
+        entry_free(entry);
+    }
+}
+
+/*
+ * This function returns the shortest-path tree from a source, computing it
+ * with sssp_dijkstra() if it isn't cached, and marks it as the most
+ * recently used.  It is safe to call from several threads at once.
+ *
+ * Params:
+ *   cache - the cache.  May not be NULL.
+ *   source - the source node.
+ *
+ * Return:
+ *   Returns the tree, which stays valid until it is passed to
+ *   tree_cache_release().
+ */
+struct sp_tree* tree_cache_get(struct tree_cache* cache, int source) {
+    assert(cache);
+    assert(source >= 0 && source < cache->graph->n_nodes);
+
+    pthread_mutex_lock(&cache->lock);
+    for (struct entry* e = *bucket(cache, source); e; e = e->next) {
+        if (e->tree.source == source) {
+            list_remove(cache, e);
+            list_push_newest(cache, e);
+            e->refs++;
+            cache->hits++;
+            pthread_mutex_unlock(&cache->lock);
+            return &e->tree;
+        }
+    }
+    cache->misses++;
+    pthread_mutex_unlock(&cache->lock);
+
+    int n = cache->graph->n_nodes;
+    struct entry* entry = malloc(sizeof(struct entry));
+    assert(entry);
+    entry->tree.source = source;
+    entry->tree.dist = malloc(n * sizeof(dist_t));
+    entry->tree.prev = malloc(n * sizeof(int));
+    assert(entry->tree.dist && entry->tree.prev);
+    sssp_dijkstra(cache->graph, source, entry->tree.dist, entry->tree.prev);
+    entry->refs = 1;
+    entry->cached = 0;
+    if (cache->capacity == 0) {
+        return &entry->tree;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    struct entry** slot = bucket(cache, source);
+    for (struct entry* e = *slot; e; e = e->next) {
+        if (e->tree.source == source) {
+            e->refs++;
+            pthread_mutex_unlock(&cache->lock);
+            entry_free(entry);
+            return &e->tree;
+        }
+    }
+    entry->cached = 1;
+    entry->next = *slot;
+    *slot = entry;
+    list_push_newest(cache, entry);
+    if (++cache->size > cache->capacity) {
+        evict_oldest(cache);
+    }
+    pthread_mutex_unlock(&cache->lock);
+    return &entry->tree;
+}
+
+/*
+ * This function gives back a tree returned by tree_cache_get().
+ *
+ * Params:
+ *   cache - the cache the tree came from.  May not be NULL.
+ *   tree - the tree.  May not be NULL.
+ */
+void tree_cache_release(struct tree_cache* cache, struct sp_tree* tree) {
+    assert(cache && tree);
+    struct entry* entry = (struct entry*)tree;
+    pthread_mutex_lock(&cache->lock);
+    int unused = --entry->refs == 0 && !entry->cached;
+    pthread_mutex_unlock(&cache->lock);
+    if (unused) {
+        entry_free(entry);
+    }
+}
+
+/*
+ * This function reports how well a cache is doing.
+ *
+ * Params:
+ *   cache - the cache.  May not be NULL.
+ *   hits, misses - receive the number of lookups that found a cached tree
+ *     and that had to compute one.
+ *   size - receives the number of trees currently cached.
+ */
+void tree_cache_stats(struct tree_cache* cache, long* hits, long* misses,
+        int* size) {
+    assert(cache);
+    pthread_mutex_lock(&cache->lock);
+    *hits = cache->hits;
+    *misses = cache->misses;
+    *size = cache->size;
+    pthread_mutex_unlock(&cache->lock);
+}
@@ -0,0 +1,42 @@
+/*
+ * This file contains the definition of the interface for a cache of
+ * shortest-path trees, shared by the threads of the query server.  You can
+ * find descriptions of the functions, including their parameters and their
+ * return values, in cache.c.
+ */
+
+#ifndef __CACHE_H
+#define __CACHE_H
+
+#include "graph.h"
+#include "sssp.h"
+
+/*
+ * A shortest-path tree from one source: dist[v] is the distance to v and
+ * prev[v] its predecessor (see sssp_canonical_previous()).  Trees returned
+ * by tree_cache_get() must not be modified.
+ */
+struct sp_tree {
+  int source;
+  dist_t* dist;
+  int* prev;
+};
+
+/*
+ * Structure used to represent a tree cache.
+ */
+struct tree_cache;
+
+/*
+ * Tree cache interface function prototypes.  Refer to cache.c for
+ * documentation about each of these functions.
+ */
+struct tree_cache* tree_cache_create(struct graph* graph, int capacity);
+void tree_cache_free(struct tree_cache* cache);
+struct sp_tree* tree_cache_get(struct tree_cache* cache, int source);
+void tree_cache_release(struct tree_cache* cache, struct sp_tree* tree);
+void tree_cache_stats(struct tree_cache* cache, long* hits, long* misses,
+  int* size);
+struct graph* tree_cache_graph(struct tree_cache* cache);
+
+#endif
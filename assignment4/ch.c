@@ -0,0 +1,727 @@
+/*
+ * This file contains an implementation of contraction hierarchies (Geisberger
+ * et al.) on the CSR graphs from graph.h.  All edge weights are assumed to be
+ * non-negative.
+ *
+ * Preprocessing removes ("contracts") the nodes one at a time, least
+ * important first.  When a node v is contracted, every path u -> v -> w
+ * through it that might be a shortest path is replaced by a shortcut edge
+ * u -> w of the same length, unless a local "witness" search finds a path
+ * from u to w that avoids v and is no longer.  The position of a node in
+ * this order is its rank.
+ *
+ * Importance is the edge difference (the number of shortcuts contracting
+ * the node would add, minus the number of edges it would remove) plus the
+ * number of neighbors already contracted and the node's level in the
+ * hierarchy so far, both of which spread contraction evenly over the graph
+ * and keep the hierarchy shallow.  Importances are kept in the pq with lazy
+ * updates: a node is re-evaluated when it comes to the front of the queue
+ * and put back if it is no longer the least important.
+ *
+ * Every edge, original or shortcut, ends up stored at its lower-ranked end:
+ * the "up" graph holds edges u -> w going up in rank from u, and the "down"
+ * graph holds each edge u -> v going down in rank reversed, as v -> u.  Some
+ * shortest path from s to t always goes only up and then only down, so a
+ * query searches forwards from s in the up graph and backwards from t in the
+ * down graph, and each search only ever climbs.  Both searches are tiny.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "ch.h"
+#include "pq.h"
+
+/*
+ * Witness searches give up after settling this many nodes when contracting
+ * a node, or when only estimating how many shortcuts contracting it would
+ * need.  A search that gives up too early only adds a shortcut that isn't
+ * needed, which keeps queries correct.
+ */
+#define WITNESS_LIMIT 500
+#define ESTIMATE_LIMIT 50
+
+/*
+ * A list of edges into or out of one node of the remaining graph during
+ * preprocessing.  A shortcut can be longer than INT_MAX, so weights are
+ * dist_t.
+ */
+struct arc {
+    int node;
+    dist_t weight;
+};
+
+struct arcs {
+    struct arc* items;
+    int size;
+    int capacity;
+};
+
+/*
+ * Helper function to add an edge to a list, or to lower the weight of the
+ * edge to the same node if the list already has one.
+ */
+static void arcs_add(struct arcs* arcs, int node, dist_t weight) {
+    for (int i = 0; i < arcs->size; i++) {
+        if (arcs->items[i].node == node) {
+            if (weight < arcs->items[i].weight) {
+                arcs->items[i].weight = weight;
+            }
+            return;
+        }
+    }
+    if (arcs->size == arcs->capacity) {
+        arcs->capacity = arcs->capacity ? 2 * arcs->capacity : 4;
+        arcs->items = realloc(arcs->items,
+            arcs->capacity * sizeof(struct arc));
+        assert(arcs->items);
+    }
+    arcs->items[arcs->size].node = node;
+    arcs->items[arcs->size++].weight = weight;
+}
+
+/*
+ * Helper function to remove the edge to a node from a list.
+ */
+static void arcs_remove(struct arcs* arcs, int node) {
+    for (int i = 0; i < arcs->size; i++) {
+        if (arcs->items[i].node == node) {
+            arcs->items[i] = arcs->items[--arcs->size];
+            return;
+        }
+    }
+}
+
+/*
+ * Witness searches and queries are short and there are millions of them, so
+ * they use this plain binary heap of (distance, node) pairs instead of the
+ * pq.  The pq keeps pointers to separate nodes, each holding the element as
+ * a void*, so every comparison in a sift follows a pointer; here the entries
+ * are stored in the array itself.
+ */
+struct heap_entry {
+    dist_t dist;
+    int node;
+};
+
+struct heap {
+    struct heap_entry* items;
+    int size;
+    int capacity;
+};
+
+static void heap_push(struct heap* heap, dist_t dist, int node) {
+    if (heap->size == heap->capacity) {
+        heap->capacity = heap->capacity ? 2 * heap->capacity : 64;
+        heap->items = realloc(heap->items,
+            heap->capacity * sizeof(struct heap_entry));
+        assert(heap->items);
+    }
+    int i = heap->size++;
+    while (i > 0 && heap->items[(i - 1) / 2].dist > dist) {
+        heap->items[i] = heap->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap->items[i].dist = dist;
+    heap->items[i].node = node;
+}
+
+static struct heap_entry heap_pop(struct heap* heap) {
+    struct heap_entry top = heap->items[0];
+    struct heap_entry last = heap->items[--heap->size];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= heap->size) {
+            break;
+        }
+        if (child + 1 < heap->size &&
+                heap->items[child + 1].dist < heap->items[child].dist) {
+            child++;
+        }
+        if (heap->items[child].dist >= last.dist) {
+            break;
+        }
+        heap->items[i] = heap->items[child];
+        i = child;
+    }
+    if (heap->size > 0) {
+        heap->items[i] = last;
+    }
+    return top;
+}
+
+/*
+ * The up and down graphs.  They have the same CSR layout as struct graph,
+ * but with dist_t weights, since shortcuts can be longer than INT_MAX.
+ */
+struct hgraph {
+    int n_edges;
+    int* offsets;
+    int* targets;
+    dist_t* weights;
+};
+
+static void hgraph_free(struct hgraph* graph) {
+    free(graph->offsets);
+    free(graph->targets);
+    free(graph->weights);
+    free(graph);
+}
+
+/*
+ * A growable list of edges for the up and down graphs.
+ */
+struct edge_list {
+    int* sources;
+    int* targets;
+    dist_t* weights;
+    int size;
+    int capacity;
+};
+
+static void edge_list_add(struct edge_list* list, int u, int v, dist_t w) {
+    if (list->size == list->capacity) {
+        list->capacity = list->capacity ? 2 * list->capacity : 1024;
+        list->sources = realloc(list->sources, list->capacity * sizeof(int));
+        list->targets = realloc(list->targets, list->capacity * sizeof(int));
+        list->weights = realloc(list->weights,
+            list->capacity * sizeof(dist_t));
+        assert(list->sources && list->targets && list->weights);
+    }
+    list->sources[list->size] = u;
+    list->targets[list->size] = v;
+    list->weights[list->size++] = w;
+}
+
+/*
+ * Helper function to turn an edge list into a graph, grouping the edges by
+ * source with a counting sort, and free the list.
+ */
+static struct hgraph* edge_list_finish(struct edge_list* list, int n_nodes) {
+    struct hgraph* graph = malloc(sizeof(struct hgraph));
+    int m = list->size;
+    assert(graph);
+    graph->n_edges = m;
+    graph->offsets = calloc(n_nodes + 1, sizeof(int));
+    graph->targets = malloc((m > 0 ? m : 1) * sizeof(int));
+    graph->weights = malloc((m > 0 ? m : 1) * sizeof(dist_t));
+    int* cursor = malloc((n_nodes + 1) * sizeof(int));
+    assert(graph->offsets && graph->targets && graph->weights && cursor);
+
+    for (int i = 0; i < m; i++) {
+        graph->offsets[list->sources[i] + 1]++;
+    }
+    for (int u = 0; u < n_nodes; u++) {
+        graph->offsets[u + 1] += graph->offsets[u];
+    }
+    memcpy(cursor, graph->offsets, (n_nodes + 1) * sizeof(int));
+    for (int i = 0; i < m; i++) {
+        int e = cursor[list->sources[i]]++;
+        graph->targets[e] = list->targets[i];
+        graph->weights[e] = list->weights[i];
+    }
+
+    free(cursor);
+    free(list->sources);
+    free(list->targets);
+    free(list->weights);
+    return graph;
+}
+
+/*
+ * State used only during preprocessing.  The remaining graph is kept as
+ * edge lists in both directions, without the nodes contracted so far.
+ */
+struct builder {
+    int n_nodes;
+    struct arcs* out;
+    struct arcs* in;
+    char* contracted;
+
+    /*
+     * The parts of each node's importance: its edge difference when last
+     * computed, its number of contracted neighbors, and its level, which is
+     * one more than the highest level of a contracted neighbor.
+     */
+    int* edge_diff;
+    int* deleted;
+    int* level;
+
+    /*
+     * The queue of nodes by importance, and each node's latest importance.
+     * A node can be in the queue more than once; only the entry with its
+     * latest importance counts.
+     */
+    struct pq* order;
+    int* priority;
+
+    /*
+     * Scratch space for witness searches, stamped with the number of the
+     * search that last wrote it.
+     */
+    struct heap heap;
+    dist_t* dist;
+    unsigned int* stamp;
+    unsigned int* target;
+    unsigned int search;
+
+    struct edge_list up;
+    struct edge_list down;
+    long n_shortcuts;
+};
+
+/*
+ * Helper function to run Dijkstra's algorithm from `source` in the remaining
+ * graph without passing through `skip`.  It stops once the nodes whose
+ * target stamp is the current search (n_targets of them) are all settled,
+ * or every node within max_dist is, or `limit` nodes are.  Afterwards
+ * b->dist[w] is an upper bound on the distance to w if b->stamp[w] is the
+ * current search.
+ */
+static void witness_search(struct builder* b, int source, int skip,
+        dist_t max_dist, int n_targets, int limit) {
+    b->dist[source] = 0;
+    b->stamp[source] = b->search;
+    b->heap.size = 0;
+    heap_push(&b->heap, 0, source);
+    int settled = 0;
+    while (b->heap.size > 0) {
+        struct heap_entry top = heap_pop(&b->heap);
+        dist_t du = top.dist;
+        int u = top.node;
+        if (du > b->dist[u]) {
+            continue;
+        }
+        if (du > max_dist || ++settled > limit) {
+            break;
+        }
+        if (b->target[u] == b->search && --n_targets == 0) {
+            break;
+        }
+        struct arcs* out = &b->out[u];
+        for (int i = 0; i < out->size; i++) {
+            int v = out->items[i].node;
+            dist_t d = du + out->items[i].weight;
+            if (v != skip && (b->stamp[v] != b->search || d < b->dist[v])) {
+                b->stamp[v] = b->search;
+                b->dist[v] = d;
+                heap_push(&b->heap, d, v);
+            }
+        }
+    }
+}
+
+/*
+ * Helper function to find the shortcuts that contracting v needs, adding
+ * them to the remaining graph if `apply` is set.
+ *
+ * Return:
+ *   Returns the number of shortcuts.
+ */
+static int shortcuts(struct builder* b, int v, int apply) {
+    struct arcs* in = &b->in[v];
+    struct arcs* out = &b->out[v];
+    int count = 0;
+    for (int i = 0; i < in->size; i++) {
+        int u = in->items[i].node;
+        dist_t to_v = in->items[i].weight;
+        dist_t max_dist = -1;
+        int n_targets = 0;
+        b->search++;
+        for (int j = 0; j < out->size; j++) {
+            int w = out->items[j].node;
+            if (w != u) {
+                b->target[w] = b->search;
+                n_targets++;
+                if (to_v + out->items[j].weight > max_dist) {
+                    max_dist = to_v + out->items[j].weight;
+                }
+            }
+        }
+        if (n_targets == 0) {
+            continue;
+        }
+
+        witness_search(b, u, v, max_dist, n_targets,
+            apply ? WITNESS_LIMIT : ESTIMATE_LIMIT);
+        for (int j = 0; j < out->size; j++) {
+            int w = out->items[j].node;
+            dist_t d = to_v + out->items[j].weight;
+            if (w == u || (b->stamp[w] == b->search && b->dist[w] <= d)) {
+                continue;
+            }
+            count++;
+            if (apply) {
+                arcs_add(&b->out[u], w, d);
+                arcs_add(&b->in[w], u, d);
+            }
+        }
+    }
+    return count;
+}
+
+/*
+ * Helper function to compute how important node v is now; less important
+ * nodes are contracted first.
+ */
+static int importance(struct builder* b, int v) {
+    b->edge_diff[v] = shortcuts(b, v, 0) - b->in[v].size - b->out[v].size;
+    return b->edge_diff[v] + b->deleted[v] + b->level[v];
+}
+
+/*
+ * Helper function to contract node v: its remaining edges go into the up
+ * and down graphs, the shortcuts it needs are added, and it is removed from
+ * the remaining graph.
+ *
+ * Only the cheap parts of the neighbors' importances, their count of
+ * contracted neighbors and their level, are updated here.  Recomputing
+ * their edge differences as well would take a witness search per edge of
+ * every neighbor, which dominates preprocessing once the remaining nodes
+ * have high degree; the lazy re-evaluation in ch_build() catches the change
+ * instead.
+ */
+static void contract(struct builder* b, int v) {
+    struct arcs* in = &b->in[v];
+    struct arcs* out = &b->out[v];
+    for (int i = 0; i < out->size; i++) {
+        edge_list_add(&b->up, v, out->items[i].node, out->items[i].weight);
+    }
+    for (int i = 0; i < in->size; i++) {
+        edge_list_add(&b->down, v, in->items[i].node, in->items[i].weight);
+    }
+    b->n_shortcuts += shortcuts(b, v, 1);
+
+    b->contracted[v] = 1;
+    for (int i = 0; i < out->size; i++) {
+        arcs_remove(&b->in[out->items[i].node], v);
+    }
+    for (int i = 0; i < in->size; i++) {
+        arcs_remove(&b->out[in->items[i].node], v);
+    }
+
+    for (int k = 0; k < 2; k++) {
+        struct arcs* arcs = k == 0 ? in : out;
+        for (int i = 0; i < arcs->size; i++) {
+            int x = arcs->items[i].node;
+            b->deleted[x]++;
+            if (b->level[x] < b->level[v] + 1) {
+                b->level[x] = b->level[v] + 1;
+            }
+            b->priority[x] = b->edge_diff[x] + b->deleted[x] + b->level[x];
+            pq_insert(b->order, (void*)(long)x, b->priority[x]);
+        }
+    }
+    free(in->items);
+    free(out->items);
+    in->items = out->items = NULL;
+    in->size = out->size = in->capacity = out->capacity = 0;
+}
+
+/*
+ * Per-node state for one direction of a query, stamped with the number of
+ * the query that last wrote it.
+ */
+struct side {
+    struct hgraph* graph;
+    struct hgraph* stall;
+    struct heap heap;
+    dist_t* dist;
+    unsigned int* reached;
+    unsigned int* settled;
+};
+
+struct ch {
+    int n_nodes;
+    int* rank;
+    struct hgraph* up;
+    struct hgraph* down;
+    long n_shortcuts;
+
+    struct side sides[2];
+    unsigned int query;
+    int settled;
+};
+
+/*
+ * This function builds a contraction hierarchy for a graph.  The graph
+ * itself isn't needed afterwards.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.
+ *
+ * Return:
+ *   Returns the contraction hierarchy, which should be freed with
+ *   ch_free().
+ */
+struct ch* ch_build(struct graph* graph) {
+    assert(graph);
+    int n = graph->n_nodes;
+
+    struct builder b;
+    b.n_nodes = n;
+    b.out = calloc(n + 1, sizeof(struct arcs));
+    b.in = calloc(n + 1, sizeof(struct arcs));
+    b.contracted = calloc(n + 1, 1);
+    b.edge_diff = calloc(n + 1, sizeof(int));
+    b.deleted = calloc(n + 1, sizeof(int));
+    b.level = calloc(n + 1, sizeof(int));
+    b.priority = malloc((n + 1) * sizeof(int));
+    b.dist = malloc((n + 1) * sizeof(dist_t));
+    b.stamp = calloc(n + 1, sizeof(unsigned int));
+    b.target = calloc(n + 1, sizeof(unsigned int));
+    assert(b.out && b.in && b.contracted && b.edge_diff && b.deleted &&
+        b.level && b.priority &&
+        b.dist && b.stamp && b.target);
+    b.order = pq_create();
+    b.heap = (struct heap){NULL, 0, 0};
+    b.search = 0;
+    b.n_shortcuts = 0;
+    b.up = (struct edge_list){NULL, NULL, NULL, 0, 0};
+    b.down = (struct edge_list){NULL, NULL, NULL, 0, 0};
+
+    /*
+     * Copy the graph into the edge lists, keeping only the cheapest of any
+     * parallel edges and dropping loops, which are never on shortest paths.
+     */
+    for (int u = 0; u < n; u++) {
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            int v = graph->targets[e];
+            if (v != u) {
+                arcs_add(&b.out[u], v, graph->weights[e]);
+                arcs_add(&b.in[v], u, graph->weights[e]);
+            }
+        }
+    }
+
+    for (int v = 0; v < n; v++) {
+        b.priority[v] = importance(&b, v);
+        pq_insert(b.order, (void*)(long)v, b.priority[v]);
+    }
+
+    struct ch* ch = malloc(sizeof(struct ch));
+    assert(ch);
+    ch->n_nodes = n;
+    ch->rank = malloc((n + 1) * sizeof(int));
+    assert(ch->rank);
+    int next_rank = 0;
+    while (!pq_isempty(b.order)) {
+        int p = pq_first_priority(b.order);
+        int v = (int)(long)pq_remove_first(b.order);
+        if (b.contracted[v] || p != b.priority[v]) {
+            continue;
+        }
+
+        /*
+         * The node's importance may have grown since it was queued, if
+         * contracting other nodes gave it shortcuts to lose; if it is no
+         * longer the least important, it goes back in the queue.
+         */
+        p = importance(&b, v);
+        if (p != b.priority[v]) {
+            b.priority[v] = p;
+            if (!pq_isempty(b.order) && p > pq_first_priority(b.order)) {
+                pq_insert(b.order, (void*)(long)v, p);
+                continue;
+            }
+        }
+        ch->rank[v] = next_rank++;
+        contract(&b, v);
+    }
+    ch->n_shortcuts = b.n_shortcuts;
+    ch->up = edge_list_finish(&b.up, n);
+    ch->down = edge_list_finish(&b.down, n);
+
+    pq_free(b.order);
+    free(b.heap.items);
+    free(b.out);
+    free(b.in);
+    free(b.contracted);
+    free(b.edge_diff);
+    free(b.deleted);
+    free(b.level);
+    free(b.priority);
+    free(b.dist);
+    free(b.stamp);
+    free(b.target);
+
+    for (int i = 0; i < 2; i++) {
+        struct side* side = &ch->sides[i];
+        side->graph = i == 0 ? ch->up : ch->down;
+        side->stall = i == 0 ? ch->down : ch->up;
+        side->heap = (struct heap){NULL, 0, 0};
+        side->dist = malloc((n + 1) * sizeof(dist_t));
+        side->reached = calloc(n + 1, sizeof(unsigned int));
+        side->settled = calloc(n + 1, sizeof(unsigned int));
+        assert(side->dist && side->reached && side->settled);
+    }
+    ch->query = 0;
+    ch->settled = 0;
+    return ch;
+}
+
+/*
+ * This function frees all memory associated with a contraction hierarchy.
+ *
+ * Params:
+ *   ch - the contraction hierarchy to be destroyed.  May not be NULL.
+ */
+void ch_free(struct ch* ch) {
+    assert(ch);
+    for (int i = 0; i < 2; i++) {
+        free(ch->sides[i].heap.items);
+        free(ch->sides[i].dist);
+        free(ch->sides[i].reached);
+        free(ch->sides[i].settled);
+    }
+    hgraph_free(ch->up);
+    hgraph_free(ch->down);
+    free(ch->rank);
+    free(ch);
+}
+
+/*
+ * This function returns the number of shortcuts preprocessing added.
+ */
+long ch_num_shortcuts(struct ch* ch) {
+    assert(ch);
+    return ch->n_shortcuts;
+}
+
+/*
+ * This function returns the number of bytes the index takes up: the up and
+ * down graphs and the ranks, not counting query scratch space.
+ */
+size_t ch_index_bytes(struct ch* ch) {
+    assert(ch);
+    size_t bytes = (size_t)ch->n_nodes * sizeof(int);
+    struct hgraph* graphs[2] = {ch->up, ch->down};
+    for (int i = 0; i < 2; i++) {
+        bytes += (ch->n_nodes + 1) * sizeof(int) +
+            (size_t)graphs[i]->n_edges * (sizeof(int) + sizeof(dist_t));
+    }
+    return bytes;
+}
+
+/*
+ * This function returns the number of nodes settled by both searches
+ * together in the last call to ch_query(), as a measure of its work.
+ */
+int ch_last_settled(struct ch* ch) {
+    assert(ch);
+    return ch->settled;
+}
+
+/*
+ * Helper function to reach node v from one side with distance d, if that is
+ * an improvement, and to update the best path length *best if the other
+ * side has also reached v.
+ */
+static void reach(struct ch* ch, struct side* side, struct side* other, int v,
+        dist_t d, long long* best) {
+    if (side->reached[v] == ch->query && side->dist[v] <= d) {
+        return;
+    }
+    side->reached[v] = ch->query;
+    side->dist[v] = d;
+    heap_push(&side->heap, d, v);
+    if (other->reached[v] == ch->query &&
+            (long long)d + other->dist[v] < *best) {
+        *best = (long long)d + other->dist[v];
+    }
+}
+
+/*
+ * This function finds the length of a shortest path from s to t.
+ *
+ * Unlike bidirectional Dijkstra, the two searches can't stop when they
+ * first meet, since the top of the hierarchy is usually reached late; each
+ * one stops when the smallest distance left in its queue is no better than
+ * the best path found.
+ *
+ * Params:
+ *   ch - the contraction hierarchy.  May not be NULL.
+ *   s, t - the two ends of the path.
+ *
+ * Return:
+ *   Returns the length of the path, or DIST_INF if t can't be reached from
+ *   s.
+ */
+dist_t ch_query(struct ch* ch, int s, int t) {
+    assert(ch);
+    assert(s >= 0 && s < ch->n_nodes && t >= 0 && t < ch->n_nodes);
+    struct side* forward = &ch->sides[0];
+    struct side* backward = &ch->sides[1];
+    if (++ch->query == 0) {
+        for (int i = 0; i < 2; i++) {
+            for (int v = 0; v < ch->n_nodes; v++) {
+                ch->sides[i].reached[v] = 0;
+                ch->sides[i].settled[v] = 0;
+            }
+        }
+        ch->query = 1;
+    }
+    ch->settled = 0;
+
+    long long best = LLONG_MAX;
+    reach(ch, forward, backward, s, 0, &best);
+    reach(ch, backward, forward, t, 0, &best);
+    for (;;) {
+        struct side* side = NULL;
+        long long top = LLONG_MAX;
+        for (int i = 0; i < 2; i++) {
+            struct side* candidate = &ch->sides[i];
+            if (candidate->heap.size > 0 &&
+                    candidate->heap.items[0].dist < top) {
+                side = candidate;
+                top = candidate->heap.items[0].dist;
+            }
+        }
+        if (side == NULL || top >= best) {
+            break;
+        }
+
+        struct side* other = side == forward ? backward : forward;
+        int u = heap_pop(&side->heap).node;
+        if (side->settled[u] == ch->query) {
+            continue;
+        }
+        side->settled[u] = ch->query;
+        ch->settled++;
+
+        /*
+         * Stall-on-demand: the other graph holds u's edges from higher
+         * nodes.  If this search reached one of them and it gives a shorter
+         * way to u, u is not on a shortest up path, and neither is anything
+         * reached only through it.
+         */
+        dist_t du = side->dist[u];
+        struct hgraph* graph = side->stall;
+        int stalled = 0;
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            int x = graph->targets[e];
+            if (side->reached[x] == ch->query &&
+                    side->dist[x] + graph->weights[e] < du) {
+                stalled = 1;
+                break;
+            }
+        }
+        if (stalled) {
+            continue;
+        }
+
+        graph = side->graph;
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            reach(ch, side, other, graph->targets[e], du + graph->weights[e],
+                &best);
+        }
+    }
+
+    forward->heap.size = 0;
+    backward->heap.size = 0;
+    return best == LLONG_MAX ? DIST_INF : (dist_t)best;
+}
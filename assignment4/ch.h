@@ -0,0 +1,32 @@
+/*
+ * This file contains the definition of the interface for contraction
+ * hierarchies, an index for fast point-to-point shortest-path queries on a
+ * graph that doesn't change.  You can find descriptions of the functions,
+ * including their parameters and their return values, in ch.c.
+ */
+
+#ifndef __CH_H
+#define __CH_H
+
+#include <stddef.h>
+
+#include "graph.h"
+#include "sssp.h"
+
+/*
+ * Structure used to represent a contraction hierarchy.
+ */
+struct ch;
+
+/*
+ * Contraction hierarchy interface function prototypes.  Refer to ch.c for
+ * documentation about each of these functions.
+ */
+struct ch* ch_build(struct graph* graph);
+void ch_free(struct ch* ch);
+dist_t ch_query(struct ch* ch, int s, int t);
+int ch_last_settled(struct ch* ch);
+long ch_num_shortcuts(struct ch* ch);
+size_t ch_index_bytes(struct ch* ch);
+
+#endif
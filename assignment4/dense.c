@@ -0,0 +1,341 @@
+/*
+ * This file contains dense graphs, stored as a single adjacency matrix, and
+ * the O(n^2) version of Dijkstra's algorithm on them, which beats a heap
+ * when almost every pair of nodes is joined by an edge.
+ *
+ * The algorithm is the one in dijkstra.c, and makes the same choices on
+ * ties: the next node settled is the lowest-numbered one of those at the
+ * smallest distance, and a node's predecessor only changes when its
+ * distance strictly drops.  Two things make it faster:
+ *
+ *   - The matrix is one aligned block rather than one allocation per row,
+ *     so rows are contiguous and the hardware prefetcher can stream them.
+ *   - There is no visited array.  Alongside the distances, a `key` array
+ *     holds each unsettled node's distance and DIST_INF for settled ones,
+ *     so finding the next node is a plain minimum over `key`.  Relaxing
+ *     never has to skip settled nodes either: a settled node is already at
+ *     least as close as the node being settled, so no edge can improve it.
+ *
+ * With that, both inner loops are branch-free passes over whole rows.  On
+ * x86-64 processors with AVX2 they are done four distances at a time:
+ * the minimum keeps a running minimum and its index per lane, and the relax
+ * step adds the row's weights to the settled node's distance and blends in
+ * the lanes that improve.  Predecessors are written one by one for the
+ * (few) lanes that change.  dense_dijkstra_scalar() runs the same loops one
+ * node at a time, and is used where AVX2 isn't available.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "dense.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define DENSE_AVX2 1
+#include <immintrin.h>
+#endif
+
+/*
+ * Alignment of the matrix and of the scratch arrays, in bytes.
+ */
+#define DENSE_ALIGN 64
+
+/*
+ * Helper function to allocate `size` bytes aligned to DENSE_ALIGN.
+ */
+static void* aligned_alloc_bytes(size_t size) {
+    void* p = NULL;
+    if (posix_memalign(&p, DENSE_ALIGN, size > 0 ? size : DENSE_ALIGN)) {
+        return NULL;
+    }
+    return p;
+}
+
+/*
+ * This function creates a dense graph with no edges.
+ *
+ * Params:
+ *   n_nodes - the number of nodes.
+ *
+ * Return:
+ *   Returns the new graph, which should be freed with dense_free(), or NULL
+ *   if there isn't enough memory for the matrix.
+ */
+struct dense_graph* dense_create(int n_nodes) {
+    assert(n_nodes >= 0);
+    int per_line = DENSE_ALIGN / sizeof(int);
+    struct dense_graph* dense = malloc(sizeof(struct dense_graph));
+    assert(dense);
+    dense->n_nodes = n_nodes;
+    dense->stride = (n_nodes + per_line - 1) / per_line * per_line;
+    size_t cells = (size_t)n_nodes * dense->stride;
+    dense->weights = aligned_alloc_bytes(cells * sizeof(int));
+    if (dense->weights == NULL) {
+        free(dense);
+        return NULL;
+    }
+    for (size_t i = 0; i < cells; i++) {
+        dense->weights[i] = DENSE_NO_EDGE;
+    }
+    return dense;
+}
+
+/*
+ * This function builds a dense graph with the same edges as a CSR graph,
+ * keeping the lightest of any parallel edges.
+ *
+ * Params:
+ *   graph - the graph to copy.  May not be NULL.
+ *
+ * Return:
+ *   Returns the new graph, which should be freed with dense_free(), or NULL
+ *   if there isn't enough memory for the matrix.
+ */
+struct dense_graph* dense_from_graph(struct graph* graph) {
+    assert(graph);
+    struct dense_graph* dense = dense_create(graph->n_nodes);
+    if (dense == NULL) {
+        return NULL;
+    }
+    for (int u = 0; u < graph->n_nodes; u++) {
+        int* row = dense->weights + (size_t)u * dense->stride;
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            if (graph->weights[e] < row[graph->targets[e]]) {
+                row[graph->targets[e]] = graph->weights[e];
+            }
+        }
+    }
+    return dense;
+}
+
+/*
+ * This function frees all memory associated with a dense graph.
+ *
+ * Params:
+ *   dense - the graph to be destroyed.  May not be NULL.
+ */
+void dense_free(struct dense_graph* dense) {
+    assert(dense);
+    free(dense->weights);
+    free(dense);
+}
+
+/*
+ * This function tells whether dense_dijkstra() can use AVX2 on this
+ * machine.
+ *
+ * Return:
+ *   Returns 1 if it can, 0 if it falls back to dense_dijkstra_scalar().
+ */
+int dense_simd_available() {
+#ifdef DENSE_AVX2
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return 0;
+#endif
+}
+
+/*
+ * Scratch state for one run.  `dist` and `key` have dense->stride entries,
+ * so whole rows can be processed without a tail loop.
+ */
+struct dense_run {
+    struct dense_graph* dense;
+    dist_t* dist;
+    dist_t* key;
+    int* prev;
+};
+
+/*
+ * Helper function to set up a run from source.
+ */
+static void run_init(struct dense_run* run, struct dense_graph* dense,
+        int source, int* prev) {
+    run->dense = dense;
+    run->dist = aligned_alloc_bytes(dense->stride * sizeof(dist_t));
+    run->key = aligned_alloc_bytes(dense->stride * sizeof(dist_t));
+    assert(run->dist && run->key);
+    run->prev = prev;
+    for (int v = 0; v < dense->stride; v++) {
+        run->dist[v] = run->key[v] = DIST_INF;
+    }
+    for (int v = 0; v < dense->n_nodes; v++) {
+        prev[v] = -1;
+    }
+    run->dist[source] = run->key[source] = 0;
+    prev[source] = source;
+}
+
+/*
+ * Helper function to hand the distances to the caller and free the
+ * scratch arrays.
+ */
+static void run_finish(struct dense_run* run, dist_t* dist) {
+    memcpy(dist, run->dist, run->dense->n_nodes * sizeof(dist_t));
+    free(run->dist);
+    free(run->key);
+}
+
+/*
+ * Helper function to return the lowest-numbered node with the smallest key,
+ * or -1 if every key is DIST_INF.
+ */
+static int argmin_scalar(struct dense_run* run) {
+    int best = -1;
+    dist_t best_key = DIST_INF;
+    for (int v = 0; v < run->dense->stride; v++) {
+        if (run->key[v] < best_key) {
+            best_key = run->key[v];
+            best = v;
+        }
+    }
+    return best;
+}
+
+/*
+ * Helper function to relax every edge out of u.
+ */
+static void relax_scalar(struct dense_run* run, int u) {
+    int* row = run->dense->weights + (size_t)u * run->dense->stride;
+    dist_t du = run->dist[u];
+    for (int v = 0; v < run->dense->stride; v++) {
+        dist_t d = du + row[v];
+        if (row[v] != DENSE_NO_EDGE && d < run->dist[v]) {
+            run->dist[v] = run->key[v] = d;
+            run->prev[v] = u;
+        }
+    }
+}
+
+#ifdef DENSE_AVX2
+
+/*
+ * AVX2 version of argmin_scalar().  Two sets of four lanes each keep the
+ * smallest key they have seen and its index, replacing them only on a
+ * strictly smaller key, so each lane keeps the lowest index among its ties;
+ * the final reduction breaks ties between lanes by index as well.
+ */
+__attribute__((target("avx2")))
+static int argmin_avx2(struct dense_run* run) {
+    const dist_t* key = run->key;
+    __m256i best0 = _mm256_set1_epi64x(DIST_INF), best1 = best0;
+    __m256i index0 = _mm256_set1_epi64x(-1), index1 = index0;
+    __m256i next0 = _mm256_set_epi64x(3, 2, 1, 0);
+    __m256i next1 = _mm256_set_epi64x(7, 6, 5, 4);
+    __m256i step = _mm256_set1_epi64x(8);
+    for (int v = 0; v < run->dense->stride; v += 8) {
+        __m256i k0 = _mm256_load_si256((const __m256i*)(key + v));
+        __m256i k1 = _mm256_load_si256((const __m256i*)(key + v + 4));
+        __m256i less0 = _mm256_cmpgt_epi64(best0, k0);
+        __m256i less1 = _mm256_cmpgt_epi64(best1, k1);
+        best0 = _mm256_blendv_epi8(best0, k0, less0);
+        best1 = _mm256_blendv_epi8(best1, k1, less1);
+        index0 = _mm256_blendv_epi8(index0, next0, less0);
+        index1 = _mm256_blendv_epi8(index1, next1, less1);
+        next0 = _mm256_add_epi64(next0, step);
+        next1 = _mm256_add_epi64(next1, step);
+    }
+
+    long long best[8], index[8];
+    _mm256_storeu_si256((__m256i*)best, best0);
+    _mm256_storeu_si256((__m256i*)(best + 4), best1);
+    _mm256_storeu_si256((__m256i*)index, index0);
+    _mm256_storeu_si256((__m256i*)(index + 4), index1);
+    int min = 0;
+    for (int i = 1; i < 8; i++) {
+        if (best[i] < best[min] ||
+                (best[i] == best[min] && index[i] < index[min])) {
+            min = i;
+        }
+    }
+    return best[min] == DIST_INF ? -1 : (int)index[min];
+}
+
+/*
+ * AVX2 version of relax_scalar().  Weights are widened four at a time to 64
+ * bits and added to u's distance; lanes that have an edge and come out
+ * strictly smaller are blended into both dist and key.
+ */
+__attribute__((target("avx2")))
+static void relax_avx2(struct dense_run* run, int u) {
+    const int* row = run->dense->weights + (size_t)u * run->dense->stride;
+    dist_t* dist = run->dist;
+    dist_t* key = run->key;
+    __m256i du = _mm256_set1_epi64x(dist[u]);
+    __m256i no_edge = _mm256_set1_epi64x(DENSE_NO_EDGE);
+    for (int v = 0; v < run->dense->stride; v += 4) {
+        __m256i w = _mm256_cvtepi32_epi64(
+            _mm_load_si128((const __m128i*)(row + v)));
+        __m256i d = _mm256_add_epi64(du, w);
+        __m256i old = _mm256_load_si256((const __m256i*)(dist + v));
+        __m256i better = _mm256_andnot_si256(_mm256_cmpeq_epi64(w, no_edge),
+            _mm256_cmpgt_epi64(old, d));
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(better));
+        if (mask == 0) {
+            continue;
+        }
+        _mm256_store_si256((__m256i*)(dist + v),
+            _mm256_blendv_epi8(old, d, better));
+        __m256i k = _mm256_load_si256((const __m256i*)(key + v));
+        _mm256_store_si256((__m256i*)(key + v),
+            _mm256_blendv_epi8(k, d, better));
+        for (; mask; mask &= mask - 1) {
+            run->prev[v + __builtin_ctz(mask)] = u;
+        }
+    }
+}
+
+#endif
+
+/*
+ * This function computes shortest paths from one node of a dense graph,
+ * using AVX2 where the processor has it.  The results are the same as those
+ * of the matrix version of Dijkstra in dijkstra.c, predecessors included.
+ *
+ * Params:
+ *   dense - the graph.  May not be NULL.
+ *   source - the node to start from.
+ *   dist - array of dense->n_nodes entries that receives the distances,
+ *     with DIST_INF for unreachable nodes.
+ *   prev - array of dense->n_nodes entries that receives the predecessors.
+ *     The source's predecessor is the source itself and unreachable nodes
+ *     get -1.
+ */
+void dense_dijkstra(struct dense_graph* dense, int source, dist_t* dist,
+        int* prev) {
+#ifdef DENSE_AVX2
+    if (dense_simd_available()) {
+        assert(dense && dist && prev);
+        assert(source >= 0 && source < dense->n_nodes);
+        struct dense_run run;
+        run_init(&run, dense, source, prev);
+        for (int u; (u = argmin_avx2(&run)) >= 0; ) {
+            run.key[u] = DIST_INF;
+            relax_avx2(&run, u);
+        }
+        run_finish(&run, dist);
+        return;
+    }
+#endif
+    dense_dijkstra_scalar(dense, source, dist, prev);
+}
+
+/*
+ * This function is dense_dijkstra() without SIMD instructions.  It takes
+ * the same parameters and gives the same results.
+ */
+void dense_dijkstra_scalar(struct dense_graph* dense, int source,
+        dist_t* dist, int* prev) {
+    assert(dense && dist && prev);
+    assert(source >= 0 && source < dense->n_nodes);
+    struct dense_run run;
+    run_init(&run, dense, source, prev);
+    for (int u; (u = argmin_scalar(&run)) >= 0; ) {
+        run.key[u] = DIST_INF;
+        relax_scalar(&run, u);
+    }
+    run_finish(&run, dist);
+}
@@ -0,0 +1,49 @@
+/*
+ * This file contains the definition of the interface for dense graphs,
+ * stored as one adjacency matrix, and the shortest-path engine for them.
+ * You can find descriptions of the functions, including their parameters
+ * and their return values, in dense.c.
+ */
+
+#ifndef __DENSE_H
+#define __DENSE_H
+
+#include "graph.h"
+#include "sssp.h"
+
+/*
+ * Weight stored in the matrix where there is no edge.
+ */
+#define DENSE_NO_EDGE INT_MAX
+
+/*
+ * Structure used to represent a dense graph.  Its fields are visible so
+ * that a matrix can be filled in directly, without building a CSR graph
+ * first.
+ *
+ * The weight of the edge u -> v is weights[u * stride + v], or
+ * DENSE_NO_EDGE.  Rows are `stride` ints apart, which is n_nodes rounded up
+ * to a whole number of 64-byte cache lines, and the matrix is 64-byte
+ * aligned, so every row starts on a cache line.  The padding at the end of
+ * each row holds DENSE_NO_EDGE.
+ */
+struct dense_graph {
+  int n_nodes;
+  int stride;
+  int* weights;
+};
+
+/*
+ * Dense graph interface function prototypes.  Refer to dense.c for
+ * documentation about each of these functions.
+ */
+struct dense_graph* dense_create(int n_nodes);
+struct dense_graph* dense_from_graph(struct graph* graph);
+void dense_free(struct dense_graph* dense);
+int dense_simd_available();
+void dense_dijkstra(struct dense_graph* dense, int source, dist_t* dist,
+  int* prev);
+void dense_dijkstra_scalar(struct dense_graph* dense, int source,
+  dist_t* dist, int* prev);
+
+#endif
@@ -7,25 +7,32 @@
  * Email: demssies@oregonstate.edu
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
+#include <unistd.h>
+
+#include "graph.h"
+#include "sssp.h"
+#include "cache.h"
+#include "server.h"
+#include "reorder.h"
+#include "dense.h"
+#include "bitset.h"
 
 #define DATA_FILE "airports.dat"
 #define START_NODE 0
 
-int main(int argc, char const *argv[]) {
-	/*
-	 * open file and read the first two int: num of nodes, num of edges
-	 */
-	int n_nodes, n_edges;
-	FILE* file = fopen(DATA_FILE, "r");
-	if (file == NULL) {
-        perror("Error opening data file");
-        return EXIT_FAILURE;
-    }
-
-	fscanf(file, " %d %d ", &n_nodes, &n_edges);
+/*
+ * Runs the original O(n^2) version of Dijkstra's algorithm on an adjacency
+ * matrix built from the graph, filling in distances and previous.
+ */
+static void matrix_dijkstra(struct graph* csr, int start, dist_t* distances,
+        int* previous) {
+	int n_nodes = csr->n_nodes;
 	
        // initialize the adjacency matrix
     int **graph = malloc(n_nodes * sizeof(int *));
@@ -36,64 +43,341 @@ int main(int argc, char const *argv[]) {
         }
     }
     
-    // read edges and fill the adjacency matrix
-    int src, dest, cost;
-    for (int i = 0; i < n_edges; i++) {
-        fscanf(file, "%d %d %d", &src, &dest, &cost);
-        graph[src][dest] = cost;
+    // fill the adjacency matrix from the loaded edges, keeping the cheapest
+    // of any parallel edges
+    for (int src = 0; src < n_nodes; src++) {
+        for (int e = csr->offsets[src]; e < csr->offsets[src + 1]; e++) {
+            int dest = csr->targets[e];
+            if (csr->weights[e] < graph[src][dest]) {
+                graph[src][dest] = csr->weights[e];
+            }
+        }
     }
-    fclose(file);
     
-    // arrays for Dijkstra's algorithm
-    int *distances = malloc(n_nodes * sizeof(int));
-    int *previous = malloc(n_nodes * sizeof(int));
-    int *visited = calloc(n_nodes, sizeof(int));
+    // one visited bit per node for Dijkstra's algorithm
+    struct bitset *visited = bitset_create(n_nodes);
 
-    // initialize distances to infinity, and distance to START_NODE to 0
+    // initialize distances to infinity, and distance to start to 0
     for (int i = 0; i < n_nodes; i++) {
-        distances[i] = INT_MAX;
+        distances[i] = DIST_INF;
         previous[i] = -1; // initialize previous node as undefined
     }
-    distances[START_NODE] = 0;
-    previous[START_NODE] = START_NODE; // start node's previous is itself
+    distances[start] = 0;
+    previous[start] = start; // start node's previous is itself
 
     for (int i = 0; i < n_nodes; i++) {
         // find the unvisited node with the smallest distance
         int u = -1;
         for (int j = 0; j < n_nodes; j++) {
-            if (!visited[j] && (u == -1 || distances[j] < distances[u])) {
+            if (!bitset_test(visited, j) &&
+                    (u == -1 || distances[j] < distances[u])) {
                 u = j;
             }
         }
 
-        visited[u] = 1; // Mark the node as visited
+        // the remaining nodes are all unreachable
+        if (distances[u] == DIST_INF) {
+            break;
+        }
+
+        bitset_set(visited, u); // Mark the node as visited
 
         // Update the distance for each neighbor v of u
         for (int v = 0; v < n_nodes; v++) {
-            if (graph[u][v] != INT_MAX && distances[u] + graph[u][v] < distances[v]) {
-                distances[v] = distances[u] + graph[u][v];
+            if (graph[u][v] == INT_MAX) {
+                continue;
+            }
+            dist_t d = dist_add(distances[u], graph[u][v]);
+            if (d < distances[v]) {
+                distances[v] = d;
                 previous[v] = u; // Update the previous node
             }
         }
     }
 
-    // Print out the least-cost paths and their previous nodes
+    // Free allocated memory
     for (int i = 0; i < n_nodes; i++) {
-        if (distances[i] == INT_MAX) {
-            printf("Cost to node %d: unreachable -- Previous node: N/A\n", i);
+        free(graph[i]);
+    }
+    free(graph);
+    bitset_free(visited);
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [-e matrix|dense|heap|delta] [-t threads] "
+        "[-d delta] [-s source] [-r bfs|rcm] [-p] [file]\n", prog);
+    fprintf(stderr, "       %s -b all|<s1,s2,...>|@<file> -o <matrix.bin> "
+        "[-t threads] [file]\n", prog);
+    fprintf(stderr, "       %s -S [-u socket] [-c cached_trees] [file]\n",
+        prog);
+}
+
+/*
+ * Parses a list of sources for batch mode: either comma-separated node
+ * numbers or, after an `@`, the name of a file of whitespace-separated node
+ * numbers.  Returns the number of sources, or -1 if the list is malformed.
+ */
+static int parse_sources(const char* arg, int** sources) {
+    int n = 0, capacity = 16, source;
+    *sources = malloc(capacity * sizeof(int));
+    FILE* file = NULL;
+    if (arg[0] == '@') {
+        file = fopen(arg + 1, "r");
+        if (file == NULL) {
+            perror(arg + 1);
+            return -1;
+        }
+    }
+
+    for (;;) {
+        int read;
+        if (file) {
+            read = fscanf(file, "%d", &source);
+            if (read == EOF) {
+                break;
+            }
         } else {
-            printf("Cost to node %d: %d -- Previous node: %d\n", i, distances[i], previous[i]);
+            char* end;
+            source = (int)strtol(arg, &end, 10);
+            read = end != arg && (*end == ',' || *end == '\0');
+            arg = end + (*end == ',');
+        }
+        if (read != 1) {
+            n = -1;
+            break;
+        }
+        if (n == capacity) {
+            capacity *= 2;
+            *sources = realloc(*sources, capacity * sizeof(int));
         }
+        (*sources)[n++] = source;
+        if (!file && *arg == '\0') {
+            break;
+        }
+    }
+    if (file) {
+        fclose(file);
     }
+    return n;
+}
 
-    // Free allocated memory
+int main(int argc, char *argv[]) {
+    const char* engine = "matrix";
+    const char* batch = NULL;
+    const char* output = NULL;
+    const char* socket_path = NULL;
+    const char* reorder = NULL;
+    int serve = 0, cached_trees = 64, paths = 0;
+    int n_threads = 1, delta = 0, start = START_NODE, opt;
+    while ((opt = getopt(argc, argv, "e:t:d:s:b:o:Su:c:pr:")) != -1) {
+        switch (opt) {
+        case 'e':
+            engine = optarg;
+            break;
+        case 't':
+            n_threads = atoi(optarg);
+            break;
+        case 'd':
+            delta = atoi(optarg);
+            break;
+        case 's':
+            start = atoi(optarg);
+            break;
+        case 'b':
+            batch = optarg;
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 'S':
+            serve = 1;
+            break;
+        case 'p':
+            paths = 1;
+            break;
+        case 'r':
+            reorder = optarg;
+            break;
+        case 'u':
+            socket_path = optarg;
+            break;
+        case 'c':
+            cached_trees = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((strcmp(engine, "matrix") && strcmp(engine, "dense") &&
+            strcmp(engine, "heap") && strcmp(engine, "delta")) ||
+            (batch != NULL) != (output != NULL) ||
+            (socket_path != NULL && !serve) || cached_trees < 0 ||
+            (reorder && ((strcmp(reorder, "bfs") && strcmp(reorder, "rcm")) ||
+            batch || serve))) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+	/*
+	 * load the graph (by default from DATA_FILE, either as text or as a binary
+	 * graph file made by graph_convert)
+	 */
+	const char* path = optind < argc ? argv[optind] : DATA_FILE;
+	struct graph* csr = graph_open(path, 0);
+	if (csr == NULL) {
+        return EXIT_FAILURE;
+    }
+	int n_nodes = csr->n_nodes;
+
+    /*
+     * Every engine assumes non-negative weights, so refuse anything else
+     * rather than print distances that depend on the engine.
+     */
+    for (int u = 0; u < n_nodes; u++) {
+        for (int e = csr->offsets[u]; e < csr->offsets[u + 1]; e++) {
+            if (csr->weights[e] < 0) {
+                fprintf(stderr, "%s: edge %d -> %d has negative weight %d\n",
+                    path, u, csr->targets[e], csr->weights[e]);
+                graph_free(csr);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    /*
+     * In server mode, answer queries on standard input or a socket until
+     * told to stop, keeping recently used source trees.
+     */
+    if (serve) {
+        struct tree_cache* cache = tree_cache_create(csr, cached_trees);
+        int result = 0;
+        if (socket_path) {
+            result = server_run_socket(cache, socket_path);
+        } else {
+            server_handle(cache, stdin, stdout);
+        }
+        tree_cache_free(cache);
+        graph_free(csr);
+        return result == 0 ? 0 : EXIT_FAILURE;
+    }
+
+    /*
+     * In batch mode, write the distances from every requested source to the
+     * output file instead of printing one tree.
+     */
+    if (batch) {
+        int* sources = NULL;
+        int n_sources = 0;
+        if (strcmp(batch, "all")) {
+            n_sources = parse_sources(batch, &sources);
+            if (n_sources < 0) {
+                fprintf(stderr, "%s: malformed source list\n", batch);
+                free(sources);
+                graph_free(csr);
+                return EXIT_FAILURE;
+            }
+            for (int i = 0; i < n_sources; i++) {
+                if (sources[i] < 0 || sources[i] >= n_nodes) {
+                    fprintf(stderr, "%s: no node %d\n", path, sources[i]);
+                    free(sources);
+                    graph_free(csr);
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+        int result = sssp_batch(csr, sources, n_sources, n_threads, output);
+        free(sources);
+        graph_free(csr);
+        return result == 0 ? 0 : EXIT_FAILURE;
+    }
+
+    if (start < 0 || start >= n_nodes) {
+        fprintf(stderr, "%s: no node %d\n", path, start);
+        graph_free(csr);
+        return EXIT_FAILURE;
+    }
+
+    /*
+     * With -r, renumber the nodes so neighbours sit close together in
+     * memory, and run from the source's new number.  Ties between equally
+     * short paths may then be broken differently.
+     */
+    int *order = NULL;
+    int source = start;
+    if (reorder) {
+        order = strcmp(reorder, "bfs") ? reorder_rcm(csr) : reorder_bfs(csr);
+        struct graph* permuted = graph_permute(csr, order);
+        graph_free(csr);
+        csr = permuted;
+        for (int i = 0; i < n_nodes; i++) {
+            if (order[i] == start) {
+                source = i;
+            }
+        }
+    }
+
+    dist_t *distances = malloc(n_nodes * sizeof(dist_t));
+    int *previous = malloc(n_nodes * sizeof(int));
+    if (!strcmp(engine, "matrix")) {
+        matrix_dijkstra(csr, source, distances, previous);
+    } else if (!strcmp(engine, "dense")) {
+        struct dense_graph* dense = dense_from_graph(csr);
+        if (dense == NULL) {
+            fprintf(stderr, "%s: not enough memory for a %d x %d matrix\n",
+                path, n_nodes, n_nodes);
+            graph_free(csr);
+            free(distances);
+            free(previous);
+            free(order);
+            return EXIT_FAILURE;
+        }
+        dense_dijkstra(dense, source, distances, previous);
+        dense_free(dense);
+    } else if (!strcmp(engine, "heap")) {
+        sssp_dijkstra(csr, source, distances, previous);
+    } else {
+        sssp_delta_stepping(csr, source, delta, n_threads, distances, previous);
+    }
+    graph_free(csr);
+
+    // map the results back to the original node numbers
+    if (order) {
+        dist_t *d = malloc(n_nodes * sizeof(dist_t));
+        int *p = malloc(n_nodes * sizeof(int));
+        for (int i = 0; i < n_nodes; i++) {
+            d[order[i]] = distances[i];
+            p[order[i]] = previous[i] < 0 ? -1 : order[previous[i]];
+        }
+        free(distances);
+        free(previous);
+        free(order);
+        distances = d;
+        previous = p;
+    }
+
+    // Print out the least-cost paths and their previous nodes, or with -p
+    // the whole path to each node
+    int *nodes = paths ? malloc(n_nodes * sizeof(int)) : NULL;
     for (int i = 0; i < n_nodes; i++) {
-        free(graph[i]);
+        if (distances[i] == DIST_INF) {
+            printf("Cost to node %d: unreachable -- Previous node: N/A\n", i);
+        } else if (paths) {
+            int length = sssp_path(previous, start, i, nodes, n_nodes);
+            printf("Cost to node %d: %lld -- Path:", i,
+                (long long)distances[i]);
+            for (int j = 0; j < length; j++) {
+                printf(" %d", nodes[j]);
+            }
+            printf("\n");
+        } else {
+            printf("Cost to node %d: %lld -- Previous node: %d\n", i, (long long)distances[i], previous[i]);
+        }
     }
-    free(graph);
+
+    free(nodes);
     free(distances);
     free(previous);
-    free(visited);
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,526 @@
+/*
+ * This file contains a directed graph whose edges can be inserted, deleted
+ * and reweighted, and shortest-path trees on it that are brought up to date
+ * after a batch of changes by repairing only the part that changed.  All
+ * edge weights are assumed to be non-negative.
+ *
+ * Each node keeps growable lists of its outgoing and incoming edges, with at
+ * most one edge from any node to any other.  Every change is appended to a
+ * log, and each tree remembers how much of the log it has seen, so several
+ * trees can share a graph and be repaired at different times.
+ *
+ * Repair follows Ramalingam and Reps.  Before looking at any weights, the
+ * nodes whose tree path used an edge that got heavier or was deleted are
+ * found, together with everything below them in the tree; their distances
+ * are thrown away.  Every remaining distance is then the length of a real
+ * path in the new graph, so it can only be too high, and the only edges that
+ * can show it are the changed ones and those into the nodes that were thrown
+ * away.  Dijkstra's algorithm is started from the targets of those edges and
+ * runs until nothing improves, which leaves the distances exact.  The work
+ * is proportional to the part of the tree that moved, not to the graph.
+ *
+ * Unlike the original algorithm, a node below a broken edge is recomputed
+ * even if it has another shortest path that avoids the edge.  This only
+ * matters when there are ties, and keeps the first step to a single walk
+ * over the tree.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "dynamic.h"
+#include "pq.h"
+
+/*
+ * A growable list of edges, from one node to `targets` (or, for incoming
+ * edges, from `targets` to the node).
+ */
+struct adjacency {
+    int* targets;
+    int* weights;
+    int size;
+    int capacity;
+};
+
+/*
+ * An entry in the change log: the edge from `source` to `target` was
+ * inserted, deleted or given a new weight.
+ */
+struct change {
+    int source;
+    int target;
+};
+
+struct dyn_graph {
+    int n_nodes;
+    struct adjacency* out;
+    struct adjacency* in;
+    struct change* changes;
+    int n_changes;
+    int changes_capacity;
+};
+
+struct dyn_tree {
+    struct dyn_graph* graph;
+    int source;
+    dist_t* dist;
+    int* prev;
+    int applied;
+    char* affected;
+    int* list;
+    struct pq* pq;
+};
+
+/*
+ * Helper function to make room for `capacity` edges in an adjacency list.
+ */
+static void adjacency_reserve(struct adjacency* list, int capacity) {
+    if (capacity <= list->capacity) {
+        return;
+    }
+    if (capacity < 2 * list->capacity) {
+        capacity = 2 * list->capacity;
+    }
+    list->targets = realloc(list->targets, capacity * sizeof(int));
+    list->weights = realloc(list->weights, capacity * sizeof(int));
+    assert(list->targets && list->weights);
+    list->capacity = capacity;
+}
+
+/*
+ * Helper function to find the index of `target` in an adjacency list, or -1
+ * if it isn't there.
+ */
+static int adjacency_find(struct adjacency* list, int target) {
+    for (int i = 0; i < list->size; i++) {
+        if (list->targets[i] == target) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Helper function to set the weight of the edge to `target` in an adjacency
+ * list, adding the edge if needed.
+ */
+static void adjacency_set(struct adjacency* list, int target, int weight) {
+    int i = adjacency_find(list, target);
+    if (i < 0) {
+        adjacency_reserve(list, list->size + 1);
+        i = list->size++;
+        list->targets[i] = target;
+    }
+    list->weights[i] = weight;
+}
+
+/*
+ * Helper function to remove the edge to `target` from an adjacency list,
+ * which must contain it.  The last edge takes its place.
+ */
+static void adjacency_remove(struct adjacency* list, int target) {
+    int i = adjacency_find(list, target);
+    assert(i >= 0);
+    list->size--;
+    list->targets[i] = list->targets[list->size];
+    list->weights[i] = list->weights[list->size];
+}
+
+/*
+ * This function creates a dynamic graph with the same edges as a CSR graph.
+ * Where the CSR graph has several edges from one node to another, only the
+ * lightest is kept, which doesn't change any distances.
+ *
+ * Params:
+ *   graph - the graph to copy.  May not be NULL.
+ *
+ * Return:
+ *   Returns the new graph, which should be freed with dyn_graph_free().
+ */
+struct dyn_graph* dyn_graph_create(struct graph* graph) {
+    assert(graph);
+    int n = graph->n_nodes;
+    struct dyn_graph* dyn = malloc(sizeof(struct dyn_graph));
+    assert(dyn);
+    dyn->n_nodes = n;
+    dyn->out = calloc(n, sizeof(struct adjacency));
+    dyn->in = calloc(n, sizeof(struct adjacency));
+    assert(dyn->out && dyn->in);
+    dyn->changes = NULL;
+    dyn->n_changes = 0;
+    dyn->changes_capacity = 0;
+
+    /*
+     * Edges out of a node are sorted by target and then by weight, so the
+     * first of a run of parallel edges is the lightest.
+     */
+    int* in_degree = calloc(n, sizeof(int));
+    assert(in_degree);
+    for (int u = 0; u < n; u++) {
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            if (e == graph->offsets[u] ||
+                    graph->targets[e] != graph->targets[e - 1]) {
+                in_degree[graph->targets[e]]++;
+            }
+        }
+    }
+    for (int v = 0; v < n; v++) {
+        adjacency_reserve(&dyn->in[v], in_degree[v]);
+    }
+    free(in_degree);
+
+    for (int u = 0; u < n; u++) {
+        struct adjacency* out = &dyn->out[u];
+        adjacency_reserve(out, graph->offsets[u + 1] - graph->offsets[u]);
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            int v = graph->targets[e];
+            if (e > graph->offsets[u] && v == graph->targets[e - 1]) {
+                continue;
+            }
+            out->targets[out->size] = v;
+            out->weights[out->size++] = graph->weights[e];
+            struct adjacency* in = &dyn->in[v];
+            in->targets[in->size] = u;
+            in->weights[in->size++] = graph->weights[e];
+        }
+    }
+    return dyn;
+}
+
+/*
+ * This function frees all memory associated with a dynamic graph.  Trees on
+ * it must be freed first.
+ *
+ * Params:
+ *   graph - the graph to be destroyed.  May not be NULL.
+ */
+void dyn_graph_free(struct dyn_graph* graph) {
+    assert(graph);
+    for (int v = 0; v < graph->n_nodes; v++) {
+        free(graph->out[v].targets);
+        free(graph->out[v].weights);
+        free(graph->in[v].targets);
+        free(graph->in[v].weights);
+    }
+    free(graph->out);
+    free(graph->in);
+    free(graph->changes);
+    free(graph);
+}
+
+/*
+ * This function returns the number of nodes in a dynamic graph.
+ */
+int dyn_graph_num_nodes(struct dyn_graph* graph) {
+    assert(graph);
+    return graph->n_nodes;
+}
+
+/*
+ * This function looks up the weight of an edge.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.
+ *   u, v - the ends of the edge.
+ *
+ * Return:
+ *   Returns the weight of the edge from u to v, or -1 if there is none.
+ */
+int dyn_graph_weight(struct dyn_graph* graph, int u, int v) {
+    assert(graph);
+    assert(u >= 0 && u < graph->n_nodes && v >= 0 && v < graph->n_nodes);
+    struct adjacency* out = &graph->out[u];
+    int i = adjacency_find(out, v);
+    return i < 0 ? -1 : out->weights[i];
+}
+
+/*
+ * Helper function to append a change to the log.
+ */
+static void log_change(struct dyn_graph* graph, int u, int v) {
+    if (graph->n_changes == graph->changes_capacity) {
+        graph->changes_capacity = graph->changes_capacity ?
+            2 * graph->changes_capacity : 64;
+        graph->changes = realloc(graph->changes,
+            graph->changes_capacity * sizeof(struct change));
+        assert(graph->changes);
+    }
+    graph->changes[graph->n_changes].source = u;
+    graph->changes[graph->n_changes++].target = v;
+}
+
+/*
+ * This function inserts an edge or changes its weight.  Trees on the graph
+ * see the change the next time they are repaired.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.
+ *   u, v - the ends of the edge.
+ *   weight - the new weight of the edge from u to v.  Must not be negative.
+ */
+void dyn_graph_set_edge(struct dyn_graph* graph, int u, int v, int weight) {
+    assert(weight >= 0);
+    if (dyn_graph_weight(graph, u, v) == weight) {
+        return;
+    }
+    adjacency_set(&graph->out[u], v, weight);
+    adjacency_set(&graph->in[v], u, weight);
+    log_change(graph, u, v);
+}
+
+/*
+ * This function deletes an edge.  Trees on the graph see the change the
+ * next time they are repaired.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.
+ *   u, v - the ends of the edge.
+ *
+ * Return:
+ *   Returns 1 if the edge from u to v was deleted, or 0 if there was none.
+ */
+int dyn_graph_remove_edge(struct dyn_graph* graph, int u, int v) {
+    if (dyn_graph_weight(graph, u, v) < 0) {
+        return 0;
+    }
+    adjacency_remove(&graph->out[u], v);
+    adjacency_remove(&graph->in[v], u);
+    log_change(graph, u, v);
+    return 1;
+}
+
+/*
+ * This function makes a CSR graph with the current edges of a dynamic
+ * graph, for use with the static algorithms.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.
+ *
+ * Return:
+ *   Returns the new graph, which should be freed with graph_free().
+ */
+struct graph* dyn_graph_snapshot(struct dyn_graph* graph) {
+    assert(graph);
+    int n_edges = 0;
+    for (int u = 0; u < graph->n_nodes; u++) {
+        n_edges += graph->out[u].size;
+    }
+    int* sources = malloc(n_edges * sizeof(int));
+    int* targets = malloc(n_edges * sizeof(int));
+    int* weights = malloc(n_edges * sizeof(int));
+    assert(n_edges == 0 || (sources && targets && weights));
+    int e = 0;
+    for (int u = 0; u < graph->n_nodes; u++) {
+        struct adjacency* out = &graph->out[u];
+        for (int i = 0; i < out->size; i++, e++) {
+            sources[e] = u;
+            targets[e] = out->targets[i];
+            weights[e] = out->weights[i];
+        }
+    }
+    struct graph* csr = graph_from_edges(graph->n_nodes, n_edges, sources,
+        targets, weights);
+    free(sources);
+    free(targets);
+    free(weights);
+    return csr;
+}
+
+/*
+ * Helper function to run Dijkstra's algorithm from the nodes in the tree's
+ * queue, lowering distances until none can be lowered any more.  Returns
+ * the number of nodes settled.
+ */
+static int propagate(struct dyn_tree* tree) {
+    struct adjacency* out = tree->graph->out;
+    dist_t* dist = tree->dist;
+    int settled = 0;
+    while (!pq_isempty(tree->pq)) {
+        dist_t du = pq_first_priority64(tree->pq);
+        int u = (int)(long)pq_remove_first(tree->pq);
+        if (du > dist[u]) {
+            continue;
+        }
+        settled++;
+        for (int i = 0; i < out[u].size; i++) {
+            int v = out[u].targets[i];
+            dist_t d = du + out[u].weights[i];
+            if (d < dist[v]) {
+                dist[v] = d;
+                tree->prev[v] = u;
+                pq_insert64(tree->pq, (void*)(long)v, d);
+            }
+        }
+    }
+    return settled;
+}
+
+/*
+ * This function computes the shortest-path tree from a node of a dynamic
+ * graph.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.  It must outlive the tree.
+ *   source - the node to start from.
+ *
+ * Return:
+ *   Returns the new tree, which should be freed with dyn_tree_free().
+ */
+struct dyn_tree* dyn_tree_create(struct dyn_graph* graph, int source) {
+    assert(graph);
+    assert(source >= 0 && source < graph->n_nodes);
+    int n = graph->n_nodes;
+    struct dyn_tree* tree = malloc(sizeof(struct dyn_tree));
+    assert(tree);
+    tree->graph = graph;
+    tree->source = source;
+    tree->dist = malloc(n * sizeof(dist_t));
+    tree->prev = malloc(n * sizeof(int));
+    tree->affected = calloc(n, sizeof(char));
+    tree->list = malloc(n * sizeof(int));
+    assert(tree->dist && tree->prev && tree->affected && tree->list);
+    tree->pq = pq_create64(0);
+    dyn_tree_recompute(tree);
+    return tree;
+}
+
+/*
+ * This function frees all memory associated with a tree.
+ *
+ * Params:
+ *   tree - the tree to be destroyed.  May not be NULL.
+ */
+void dyn_tree_free(struct dyn_tree* tree) {
+    assert(tree);
+    free(tree->dist);
+    free(tree->prev);
+    free(tree->affected);
+    free(tree->list);
+    pq_free(tree->pq);
+    free(tree);
+}
+
+/*
+ * These functions return a tree's distances (DIST_INF for unreachable
+ * nodes) and predecessors (-1 for the source and unreachable nodes).  The
+ * arrays are updated in place by dyn_tree_repair() and must not be
+ * modified.
+ */
+dist_t* dyn_tree_dist(struct dyn_tree* tree) {
+    assert(tree);
+    return tree->dist;
+}
+
+int* dyn_tree_prev(struct dyn_tree* tree) {
+    assert(tree);
+    return tree->prev;
+}
+
+/*
+ * This function computes a tree again from scratch, taking in every change
+ * made to the graph so far.
+ *
+ * Params:
+ *   tree - the tree.  May not be NULL.
+ */
+void dyn_tree_recompute(struct dyn_tree* tree) {
+    assert(tree);
+    for (int v = 0; v < tree->graph->n_nodes; v++) {
+        tree->dist[v] = DIST_INF;
+        tree->prev[v] = -1;
+    }
+    tree->dist[tree->source] = 0;
+    tree->applied = tree->graph->n_changes;
+    pq_insert64(tree->pq, (void*)(long)tree->source, 0);
+    propagate(tree);
+}
+
+/*
+ * This function brings a tree up to date with the changes made to its graph
+ * since it was last computed or repaired.
+ *
+ * Params:
+ *   tree - the tree.  May not be NULL.
+ *
+ * Return:
+ *   Returns the number of nodes whose distances had to be recomputed.
+ */
+int dyn_tree_repair(struct dyn_tree* tree) {
+    assert(tree);
+    struct dyn_graph* graph = tree->graph;
+    dist_t* dist = tree->dist;
+    int* prev = tree->prev;
+    struct change* changes = graph->changes + tree->applied;
+    int n_changes = graph->n_changes - tree->applied;
+    tree->applied = graph->n_changes;
+
+    /*
+     * Find the nodes whose tree edge got heavier or was deleted, and then
+     * everything below them.  A tree edge into a node that isn't one of these
+     * is still in the graph, so walking the edges out of each node found
+     * reaches all its children.
+     */
+    int n_affected = 0;
+    for (int i = 0; i < n_changes; i++) {
+        int u = changes[i].source, v = changes[i].target;
+        if (prev[v] != u || tree->affected[v]) {
+            continue;
+        }
+        int w = dyn_graph_weight(graph, u, v);
+        if (w < 0 || dist[u] + w > dist[v]) {
+            tree->affected[v] = 1;
+            tree->list[n_affected++] = v;
+        }
+    }
+    for (int i = 0; i < n_affected; i++) {
+        struct adjacency* out = &graph->out[tree->list[i]];
+        for (int j = 0; j < out->size; j++) {
+            int v = out->targets[j];
+            if (prev[v] == tree->list[i] && !tree->affected[v]) {
+                tree->affected[v] = 1;
+                tree->list[n_affected++] = v;
+            }
+        }
+    }
+    for (int i = 0; i < n_affected; i++) {
+        dist[tree->list[i]] = DIST_INF;
+        prev[tree->list[i]] = -1;
+    }
+
+    /*
+     * Give each of those nodes its best distance through an edge from the
+     * rest of the tree, and lower the targets of edges that got lighter or
+     * were inserted.
+     */
+    for (int i = 0; i < n_affected; i++) {
+        int v = tree->list[i];
+        struct adjacency* in = &graph->in[v];
+        for (int j = 0; j < in->size; j++) {
+            int u = in->targets[j];
+            if (!tree->affected[u] && dist[u] != DIST_INF &&
+                    dist[u] + in->weights[j] < dist[v]) {
+                dist[v] = dist[u] + in->weights[j];
+                prev[v] = u;
+            }
+        }
+        if (dist[v] != DIST_INF) {
+            pq_insert64(tree->pq, (void*)(long)v, dist[v]);
+        }
+    }
+    for (int i = 0; i < n_affected; i++) {
+        tree->affected[tree->list[i]] = 0;
+    }
+    for (int i = 0; i < n_changes; i++) {
+        int u = changes[i].source, v = changes[i].target;
+        int w = dyn_graph_weight(graph, u, v);
+        if (w >= 0 && dist[u] != DIST_INF && dist[u] + w < dist[v]) {
+            dist[v] = dist[u] + w;
+            prev[v] = u;
+            pq_insert64(tree->pq, (void*)(long)v, dist[v]);
+        }
+    }
+
+    return propagate(tree);
+}
@@ -0,0 +1,40 @@
+/*
+ * This file contains the definition of the interface for a graph whose edges
+ * can change, and for shortest-path trees that are repaired after changes
+ * instead of being recomputed.  You can find descriptions of the functions,
+ * including their parameters and their return values, in dynamic.c.
+ */
+
+#ifndef __DYNAMIC_H
+#define __DYNAMIC_H
+
+#include "graph.h"
+#include "sssp.h"
+
+/*
+ * Structures used to represent a dynamic graph and a shortest-path tree in
+ * one.
+ */
+struct dyn_graph;
+struct dyn_tree;
+
+/*
+ * Dynamic graph interface function prototypes.  Refer to dynamic.c for
+ * documentation about each of these functions.
+ */
+struct dyn_graph* dyn_graph_create(struct graph* graph);
+void dyn_graph_free(struct dyn_graph* graph);
+int dyn_graph_num_nodes(struct dyn_graph* graph);
+int dyn_graph_weight(struct dyn_graph* graph, int u, int v);
+void dyn_graph_set_edge(struct dyn_graph* graph, int u, int v, int weight);
+int dyn_graph_remove_edge(struct dyn_graph* graph, int u, int v);
+struct graph* dyn_graph_snapshot(struct dyn_graph* graph);
+
+struct dyn_tree* dyn_tree_create(struct dyn_graph* graph, int source);
+void dyn_tree_free(struct dyn_tree* tree);
+dist_t* dyn_tree_dist(struct dyn_tree* tree);
+int* dyn_tree_prev(struct dyn_tree* tree);
+int dyn_tree_repair(struct dyn_tree* tree);
+void dyn_tree_recompute(struct dyn_tree* tree);
+
+#endif
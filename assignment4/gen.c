@@ -0,0 +1,308 @@
+/*
+ * This file contains generators for random graphs with the shapes that
+ * shortest-path algorithms are usually measured on.  Every generator takes a
+ * seed and produces the same graph for the same seed on every machine.
+ *
+ * The generators pick their own weights, which suit the shape they model.
+ * gen_reweight() replaces them with weights from another distribution, so
+ * the effect of the weights can be measured separately from the shape.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+
+#include "gen.h"
+
+#define PI 3.14159265358979323846
+
+/*
+ * Helper function to return the next number from a SplitMix64 generator,
+ * which is small, fast and has no bad seeds.
+ */
+static unsigned long long next_random(unsigned long long* state) {
+    unsigned long long z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/*
+ * Helper function to return a random number in [0, 1).
+ */
+static double next_double(unsigned long long* state) {
+    return (next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*
+ * A growable list of edges.
+ */
+struct edge_list {
+    int* sources;
+    int* targets;
+    int* weights;
+    int size;
+    int capacity;
+};
+
+static void edge_list_add(struct edge_list* list, int u, int v, int w) {
+    if (list->size == list->capacity) {
+        list->capacity = list->capacity ? 2 * list->capacity : 1024;
+        list->sources = realloc(list->sources, list->capacity * sizeof(int));
+        list->targets = realloc(list->targets, list->capacity * sizeof(int));
+        list->weights = realloc(list->weights, list->capacity * sizeof(int));
+        assert(list->sources && list->targets && list->weights);
+    }
+    list->sources[list->size] = u;
+    list->targets[list->size] = v;
+    list->weights[list->size++] = w;
+}
+
+/*
+ * Helper function to build a graph from an edge list and free the list.
+ */
+static struct graph* edge_list_finish(struct edge_list* list, int n_nodes) {
+    struct graph* graph = graph_from_edges(n_nodes, list->size, list->sources,
+        list->targets, list->weights);
+    free(list->sources);
+    free(list->targets);
+    free(list->weights);
+    return graph;
+}
+
+/*
+ * This function generates a grid graph, a rough model of a city street
+ * network.  Node r * cols + c is at row r and column c, and is joined to the
+ * nodes above, below, left and right of it by one edge each way.  Each edge
+ * gets its own random weight, so the two directions of a street can differ.
+ *
+ * Params:
+ *   rows, cols - the size of the grid.  Both must be positive.
+ *   max_weight - weights are uniformly random in [1, max_weight].
+ *   seed - the random seed.
+ *
+ * Return:
+ *   Returns the new graph, which should be freed with graph_free().
+ */
+struct graph* gen_grid(int rows, int cols, int max_weight,
+        unsigned long long seed) {
+    assert(rows > 0 && cols > 0 && max_weight > 0);
+    struct edge_list list = {NULL, NULL, NULL, 0, 0};
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            int u = r * cols + c;
+            int neighbors[4] = {
+                c > 0 ? u - 1 : -1, c < cols - 1 ? u + 1 : -1,
+                r > 0 ? u - cols : -1, r < rows - 1 ? u + cols : -1
+            };
+            for (int i = 0; i < 4; i++) {
+                if (neighbors[i] >= 0) {
+                    edge_list_add(&list, u, neighbors[i],
+                        1 + next_random(&seed) % max_weight);
+                }
+            }
+        }
+    }
+    return edge_list_finish(&list, rows * cols);
+}
+
+/*
+ * This function generates a random geometric graph, a rough model of a road
+ * network between towns.  Nodes are scattered uniformly over the unit
+ * square, and every two nodes closer than a radius r are joined by an edge
+ * each way, weighted by their distance: 1 + 1000 * distance / r, so weights
+ * are in [1, 1001].  The radius is chosen so that nodes have `degree`
+ * neighbors on average.
+ *
+ * Nodes are sorted into square cells of side r, so each node only has to be
+ * compared with the nodes in its own cell and the 8 around it.
+ *
+ * Params:
+ *   n_nodes - the number of nodes.  Must be positive.
+ *   degree - the average number of neighbors.
+ *   seed - the random seed.
+ *
+ * Return:
+ *   Returns the new graph, which should be freed with graph_free().
+ */
+struct graph* gen_geometric(int n_nodes, double degree,
+        unsigned long long seed) {
+    assert(n_nodes > 0 && degree > 0);
+    double r = sqrt(degree / (PI * n_nodes));
+    int cells = (int)(1 / r);
+    if (cells < 1) {
+        cells = 1;
+    }
+    double* x = malloc(n_nodes * sizeof(double));
+    double* y = malloc(n_nodes * sizeof(double));
+    int* cell_start = calloc((long)cells * cells + 1, sizeof(int));
+    int* order = malloc(n_nodes * sizeof(int));
+    assert(x && y && cell_start && order);
+
+    /*
+     * Place the nodes and sort them by cell with a counting sort.
+     */
+    int* cell = malloc(n_nodes * sizeof(int));
+    assert(cell);
+    for (int v = 0; v < n_nodes; v++) {
+        x[v] = next_double(&seed);
+        y[v] = next_double(&seed);
+        int cx = (int)(x[v] * cells), cy = (int)(y[v] * cells);
+        cell[v] = cy * cells + cx;
+        cell_start[cell[v] + 1]++;
+    }
+    for (long c = 0; c < (long)cells * cells; c++) {
+        cell_start[c + 1] += cell_start[c];
+    }
+    int* cursor = malloc((long)cells * cells * sizeof(int));
+    assert(cursor);
+    for (long c = 0; c < (long)cells * cells; c++) {
+        cursor[c] = cell_start[c];
+    }
+    for (int v = 0; v < n_nodes; v++) {
+        order[cursor[cell[v]]++] = v;
+    }
+    free(cursor);
+
+    struct edge_list list = {NULL, NULL, NULL, 0, 0};
+    for (int u = 0; u < n_nodes; u++) {
+        int cx = cell[u] % cells, cy = cell[u] / cells;
+        for (int ny = cy - 1; ny <= cy + 1; ny++) {
+            for (int nx = cx - 1; nx <= cx + 1; nx++) {
+                if (nx < 0 || ny < 0 || nx >= cells || ny >= cells) {
+                    continue;
+                }
+                int c = ny * cells + nx;
+                for (int i = cell_start[c]; i < cell_start[c + 1]; i++) {
+                    int v = order[i];
+                    double dx = x[u] - x[v], dy = y[u] - y[v];
+                    double d = sqrt(dx * dx + dy * dy);
+                    if (v != u && d < r) {
+                        edge_list_add(&list, u, v, 1 + (int)(1000 * d / r));
+                    }
+                }
+            }
+        }
+    }
+
+    free(x);
+    free(y);
+    free(cell);
+    free(cell_start);
+    free(order);
+    return edge_list_finish(&list, n_nodes);
+}
+
+/*
+ * This function generates a uniformly random sparse graph: each of its edges
+ * joins a random node to a random node, so there may be self-loops and
+ * parallel edges.  Node degrees are close to the average, and any two nodes
+ * are a few hops apart.
+ *
+ * Params:
+ *   n_nodes - the number of nodes.  Must be positive.
+ *   n_edges - the number of edges.
+ *   max_weight - weights are uniformly random in [1, max_weight].
+ *   seed - the random seed.
+ *
+ * Return:
+ *   Returns the new graph, which should be freed with graph_free().
+ */
+struct graph* gen_random(int n_nodes, int n_edges, int max_weight,
+        unsigned long long seed) {
+    assert(n_nodes > 0 && n_edges >= 0 && max_weight > 0);
+    struct edge_list list = {NULL, NULL, NULL, 0, 0};
+    for (int i = 0; i < n_edges; i++) {
+        int u = next_random(&seed) % n_nodes;
+        int v = next_random(&seed) % n_nodes;
+        edge_list_add(&list, u, v, 1 + next_random(&seed) % max_weight);
+    }
+    return edge_list_finish(&list, n_nodes);
+}
+
+/*
+ * This function generates a power-law graph with the R-MAT model, a rough
+ * model of social and web graphs.  Each edge is placed by walking down the
+ * adjacency matrix: at each of `scale` levels, one of the four quadrants is
+ * chosen with probabilities 0.57, 0.19, 0.19 and 0.05 (the Graph500
+ * parameters), so a few nodes get very many edges and most get very few.
+ * The nodes are then renumbered in a random order, so the busiest ones are
+ * not all at the start.
+ *
+ * Params:
+ *   scale - the graph has 2^scale nodes.  Must be in [0, 30].
+ *   n_edges - the number of edges.
+ *   max_weight - weights are uniformly random in [1, max_weight].
+ *   seed - the random seed.
+ *
+ * Return:
+ *   Returns the new graph, which should be freed with graph_free().
+ */
+struct graph* gen_rmat(int scale, int n_edges, int max_weight,
+        unsigned long long seed) {
+    assert(scale >= 0 && scale <= 30 && n_edges >= 0 && max_weight > 0);
+    int n_nodes = 1 << scale;
+    int* label = malloc(n_nodes * sizeof(int));
+    assert(label);
+    for (int v = 0; v < n_nodes; v++) {
+        label[v] = v;
+    }
+    for (int v = n_nodes - 1; v > 0; v--) {
+        int j = next_random(&seed) % (v + 1);
+        int t = label[v];
+        label[v] = label[j];
+        label[j] = t;
+    }
+
+    struct edge_list list = {NULL, NULL, NULL, 0, 0};
+    for (int i = 0; i < n_edges; i++) {
+        int u = 0, v = 0;
+        for (int level = 0; level < scale; level++) {
+            double r = next_double(&seed);
+            u = 2 * u + (r >= 0.76);
+            v = 2 * v + (r >= 0.57 && r < 0.76) + (r >= 0.95);
+        }
+        edge_list_add(&list, label[u], label[v],
+            1 + next_random(&seed) % max_weight);
+    }
+    free(label);
+    return edge_list_finish(&list, n_nodes);
+}
+
+/*
+ * This function replaces every weight of a generated graph with one drawn
+ * from a distribution:
+ *
+ *   GEN_WEIGHTS_UNIFORM - uniformly random in [1, max_weight];
+ *   GEN_WEIGHTS_LOG - log-uniform in [1, max_weight], so each power of two
+ *     is as likely as any other and most weights are small, with a long tail
+ *     of large ones;
+ *   GEN_WEIGHTS_UNIT - all 1, which turns shortest paths into hop counts.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.  Its arrays must be writable, so it
+ *     may not be a mapped binary graph file.
+ *   distribution - one of the GEN_WEIGHTS_ values above.
+ *   max_weight - the largest weight.  Must be positive.
+ *   seed - the random seed.
+ */
+void gen_reweight(struct graph* graph, int distribution, int max_weight,
+        unsigned long long seed) {
+    assert(graph && graph->map == NULL && max_weight > 0);
+    double log_max = log(max_weight + 1.0);
+    for (int e = 0; e < graph->n_edges; e++) {
+        int w;
+        switch (distribution) {
+        case GEN_WEIGHTS_UNIFORM:
+            w = 1 + next_random(&seed) % max_weight;
+            break;
+        case GEN_WEIGHTS_LOG:
+            w = (int)exp(next_double(&seed) * log_max);
+            break;
+        default:
+            assert(distribution == GEN_WEIGHTS_UNIT);
+            w = 1;
+        }
+        graph->weights[e] = w;
+    }
+}
@@ -0,0 +1,34 @@
+/*
+ * This file contains the definition of the interface for the random graph
+ * generators.  You can find descriptions of the functions, including their
+ * parameters and their return values, in gen.c.
+ */
+
+#ifndef __GEN_H
+#define __GEN_H
+
+#include "graph.h"
+
+/*
+ * Weight distributions for gen_reweight().
+ */
+#define GEN_WEIGHTS_UNIFORM 0
+#define GEN_WEIGHTS_LOG 1
+#define GEN_WEIGHTS_UNIT 2
+
+/*
+ * Graph generator function prototypes.  Refer to gen.c for documentation
+ * about each of these functions.
+ */
+struct graph* gen_grid(int rows, int cols, int max_weight,
+  unsigned long long seed);
+struct graph* gen_geometric(int n_nodes, double degree,
+  unsigned long long seed);
+struct graph* gen_random(int n_nodes, int n_edges, int max_weight,
+  unsigned long long seed);
+struct graph* gen_rmat(int scale, int n_edges, int max_weight,
+  unsigned long long seed);
+void gen_reweight(struct graph* graph, int distribution, int max_weight,
+  unsigned long long seed);
+
+#endif
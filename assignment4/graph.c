@@ -0,0 +1,834 @@
+/*
+ * This file contains an implementation of a weighted directed graph stored in
+ * compressed sparse row (CSR) form, and of loaders that read one from a text
+ * file in the `airports.dat` format:
+ *
+ *   <number of nodes>
+ *   <number of edges>
+ *   <source> <target> <weight>      (one line per edge)
+ *
+ * graph_load() is the fast path.  It maps the file into memory, splits it into
+ * chunks at newline boundaries, and parses the chunks in parallel with a
+ * hand-written integer scanner, then builds the CSR arrays in parallel.
+ * graph_load_fscanf() reads the file with one fscanf() per edge, the way
+ * dijkstra.c originally did, and is kept for comparison.
+ *
+ * Graphs can also be saved in a binary format (see graph.h) that holds the
+ * CSR arrays exactly as they are laid out in memory.  graph_load_binary()
+ * maps such a file and uses it in place, so opening even a very large graph
+ * takes only a few system calls; pages are read on demand as the arrays are
+ * used.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "graph.h"
+
+/*
+ * Files smaller than this many bytes per thread are parsed with fewer
+ * threads, since starting a thread costs more than parsing a small chunk.
+ */
+#define MIN_CHUNK_BYTES (1 << 20)
+
+/*
+ * Adjacency lists shorter than this are sorted with insertion sort.
+ */
+#define INSERTION_SORT_MAX 32
+
+/*
+ * Helper function to allocate a graph with room for the given number of
+ * nodes and edges.  The offsets array is zeroed.
+ */
+static struct graph* graph_alloc(int n_nodes, int n_edges) {
+    struct graph* graph = malloc(sizeof(struct graph));
+    assert(graph);
+    graph->n_nodes = n_nodes;
+    graph->n_edges = n_edges;
+    graph->map = NULL;
+    graph->map_size = 0;
+    graph->offsets = calloc(n_nodes + 1, sizeof(int));
+    graph->targets = malloc((n_edges > 0 ? n_edges : 1) * sizeof(int));
+    graph->weights = malloc((n_edges > 0 ? n_edges : 1) * sizeof(int));
+    assert(graph->offsets && graph->targets && graph->weights);
+    return graph;
+}
+
+/*
+ * While a graph is being built, its edges are first scattered into an array
+ * of (target, weight) pairs, so that placing an edge costs one cache miss
+ * rather than one per CSR array.
+ */
+struct edge {
+    int target;
+    int weight;
+};
+
+static int edge_cmp(const void* a, const void* b) {
+    const struct edge* x = a;
+    const struct edge* y = b;
+    if (x->target != y->target) {
+        return x->target < y->target ? -1 : 1;
+    }
+    return (x->weight > y->weight) - (x->weight < y->weight);
+}
+
+/*
+ * Helper function to sort the adjacency lists of nodes `lo` through `hi - 1`
+ * in `edges` by target and then by weight, and copy them into the graph's
+ * CSR arrays.  Sorting gives every graph a canonical edge order no matter how
+ * (or in what order) it was built.
+ */
+static void finish_adjacency(struct graph* graph, struct edge* edges, int lo,
+        int hi) {
+    for (int u = lo; u < hi; u++) {
+        int begin = graph->offsets[u], end = graph->offsets[u + 1];
+        if (end - begin <= INSERTION_SORT_MAX) {
+            for (int i = begin + 1; i < end; i++) {
+                struct edge e = edges[i];
+                int j = i;
+                while (j > begin && edge_cmp(&edges[j - 1], &e) > 0) {
+                    edges[j] = edges[j - 1];
+                    j--;
+                }
+                edges[j] = e;
+            }
+        } else {
+            qsort(edges + begin, end - begin, sizeof(struct edge), edge_cmp);
+        }
+        for (int i = begin; i < end; i++) {
+            graph->targets[i] = edges[i].target;
+            graph->weights[i] = edges[i].weight;
+        }
+    }
+}
+
+/*
+ * This function builds a CSR graph from an edge list.  The edge arrays are
+ * not modified and are not owned by the returned graph.
+ *
+ * Params:
+ *   n_nodes - the number of nodes in the graph.
+ *   n_edges - the number of edges in the graph.
+ *   sources, targets, weights - arrays of `n_edges` elements; edge `i` goes
+ *     from sources[i] to targets[i] with weight weights[i].  Every node ID
+ *     must be between 0 (inclusive) and n_nodes (exclusive).
+ *
+ * Return:
+ *   Returns the new graph, which should be freed with graph_free().
+ */
+struct graph* graph_from_edges(int n_nodes, int n_edges, int* sources,
+        int* targets, int* weights) {
+    assert(n_nodes >= 0 && n_edges >= 0);
+    struct graph* graph = graph_alloc(n_nodes, n_edges);
+
+    for (int i = 0; i < n_edges; i++) {
+        assert(sources[i] >= 0 && sources[i] < n_nodes);
+        assert(targets[i] >= 0 && targets[i] < n_nodes);
+        graph->offsets[sources[i] + 1]++;
+    }
+    for (int u = 0; u < n_nodes; u++) {
+        graph->offsets[u + 1] += graph->offsets[u];
+    }
+
+    int* cursor = malloc((n_nodes + 1) * sizeof(int));
+    struct edge* edges = malloc((n_edges > 0 ? n_edges : 1) *
+        sizeof(struct edge));
+    assert(cursor && edges);
+    memcpy(cursor, graph->offsets, (n_nodes + 1) * sizeof(int));
+    for (int i = 0; i < n_edges; i++) {
+        struct edge* e = &edges[cursor[sources[i]]++];
+        e->target = targets[i];
+        e->weight = weights[i];
+    }
+    free(cursor);
+
+    finish_adjacency(graph, edges, 0, n_nodes);
+    free(edges);
+    return graph;
+}
+
+/*
+ * This function builds the transpose of a graph, which has an edge v -> u
+ * with weight w for every edge u -> v with weight w in the original.  It is
+ * used to search backwards from a target.
+ *
+ * Since the tails are visited in increasing order and each adjacency list is
+ * already sorted, the new adjacency lists come out sorted without another
+ * sort.
+ *
+ * Params:
+ *   graph - the graph to transpose.  May not be NULL.
+ *
+ * Return:
+ *   Returns the new graph, which should be freed with graph_free().
+ */
+struct graph* graph_transpose(struct graph* graph) {
+    assert(graph);
+    int n_nodes = graph->n_nodes;
+    struct graph* transpose = graph_alloc(n_nodes, graph->n_edges);
+
+    for (int e = 0; e < graph->n_edges; e++) {
+        transpose->offsets[graph->targets[e] + 1]++;
+    }
+    for (int v = 0; v < n_nodes; v++) {
+        transpose->offsets[v + 1] += transpose->offsets[v];
+    }
+
+    int* cursor = malloc((n_nodes + 1) * sizeof(int));
+    assert(cursor);
+    memcpy(cursor, transpose->offsets, (n_nodes + 1) * sizeof(int));
+    for (int u = 0; u < n_nodes; u++) {
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            int i = cursor[graph->targets[e]]++;
+            transpose->targets[i] = u;
+            transpose->weights[i] = graph->weights[e];
+        }
+    }
+    free(cursor);
+    return transpose;
+}
+
+/*
+ * This function renumbers the nodes of a graph.  Node order[i] of the
+ * original graph becomes node i of the new one, so `order` also maps the new
+ * node numbers back to the original ones.
+ *
+ * Params:
+ *   graph - the graph to renumber.  May not be NULL.
+ *   order - a permutation of the graph's nodes, with graph->n_nodes entries.
+ *
+ * Return:
+ *   Returns the new graph, which should be freed with graph_free().
+ */
+struct graph* graph_permute(struct graph* graph, int* order) {
+    assert(graph && order);
+    int n_nodes = graph->n_nodes;
+    struct graph* permuted = graph_alloc(n_nodes, graph->n_edges);
+
+    int* rank = malloc((n_nodes > 0 ? n_nodes : 1) * sizeof(int));
+    struct edge* edges = malloc((graph->n_edges > 0 ? graph->n_edges : 1) *
+        sizeof(struct edge));
+    assert(rank && edges);
+    for (int i = 0; i < n_nodes; i++) {
+        rank[order[i]] = i;
+    }
+    for (int i = 0; i < n_nodes; i++) {
+        int u = order[i], out = permuted->offsets[i];
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            edges[out].target = rank[graph->targets[e]];
+            edges[out++].weight = graph->weights[e];
+        }
+        permuted->offsets[i + 1] = out;
+    }
+
+    finish_adjacency(permuted, edges, 0, n_nodes);
+    free(edges);
+    free(rank);
+    return permuted;
+}
+
+/*
+ * This function frees all memory associated with a graph.
+ *
+ * Params:
+ *   graph - the graph to be destroyed.  May not be NULL.
+ */
+void graph_free(struct graph* graph) {
+    assert(graph);
+    if (graph->map) {
+        munmap(graph->map, graph->map_size);
+    } else {
+        free(graph->offsets);
+        free(graph->targets);
+        free(graph->weights);
+    }
+    free(graph);
+}
+
+/*****************************************************************************
+ **
+ ** Text loaders
+ **
+ *****************************************************************************/
+
+/*
+ * Helper function to parse one decimal integer from the text in [p, end).
+ * Leading whitespace is skipped.  Digits are recognized with a single
+ * unsigned range check, so the inner loop has one data-dependent branch per
+ * byte.  Values are assumed to fit in an int.
+ *
+ * Return:
+ *   Returns a pointer just past the integer, or NULL if the text contains
+ *   only whitespace (in which case *eof is set to 1) or something that isn't
+ *   an integer (in which case *eof is set to 0).
+ */
+static const char* parse_int(const char* p, const char* end, int* out,
+        int* eof) {
+    while (p < end && (unsigned char)*p <= ' ') {
+        p++;
+    }
+    *eof = p == end;
+    if (*eof) {
+        return NULL;
+    }
+
+    int negative = *p == '-';
+    p += negative;
+    const char* digits = p;
+    unsigned int value = 0, d;
+    while (p < end && (d = (unsigned int)(*p - '0')) <= 9) {
+        value = value * 10 + d;
+        p++;
+    }
+    if (p == digits || (p < end && (unsigned char)*p > ' ')) {
+        return NULL;
+    }
+    *out = negative ? -(int)value : (int)value;
+    return p;
+}
+
+/*
+ * State for parsing one chunk of the edge list.  Each thread parses the edges
+ * in [begin, end) into its own arrays.
+ */
+struct chunk {
+    const char* begin;
+    const char* end;
+    int n_nodes;
+    int* sources;
+    int* targets;
+    int* weights;
+    int count;
+    int error;
+
+    /*
+     * Used by the CSR-building phases after parsing.
+     */
+    struct graph* graph;
+    struct edge* edges;
+    int* cursor;
+    int lo, hi;
+    int index, n_chunks;
+};
+
+static void* parse_chunk(void* arg) {
+    struct chunk* c = arg;
+    const char* p = c->begin;
+    int src, dst, w, eof;
+
+    c->count = 0;
+    c->error = 0;
+    while ((p = parse_int(p, c->end, &src, &eof)) != NULL) {
+        if (!(p = parse_int(p, c->end, &dst, &eof)) ||
+                !(p = parse_int(p, c->end, &w, &eof))) {
+            c->error = 1;
+            return NULL;
+        }
+        if ((unsigned int)src >= (unsigned int)c->n_nodes ||
+                (unsigned int)dst >= (unsigned int)c->n_nodes) {
+            c->error = 2;
+            return NULL;
+        }
+        c->sources[c->count] = src;
+        c->targets[c->count] = dst;
+        c->weights[c->count] = w;
+        c->count++;
+    }
+    c->error = !eof;
+    return NULL;
+}
+
+static void* count_chunk(void* arg) {
+    struct chunk* c = arg;
+    for (int i = 0; i < c->count; i++) {
+        __atomic_add_fetch(&c->graph->offsets[c->sources[i] + 1], 1,
+            __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+/*
+ * Each thread owns the nodes in [lo, hi) and places every edge leaving one of
+ * them, scanning the parsed edges of all chunks in file order.  Reading every
+ * chunk's sources in every thread is cheap compared with the alternative: an
+ * atomic increment per edge on a shared cursor array, which on x86 is a full
+ * barrier that serializes the cache misses of the random stores around it.
+ */
+static void* scatter_range(void* arg) {
+    struct chunk* c = arg;
+    struct chunk* chunks = c - c->index;
+    int* cursor = c->cursor;
+    for (int k = 0; k < c->n_chunks; k++) {
+        struct chunk* from = &chunks[k];
+        for (int i = 0; i < from->count; i++) {
+            int src = from->sources[i];
+            if (src >= c->lo && src < c->hi) {
+                struct edge* e = &c->edges[cursor[src]++];
+                e->target = from->targets[i];
+                e->weight = from->weights[i];
+            }
+        }
+    }
+    finish_adjacency(c->graph, c->edges, c->lo, c->hi);
+    return NULL;
+}
+
+/*
+ * Helper function to run `fn` on each of `n` chunks, each in its own thread
+ * (or directly, if there is only one).
+ */
+static void run_chunks(void* (*fn)(void*), struct chunk* chunks, int n) {
+    if (n == 1) {
+        fn(&chunks[0]);
+        return;
+    }
+    pthread_t* threads = malloc(n * sizeof(pthread_t));
+    assert(threads);
+    for (int i = 0; i < n; i++) {
+        pthread_create(&threads[i], NULL, fn, &chunks[i]);
+    }
+    for (int i = 0; i < n; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+}
+
+/*
+ * This function loads a graph from a text file in the `airports.dat` format
+ * (see the top of this file).  After the two header numbers, each edge must
+ * be on its own line.  The file is memory-mapped and split into chunks at
+ * newline boundaries, which are parsed in parallel; the CSR arrays are then
+ * built in parallel as well.  If the file lists more edges than the header
+ * says, the extra ones are ignored, as dijkstra.c always did.
+ *
+ * Params:
+ *   path - the path of the file to load.
+ *   n_threads - the number of threads to use, or 0 to use one per online
+ *     CPU.  Small files are parsed with fewer threads.
+ *
+ * Return:
+ *   Returns the new graph, which should be freed with graph_free(), or NULL
+ *   if the file couldn't be read or is malformed.  An error message is
+ *   printed to stderr in that case.
+ */
+struct graph* graph_load(const char* path, int n_threads) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+    if (st.st_size == 0) {
+        fprintf(stderr, "%s: empty file\n", path);
+        close(fd);
+        return NULL;
+    }
+    size_t size = st.st_size;
+    const char* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    posix_madvise((void*)map, size, POSIX_MADV_WILLNEED);
+    const char* end = map + size;
+
+    /*
+     * Parse the header.
+     */
+    int n_nodes, n_edges, eof;
+    const char* body = parse_int(map, end, &n_nodes, &eof);
+    if (body) {
+        body = parse_int(body, end, &n_edges, &eof);
+    }
+    if (!body || n_nodes < 0 || n_edges < 0) {
+        fprintf(stderr, "%s: malformed header\n", path);
+        munmap((void*)map, size);
+        return NULL;
+    }
+
+    /*
+     * Split the edge list into chunks that start right after a newline.
+     */
+    if (n_threads <= 0) {
+        n_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    size_t body_size = end - body;
+    int n_chunks = (int)(body_size / MIN_CHUNK_BYTES) + 1;
+    if (n_chunks > n_threads) {
+        n_chunks = n_threads;
+    }
+    struct chunk* chunks = calloc(n_chunks, sizeof(struct chunk));
+    assert(chunks);
+    for (int i = 0; i < n_chunks; i++) {
+        const char* begin = body + body_size / n_chunks * i;
+        if (i > 0) {
+            const char* nl = memchr(begin, '\n', end - begin);
+            begin = nl ? nl + 1 : end;
+            if (begin < chunks[i - 1].begin) {
+                begin = chunks[i - 1].begin;
+            }
+            chunks[i - 1].end = begin;
+        }
+        chunks[i].begin = begin;
+        chunks[i].end = end;
+    }
+
+    /*
+     * Each line holds at least five bytes ("0 0 0") plus a newline, which
+     * bounds the number of edges in a chunk.
+     */
+    for (int i = 0; i < n_chunks; i++) {
+        size_t cap = (chunks[i].end - chunks[i].begin) / 6 + 1;
+        chunks[i].n_nodes = n_nodes;
+        chunks[i].sources = malloc(cap * sizeof(int));
+        chunks[i].targets = malloc(cap * sizeof(int));
+        chunks[i].weights = malloc(cap * sizeof(int));
+        assert(chunks[i].sources && chunks[i].targets && chunks[i].weights);
+    }
+    run_chunks(parse_chunk, chunks, n_chunks);
+    munmap((void*)map, size);
+
+    /*
+     * Keep exactly the first n_edges edges, in file order.  A chunk stops
+     * at its first bad line, so its count says where that line is; only a
+     * bad line before the last edge needed is an error.
+     */
+    int total = 0, error = 0;
+    for (int i = 0; i < n_chunks; i++) {
+        if (chunks[i].error && total + chunks[i].count < n_edges) {
+            error = chunks[i].error;
+        }
+        if (chunks[i].count > n_edges - total) {
+            chunks[i].count = n_edges - total;
+        }
+        total += chunks[i].count;
+    }
+    if (!error && total < n_edges) {
+        error = 3;
+    }
+
+    struct graph* graph = NULL;
+    if (error) {
+        fprintf(stderr, "%s: %s\n", path,
+            error == 1 ? "malformed edge" :
+            error == 2 ? "edge endpoint out of range" :
+            "fewer edges than the header says");
+    } else {
+        graph = graph_alloc(n_nodes, n_edges);
+        int* cursor = malloc((n_nodes + 1) * sizeof(int));
+        struct edge* edges = malloc((n_edges > 0 ? n_edges : 1) *
+            sizeof(struct edge));
+        assert(cursor && edges);
+        for (int i = 0; i < n_chunks; i++) {
+            chunks[i].graph = graph;
+            chunks[i].edges = edges;
+            chunks[i].cursor = cursor;
+            chunks[i].index = i;
+            chunks[i].n_chunks = n_chunks;
+        }
+
+        run_chunks(count_chunk, chunks, n_chunks);
+        for (int u = 0; u < n_nodes; u++) {
+            graph->offsets[u + 1] += graph->offsets[u];
+        }
+        memcpy(cursor, graph->offsets, (n_nodes + 1) * sizeof(int));
+
+        /*
+         * Give each thread a range of nodes with about the same number of
+         * outgoing edges.
+         */
+        int u = 0;
+        for (int i = 0; i < n_chunks; i++) {
+            long goal = (long)n_edges * (i + 1) / n_chunks;
+            chunks[i].lo = u;
+            while (u < n_nodes && (i == n_chunks - 1 ||
+                    graph->offsets[u + 1] <= goal)) {
+                u++;
+            }
+            chunks[i].hi = u;
+        }
+        run_chunks(scatter_range, chunks, n_chunks);
+        free(cursor);
+        free(edges);
+    }
+
+    for (int i = 0; i < n_chunks; i++) {
+        free(chunks[i].sources);
+        free(chunks[i].targets);
+        free(chunks[i].weights);
+    }
+    free(chunks);
+    return graph;
+}
+
+/*
+ * This function loads a graph from a text file in the `airports.dat` format
+ * using one fscanf() call per edge.  It is much slower than graph_load() and
+ * is kept as a reference for benchmarking.
+ *
+ * Params:
+ *   path - the path of the file to load.
+ *
+ * Return:
+ *   Returns the new graph, which should be freed with graph_free(), or NULL
+ *   if the file couldn't be read or is malformed.  An error message is
+ *   printed to stderr in that case.
+ */
+struct graph* graph_load_fscanf(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    int n_nodes, n_edges;
+    if (fscanf(file, " %d %d ", &n_nodes, &n_edges) != 2 || n_nodes < 0 ||
+            n_edges < 0) {
+        fprintf(stderr, "%s: malformed header\n", path);
+        fclose(file);
+        return NULL;
+    }
+
+    int* sources = malloc((n_edges > 0 ? n_edges : 1) * sizeof(int));
+    int* targets = malloc((n_edges > 0 ? n_edges : 1) * sizeof(int));
+    int* weights = malloc((n_edges > 0 ? n_edges : 1) * sizeof(int));
+    assert(sources && targets && weights);
+    struct graph* graph = NULL;
+    int i;
+    for (i = 0; i < n_edges; i++) {
+        if (fscanf(file, "%d %d %d", &sources[i], &targets[i],
+                &weights[i]) != 3 ||
+                (unsigned int)sources[i] >= (unsigned int)n_nodes ||
+                (unsigned int)targets[i] >= (unsigned int)n_nodes) {
+            break;
+        }
+    }
+    fclose(file);
+
+    if (i == n_edges) {
+        graph = graph_from_edges(n_nodes, n_edges, sources, targets, weights);
+    } else {
+        fprintf(stderr, "%s: malformed edge %d\n", path, i);
+    }
+    free(sources);
+    free(targets);
+    free(weights);
+    return graph;
+}
+
+/*
+ * This function saves a graph as a text file in the `airports.dat` format,
+ * which graph_load() can read back.  Edges are written in CSR order, that
+ * is, grouped by source node.
+ *
+ * Params:
+ *   graph - the graph to save.  May not be NULL.
+ *   path - the path of the file to write.  An existing file is replaced.
+ *
+ * Return:
+ *   Returns 0 on success or -1 if the file couldn't be written, in which
+ *   case an error message is printed to stderr.
+ */
+int graph_save_text(struct graph* graph, const char* path) {
+    assert(graph);
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    int result = fprintf(file, "%d\n%d\n", graph->n_nodes,
+        graph->n_edges) < 0 ? -1 : 0;
+    for (int u = 0; u < graph->n_nodes && result == 0; u++) {
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            if (fprintf(file, "%d %d %d\n", u, graph->targets[e],
+                    graph->weights[e]) < 0) {
+                result = -1;
+                break;
+            }
+        }
+    }
+    if (fclose(file) != 0) {
+        result = -1;
+    }
+    if (result != 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+    }
+    return result;
+}
+
+/*****************************************************************************
+ **
+ ** Binary graph files
+ **
+ *****************************************************************************/
+
+/*
+ * Helper function to write `size` bytes to a file, returning 0 on success.
+ */
+static int write_all(FILE* file, const void* data, size_t size) {
+    return fwrite(data, 1, size, file) == size ? 0 : -1;
+}
+
+/*
+ * This function saves a graph as a binary graph file (see graph.h), which can
+ * later be opened with graph_load_binary().
+ *
+ * Params:
+ *   graph - the graph to save.  May not be NULL.
+ *   path - the path of the file to write.  An existing file is replaced.
+ *
+ * Return:
+ *   Returns 0 on success or -1 if the file couldn't be written, in which
+ *   case an error message is printed to stderr.
+ */
+int graph_save_binary(struct graph* graph, const char* path) {
+    assert(graph);
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    struct graph_file_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, GRAPH_FILE_MAGIC, sizeof(header.magic));
+    header.version = GRAPH_FILE_VERSION;
+    header.n_nodes = graph->n_nodes;
+    header.n_edges = graph->n_edges;
+
+    int result = write_all(file, &header, sizeof(header));
+    if (result == 0) {
+        result = write_all(file, graph->offsets,
+            (graph->n_nodes + 1) * sizeof(int));
+    }
+    if (result == 0) {
+        result = write_all(file, graph->targets, graph->n_edges * sizeof(int));
+    }
+    if (result == 0) {
+        result = write_all(file, graph->weights, graph->n_edges * sizeof(int));
+    }
+    if (fclose(file) != 0) {
+        result = -1;
+    }
+    if (result != 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+    }
+    return result;
+}
+
+/*
+ * This function opens a binary graph file written by graph_save_binary().
+ * The file is mapped read-only and the returned graph's arrays point into
+ * the mapping, so nothing is read or copied up front.  Only the header and
+ * the file size are checked; the arrays are trusted to be well-formed.
+ *
+ * Params:
+ *   path - the path of the file to open.
+ *
+ * Return:
+ *   Returns the graph, which should be freed with graph_free() (which also
+ *   unmaps the file), or NULL if the file couldn't be mapped or isn't a
+ *   valid binary graph file.  An error message is printed to stderr in that
+ *   case.
+ */
+struct graph* graph_load_binary(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+    size_t size = st.st_size;
+    if (size < sizeof(struct graph_file_header)) {
+        fprintf(stderr, "%s: not a binary graph file\n", path);
+        close(fd);
+        return NULL;
+    }
+    void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    struct graph_file_header* header = map;
+    size_t expected = 0;
+    int valid = memcmp(header->magic, GRAPH_FILE_MAGIC,
+        sizeof(header->magic)) == 0 && header->version == GRAPH_FILE_VERSION &&
+        header->n_nodes >= 0 && header->n_edges >= 0;
+    if (valid) {
+        expected = sizeof(struct graph_file_header) +
+            ((size_t)header->n_nodes + 1 + 2 * (size_t)header->n_edges) *
+            sizeof(int);
+        valid = size == expected;
+    }
+    if (!valid) {
+        fprintf(stderr, "%s: not a valid binary graph file\n", path);
+        munmap(map, size);
+        return NULL;
+    }
+
+    struct graph* graph = malloc(sizeof(struct graph));
+    assert(graph);
+    graph->n_nodes = header->n_nodes;
+    graph->n_edges = header->n_edges;
+    graph->offsets = (int*)(header + 1);
+    graph->targets = graph->offsets + graph->n_nodes + 1;
+    graph->weights = graph->targets + graph->n_edges;
+    graph->map = map;
+    graph->map_size = size;
+    return graph;
+}
+
+/*
+ * This function opens a graph file in either format: files that start with
+ * the binary graph file magic are mapped with graph_load_binary(), and
+ * anything else is parsed as text with graph_load().
+ *
+ * Params:
+ *   path - the path of the file to open.
+ *   n_threads - the number of threads to use for parsing a text file, or 0
+ *     to use one per online CPU.
+ *
+ * Return:
+ *   Returns the graph, which should be freed with graph_free(), or NULL on
+ *   error, in which case an error message is printed to stderr.
+ */
+struct graph* graph_open(const char* path, int n_threads) {
+    char magic[sizeof(GRAPH_FILE_MAGIC) - 1];
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    size_t n = fread(magic, 1, sizeof(magic), file);
+    fclose(file);
+
+    if (n == sizeof(magic) && memcmp(magic, GRAPH_FILE_MAGIC, n) == 0) {
+        return graph_load_binary(path);
+    }
+    return graph_load(path, n_threads);
+}
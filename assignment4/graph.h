@@ -0,0 +1,70 @@
+/*
+ * This file contains the definition of the interface for a weighted directed
+ * graph stored in compressed sparse row (CSR) form, along with functions to
+ * load one from a file in the `airports.dat` format.  You can find
+ * descriptions of the graph functions, including their parameters and their
+ * return values, in graph.c.
+ */
+
+#ifndef __GRAPH_H
+#define __GRAPH_H
+
+/*
+ * Structure used to represent a graph.  Unlike most of the structures in
+ * this directory, its fields are visible, because the shortest-path code
+ * walks the arrays directly in its inner loops.
+ *
+ * The edges leaving node `u` are stored at indices offsets[u] (inclusive)
+ * through offsets[u + 1] (exclusive) of `targets` and `weights`, sorted by
+ * target and then by weight.  Nodes are numbered 0 through n_nodes - 1.
+ *
+ * A graph loaded from a binary graph file points straight into a read-only
+ * memory mapping of that file, which is recorded in `map` and `map_size`;
+ * for other graphs `map` is NULL.  Either way the arrays must not be
+ * modified.
+ */
+struct graph {
+  int n_nodes;
+  int n_edges;
+  int* offsets;
+  int* targets;
+  int* weights;
+  void* map;
+  unsigned long map_size;
+};
+
+/*
+ * Layout of a binary graph file, written by graph_save_binary() and mapped by
+ * graph_load_binary().  The file starts with this header and is followed
+ * directly by the offsets array (n_nodes + 1 ints), the targets array
+ * (n_edges ints) and the weights array (n_edges ints), all in the byte order
+ * of the machine that wrote it.
+ */
+#define GRAPH_FILE_MAGIC "CSRGRAPH"
+#define GRAPH_FILE_VERSION 1
+
+struct graph_file_header {
+  char magic[8];
+  unsigned int version;
+  int n_nodes;
+  int n_edges;
+  unsigned int reserved;
+};
+
+/*
+ * Graph interface function prototypes.  Refer to graph.c for documentation
+ * about each of these functions.
+ */
+struct graph* graph_from_edges(int n_nodes, int n_edges, int* sources,
+  int* targets, int* weights);
+struct graph* graph_transpose(struct graph* graph);
+struct graph* graph_permute(struct graph* graph, int* order);
+struct graph* graph_load(const char* path, int n_threads);
+struct graph* graph_load_fscanf(const char* path);
+struct graph* graph_load_binary(const char* path);
+struct graph* graph_open(const char* path, int n_threads);
+int graph_save_text(struct graph* graph, const char* path);
+int graph_save_binary(struct graph* graph, const char* path);
+void graph_free(struct graph* graph);
+
+#endif
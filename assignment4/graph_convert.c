@@ -0,0 +1,32 @@
+/*
+ * This program converts a graph in the `airports.dat` text format into a
+ * binary graph file (see graph.h), which dijkstra and the other programs in
+ * this directory can map directly instead of parsing the text on every run.
+ *
+ * Usage: ./graph_convert <input.dat> <output.bin> [threads]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s <input.dat> <output.bin> [threads]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  int n_threads = argc > 3 ? atoi(argv[3]) : 0;
+
+  struct graph* graph = graph_load(argv[1], n_threads);
+  if (graph == NULL) {
+    return EXIT_FAILURE;
+  }
+  int result = graph_save_binary(graph, argv[2]);
+  if (result == 0) {
+    printf("%s: %d nodes, %d edges\n", argv[2], graph->n_nodes,
+      graph->n_edges);
+  }
+  graph_free(graph);
+  return result == 0 ? 0 : EXIT_FAILURE;
+}
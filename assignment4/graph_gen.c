@@ -0,0 +1,104 @@
+/*
+ * This program writes a synthetic graph, for measuring the shortest-path
+ * programs in this directory on something bigger than `airports.dat`.  The
+ * graph is written in the `airports.dat` text format, or with -b as a binary
+ * graph file (see graph.h).  The same arguments and seed always give the
+ * same file.
+ *
+ * Usage: ./graph_gen [-s seed] [-w uniform|log|unit] [-W max_weight] [-b]
+ *          <shape> <size> <size> <output>
+ *
+ * where the shape and sizes are one of:
+ *
+ *   random <n_nodes> <n_edges>     uniformly random edges
+ *   grid <rows> <cols>             a grid with edges both ways
+ *   rmat <scale> <n_edges>         a power-law graph on 2^scale nodes
+ *   geometric <n_nodes> <degree>   a random geometric graph
+ *
+ * Without -w, each shape keeps its own weights: uniform in [1, max_weight]
+ * (1000 by default), or distances for the geometric graph.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gen.h"
+#include "graph.h"
+
+static void usage(const char* prog) {
+  fprintf(stderr, "usage: %s [-s seed] [-w uniform|log|unit] "
+    "[-W max_weight] [-b] <shape> <size> <size> <output>\n", prog);
+  fprintf(stderr, "shapes: random <n_nodes> <n_edges>, grid <rows> <cols>, "
+    "rmat <scale> <n_edges>, geometric <n_nodes> <degree>\n");
+}
+
+int main(int argc, char** argv) {
+  unsigned long long seed = 1;
+  const char* weights = NULL;
+  int max_weight = 1000, binary = 0, opt;
+  while ((opt = getopt(argc, argv, "s:w:W:b")) != -1) {
+    switch (opt) {
+    case 's':
+      seed = strtoull(optarg, NULL, 10);
+      break;
+    case 'w':
+      weights = optarg;
+      break;
+    case 'W':
+      max_weight = atoi(optarg);
+      break;
+    case 'b':
+      binary = 1;
+      break;
+    default:
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (argc - optind != 4 || max_weight <= 0 || (weights &&
+      strcmp(weights, "uniform") && strcmp(weights, "log") &&
+      strcmp(weights, "unit"))) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const char* shape = argv[optind];
+  int a = atoi(argv[optind + 1]);
+  double b = atof(argv[optind + 2]);
+  const char* path = argv[optind + 3];
+  struct graph* graph = NULL;
+  if (!strcmp(shape, "random") && a > 0 && b >= 0) {
+    graph = gen_random(a, (int)b, max_weight, seed);
+  } else if (!strcmp(shape, "grid") && a > 0 && b > 0) {
+    graph = gen_grid(a, (int)b, max_weight, seed);
+  } else if (!strcmp(shape, "rmat") && a >= 0 && a <= 30 && b >= 0) {
+    graph = gen_rmat(a, (int)b, max_weight, seed);
+  } else if (!strcmp(shape, "geometric") && a > 0 && b > 0) {
+    graph = gen_geometric(a, b, seed);
+  } else {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  /*
+   * Draw the new weights from a different stream than the shape, so the
+   * same seed gives the same shape whatever the weights.
+   */
+  if (weights) {
+    int distribution = !strcmp(weights, "uniform") ? GEN_WEIGHTS_UNIFORM :
+      !strcmp(weights, "log") ? GEN_WEIGHTS_LOG : GEN_WEIGHTS_UNIT;
+    gen_reweight(graph, distribution, max_weight, ~seed);
+  }
+
+  int result = binary ? graph_save_binary(graph, path) :
+    graph_save_text(graph, path);
+  if (result == 0) {
+    printf("%s: %d nodes, %d edges\n", path, graph->n_nodes, graph->n_edges);
+  }
+  graph_free(graph);
+  return result == 0 ? 0 : EXIT_FAILURE;
+}
@@ -0,0 +1,476 @@
+/*
+ * This file contains Yen's algorithm for the K shortest loopless paths from
+ * one node to another.  All edge weights are assumed to be non-negative.
+ *
+ * The shortest path comes from Dijkstra's algorithm.  Each further path is
+ * found by taking the last path accepted and, for each node on it (the spur
+ * node), looking for the shortest path that follows the last path up to the
+ * spur node and then leaves it.  The search from the spur node may not use
+ * the nodes before it on the path (so the result has no loops), nor any
+ * edge out of the spur node that an accepted path with the same start takes
+ * (so the result is new).  Candidates go into a priority queue, and the
+ * shortest one not accepted yet becomes the next path.
+ *
+ * Following Lawler, a path only spurs from the node where it left the path
+ * it was derived from, or later: spurring earlier would only find paths
+ * that have been found already.
+ *
+ * A path is a run of nodes in one shared pool, with the distance from s to
+ * each node along it kept next to the node.  Candidates are checked against
+ * a hash set of every path found so far, since different spurs can produce
+ * the same path.  All scratch space lives in the struct ksp and is reused
+ * from one search to the next: the per-node arrays are stamped with the
+ * number of the search that last wrote them, so none has to be cleared, and
+ * the pool, the path list and the hash set only grow, so once they are big
+ * enough a query allocates nothing.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "kpaths.h"
+#include "pq.h"
+
+/*
+ * A path in the pool: `length` nodes starting at nodes[offset], which left
+ * the path it was derived from after node `deviation`.
+ */
+struct path {
+    long offset;
+    int length;
+    int deviation;
+    unsigned long long hash;
+};
+
+struct ksp {
+    struct graph* graph;
+
+    /*
+     * Scratch space for the searches from spur nodes.  dist[v] and prev[v]
+     * are only valid when seen[v] is the current stamp; a node is off limits
+     * when blocked[v] is, and the edge from the spur node to v when
+     * banned[v] is.
+     */
+    dist_t* dist;
+    int* prev;
+    int* seen;
+    int* blocked;
+    int* banned;
+    int stamp;
+    struct pq* pq;
+    int* spur;
+
+    /*
+     * The pool of path nodes, with the distance from s to each.
+     */
+    int* nodes;
+    dist_t* cum;
+    long pool_size;
+    long pool_capacity;
+
+    /*
+     * Every path found by the current query, the ones accepted so far, and
+     * the candidates not accepted yet.
+     */
+    struct path* paths;
+    int n_paths;
+    int paths_capacity;
+    int* accepted;
+    int n_accepted;
+    int accepted_capacity;
+    struct pq* candidates;
+
+    /*
+     * Hash set of path indices, with open addressing; -1 marks a free slot.
+     */
+    int* table;
+    int table_size;
+
+    long searches;
+};
+
+/*
+ * This function sets up K-shortest-path searches on a graph.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.  It must stay alive and unchanged
+ *     until the struct ksp is freed.
+ *
+ * Return:
+ *   Returns the new struct ksp, which should be freed with ksp_free().
+ */
+struct ksp* ksp_create(struct graph* graph) {
+    assert(graph);
+    int n = graph->n_nodes > 0 ? graph->n_nodes : 1;
+    struct ksp* ksp = malloc(sizeof(struct ksp));
+    assert(ksp);
+    ksp->graph = graph;
+    ksp->dist = malloc(n * sizeof(dist_t));
+    ksp->prev = malloc(n * sizeof(int));
+    ksp->seen = calloc(n, sizeof(int));
+    ksp->blocked = calloc(n, sizeof(int));
+    ksp->banned = calloc(n, sizeof(int));
+    ksp->spur = malloc(n * sizeof(int));
+    assert(ksp->dist && ksp->prev && ksp->seen && ksp->blocked &&
+        ksp->banned && ksp->spur);
+    ksp->stamp = 0;
+    ksp->pq = pq_create64(0);
+
+    ksp->pool_capacity = 1024;
+    ksp->nodes = malloc(ksp->pool_capacity * sizeof(int));
+    ksp->cum = malloc(ksp->pool_capacity * sizeof(dist_t));
+    ksp->paths_capacity = 64;
+    ksp->paths = malloc(ksp->paths_capacity * sizeof(struct path));
+    ksp->accepted_capacity = 64;
+    ksp->accepted = malloc(ksp->accepted_capacity * sizeof(int));
+    ksp->table_size = 128;
+    ksp->table = malloc(ksp->table_size * sizeof(int));
+    assert(ksp->nodes && ksp->cum && ksp->paths && ksp->accepted &&
+        ksp->table);
+    memset(ksp->table, -1, ksp->table_size * sizeof(int));
+    ksp->candidates = pq_create64(0);
+    ksp->pool_size = ksp->n_paths = ksp->n_accepted = 0;
+    ksp->searches = 0;
+    return ksp;
+}
+
+/*
+ * This function frees all memory associated with a struct ksp.
+ *
+ * Params:
+ *   ksp - the struct ksp to be destroyed.  May not be NULL.
+ */
+void ksp_free(struct ksp* ksp) {
+    assert(ksp);
+    free(ksp->dist);
+    free(ksp->prev);
+    free(ksp->seen);
+    free(ksp->blocked);
+    free(ksp->banned);
+    free(ksp->spur);
+    pq_free(ksp->pq);
+    free(ksp->nodes);
+    free(ksp->cum);
+    free(ksp->paths);
+    free(ksp->accepted);
+    free(ksp->table);
+    pq_free(ksp->candidates);
+    free(ksp);
+}
+
+/*
+ * Helper function to start a new search, returning its stamp.  When the
+ * stamps run out, the stamped arrays are cleared and numbering starts over.
+ */
+static int next_stamp(struct ksp* ksp) {
+    if (ksp->stamp == INT_MAX) {
+        int n = ksp->graph->n_nodes;
+        memset(ksp->seen, 0, n * sizeof(int));
+        memset(ksp->blocked, 0, n * sizeof(int));
+        memset(ksp->banned, 0, n * sizeof(int));
+        ksp->stamp = 0;
+    }
+    return ++ksp->stamp;
+}
+
+/*
+ * Helper function to run Dijkstra's algorithm from the spur node, whose
+ * distance from s is `base`, until t is settled, avoiding the nodes and
+ * edges marked with the current stamp.  Returns 1 if t was reached.
+ */
+static int spur_search(struct ksp* ksp, int spur, int t, dist_t base) {
+    struct graph* graph = ksp->graph;
+    int stamp = ksp->stamp;
+    ksp->searches++;
+    ksp->seen[spur] = stamp;
+    ksp->dist[spur] = base;
+    ksp->prev[spur] = -1;
+    pq_insert64(ksp->pq, (void*)(long)spur, base);
+
+    int found = 0;
+    while (!pq_isempty(ksp->pq)) {
+        dist_t du = pq_first_priority64(ksp->pq);
+        int u = (int)(long)pq_remove_first(ksp->pq);
+        if (du > ksp->dist[u]) {
+            continue;
+        }
+        if (u == t) {
+            found = 1;
+            break;
+        }
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            int v = graph->targets[e];
+            if (ksp->blocked[v] == stamp ||
+                    (u == spur && ksp->banned[v] == stamp)) {
+                continue;
+            }
+            dist_t d = du + graph->weights[e];
+            if (ksp->seen[v] != stamp || d < ksp->dist[v]) {
+                ksp->seen[v] = stamp;
+                ksp->dist[v] = d;
+                ksp->prev[v] = u;
+                pq_insert64(ksp->pq, (void*)(long)v, d);
+            }
+        }
+    }
+    while (!pq_isempty(ksp->pq)) {
+        pq_remove_first(ksp->pq);
+    }
+    return found;
+}
+
+/*
+ * Helper function to make room for `extra` more nodes in the pool.
+ */
+static void pool_reserve(struct ksp* ksp, long extra) {
+    if (ksp->pool_size + extra <= ksp->pool_capacity) {
+        return;
+    }
+    while (ksp->pool_size + extra > ksp->pool_capacity) {
+        ksp->pool_capacity *= 2;
+    }
+    ksp->nodes = realloc(ksp->nodes, ksp->pool_capacity * sizeof(int));
+    ksp->cum = realloc(ksp->cum, ksp->pool_capacity * sizeof(dist_t));
+    assert(ksp->nodes && ksp->cum);
+}
+
+static unsigned long long hash_nodes(int* nodes, int length) {
+    unsigned long long h = 14695981039346656037ULL;
+    for (int i = 0; i < length; i++) {
+        h = (h ^ (unsigned int)nodes[i]) * 1099511628211ULL;
+    }
+    return h;
+}
+
+/*
+ * Helper function to find the hash set slot for path p: the slot holding a
+ * path with the same nodes, or the free slot where p belongs.
+ */
+static int table_slot(struct ksp* ksp, struct path* p) {
+    int mask = ksp->table_size - 1;
+    for (int i = (int)(p->hash & mask); ; i = (i + 1) & mask) {
+        int id = ksp->table[i];
+        if (id < 0) {
+            return i;
+        }
+        struct path* q = &ksp->paths[id];
+        if (q->hash == p->hash && q->length == p->length &&
+                !memcmp(ksp->nodes + q->offset, ksp->nodes + p->offset,
+                    p->length * sizeof(int))) {
+            return i;
+        }
+    }
+}
+
+/*
+ * Helper function to double the hash set.
+ */
+static void table_grow(struct ksp* ksp) {
+    free(ksp->table);
+    ksp->table_size *= 2;
+    ksp->table = malloc(ksp->table_size * sizeof(int));
+    assert(ksp->table);
+    memset(ksp->table, -1, ksp->table_size * sizeof(int));
+    for (int id = 0; id < ksp->n_paths; id++) {
+        ksp->table[table_slot(ksp, &ksp->paths[id])] = id;
+    }
+}
+
+/*
+ * Helper function to record the path at the end of the pool, starting at
+ * `offset`, unless it has been found before, in which case it is dropped.
+ * Returns the new path's index, or -1 for a duplicate.
+ */
+static int add_path(struct ksp* ksp, long offset, int deviation) {
+    if (ksp->n_paths == ksp->paths_capacity) {
+        ksp->paths_capacity *= 2;
+        ksp->paths = realloc(ksp->paths,
+            ksp->paths_capacity * sizeof(struct path));
+        assert(ksp->paths);
+    }
+    struct path* p = &ksp->paths[ksp->n_paths];
+    p->offset = offset;
+    p->length = (int)(ksp->pool_size - offset);
+    p->deviation = deviation;
+    p->hash = hash_nodes(ksp->nodes + offset, p->length);
+
+    int slot = table_slot(ksp, p);
+    if (ksp->table[slot] >= 0) {
+        ksp->pool_size = offset;
+        return -1;
+    }
+    ksp->table[slot] = ksp->n_paths++;
+    if (2 * ksp->n_paths > ksp->table_size) {
+        table_grow(ksp);
+    }
+    return ksp->n_paths - 1;
+}
+
+/*
+ * Helper function to append the nodes of the path found by the last search,
+ * from the spur node to t, to the pool.
+ */
+static void append_spur(struct ksp* ksp, int t) {
+    int length = 0;
+    for (int v = t; v >= 0; v = ksp->prev[v]) {
+        ksp->spur[length++] = v;
+    }
+    pool_reserve(ksp, length);
+    while (length > 0) {
+        int v = ksp->spur[--length];
+        ksp->nodes[ksp->pool_size] = v;
+        ksp->cum[ksp->pool_size++] = ksp->dist[v];
+    }
+}
+
+/*
+ * Helper function to move a path to the list of accepted paths.
+ */
+static void accept(struct ksp* ksp, int id) {
+    if (ksp->n_accepted == ksp->accepted_capacity) {
+        ksp->accepted_capacity *= 2;
+        ksp->accepted = realloc(ksp->accepted,
+            ksp->accepted_capacity * sizeof(int));
+        assert(ksp->accepted);
+    }
+    ksp->accepted[ksp->n_accepted++] = id;
+}
+
+/*
+ * Helper function to generate the candidates that spur from path `id` at
+ * node index i, for every i from the path's deviation on.
+ */
+static void spur_from(struct ksp* ksp, int id, int t) {
+    int length = ksp->paths[id].length;
+    for (int i = ksp->paths[id].deviation; i < length - 1; i++) {
+        long offset = ksp->paths[id].offset;
+        int* root = ksp->nodes + offset;
+        int stamp = next_stamp(ksp);
+        for (int j = 0; j < i; j++) {
+            ksp->blocked[root[j]] = stamp;
+        }
+        for (int a = 0; a < ksp->n_accepted; a++) {
+            struct path* p = &ksp->paths[ksp->accepted[a]];
+            if (p->length > i + 1 && !memcmp(ksp->nodes + p->offset, root,
+                    (i + 1) * sizeof(int))) {
+                ksp->banned[ksp->nodes[p->offset + i + 1]] = stamp;
+            }
+        }
+        if (!spur_search(ksp, root[i], t, ksp->cum[offset + i])) {
+            continue;
+        }
+
+        /*
+         * The candidate is the root (copied, since the pool may move) and
+         * then the spur path, which starts with the spur node again.
+         */
+        long start = ksp->pool_size;
+        pool_reserve(ksp, i);
+        memcpy(ksp->nodes + start, ksp->nodes + offset, i * sizeof(int));
+        memcpy(ksp->cum + start, ksp->cum + offset, i * sizeof(dist_t));
+        ksp->pool_size += i;
+        append_spur(ksp, t);
+        int candidate = add_path(ksp, start, i);
+        if (candidate >= 0) {
+            pq_insert64(ksp->candidates, (void*)(long)candidate,
+                ksp->cum[ksp->pool_size - 1]);
+        }
+    }
+}
+
+/*
+ * This function finds the k shortest loopless paths from s to t, which can
+ * then be read with ksp_length() and ksp_path().  Paths are found in order
+ * of length; among paths of equal length the order is unspecified.
+ *
+ * Params:
+ *   ksp - the struct ksp for the graph.  May not be NULL.
+ *   s, t - the ends of the paths.
+ *   k - the number of paths wanted.
+ *
+ * Return:
+ *   Returns the number of paths found, which is k unless there are fewer
+ *   loopless paths from s to t.
+ */
+int ksp_find(struct ksp* ksp, int s, int t, int k) {
+    assert(ksp && k >= 0);
+    assert(s >= 0 && s < ksp->graph->n_nodes);
+    assert(t >= 0 && t < ksp->graph->n_nodes);
+    ksp->pool_size = ksp->n_paths = ksp->n_accepted = 0;
+    ksp->searches = 0;
+    memset(ksp->table, -1, ksp->table_size * sizeof(int));
+    while (!pq_isempty(ksp->candidates)) {
+        pq_remove_first(ksp->candidates);
+    }
+    if (k == 0) {
+        return 0;
+    }
+
+    next_stamp(ksp);
+    if (!spur_search(ksp, s, t, 0)) {
+        return 0;
+    }
+    append_spur(ksp, t);
+    accept(ksp, add_path(ksp, 0, 0));
+
+    while (ksp->n_accepted < k) {
+        spur_from(ksp, ksp->accepted[ksp->n_accepted - 1], t);
+        if (pq_isempty(ksp->candidates)) {
+            break;
+        }
+        accept(ksp, (int)(long)pq_remove_first(ksp->candidates));
+    }
+    return ksp->n_accepted;
+}
+
+/*
+ * This function returns the length of a path found by the last call to
+ * ksp_find().
+ *
+ * Params:
+ *   ksp - the struct ksp.  May not be NULL.
+ *   i - the path's rank, from 0 (the shortest) to the number of paths found
+ *     minus 1.
+ */
+dist_t ksp_length(struct ksp* ksp, int i) {
+    assert(ksp && i >= 0 && i < ksp->n_accepted);
+    struct path* p = &ksp->paths[ksp->accepted[i]];
+    return ksp->cum[p->offset + p->length - 1];
+}
+
+/*
+ * This function copies the nodes of a path found by the last call to
+ * ksp_find() into a caller's buffer.
+ *
+ * Params:
+ *   ksp - the struct ksp.  May not be NULL.
+ *   i - the path's rank, as for ksp_length().
+ *   path - buffer that receives the path, starting with s and ending with
+ *     t.  May be NULL if capacity is 0.
+ *   capacity - the number of nodes path has room for.
+ *
+ * Return:
+ *   Returns the number of nodes on the path.  If that is more than
+ *   capacity, nothing is written.
+ */
+int ksp_path(struct ksp* ksp, int i, int* path, int capacity) {
+    assert(ksp && i >= 0 && i < ksp->n_accepted);
+    assert(path || capacity == 0);
+    struct path* p = &ksp->paths[ksp->accepted[i]];
+    if (p->length <= capacity) {
+        memcpy(path, ksp->nodes + p->offset, p->length * sizeof(int));
+    }
+    return p->length;
+}
+
+/*
+ * This function returns the number of Dijkstra searches (one per spur node
+ * tried, plus the first) made by the last call to ksp_find().
+ */
+long ksp_last_searches(struct ksp* ksp) {
+    assert(ksp);
+    return ksp->searches;
+}
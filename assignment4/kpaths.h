@@ -0,0 +1,31 @@
+/*
+ * This file contains the definition of the interface for finding the K
+ * shortest loopless paths between two nodes.  You can find descriptions of
+ * the functions, including their parameters and their return values, in
+ * kpaths.c.
+ */
+
+#ifndef __KPATHS_H
+#define __KPATHS_H
+
+#include "graph.h"
+#include "sssp.h"
+
+/*
+ * Structure used to hold the scratch space for K-shortest-path searches on
+ * one graph, and the paths found by the last one.
+ */
+struct ksp;
+
+/*
+ * K-shortest-paths interface function prototypes.  Refer to kpaths.c for
+ * documentation about each of these functions.
+ */
+struct ksp* ksp_create(struct graph* graph);
+void ksp_free(struct ksp* ksp);
+int ksp_find(struct ksp* ksp, int s, int t, int k);
+dist_t ksp_length(struct ksp* ksp, int i);
+int ksp_path(struct ksp* ksp, int i, int* path, int capacity);
+long ksp_last_searches(struct ksp* ksp);
+
+#endif
@@ -0,0 +1,262 @@
+/*
+ * This file contains an implementation of a MultiQueue (Rihani, Sanders and
+ * Dementiev, "MultiQueues: Simpler, Faster, and Better Relaxed Concurrent
+ * Priority Queues").  A single pq protected by one mutex serializes every
+ * thread on the heap root.  A MultiQueue instead keeps c * p ordinary pq
+ * instances for p threads, each with its own lock:
+ *
+ *   - mq_insert() puts the element into one randomly chosen queue.
+ *   - mq_remove_first() looks at the first priority of two randomly chosen
+ *     queues and removes from the better one ("two random choices").
+ *
+ * The element removed is not always the global minimum, but its expected rank
+ * among the elements in the structure is O(c * p), and threads rarely
+ * contend for the same lock.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <assert.h>
+#include <limits.h>
+#include <pthread.h>
+
+#include "mq.h"
+#include "pq.h"
+
+/*
+ * Priority cached for a sub-queue that is currently empty.  It is larger than
+ * any int priority, so empty queues always lose the two-choice comparison.
+ */
+#define MQ_EMPTY LLONG_MAX
+
+/*
+ * Number of random lock attempts mq_remove_first() makes before scanning all
+ * sub-queues to decide whether the whole structure is empty.
+ */
+#define MQ_MAX_ATTEMPTS 64
+
+/*
+ * This structure represents one sub-queue.  The priority of its first element
+ * is cached in `top` so that the two-choice comparison can read it without
+ * taking the lock.  Each sub-queue is padded to a cache line so that threads
+ * working on neighbouring queues don't false-share.
+ */
+struct mq_queue {
+    pthread_mutex_t lock;
+    struct pq* pq;
+    long long top;
+    int size;
+} __attribute__((aligned(64)));
+
+/*
+ * This structure represents an entire MultiQueue.
+ */
+struct mq {
+    struct mq_queue* queues;
+    int n_queues;
+};
+
+/*
+ * Per-thread random number generator state for picking sub-queues.  It is
+ * lazily seeded the first time a thread uses any MultiQueue.
+ */
+static __thread unsigned int rng_state;
+static unsigned int rng_next_seed = 0x9e3779b9;
+
+/*
+ * Helper function that returns a pseudo-random integer in [0, n) using a
+ * per-thread xorshift generator.
+ */
+static int random_queue(int n) {
+    unsigned int x = rng_state;
+    if (x == 0) {
+        x = __atomic_add_fetch(&rng_next_seed, 0x6d2b79f5, __ATOMIC_RELAXED);
+        x |= 1;
+    }
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return (int)(((unsigned long long)x * n) >> 32);
+}
+
+/*
+ * Helper function to refresh a sub-queue's cached first priority.  Must be
+ * called with the sub-queue's lock held.
+ */
+static void update_top(struct mq_queue* q) {
+    long long top = pq_isempty(q->pq) ? MQ_EMPTY : pq_first_priority(q->pq);
+    __atomic_store_n(&q->top, top, __ATOMIC_RELAXED);
+}
+
+/*
+ * This function allocates and initializes an empty MultiQueue sized for a
+ * given number of threads.
+ *
+ * Params:
+ *   n_threads - the number of threads expected to use the queue
+ *     concurrently.  Must be at least 1.
+ *   queues_per_thread - the number of sub-queues per thread (usually called
+ *     `c`).  Larger values reduce lock contention but increase how far the
+ *     removed element can be from the true minimum.  2 is a good default.
+ *     Must be at least 1.
+ *
+ * Return:
+ *   Returns a pointer to the new MultiQueue.
+ */
+struct mq* mq_create(int n_threads, int queues_per_thread) {
+    assert(n_threads > 0 && queues_per_thread > 0);
+    struct mq* mq = malloc(sizeof(struct mq));
+    assert(mq);
+
+    mq->n_queues = n_threads * queues_per_thread;
+    void* queues;
+    int err = posix_memalign(&queues, 64,
+        mq->n_queues * sizeof(struct mq_queue));
+    assert(err == 0);
+    mq->queues = queues;
+    for (int i = 0; i < mq->n_queues; i++) {
+        pthread_mutex_init(&mq->queues[i].lock, NULL);
+        mq->queues[i].pq = pq_create();
+        mq->queues[i].top = MQ_EMPTY;
+        mq->queues[i].size = 0;
+    }
+    return mq;
+}
+
+/*
+ * This function frees the memory allocated to a MultiQueue.  As with
+ * pq_free(), the values stored in the queue are not freed.  No other thread
+ * may be using the queue.
+ *
+ * Params:
+ *   mq - the MultiQueue to be destroyed.  May not be NULL.
+ */
+void mq_free(struct mq* mq) {
+    assert(mq);
+    for (int i = 0; i < mq->n_queues; i++) {
+        pthread_mutex_destroy(&mq->queues[i].lock);
+        pq_free(mq->queues[i].pq);
+    }
+    free(mq->queues);
+    free(mq);
+}
+
+/*
+ * This function returns the total number of sub-queues in a MultiQueue.
+ */
+int mq_num_queues(struct mq* mq) {
+    assert(mq);
+    return mq->n_queues;
+}
+
+/*
+ * This function returns the number of elements in a MultiQueue.  While other
+ * threads are inserting or removing, the result is only a snapshot.
+ */
+int mq_size(struct mq* mq) {
+    assert(mq);
+    int size = 0;
+    for (int i = 0; i < mq->n_queues; i++) {
+        size += __atomic_load_n(&mq->queues[i].size, __ATOMIC_RELAXED);
+    }
+    return size;
+}
+
+/*
+ * This function inserts an element into a randomly chosen sub-queue of a
+ * MultiQueue.  If the chosen sub-queue's lock is busy, another one is tried,
+ * so an insert never waits behind another thread.
+ *
+ * Params:
+ *   mq - the MultiQueue into which to insert an element.  May not be NULL.
+ *   value - the value to be inserted.
+ *   priority - the priority value of the element.  LOWER priority values are
+ *     removed FIRST.
+ */
+void mq_insert(struct mq* mq, void* value, int priority) {
+    assert(mq);
+    struct mq_queue* q;
+    do {
+        q = &mq->queues[random_queue(mq->n_queues)];
+    } while (pthread_mutex_trylock(&q->lock) != 0);
+
+    pq_insert(q->pq, value, priority);
+    __atomic_store_n(&q->size, q->size + 1, __ATOMIC_RELAXED);
+    update_top(q);
+    pthread_mutex_unlock(&q->lock);
+}
+
+/*
+ * This function removes an element with a low priority value from a
+ * MultiQueue.  Two sub-queues are chosen at random and the first element of
+ * the one with the lower cached priority is removed.  The element is not
+ * guaranteed to be the global minimum.
+ *
+ * If repeated random attempts only find empty sub-queues, every sub-queue is
+ * checked in turn before reporting the MultiQueue as empty.  Because other
+ * threads may be inserting at the same time, an empty result means only that
+ * the MultiQueue was empty at some point during the call.
+ *
+ * Params:
+ *   mq - the MultiQueue from which to remove an element.  May not be NULL.
+ *   value - pointer at which the removed element's value is stored.  May be
+ *     NULL if the value isn't needed.
+ *   priority - pointer at which the removed element's priority value is
+ *     stored.  May be NULL if the priority isn't needed.
+ *
+ * Return:
+ *   Returns 1 if an element was removed or 0 if the MultiQueue was empty.
+ */
+int mq_remove_first(struct mq* mq, void** value, int* priority) {
+    assert(mq);
+    for (int attempt = 0; ; attempt++) {
+        struct mq_queue* q;
+        if (attempt < MQ_MAX_ATTEMPTS) {
+            struct mq_queue* a = &mq->queues[random_queue(mq->n_queues)];
+            struct mq_queue* b = &mq->queues[random_queue(mq->n_queues)];
+            long long top_a = __atomic_load_n(&a->top, __ATOMIC_RELAXED);
+            long long top_b = __atomic_load_n(&b->top, __ATOMIC_RELAXED);
+            q = top_b < top_a ? b : a;
+            long long top = top_b < top_a ? top_b : top_a;
+            if (top == MQ_EMPTY || pthread_mutex_trylock(&q->lock) != 0) {
+                continue;
+            }
+        } else {
+            /*
+             * Random choices keep finding empty queues, so the MultiQueue is
+             * probably (nearly) empty.  Check every sub-queue.
+             */
+            int i;
+            for (i = 0; i < mq->n_queues; i++) {
+                q = &mq->queues[i];
+                pthread_mutex_lock(&q->lock);
+                if (!pq_isempty(q->pq)) {
+                    break;
+                }
+                pthread_mutex_unlock(&q->lock);
+            }
+            if (i == mq->n_queues) {
+                return 0;
+            }
+            attempt = 0;
+        }
+
+        if (pq_isempty(q->pq)) {
+            pthread_mutex_unlock(&q->lock);
+            continue;
+        }
+        if (priority) {
+            *priority = pq_first_priority(q->pq);
+        }
+        void* removed = pq_remove_first(q->pq);
+        if (value) {
+            *value = removed;
+        }
+        __atomic_store_n(&q->size, q->size - 1, __ATOMIC_RELAXED);
+        update_top(q);
+        pthread_mutex_unlock(&q->lock);
+        return 1;
+    }
+}
@@ -0,0 +1,27 @@
+/*
+ * This file contains the definition of the interface for a MultiQueue, a
+ * relaxed concurrent priority queue built from many independently-locked
+ * priority queues.  You can find descriptions of the MultiQueue functions,
+ * including their parameters and their return values, in mq.c.
+ */
+
+#ifndef __MQ_H
+#define __MQ_H
+
+/*
+ * Structure used to represent a MultiQueue.
+ */
+struct mq;
+
+/*
+ * MultiQueue interface function prototypes.  Refer to mq.c for documentation
+ * about each of these functions.
+ */
+struct mq* mq_create(int n_threads, int queues_per_thread);
+void mq_free(struct mq* mq);
+int mq_num_queues(struct mq* mq);
+int mq_size(struct mq* mq);
+void mq_insert(struct mq* mq, void* value, int priority);
+int mq_remove_first(struct mq* mq, void** value, int* priority);
+
+#endif
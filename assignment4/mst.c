@@ -0,0 +1,653 @@
+/*
+ * This file contains minimum spanning tree algorithms for the CSR graphs from
+ * graph.h.  Edge directions are ignored: an edge u -> v joins u and v either
+ * way.  If the graph is not connected, each function finds a minimum
+ * spanning forest, with one tree per connected component, so a graph with n
+ * nodes and c components gets n - c tree edges.  Weights may be negative.
+ *
+ * mst_naive() is Prim's algorithm in its textbook O(n^2) form, scanning
+ * every node for the closest one at each step, like the matrix version of
+ * Dijkstra's algorithm in dijkstra.c.  It is kept as a baseline.
+ *
+ * mst_prim() is Prim's algorithm driven by the rank-pairing heap from ph.c,
+ * using its decrease-key when a node gets closer to the tree.
+ *
+ * mst_kruskal() sorts the edges by weight in parallel (each thread radix
+ * sorts a run, then runs are merged in pairs, one pair per thread) and adds
+ * them in order, skipping any edge whose ends a union-find already joins.
+ *
+ * mst_boruvka() works in rounds.  In each, the threads find the lightest
+ * edge leaving every component, then join the components along those edges.
+ * Both steps run in parallel without locks: lightest edges are kept with an
+ * atomic minimum, and the union-find links roots with compare-and-swap.
+ * Each round at least halves the number of components, and edges inside a
+ * component are dropped as they are found, so later rounds are cheaper.
+ *
+ * Kruskal and Borůvka break ties between equal weights by edge number, so
+ * the tree is unique and both return the same edges.  Every function
+ * returns a tree of the same total weight.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "mst.h"
+#include "ph.h"
+#include "bitset.h"
+
+/*
+ * Key of a component with no lightest edge yet.
+ */
+#define NO_EDGE ULLONG_MAX
+
+/*
+ * Helper function to pack an edge's weight and number into one key, so that
+ * keys order edges by weight and then by number.  The weight's sign bit is
+ * flipped so negative weights sort below positive ones.
+ */
+static unsigned long long edge_key(int weight, int e) {
+    return (unsigned long long)((unsigned int)weight ^ 0x80000000u) << 32 |
+        (unsigned int)e;
+}
+
+/*
+ * Helper function to run fn(&args[i]) on n threads and wait for all of them.
+ * args is an array of n elements of the given size.
+ */
+static void run_threads(void* (*fn)(void*), void* args, size_t size, int n) {
+    if (n == 1) {
+        fn(args);
+        return;
+    }
+    pthread_t* threads = malloc(n * sizeof(pthread_t));
+    assert(threads);
+    for (int i = 0; i < n; i++) {
+        pthread_create(&threads[i], NULL, fn, (char*)args + i * size);
+    }
+    for (int i = 0; i < n; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+}
+
+/*
+ * Helper function to return an array holding the source node of every edge.
+ */
+static int* edge_sources(struct graph* graph) {
+    int* sources = malloc(graph->n_edges * sizeof(int));
+    assert(sources);
+    for (int u = 0; u < graph->n_nodes; u++) {
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            sources[e] = u;
+        }
+    }
+    return sources;
+}
+
+/*
+ * This function returns the total weight of a spanning tree.
+ *
+ * Params:
+ *   tree - the tree's edges.
+ *   n_edges - the number of edges in the tree.
+ */
+long long mst_weight(struct mst_edge* tree, int n_edges) {
+    long long total = 0;
+    for (int i = 0; i < n_edges; i++) {
+        total += tree[i].weight;
+    }
+    return total;
+}
+
+/*****************************************************************************
+ **
+ ** Prim
+ **
+ *****************************************************************************/
+
+/*
+ * This function finds a minimum spanning forest with the O(n^2) version of
+ * Prim's algorithm.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.
+ *   tree - array of at least graph->n_nodes - 1 entries that receives the
+ *     edges of the forest.
+ *
+ * Return:
+ *   Returns the number of edges in the forest.
+ */
+int mst_naive(struct graph* graph, struct mst_edge* tree) {
+    assert(graph && tree);
+    int n = graph->n_nodes;
+    struct graph* transpose = graph_transpose(graph);
+    struct graph* sides[2] = {graph, transpose};
+    long long* key = malloc(n * sizeof(long long));
+    int* parent = malloc(n * sizeof(int));
+    struct bitset* in_tree = bitset_create(n);
+    assert(key && parent);
+    for (int v = 0; v < n; v++) {
+        key[v] = LLONG_MAX;
+        parent[v] = -1;
+    }
+
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        // find the closest node not in the tree, or any one to start a new
+        // tree if none is joined to the tree
+        int u = -1;
+        for (int v = 0; v < n; v++) {
+            if (!bitset_test(in_tree, v) && (u == -1 || key[v] < key[u])) {
+                u = v;
+            }
+        }
+        bitset_set(in_tree, u);
+        if (parent[u] >= 0) {
+            tree[count].u = parent[u];
+            tree[count].v = u;
+            tree[count++].weight = (int)key[u];
+        }
+
+        for (int s = 0; s < 2; s++) {
+            struct graph* side = sides[s];
+            for (int e = side->offsets[u]; e < side->offsets[u + 1]; e++) {
+                int v = side->targets[e];
+                if (!bitset_test(in_tree, v) && side->weights[e] < key[v]) {
+                    key[v] = side->weights[e];
+                    parent[v] = u;
+                }
+            }
+        }
+    }
+
+    free(key);
+    free(parent);
+    bitset_free(in_tree);
+    graph_free(transpose);
+    return count;
+}
+
+/*
+ * This function finds a minimum spanning forest with Prim's algorithm,
+ * using a rank-pairing heap with decrease-key.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.
+ *   tree - array of at least graph->n_nodes - 1 entries that receives the
+ *     edges of the forest.
+ *
+ * Return:
+ *   Returns the number of edges in the forest.
+ */
+int mst_prim(struct graph* graph, struct mst_edge* tree) {
+    assert(graph && tree);
+    int n = graph->n_nodes;
+    struct graph* transpose = graph_transpose(graph);
+    struct graph* sides[2] = {graph, transpose};
+    struct ph_node** handle = calloc(n, sizeof(struct ph_node*));
+    int* parent = malloc(n * sizeof(int));
+    struct bitset* in_tree = bitset_create(n);
+    assert(handle && parent);
+    struct ph* ph = ph_create();
+
+    int count = 0;
+    for (int root = 0; root < n; root++) {
+        if (bitset_test(in_tree, root)) {
+            continue;
+        }
+        parent[root] = -1;
+        handle[root] = ph_insert(ph, (void*)(long)root, 0);
+        while (!ph_isempty(ph)) {
+            int w = ph_first_priority(ph);
+            int u = (int)(long)ph_remove_first(ph);
+            bitset_set(in_tree, u);
+            if (parent[u] >= 0) {
+                tree[count].u = parent[u];
+                tree[count].v = u;
+                tree[count++].weight = w;
+            }
+
+            for (int s = 0; s < 2; s++) {
+                struct graph* side = sides[s];
+                for (int e = side->offsets[u]; e < side->offsets[u + 1]; e++) {
+                    int v = side->targets[e];
+                    if (bitset_test(in_tree, v)) {
+                        continue;
+                    }
+                    if (handle[v] == NULL) {
+                        handle[v] = ph_insert(ph, (void*)(long)v,
+                            side->weights[e]);
+                        parent[v] = u;
+                    } else if (side->weights[e] <
+                            ph_node_priority(handle[v])) {
+                        ph_decrease_priority(ph, handle[v], side->weights[e]);
+                        parent[v] = u;
+                    }
+                }
+            }
+        }
+    }
+
+    ph_free(ph);
+    free(handle);
+    free(parent);
+    bitset_free(in_tree);
+    graph_free(transpose);
+    return count;
+}
+
+/*****************************************************************************
+ **
+ ** Lock-free union-find
+ **
+ *****************************************************************************/
+
+/*
+ * The union-find keeps a parent for every node, with roots their own
+ * parents.  Any number of threads may call uf_find() and uf_union() at once.
+ * A root is only ever linked below a root with a smaller number, so links
+ * can't form a cycle, and a parent is only ever replaced by one of its own
+ * ancestors, so every parent still leads to the same root.
+ */
+
+/*
+ * Helper function to return the root of x's set, halving the path to it on
+ * the way.  A failed halving step is simply skipped.
+ */
+static int uf_find(int* parent, int x) {
+    for (;;) {
+        int p = __atomic_load_n(&parent[x], __ATOMIC_RELAXED);
+        if (p == x) {
+            return x;
+        }
+        int gp = __atomic_load_n(&parent[p], __ATOMIC_RELAXED);
+        if (gp != p) {
+            __atomic_compare_exchange_n(&parent[x], &p, gp, 0,
+                __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        }
+        x = gp;
+    }
+}
+
+/*
+ * Helper function to join the sets of a and b.
+ *
+ * Return:
+ *   Returns 1 if they were joined, or 0 if they were already the same set.
+ */
+static int uf_union(int* parent, int a, int b) {
+    for (;;) {
+        a = uf_find(parent, a);
+        b = uf_find(parent, b);
+        if (a == b) {
+            return 0;
+        }
+        if (a < b) {
+            int t = a;
+            a = b;
+            b = t;
+        }
+        int expected = a;
+        if (__atomic_compare_exchange_n(&parent[a], &expected, b, 0,
+                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            return 1;
+        }
+    }
+}
+
+/*
+ * Helper function to allocate a union-find with every node in its own set.
+ */
+static int* uf_create(int n) {
+    int* parent = malloc(n * sizeof(int));
+    assert(parent);
+    for (int v = 0; v < n; v++) {
+        parent[v] = v;
+    }
+    return parent;
+}
+
+/*****************************************************************************
+ **
+ ** Kruskal
+ **
+ *****************************************************************************/
+
+/*
+ * Keys are sorted by radix sort, RADIX_BITS bits at a time.
+ */
+#define RADIX_BITS 16
+
+/*
+ * One thread's share of the parallel sort.  In the first pass it fills in
+ * and sorts from[lo, hi), using to[lo, hi) as scratch space; in each merge
+ * pass it merges the sorted runs from[lo, mid) and from[mid, hi) into
+ * to[lo, hi).
+ */
+struct sort_job {
+    struct graph* graph;
+    unsigned long long* from;
+    unsigned long long* to;
+    long lo;
+    long mid;
+    long hi;
+};
+
+/*
+ * Sorts the thread's keys with a least-significant-digit radix sort.  A
+ * digit that is the same in every key, such as the high bits of the edge
+ * numbers, is skipped.
+ */
+static void* sort_run(void* arg) {
+    struct sort_job* job = arg;
+    long n = job->hi - job->lo;
+    unsigned long long* a = job->from + job->lo;
+    unsigned long long* b = job->to + job->lo;
+    for (long i = 0; i < n; i++) {
+        a[i] = edge_key(job->graph->weights[job->lo + i], (int)(job->lo + i));
+    }
+
+    long* count = malloc((1 << RADIX_BITS) * sizeof(long));
+    assert(count);
+    for (int shift = 0; shift < 64; shift += RADIX_BITS) {
+        memset(count, 0, (1 << RADIX_BITS) * sizeof(long));
+        for (long i = 0; i < n; i++) {
+            count[(a[i] >> shift) & ((1 << RADIX_BITS) - 1)]++;
+        }
+        if (n == 0 || count[(a[0] >> shift) & ((1 << RADIX_BITS) - 1)] == n) {
+            continue;
+        }
+        long sum = 0;
+        for (int d = 0; d < 1 << RADIX_BITS; d++) {
+            long c = count[d];
+            count[d] = sum;
+            sum += c;
+        }
+        for (long i = 0; i < n; i++) {
+            b[count[(a[i] >> shift) & ((1 << RADIX_BITS) - 1)]++] = a[i];
+        }
+        unsigned long long* t = a;
+        a = b;
+        b = t;
+    }
+    if (a != job->from + job->lo) {
+        memcpy(job->from + job->lo, a, n * sizeof(unsigned long long));
+    }
+    free(count);
+    return NULL;
+}
+
+static void* merge_runs(void* arg) {
+    struct sort_job* job = arg;
+    long i = job->lo, j = job->mid, k = job->lo;
+    while (i < job->mid && j < job->hi) {
+        job->to[k++] = job->from[j] < job->from[i] ? job->from[j++] :
+            job->from[i++];
+    }
+    while (i < job->mid) {
+        job->to[k++] = job->from[i++];
+    }
+    while (j < job->hi) {
+        job->to[k++] = job->from[j++];
+    }
+    return NULL;
+}
+
+/*
+ * Helper function to return the keys of every edge in sorted order.  Each
+ * of n_threads threads sorts one run, and the runs are then merged in pairs
+ * until one is left.
+ */
+static unsigned long long* sort_edges(struct graph* graph, int n_threads) {
+    long m = graph->n_edges;
+    unsigned long long* keys = malloc(m * sizeof(unsigned long long));
+    unsigned long long* other = malloc(m * sizeof(unsigned long long));
+    struct sort_job* jobs = malloc(n_threads * sizeof(struct sort_job));
+    long* bounds = malloc((n_threads + 1) * sizeof(long));
+    assert(keys && other && jobs && bounds);
+
+    for (int i = 0; i <= n_threads; i++) {
+        bounds[i] = m * i / n_threads;
+    }
+    for (int i = 0; i < n_threads; i++) {
+        jobs[i].graph = graph;
+        jobs[i].from = keys;
+        jobs[i].to = other;
+        jobs[i].lo = bounds[i];
+        jobs[i].hi = bounds[i + 1];
+    }
+    run_threads(sort_run, jobs, sizeof(struct sort_job), n_threads);
+
+    /*
+     * Merge runs 2i and 2i + 1 into run i.  An odd run out is merged with
+     * an empty one, which just copies it across.
+     */
+    int n_runs = n_threads;
+    while (n_runs > 1) {
+        int n_jobs = (n_runs + 1) / 2;
+        for (int i = 0; i < n_jobs; i++) {
+            jobs[i].from = keys;
+            jobs[i].to = other;
+            jobs[i].lo = bounds[2 * i];
+            jobs[i].mid = bounds[2 * i + 1];
+            jobs[i].hi = 2 * i + 2 <= n_runs ? bounds[2 * i + 2] :
+                bounds[2 * i + 1];
+        }
+        run_threads(merge_runs, jobs, sizeof(struct sort_job), n_jobs);
+        for (int i = 0; i < n_jobs; i++) {
+            bounds[i] = jobs[i].lo;
+        }
+        bounds[n_jobs] = m;
+        n_runs = n_jobs;
+        unsigned long long* t = keys;
+        keys = other;
+        other = t;
+    }
+
+    free(other);
+    free(jobs);
+    free(bounds);
+    return keys;
+}
+
+/*
+ * This function finds a minimum spanning forest with Kruskal's algorithm,
+ * sorting the edges in parallel.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.
+ *   n_threads - the number of threads to sort with.
+ *   tree - array of at least graph->n_nodes - 1 entries that receives the
+ *     edges of the forest, lightest first.
+ *
+ * Return:
+ *   Returns the number of edges in the forest.
+ */
+int mst_kruskal(struct graph* graph, int n_threads, struct mst_edge* tree) {
+    assert(graph && tree);
+    if (n_threads < 1) {
+        n_threads = 1;
+    }
+    int n = graph->n_nodes, m = graph->n_edges;
+    unsigned long long* keys = sort_edges(graph, n_threads);
+    int* sources = edge_sources(graph);
+    int* parent = uf_create(n);
+
+    int count = 0;
+    for (int i = 0; i < m && count < n - 1; i++) {
+        int e = (int)(keys[i] & 0xffffffffu);
+        int u = sources[e], v = graph->targets[e];
+        if (uf_union(parent, u, v)) {
+            tree[count].u = u;
+            tree[count].v = v;
+            tree[count++].weight = graph->weights[e];
+        }
+    }
+
+    free(keys);
+    free(sources);
+    free(parent);
+    return count;
+}
+
+/*****************************************************************************
+ **
+ ** Borůvka
+ **
+ *****************************************************************************/
+
+/*
+ * State shared by the threads of mst_boruvka().  best[c] is the key of the
+ * lightest edge leaving component c found so far in this round.
+ */
+struct boruvka {
+    struct graph* graph;
+    int* sources;
+    int* parent;
+    unsigned long long* best;
+    int* edges;
+    struct mst_edge* tree;
+    int count;
+};
+
+/*
+ * State for one thread of mst_boruvka().  The thread owns the edges listed
+ * in b->edges[lo, lo + live) and the components rooted in [node_lo,
+ * node_hi).
+ */
+struct boruvka_thread {
+    struct boruvka* b;
+    long lo;
+    long live;
+    int node_lo;
+    int node_hi;
+    int added;
+};
+
+/*
+ * Offers each of the thread's edges as the lightest edge leaving the
+ * components at both its ends, and drops the ones inside a component for
+ * good.
+ */
+static void* find_lightest(void* arg) {
+    struct boruvka_thread* t = arg;
+    struct boruvka* b = t->b;
+    int* edges = b->edges + t->lo;
+    long kept = 0;
+    for (long i = 0; i < t->live; i++) {
+        int e = edges[i];
+        int cu = uf_find(b->parent, b->sources[e]);
+        int cv = uf_find(b->parent, b->graph->targets[e]);
+        if (cu == cv) {
+            continue;
+        }
+        edges[kept++] = e;
+        unsigned long long key = edge_key(b->graph->weights[e], e);
+        int ends[2] = {cu, cv};
+        for (int k = 0; k < 2; k++) {
+            unsigned long long* p = &b->best[ends[k]];
+            unsigned long long old = __atomic_load_n(p, __ATOMIC_RELAXED);
+            while (key < old && !__atomic_compare_exchange_n(p, &old, key,
+                    1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            }
+        }
+    }
+    t->live = kept;
+    return NULL;
+}
+
+/*
+ * Joins each of the thread's components along its lightest edge.  When two
+ * components pick the same edge, only the first join succeeds, so every
+ * edge is added once.
+ */
+static void* join_components(void* arg) {
+    struct boruvka_thread* t = arg;
+    struct boruvka* b = t->b;
+    t->added = 0;
+    for (int c = t->node_lo; c < t->node_hi; c++) {
+        if (b->best[c] == NO_EDGE) {
+            continue;
+        }
+        int e = (int)(b->best[c] & 0xffffffffu);
+        b->best[c] = NO_EDGE;
+        int u = b->sources[e], v = b->graph->targets[e];
+        if (uf_union(b->parent, u, v)) {
+            int i = __atomic_fetch_add(&b->count, 1, __ATOMIC_RELAXED);
+            b->tree[i].u = u;
+            b->tree[i].v = v;
+            b->tree[i].weight = b->graph->weights[e];
+            t->added++;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * This function finds a minimum spanning forest with Borůvka's algorithm,
+ * using a lock-free union-find.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.
+ *   n_threads - the number of threads to use.
+ *   tree - array of at least graph->n_nodes - 1 entries that receives the
+ *     edges of the forest, in no particular order.
+ *
+ * Return:
+ *   Returns the number of edges in the forest.
+ */
+int mst_boruvka(struct graph* graph, int n_threads, struct mst_edge* tree) {
+    assert(graph && tree);
+    if (n_threads < 1) {
+        n_threads = 1;
+    }
+    int n = graph->n_nodes, m = graph->n_edges;
+    struct boruvka b;
+    b.graph = graph;
+    b.sources = edge_sources(graph);
+    b.parent = uf_create(n);
+    b.best = malloc(n * sizeof(unsigned long long));
+    b.edges = malloc(m * sizeof(int));
+    assert(b.best && b.edges);
+    memset(b.best, 0xff, n * sizeof(unsigned long long));
+    for (int e = 0; e < m; e++) {
+        b.edges[e] = e;
+    }
+    b.tree = tree;
+    b.count = 0;
+
+    struct boruvka_thread* threads = malloc(n_threads *
+        sizeof(struct boruvka_thread));
+    assert(threads);
+    for (int i = 0; i < n_threads; i++) {
+        threads[i].b = &b;
+        threads[i].lo = (long)m * i / n_threads;
+        threads[i].live = (long)m * (i + 1) / n_threads - threads[i].lo;
+        threads[i].node_lo = (int)((long)n * i / n_threads);
+        threads[i].node_hi = (int)((long)n * (i + 1) / n_threads);
+    }
+
+    int added;
+    do {
+        run_threads(find_lightest, threads, sizeof(struct boruvka_thread),
+            n_threads);
+        run_threads(join_components, threads, sizeof(struct boruvka_thread),
+            n_threads);
+        added = 0;
+        for (int i = 0; i < n_threads; i++) {
+            added += threads[i].added;
+        }
+    } while (added > 0);
+
+    free(threads);
+    free(b.sources);
+    free(b.parent);
+    free(b.best);
+    free(b.edges);
+    return b.count;
+}
@@ -0,0 +1,32 @@
+/*
+ * This file contains the definition of the interface for finding minimum
+ * spanning trees.  You can find descriptions of the functions, including
+ * their parameters and their return values, in mst.c.
+ */
+
+#ifndef __MST_H
+#define __MST_H
+
+#include "graph.h"
+
+/*
+ * Structure used to represent one edge of a spanning tree, joining nodes u
+ * and v.
+ */
+struct mst_edge {
+  int u;
+  int v;
+  int weight;
+};
+
+/*
+ * Minimum spanning tree interface function prototypes.  Refer to mst.c for
+ * documentation about each of these functions.
+ */
+int mst_naive(struct graph* graph, struct mst_edge* tree);
+int mst_prim(struct graph* graph, struct mst_edge* tree);
+int mst_kruskal(struct graph* graph, int n_threads, struct mst_edge* tree);
+int mst_boruvka(struct graph* graph, int n_threads, struct mst_edge* tree);
+long long mst_weight(struct mst_edge* tree, int n_edges);
+
+#endif
@@ -0,0 +1,410 @@
+/*
+ * This file contains an implementation of a rank-pairing heap (Haeupler, Sen
+ * and Tarjan, "Rank-Pairing Heaps"), a variant of the pairing heap.  Like the
+ * array heap in pq.c, it is a min-priority queue (LOWER priority values come
+ * out FIRST), but it is built from heap-ordered trees instead of an array.
+ * That makes two operations cheap that the array heap can't do well:
+ *
+ *   - ph_meld() merges two whole heaps in O(1) by splicing their lists of
+ *     trees together.
+ *   - ph_decrease_priority() cuts a node out of its tree and makes it a new
+ *     tree in O(1) amortized time.
+ *
+ * ph_remove_first() is O(log n) amortized.
+ *
+ * A plain pairing heap does the same things with less bookkeeping, but its
+ * decrease-key is not O(1) amortized: the best known bound is
+ * O(2^(2 sqrt(log log n))) (Pettie), and Fredman showed that pairing heaps
+ * can't do better than O(log log n).  Rank-pairing heaps get O(1) by giving
+ * every node a rank and linking only trees of equal rank, as Fibonacci heaps
+ * do, but without the cascading cuts.
+ *
+ * Each tree is stored as a binary "half tree": a node's priority is no
+ * larger than any in its LEFT subtree, while its right subtree is
+ * unconstrained, and the root of a half tree has no right child.  (This is
+ * the usual child/sibling representation of a multiway heap-ordered tree.)
+ * The roots are kept in a circular list through their `right` pointers, and
+ * the heap points to the root with the lowest priority.
+ *
+ * Ranks follow the "type-1" rule: a missing child has rank -1, a root has
+ * rank one more than its left child, and any other node with children of
+ * ranks r1 and r2 has rank r1 + 1 if r1 == r2 and max(r1, r2) otherwise.
+ * A half tree of rank k then holds at least F(k + 2) nodes (Fibonacci
+ * numbers), so ranks stay below MAX_RANK for any heap of int-many nodes.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "ph.h"
+
+/*
+ * A half tree of rank 45 would hold at least F(47) > INT_MAX nodes, so ranks
+ * stay well below this.
+ */
+#define MAX_RANK 48
+
+/*
+ * This structure represents a single node in the heap.  For a root, `right`
+ * is the next root in the heap's root list and `parent` is NULL.
+ */
+struct ph_node {
+    void* value;
+    int priority;
+    int rank;
+    struct ph_node* left;
+    struct ph_node* right;
+    struct ph_node* parent;
+};
+
+/*
+ * This structure represents an entire rank-pairing heap.  `root` is the root
+ * with the lowest priority, or NULL if the heap is empty.  `buckets` is
+ * scratch space for ph_remove_first(), and is all NULL between calls.
+ */
+struct ph {
+    struct ph_node* root;
+    int size;
+    struct ph_node* buckets[MAX_RANK];
+};
+
+static int rank_of(struct ph_node* node) {
+    return node ? node->rank : -1;
+}
+
+/*
+ * Helper function to add a detached node (with no parent and no right
+ * child) to a heap's root list.
+ */
+static void add_root(struct ph* ph, struct ph_node* node) {
+    if (ph->root == NULL) {
+        node->right = node;
+        ph->root = node;
+        return;
+    }
+    node->right = ph->root->right;
+    ph->root->right = node;
+    if (node->priority < ph->root->priority) {
+        ph->root = node;
+    }
+}
+
+/*
+ * Helper function to link two half trees with roots `a` and `b`, which must
+ * have the same rank.  The root with the larger priority becomes the left
+ * child of the other one, whose old left subtree becomes its right subtree,
+ * and the root of the combined half tree is returned.
+ */
+static struct ph_node* link(struct ph_node* a, struct ph_node* b) {
+    if (b->priority < a->priority) {
+        struct ph_node* temp = a;
+        a = b;
+        b = temp;
+    }
+    b->right = a->left;
+    if (a->left) {
+        a->left->parent = b;
+    }
+    b->parent = a;
+    a->left = b;
+    a->rank = b->rank + 1;
+    return a;
+}
+
+/*
+ * This function allocates and initializes an empty pairing heap and returns
+ * a pointer to it.
+ */
+struct ph* ph_create() {
+    struct ph* ph = calloc(1, sizeof(struct ph));
+    assert(ph);
+    return ph;
+}
+
+/*
+ * This function frees the memory allocated to a given pairing heap, including
+ * all of its nodes.  Any handles returned by ph_insert() become invalid.  As
+ * with pq_free(), the values stored in the heap are not freed.
+ *
+ * Params:
+ *   ph - the pairing heap to be destroyed.  May not be NULL.
+ */
+void ph_free(struct ph* ph) {
+    assert(ph);
+
+    /*
+     * Once the root list is cut open into a chain through `right`, the whole
+     * heap is one binary tree.  It is freed with an explicit stack linked
+     * through `parent`.
+     */
+    struct ph_node* stack = NULL;
+    if (ph->root) {
+        stack = ph->root->right;
+        ph->root->right = NULL;
+        stack->parent = NULL;
+    }
+    while (stack != NULL) {
+        struct ph_node* node = stack;
+        stack = node->parent;
+        if (node->left) {
+            node->left->parent = stack;
+            stack = node->left;
+        }
+        if (node->right) {
+            node->right->parent = stack;
+            stack = node->right;
+        }
+        free(node);
+    }
+    free(ph);
+}
+
+/*
+ * This function returns 1 if the specified pairing heap is empty and 0
+ * otherwise.
+ *
+ * Params:
+ *   ph - the pairing heap whose emptiness is to be checked.  May not be NULL.
+ */
+int ph_isempty(struct ph* ph) {
+    assert(ph);
+    return ph->root == NULL;
+}
+
+/*
+ * This function returns the number of elements stored in a pairing heap.
+ *
+ * Params:
+ *   ph - the pairing heap whose elements are to be counted.  May not be NULL.
+ */
+int ph_size(struct ph* ph) {
+    assert(ph);
+    return ph->size;
+}
+
+/*
+ * This function inserts a given element into a pairing heap with a specified
+ * priority value.  LOWER priority values are returned FIRST.
+ *
+ * Params:
+ *   ph - the pairing heap into which to insert an element.  May not be NULL.
+ *   value - the value to be inserted into ph.
+ *   priority - the priority value to be assigned to the new element.
+ *
+ * Return:
+ *   Returns a handle to the new element, which stays valid until the element
+ *   is removed with ph_remove_first() or the heap holding it is freed.  It
+ *   can be passed to ph_decrease_priority().
+ */
+struct ph_node* ph_insert(struct ph* ph, void* value, int priority) {
+    assert(ph);
+    struct ph_node* node = malloc(sizeof(struct ph_node));
+    assert(node);
+    node->value = value;
+    node->priority = priority;
+    node->rank = 0;
+    node->left = node->parent = NULL;
+
+    add_root(ph, node);
+    ph->size++;
+    return node;
+}
+
+/*
+ * This function returns the value of the first item in a pairing heap, i.e.
+ * the item with LOWEST priority value.
+ *
+ * Params:
+ *   ph - the pairing heap from which to fetch a value.  May not be NULL or
+ *     empty.
+ */
+void* ph_first(struct ph* ph) {
+    assert(!ph_isempty(ph));
+    return ph->root->value;
+}
+
+/*
+ * This function returns the priority value of the first item in a pairing
+ * heap, i.e. the item with LOWEST priority value.
+ *
+ * Params:
+ *   ph - the pairing heap from which to fetch a priority value.  May not be
+ *     NULL or empty.
+ */
+int ph_first_priority(struct ph* ph) {
+    assert(!ph_isempty(ph));
+    return ph->root->priority;
+}
+
+/*
+ * Helper function for ph_remove_first() to put a half tree into the bucket
+ * for its rank, or, if that bucket already holds one, to link the two and
+ * push the result onto the list `*linked` through `right`.  Returns the
+ * larger of `max_rank` and the tree's rank.
+ */
+static int bucket_tree(struct ph* ph, struct ph_node* node,
+        struct ph_node** linked, int max_rank) {
+    int rank = node->rank;
+    assert(rank < MAX_RANK);
+    if (ph->buckets[rank] == NULL) {
+        ph->buckets[rank] = node;
+        return rank > max_rank ? rank : max_rank;
+    }
+    node = link(ph->buckets[rank], node);
+    ph->buckets[rank] = NULL;
+    node->right = *linked;
+    *linked = node;
+    return max_rank;
+}
+
+/*
+ * This function returns the value of the first item in a pairing heap, i.e.
+ * the item with LOWEST priority value, and then removes that item from the
+ * heap.  The handle for the removed item becomes invalid.
+ *
+ * The half trees left behind are the other roots and the nodes on the right
+ * spine of the removed root's left child, each with its left subtree.  They
+ * are linked in one pass: each one goes into a bucket by rank, and when two
+ * meet in a bucket they are linked and set aside, without trying to link the
+ * result again.
+ *
+ * Params:
+ *   ph - the pairing heap from which to remove a value.  May not be NULL or
+ *     empty.
+ */
+void* ph_remove_first(struct ph* ph) {
+    assert(!ph_isempty(ph));
+    struct ph_node* root = ph->root;
+    void* value = root->value;
+
+    struct ph_node* linked = NULL;
+    int max_rank = -1;
+    struct ph_node* node = root->right;
+    while (node != root) {
+        struct ph_node* next = node->right;
+        max_rank = bucket_tree(ph, node, &linked, max_rank);
+        node = next;
+    }
+    node = root->left;
+    while (node != NULL) {
+        struct ph_node* next = node->right;
+        node->parent = node->right = NULL;
+        node->rank = rank_of(node->left) + 1;
+        max_rank = bucket_tree(ph, node, &linked, max_rank);
+        node = next;
+    }
+    free(root);
+
+    ph->root = NULL;
+    while (linked != NULL) {
+        struct ph_node* next = linked->right;
+        add_root(ph, linked);
+        linked = next;
+    }
+    for (int k = 0; k <= max_rank; k++) {
+        if (ph->buckets[k]) {
+            add_root(ph, ph->buckets[k]);
+            ph->buckets[k] = NULL;
+        }
+    }
+    ph->size--;
+    return value;
+}
+
+/*
+ * This function lowers the priority value of an element already stored in a
+ * pairing heap.  Unless the element is a root, it is cut out of its tree
+ * together with its left subtree, which becomes a new tree, and its right
+ * subtree takes its place.  The ranks of its former ancestors are then
+ * lowered to fit their new children, stopping at the first one whose rank
+ * doesn't change; the rank-pairing heap analysis shows this walk is O(1)
+ * amortized.
+ *
+ * Params:
+ *   ph - the pairing heap containing `node`.  May not be NULL.
+ *   node - a handle returned by ph_insert() for an element still in `ph`.
+ *   priority - the new priority value for the element.  Must be less than or
+ *     equal to the element's current priority value.
+ */
+void ph_decrease_priority(struct ph* ph, struct ph_node* node, int priority) {
+    assert(ph && node);
+    assert(priority <= node->priority);
+    node->priority = priority;
+    if (node->parent == NULL) {
+        if (priority < ph->root->priority) {
+            ph->root = node;
+        }
+        return;
+    }
+
+    struct ph_node* parent = node->parent;
+    if (parent->left == node) {
+        parent->left = node->right;
+    } else {
+        parent->right = node->right;
+    }
+    if (node->right) {
+        node->right->parent = parent;
+    }
+    node->parent = NULL;
+    node->rank = rank_of(node->left) + 1;
+    add_root(ph, node);
+
+    for (struct ph_node* u = parent; ; u = u->parent) {
+        if (u->parent == NULL) {
+            u->rank = rank_of(u->left) + 1;
+            break;
+        }
+        int r1 = rank_of(u->left), r2 = rank_of(u->right);
+        int rank = r1 == r2 ? r1 + 1 : r1 > r2 ? r1 : r2;
+        if (rank >= u->rank) {
+            break;
+        }
+        u->rank = rank;
+    }
+}
+
+/*
+ * This function moves every element of `other` into `ph` in O(1) time by
+ * splicing the two root lists together.  Afterwards `other` is empty, but it
+ * must still be freed with ph_free().  Handles to elements that were in
+ * `other` stay valid and now refer to elements of `ph`.
+ *
+ * Params:
+ *   ph - the pairing heap that receives the elements.  May not be NULL.
+ *   other - the pairing heap whose elements are moved.  May not be NULL and
+ *     may not be the same heap as `ph`.
+ */
+void ph_meld(struct ph* ph, struct ph* other) {
+    assert(ph && other && ph != other);
+    if (other->root == NULL) {
+        return;
+    }
+    if (ph->root == NULL) {
+        ph->root = other->root;
+    } else {
+        struct ph_node* next = ph->root->right;
+        ph->root->right = other->root->right;
+        other->root->right = next;
+        if (other->root->priority < ph->root->priority) {
+            ph->root = other->root;
+        }
+    }
+    ph->size += other->size;
+    other->root = NULL;
+    other->size = 0;
+}
+
+/*
+ * These functions return the value and the current priority value of the
+ * element referred to by a handle returned from ph_insert().
+ */
+void* ph_node_value(struct ph_node* node) {
+    assert(node);
+    return node->value;
+}
+
+int ph_node_priority(struct ph_node* node) {
+    assert(node);
+    return node->priority;
+}
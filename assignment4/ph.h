@@ -0,0 +1,39 @@
+/*
+ * This file contains the definition of the interface for a rank-pairing heap,
+ * a meldable priority queue.  You can find descriptions of the heap
+ * functions, including their parameters and their return values, in ph.c.
+ */
+
+#ifndef __PH_H
+#define __PH_H
+
+/*
+ * Structure used to represent a rank-pairing heap.
+ */
+struct ph;
+
+/*
+ * Structure used to represent a single element stored in a rank-pairing heap.
+ * Pointers to these are returned by ph_insert() and act as handles that can
+ * be passed to ph_decrease_priority().
+ */
+struct ph_node;
+
+/*
+ * Rank-pairing heap interface function prototypes.  Refer to ph.c for
+ * documentation about each of these functions.
+ */
+struct ph* ph_create();
+void ph_free(struct ph* ph);
+int ph_isempty(struct ph* ph);
+int ph_size(struct ph* ph);
+struct ph_node* ph_insert(struct ph* ph, void* value, int priority);
+void* ph_first(struct ph* ph);
+int ph_first_priority(struct ph* ph);
+void* ph_remove_first(struct ph* ph);
+void ph_decrease_priority(struct ph* ph, struct ph_node* node, int priority);
+void ph_meld(struct ph* ph, struct ph* other);
+void* ph_node_value(struct ph_node* node);
+int ph_node_priority(struct ph_node* node);
+
+#endif
@@ -10,23 +10,61 @@
 
 #include <stdlib.h>
 #include <assert.h>
+#include <limits.h>
 
 #include "pq.h"
 #include "dynarray.h"
 
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 /*
  * This is the structure that represents a priority queue.  You must define
  * this struct to contain the data needed to implement a priority queue.
+ *
+ * Each node stores a single 64-bit `key` that combines the element's priority
+ * with its insertion sequence number:
+ *
+ *   key = priority * 2^seq_bits + (seq mod 2^seq_bits)
+ *
+ * Comparing keys therefore orders elements by priority and, among equal
+ * priorities, by insertion order (FIFO), with a single comparison per step
+ * of a sift.  The sequence number wraps after 2^seq_bits insertions, so FIFO
+ * order is only guaranteed among equal-priority elements inserted fewer than
+ * 2^seq_bits insertions apart.
+ *
+ * A bounded queue (see pq_create_bounded()) has a non-zero `bound` and keeps
+ * at most that many elements in a max-heap.  It stores the bitwise complement
+ * of each key, which reverses the key order, so the same min-heap sift code
+ * serves both modes.  `threshold` caches the priority of a full bounded
+ * queue's root (the largest one kept), or LLONG_MAX while it is not full.
+ *
+ * Nodes of removed elements are kept on the `spare` list (linked through
+ * their `value` fields) and reused by later insertions, so a queue that is
+ * filled and drained over and over, as in repeated shortest-path searches,
+ * stops calling malloc() once it has reached its largest size.
  */
 struct pq_node {
     void* value;
-    int priority;
+    long long key;
 };
 
 struct pq {
     struct dynarray* data;
+    struct pq_node* spare;
+    unsigned long long seq;
+    int seq_bits;
+    int bound;
+    long long threshold;
 };
 
+/*
+ * Number of sequence bits used by pq_create().  With 32 sequence bits every
+ * int priority still fits in the remaining 32 bits of the key.
+ */
+#define PQ_DEFAULT_SEQ_BITS 32
+
 /*
  * Helper function to swap two pq_node pointers.
  */
@@ -44,7 +82,7 @@ static void heapify_up(struct pq* pq, int idx) {
         int parent_idx = (idx - 1) / 2;
         struct pq_node* parent = dynarray_get(pq->data, parent_idx);
         struct pq_node* current = dynarray_get(pq->data, idx);
-        if (current->priority < parent->priority) {
+        if (current->key < parent->key) {
             dynarray_set(pq->data, idx, parent);
             dynarray_set(pq->data, parent_idx, current);
             idx = parent_idx;
@@ -57,39 +95,130 @@ static void heapify_up(struct pq* pq, int idx) {
 
 /*
  * Helper function to maintain the heap property from a given node down to the leaves.
+ * Rather than swapping at every level, the node being sifted is held aside
+ * while the smaller child is moved up into the "hole", and it is written back
+ * only once its final position is known.
  */
 static void heapify_down(struct pq* pq, int idx) {
     int size = dynarray_size(pq->data);
+    if (idx >= size) {
+        return;
+    }
+    struct pq_node* node = dynarray_get(pq->data, idx);
     while (1) {
-        int left_idx = 2 * idx + 1;
-        int right_idx = 2 * idx + 2;
-        int min_idx = idx;
-
-        if (left_idx < size) {
-            struct pq_node* left = dynarray_get(pq->data, left_idx);
-            struct pq_node* min = dynarray_get(pq->data, min_idx);
-            if (left->priority < min->priority) {
-                min_idx = left_idx;
-            }
+        int min_idx = 2 * idx + 1;
+        if (min_idx >= size) {
+            break;
         }
 
-        if (right_idx < size) {
-            struct pq_node* right = dynarray_get(pq->data, right_idx);
-            struct pq_node* min = dynarray_get(pq->data, min_idx);
-            if (right->priority < min->priority) {
-                min_idx = right_idx;
+        struct pq_node* min = dynarray_get(pq->data, min_idx);
+        if (min_idx + 1 < size) {
+            struct pq_node* right = dynarray_get(pq->data, min_idx + 1);
+            if (right->key < min->key) {
+                min_idx++;
+                min = right;
             }
         }
 
-        if (min_idx != idx) {
-            struct pq_node* temp = dynarray_get(pq->data, idx);
-            dynarray_set(pq->data, idx, dynarray_get(pq->data, min_idx));
-            dynarray_set(pq->data, min_idx, temp);
+        if (min->key < node->key) {
+            dynarray_set(pq->data, idx, min);
             idx = min_idx;
         } else {
             break;
         }
     }
+    dynarray_set(pq->data, idx, node);
+}
+
+/*
+ * Helper function to restore the heap property over the whole array at once
+ * using Floyd's bottom-up method.  Every internal node is sifted down,
+ * starting from the last one, which costs O(n) instead of the O(n log n)
+ * needed to insert the same elements one at a time.
+ */
+static void build_heap(struct pq* pq) {
+    int size = dynarray_size(pq->data);
+    for (int i = size / 2 - 1; i >= 0; i--) {
+        heapify_down(pq, i);
+    }
+}
+
+/*
+ * Helper function to build the key for a new element with a given priority,
+ * using (and advancing) the queue's insertion sequence number.
+ */
+static long long make_key(struct pq* pq, long long priority) {
+    if (pq->seq_bits > 0) {
+        long long limit = 1LL << (63 - pq->seq_bits);
+        assert(priority >= -limit && priority < limit);
+    }
+    unsigned long long mask = (1ULL << pq->seq_bits) - 1;
+    long long seq = (long long)(pq->seq++ & mask);
+    return priority * (1LL << pq->seq_bits) + seq;
+}
+
+/*
+ * Helper function to recover the priority stored in a key.  Subtracting the
+ * sequence bits first makes the division exact, so this also works for
+ * negative priorities.
+ */
+static long long key_priority(struct pq* pq, long long key) {
+    long long seq = key & (long long)((1ULL << pq->seq_bits) - 1);
+    return (key - seq) / (1LL << pq->seq_bits);
+}
+
+/*
+ * Helper function to recover the priority of a stored node, undoing the key
+ * complement used by bounded queues.
+ */
+static long long node_priority(struct pq* pq, struct pq_node* node) {
+    return key_priority(pq, pq->bound ? ~node->key : node->key);
+}
+
+/*
+ * Helper function to get a node, from the spare list if it has one.
+ */
+static struct pq_node* node_alloc(struct pq* pq) {
+    struct pq_node* node = pq->spare;
+    if (node) {
+        pq->spare = node->value;
+        return node;
+    }
+    node = malloc(sizeof(struct pq_node));
+    assert(node);
+    return node;
+}
+
+/*
+ * Helper function to put a node that is no longer in the heap on the spare
+ * list.
+ */
+static void node_release(struct pq* pq, struct pq_node* node) {
+    node->value = pq->spare;
+    pq->spare = node;
+}
+
+/*
+ * Helper function to get a node and append it to the end of the heap array
+ * without restoring the heap property.
+ */
+static void append_node(struct pq* pq, void* value, long long priority) {
+    struct pq_node* node = node_alloc(pq);
+    node->value = value;
+    node->key = make_key(pq, priority);
+    dynarray_insert(pq->data, node);
+}
+
+/*
+ * Helper function to compute floor(log2(n)) for n > 0.
+ */
+static int log2_floor(int n) {
+    int lg = 0;
+    while (n > 1) {
+        n >>= 1;
+        lg++;
+    }
+    return lg;
 }
 
 
@@ -102,8 +231,100 @@ struct pq* pq_create() {
     assert(pq);
     pq->data = dynarray_create();
 	assert(pq->data);
+    pq->seq = 0;
+    pq->spare = NULL;
+    pq->seq_bits = PQ_DEFAULT_SEQ_BITS;
+    pq->bound = 0;
+    pq->threshold = LLONG_MAX;
+    return pq;
+
+}
+
+
+/*
+ * This function allocates an empty priority queue for 64-bit priorities,
+ * inserted with pq_insert64().  Elements with equal priorities are returned
+ * in the order they were inserted (FIFO).
+ *
+ * The priority and the insertion sequence number share one 64-bit key, so
+ * the queue still does a single comparison per sift step.  The caller picks
+ * how the 64 bits are split:
+ *
+ *   - priorities must lie in [-2^(63 - seq_bits), 2^(63 - seq_bits)).
+ *   - FIFO order is guaranteed among equal priorities inserted fewer than
+ *     2^seq_bits insertions apart.
+ *
+ * For example, with seq_bits = 20, nanosecond timestamps measured from a
+ * fixed epoch (such as scheduler start-up) can span about 2.4 hours, with
+ * FIFO ties among about a million insertions.
+ *
+ * Params:
+ *   seq_bits - the number of key bits used for the sequence number, between
+ *     0 (no FIFO tie-breaking, full 64-bit priorities) and 62.
+ *
+ * Return:
+ *   Should return a pointer to the newly-created priority queue.
+ */
+struct pq* pq_create64(int seq_bits) {
+    assert(seq_bits >= 0 && seq_bits <= 62);
+    struct pq* pq = pq_create();
+    pq->seq_bits = seq_bits;
     return pq;
+}
+
 
+/*
+ * This function allocates an empty bounded priority queue that keeps only the
+ * `k` elements with the LOWEST priority values offered to it, which is how
+ * the K smallest elements of a large stream can be found in O(K) memory.
+ *
+ * Internally the queue is a max-heap of at most `k` elements, so its root is
+ * the element that would be evicted next.  Elements are added with
+ * pq_offer() or pq_offer_many(); once the queue is full, an element that
+ * can't make the cut is rejected with a single comparison against the root.
+ * pq_first(), pq_first_priority() and pq_remove_first() work as usual, except
+ * that they see the element with the HIGHEST priority value kept, i.e. the
+ * retained elements come out from largest to smallest.  Among equal priority
+ * values, the element offered first is kept.
+ *
+ * Params:
+ *   k - the maximum number of elements to keep.  Must be at least 1.
+ *
+ * Return:
+ *   Should return a pointer to the newly-created priority queue.
+ */
+struct pq* pq_create_bounded(int k) {
+    assert(k > 0);
+    struct pq* pq = pq_create();
+    pq->bound = k;
+    return pq;
+}
+
+
+/*
+ * This function allocates a priority queue that already contains `n`
+ * elements.  The elements are appended in the order given and the heap is
+ * then built bottom-up in O(n) time, which is much cheaper than calling
+ * pq_insert() `n` times when loading a large batch at startup.
+ *
+ * Params:
+ *   values - array of `n` values to be stored in the new priority queue.
+ *   priorities - array of `n` priority values; priorities[i] is assigned to
+ *     values[i].  As with pq_insert(), LOWER priority values correspond to
+ *     elements with HIGHER priority.
+ *   n - the number of elements in `values` and `priorities`.  May be 0.
+ *
+ * Return:
+ *   Should return a pointer to the newly-created priority queue.
+ */
+struct pq* pq_create_from(void** values, int* priorities, int n) {
+    assert(n >= 0);
+    struct pq* pq = pq_create();
+    for (int i = 0; i < n; i++) {
+        append_node(pq, values[i], priorities[i]);
+    }
+    build_heap(pq);
+    return pq;
 }
 
 
@@ -122,6 +343,11 @@ void pq_free(struct pq* pq) {
 	for (int i = 0; i < size; i++){
 		free(dynarray_get(pq->data, i));
 	}
+	while (pq->spare) {
+		struct pq_node* next = pq->spare->value;
+		free(pq->spare);
+		pq->spare = next;
+	}
 	dynarray_free(pq->data);
 	free(pq);
 }
@@ -158,15 +384,30 @@ int pq_isempty(struct pq* pq) {
  *     element.  Note that in this implementation, LOWER priority values
  *     should correspond to elements with HIGHER priority.  In other words,
  *     the element in the priority queue with the LOWEST priority value should
- *     be the FIRST one returned.
+ *     be the FIRST one returned.  Elements with equal priority values are
+ *     returned in the order they were inserted.
  */
 void pq_insert(struct pq* pq, void* value, int priority) {
-    struct pq_node* node = malloc(sizeof(struct pq_node));
-    assert(node);
-    node->value = value;
-    node->priority = priority;
+    pq_insert64(pq, value, priority);
+}
 
-    dynarray_insert(pq->data, node);
+
+/*
+ * This function inserts a given element into a priority queue with a 64-bit
+ * priority value.  Elements with equal priority values are returned in the
+ * order they were inserted.
+ *
+ * Params:
+ *   pq - the priority queue into which to insert an element.  May not be
+ *     NULL.
+ *   value - the value to be inserted into pq.
+ *   priority - the priority value to be assigned to the newly-inserted
+ *     element.  LOWER priority values are returned FIRST.  Must fit in the
+ *     range allowed by the queue's sequence bits (see pq_create64()).
+ */
+void pq_insert64(struct pq* pq, void* value, long long priority) {
+    assert(!pq->bound);
+    append_node(pq, value, priority);
 
     int size = dynarray_size(pq->data);
     int current = size - 1;
@@ -175,7 +416,7 @@ void pq_insert(struct pq* pq, void* value, int priority) {
         struct pq_node* parentNode = dynarray_get(pq->data, parent);
         struct pq_node* currentNode = dynarray_get(pq->data, current);
         // if the current node has a lower priority (higher priority in queue terms), swap it with its parent
-        if (parentNode->priority <= currentNode->priority) {
+        if (parentNode->key <= currentNode->key) {
             break;
         }
         dynarray_set(pq->data, current, parentNode);
@@ -183,6 +424,40 @@ void pq_insert(struct pq* pq, void* value, int priority) {
         current = parent;
     }
 }
+
+
+/*
+ * This function inserts a batch of `n` elements into a priority queue.  The
+ * elements are first appended to the heap array.  If the batch is small
+ * relative to the heap, each new element is then sifted up individually;
+ * if the batch is large enough that `n` sift-ups (O(n log size) in the worst
+ * case) would cost more than rebuilding the whole heap (O(size)), the heap is
+ * rebuilt bottom-up instead.
+ *
+ * Params:
+ *   pq - the priority queue into which to insert the elements.  May not be
+ *     NULL.
+ *   values - array of `n` values to be inserted into pq.
+ *   priorities - array of `n` priority values; priorities[i] is assigned to
+ *     values[i].
+ *   n - the number of elements to insert.  May be 0.
+ */
+void pq_insert_many(struct pq* pq, void** values, int* priorities, int n) {
+    assert(n >= 0 && !pq->bound);
+    int old_size = dynarray_size(pq->data);
+    for (int i = 0; i < n; i++) {
+        append_node(pq, values[i], priorities[i]);
+    }
+
+    int size = old_size + n;
+    if (size > 0 && (long)n * log2_floor(size) > 2L * size) {
+        build_heap(pq);
+    } else {
+        for (int i = old_size; i < size; i++) {
+            heapify_up(pq, i);
+        }
+    }
+}
 /*
  * This function should return the value of the first item in a priority
  * queue, i.e. the item with LOWEST priority value.
@@ -215,9 +490,166 @@ void* pq_first(struct pq* pq) {
  *   with LOWEST priority value.
  */
 int pq_first_priority(struct pq* pq) {
+    long long priority = pq_first_priority64(pq);
+    assert(priority >= INT_MIN && priority <= INT_MAX);
+    return (int)priority;
+}
+
+
+/*
+ * This function returns the 64-bit priority value of the first item in a
+ * priority queue, i.e. the item with LOWEST priority value.
+ *
+ * Params:
+ *   pq - the priority queue from which to fetch a priority value.  May not be
+ *     NULL or empty.
+ */
+long long pq_first_priority64(struct pq* pq) {
     assert(!pq_isempty(pq));
     struct pq_node* node = dynarray_get(pq->data, 0);
-    return node->priority;
+    return node_priority(pq, node);
+}
+
+
+/*
+ * This function offers an element to a bounded priority queue created with
+ * pq_create_bounded().  While the queue holds fewer than `k` elements, every
+ * element is accepted.  After that, an element is accepted only if its
+ * priority value is lower than the highest one currently kept, and that
+ * element is evicted to make room.
+ *
+ * Params:
+ *   pq - the bounded priority queue.  May not be NULL.
+ *   value - the value being offered.
+ *   priority - the priority value of the element being offered.
+ *
+ * Return:
+ *   Returns 1 if the element was kept or 0 if it was rejected.
+ */
+int pq_offer(struct pq* pq, void* value, int priority) {
+    assert(pq->bound);
+    if (priority >= pq->threshold) {
+        return 0;
+    }
+
+    int size = dynarray_size(pq->data);
+    if (size < pq->bound) {
+        struct pq_node* node = node_alloc(pq);
+        node->value = value;
+        node->key = ~make_key(pq, priority);
+        dynarray_insert(pq->data, node);
+        heapify_up(pq, size);
+        if (size + 1 < pq->bound) {
+            return 1;
+        }
+    } else {
+        /*
+         * Reuse the evicted root's node for the new element.
+         */
+        struct pq_node* root = dynarray_get(pq->data, 0);
+        root->value = value;
+        root->key = ~make_key(pq, priority);
+        heapify_down(pq, 0);
+    }
+    pq->threshold = node_priority(pq, dynarray_get(pq->data, 0));
+    return 1;
+}
+
+/*
+ * Helper functions that return the index of the first element of
+ * priorities[i..n-1] that is lower than `threshold`, or `n` if there is none.
+ * The SIMD versions compare 4 (SSE2) or 8 (AVX2) priorities per instruction
+ * and only fall out of their loop for the rare candidate that beats the
+ * threshold.  The AVX2 version is only used if the CPU supports it.
+ */
+static int scan_below_scalar(int* priorities, int i, int n, int threshold) {
+    for (; i < n; i++) {
+        if (priorities[i] < threshold) {
+            return i;
+        }
+    }
+    return n;
+}
+
+#if defined(__x86_64__)
+static int scan_below_sse2(int* priorities, int i, int n, int threshold) {
+    __m128i t = _mm_set1_epi32(threshold);
+    for (; i + 4 <= n; i += 4) {
+        __m128i p = _mm_loadu_si128((__m128i*)(priorities + i));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(p, t)));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return scan_below_scalar(priorities, i, n, threshold);
+}
+
+__attribute__((target("avx2")))
+static int scan_below_avx2(int* priorities, int i, int n, int threshold) {
+    __m256i t = _mm256_set1_epi32(threshold);
+    for (; i + 8 <= n; i += 8) {
+        __m256i p = _mm256_loadu_si256((__m256i*)(priorities + i));
+        int mask = _mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpgt_epi32(t, p)));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return scan_below_sse2(priorities, i, n, threshold);
+}
+#endif
+
+static int scan_below(int* priorities, int i, int n, int threshold) {
+#if defined(__x86_64__)
+    static int have_avx2 = -1;
+    if (have_avx2 < 0) {
+        have_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    if (have_avx2) {
+        return scan_below_avx2(priorities, i, n, threshold);
+    }
+    return scan_below_sse2(priorities, i, n, threshold);
+#else
+    return scan_below_scalar(priorities, i, n, threshold);
+#endif
+}
+
+
+/*
+ * This function offers a batch of `n` elements to a bounded priority queue,
+ * with the same result as calling pq_offer() on each of them in order.  Once
+ * the queue is full, the batch is scanned with SIMD comparisons against the
+ * current threshold, so elements that can't make the cut cost a fraction of
+ * a comparison each.
+ *
+ * Params:
+ *   pq - the bounded priority queue.  May not be NULL.
+ *   values - array of `n` values being offered, or NULL to offer NULL values.
+ *   priorities - array of `n` priority values; priorities[i] belongs to
+ *     values[i].
+ *   n - the number of elements in the batch.  May be 0.
+ *
+ * Return:
+ *   Returns the number of elements that were kept.
+ */
+int pq_offer_many(struct pq* pq, void** values, int* priorities, int n) {
+    assert(pq->bound && n >= 0);
+    int accepted = 0;
+    int i = 0;
+    while (i < n) {
+        if (pq->threshold == LLONG_MAX) {
+            accepted += pq_offer(pq, values ? values[i] : NULL, priorities[i]);
+            i++;
+            continue;
+        }
+
+        i = scan_below(priorities, i, n, (int)pq->threshold);
+        if (i < n) {
+            accepted += pq_offer(pq, values ? values[i] : NULL, priorities[i]);
+            i++;
+        }
+    }
+    return accepted;
 }
 
 
@@ -244,7 +676,8 @@ void* pq_remove_first(struct pq* pq) {
     struct pq_node* lastNode = dynarray_get(pq->data, size - 1);
     dynarray_set(pq->data, 0, lastNode);
     dynarray_remove(pq->data, size - 1); //remore last element
-    free(root);
+    node_release(pq, root);
+    pq->threshold = LLONG_MAX;
 
     heapify_down(pq, 0);
 
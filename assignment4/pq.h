@@ -19,11 +19,19 @@ struct pq;
  * documentation about each of these functions.
  */
 struct pq* pq_create();
+struct pq* pq_create_from(void** values, int* priorities, int n);
+struct pq* pq_create64(int seq_bits);
+struct pq* pq_create_bounded(int k);
 void pq_free(struct pq* pq);
 int pq_isempty(struct pq* pq);
 void pq_insert(struct pq* pq, void* value, int priority);
+void pq_insert_many(struct pq* pq, void** values, int* priorities, int n);
+void pq_insert64(struct pq* pq, void* value, long long priority);
+int pq_offer(struct pq* pq, void* value, int priority);
+int pq_offer_many(struct pq* pq, void** values, int* priorities, int n);
 void* pq_first(struct pq* pq);
 int pq_first_priority(struct pq* pq);
+long long pq_first_priority64(struct pq* pq);
 void* pq_remove_first(struct pq* pq);
 
 #endif
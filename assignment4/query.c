@@ -0,0 +1,386 @@
+/*
+ * This file contains point-to-point shortest-path queries on the CSR graphs
+ * from graph.h.  All edge weights are assumed to be non-negative.
+ *
+ * A query runs Dijkstra's algorithm forwards from s and backwards from t at
+ * the same time, on the graph and on its transpose.  Every edge relaxed
+ * towards a node the other search has reached gives an s-t path, and the
+ * shortest one found so far is kept.  The searches stop as soon as the
+ * smallest keys left in the two queues add up to at least that path's
+ * length, since no path through an unsettled node can be shorter.  Each
+ * search settles roughly the nodes within half the s-t distance of its end.
+ *
+ * With landmarks, the searches become A* (the ALT algorithm of Goldberg and
+ * Harrelson).  Distances to and from a few far-apart landmark nodes are
+ * precomputed, and the triangle inequality turns them into lower bounds on
+ * the distance from any node to t and from s to it.  The forward search uses
+ * half the difference of the two bounds as its potential and the backward
+ * search the negation, which keeps both searches consistent so the same
+ * stopping rule applies.  Keys are doubled to keep them whole numbers.
+ *
+ * The per-node scratch arrays are stamped with the number of the query that
+ * last wrote them, so starting a query costs nothing however large the graph
+ * is.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "query.h"
+#include "pq.h"
+
+/*
+ * Stand-in for the potential of a node that can't be on any s-t path.
+ */
+#define OFF_PATH LLONG_MAX
+
+/*
+ * Per-node state for one direction of a query.  A node has been reached in
+ * the current query only if its stamp is the current query number.
+ */
+struct side {
+    struct graph* graph;
+    struct pq* pq;
+    dist_t* dist;
+    unsigned int* reached;
+    unsigned int* settled;
+    int sign;
+};
+
+struct sp {
+    struct graph* graph;
+    struct graph* transpose;
+    struct side sides[2];
+
+    /*
+     * Landmark distances, stored by node so a node's bounds are in one
+     * cache line: to[v * n_landmarks + i] is the distance from v to landmark
+     * i and from[v * n_landmarks + i] the distance from landmark i to v.
+     */
+    int n_landmarks;
+    dist_t* to;
+    dist_t* from;
+
+    /*
+     * Potentials of the forward search, cached per query.
+     */
+    long long* potential;
+    unsigned int* potential_stamp;
+
+    unsigned int query;
+    int s;
+    int t;
+    int settled;
+};
+
+/*
+ * Helper function to pick landmarks far apart from each other.  The first
+ * landmark is the node farthest from node 0, and each further one is the
+ * node whose distance to the closest landmark chosen so far, both ways, is
+ * largest.  Nodes that can't reach or be reached from a landmark count as
+ * infinitely far, which spreads landmarks over separate components.
+ */
+static void choose_landmarks(struct sp* sp) {
+    int n = sp->graph->n_nodes;
+    int k = sp->n_landmarks;
+    dist_t* to = malloc(n * sizeof(dist_t));
+    dist_t* from = malloc(n * sizeof(dist_t));
+    long long* closest = malloc(n * sizeof(long long));
+    assert(to && from && closest);
+
+    sssp_dijkstra(sp->graph, 0, from, NULL);
+    int landmark = 0;
+    for (int v = 0; v < n; v++) {
+        if (from[v] != DIST_INF && from[v] > from[landmark]) {
+            landmark = v;
+        }
+        closest[v] = LLONG_MAX;
+    }
+
+    for (int i = 0; i < k; i++) {
+        sssp_dijkstra(sp->graph, landmark, from, NULL);
+        sssp_dijkstra(sp->transpose, landmark, to, NULL);
+        int next = landmark;
+        for (int v = 0; v < n; v++) {
+            sp->from[(long)v * k + i] = from[v];
+            sp->to[(long)v * k + i] = to[v];
+            long long d = from[v] == DIST_INF || to[v] == DIST_INF ?
+                LLONG_MAX - 1 : (long long)from[v] + to[v];
+            if (d < closest[v]) {
+                closest[v] = d;
+            }
+            if (closest[v] > closest[next]) {
+                next = v;
+            }
+        }
+        landmark = next;
+    }
+    free(to);
+    free(from);
+    free(closest);
+}
+
+/*
+ * This function prepares a graph for point-to-point queries by building its
+ * transpose and, optionally, choosing landmarks and computing the distances
+ * to and from them.  Landmarks take 2 * n_landmarks Dijkstra runs to set up
+ * and 2 * n_landmarks distances of memory per node.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.  It must stay alive and unchanged
+ *     until the result is freed.
+ *   n_landmarks - the number of landmarks to use for A*, or 0 for plain
+ *     bidirectional Dijkstra.
+ *
+ * Return:
+ *   Returns the query structure, which should be freed with sp_free().
+ */
+struct sp* sp_create(struct graph* graph, int n_landmarks) {
+    assert(graph);
+    assert(n_landmarks >= 0);
+    int n = graph->n_nodes;
+    if (n == 0) {
+        n_landmarks = 0;
+    }
+
+    struct sp* sp = malloc(sizeof(struct sp));
+    assert(sp);
+    sp->graph = graph;
+    sp->transpose = graph_transpose(graph);
+    sp->n_landmarks = n_landmarks;
+    sp->to = malloc(((long)n * n_landmarks + 1) * sizeof(dist_t));
+    sp->from = malloc(((long)n * n_landmarks + 1) * sizeof(dist_t));
+    sp->potential = malloc((n + 1) * sizeof(long long));
+    sp->potential_stamp = calloc(n + 1, sizeof(unsigned int));
+    assert(sp->to && sp->from && sp->potential && sp->potential_stamp);
+    for (int i = 0; i < 2; i++) {
+        struct side* side = &sp->sides[i];
+        side->graph = i == 0 ? graph : sp->transpose;
+        side->pq = pq_create64(0);
+        side->dist = malloc((n + 1) * sizeof(dist_t));
+        side->reached = calloc(n + 1, sizeof(unsigned int));
+        side->settled = calloc(n + 1, sizeof(unsigned int));
+        side->sign = i == 0 ? 1 : -1;
+        assert(side->dist && side->reached && side->settled);
+    }
+    sp->query = 0;
+    sp->settled = 0;
+
+    if (n_landmarks > 0) {
+        choose_landmarks(sp);
+    }
+    return sp;
+}
+
+/*
+ * This function frees all memory associated with a query structure.  The
+ * graph it was created from is not freed.
+ *
+ * Params:
+ *   sp - the query structure to be destroyed.  May not be NULL.
+ */
+void sp_free(struct sp* sp) {
+    assert(sp);
+    for (int i = 0; i < 2; i++) {
+        pq_free(sp->sides[i].pq);
+        free(sp->sides[i].dist);
+        free(sp->sides[i].reached);
+        free(sp->sides[i].settled);
+    }
+    graph_free(sp->transpose);
+    free(sp->to);
+    free(sp->from);
+    free(sp->potential);
+    free(sp->potential_stamp);
+    free(sp);
+}
+
+/*
+ * This function returns the number of landmarks a query structure uses.
+ */
+int sp_num_landmarks(struct sp* sp) {
+    assert(sp);
+    return sp->n_landmarks;
+}
+
+/*
+ * This function returns the number of nodes settled by both searches
+ * together in the last call to sp_query(), as a measure of its work.
+ */
+int sp_last_settled(struct sp* sp) {
+    assert(sp);
+    return sp->settled;
+}
+
+/*
+ * Helper function to compute a lower bound on the distance from v to t (if
+ * `to_t` is set) or from s to v (otherwise) from the landmark distances.
+ * The distance from v to t is at least d(v, L) - d(t, L) and at least
+ * d(L, t) - d(L, v) for every landmark L.
+ *
+ * Return:
+ *   Returns the bound, or OFF_PATH if the landmarks show that t can't be
+ *   reached from v (or v from s).
+ */
+static long long landmark_bound(struct sp* sp, int v, int to_t) {
+    int k = sp->n_landmarks;
+    int end = to_t ? sp->t : sp->s;
+    dist_t* v_to = sp->to + (long)v * k;
+    dist_t* v_from = sp->from + (long)v * k;
+    dist_t* end_to = sp->to + (long)end * k;
+    dist_t* end_from = sp->from + (long)end * k;
+    long long bound = 0;
+    for (int i = 0; i < k; i++) {
+        /*
+         * Going forwards the bounds are d(v, L) - d(t, L) and
+         * d(L, t) - d(L, v); going backwards, with s for t, they are
+         * d(L, v) - d(L, s) and d(s, L) - d(v, L).
+         */
+        dist_t a_v = to_t ? v_to[i] : v_from[i];
+        dist_t a_end = to_t ? end_to[i] : end_from[i];
+        dist_t b_v = to_t ? v_from[i] : v_to[i];
+        dist_t b_end = to_t ? end_from[i] : end_to[i];
+        if (a_end != DIST_INF) {
+            if (a_v == DIST_INF) {
+                return OFF_PATH;
+            }
+            if ((long long)a_v - a_end > bound) {
+                bound = (long long)a_v - a_end;
+            }
+        }
+        if (b_end != DIST_INF && b_v != DIST_INF &&
+                (long long)b_end - b_v > bound) {
+            bound = (long long)b_end - b_v;
+        }
+    }
+    return bound;
+}
+
+/*
+ * Helper function to return twice the forward potential of v, which is the
+ * bound on its distance to t minus the bound on its distance from s.  The
+ * backward potential is its negation.
+ */
+static long long potential(struct sp* sp, int v) {
+    if (sp->n_landmarks == 0) {
+        return 0;
+    }
+    if (sp->potential_stamp[v] != sp->query) {
+        long long to_t = landmark_bound(sp, v, 1);
+        long long from_s = landmark_bound(sp, v, 0);
+        sp->potential[v] = to_t == OFF_PATH || from_s == OFF_PATH ?
+            OFF_PATH : to_t - from_s;
+        sp->potential_stamp[v] = sp->query;
+    }
+    return sp->potential[v];
+}
+
+/*
+ * Helper function to reach node v from one side with distance d, if that is
+ * an improvement, and to update the best path length *best if the other
+ * side has also reached v.
+ */
+static void reach(struct sp* sp, struct side* side, struct side* other, int v,
+        dist_t d, long long* best) {
+    if (side->reached[v] == sp->query && side->dist[v] <= d) {
+        return;
+    }
+    long long p = potential(sp, v);
+    if (p == OFF_PATH) {
+        return;
+    }
+    side->reached[v] = sp->query;
+    side->dist[v] = d;
+    pq_insert64(side->pq, (void*)(long)v, 2 * (long long)d + side->sign * p);
+    if (other->reached[v] == sp->query &&
+            (long long)d + other->dist[v] < *best) {
+        *best = (long long)d + other->dist[v];
+    }
+}
+
+/*
+ * Helper function to settle the node at the front of one side's queue and
+ * relax its edges, skipping stale entries.
+ */
+static void settle_next(struct sp* sp, struct side* side, struct side* other,
+        long long* best) {
+    int u = (int)(long)pq_remove_first(side->pq);
+    if (side->settled[u] == sp->query) {
+        return;
+    }
+    side->settled[u] = sp->query;
+    sp->settled++;
+
+    struct graph* graph = side->graph;
+    dist_t du = side->dist[u];
+    for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+        reach(sp, side, other, graph->targets[e], du + graph->weights[e],
+            best);
+    }
+}
+
+/*
+ * This function finds the length of a shortest path from s to t.
+ *
+ * Params:
+ *   sp - the query structure for the graph.  May not be NULL.
+ *   s, t - the two ends of the path.
+ *
+ * Return:
+ *   Returns the length of the path, or DIST_INF if t can't be reached from
+ *   s.
+ */
+dist_t sp_query(struct sp* sp, int s, int t) {
+    assert(sp);
+    assert(s >= 0 && s < sp->graph->n_nodes);
+    assert(t >= 0 && t < sp->graph->n_nodes);
+    struct side* forward = &sp->sides[0];
+    struct side* backward = &sp->sides[1];
+
+    /*
+     * Clear all stamps when the query number wraps around, so no node looks
+     * reached by an old query.
+     */
+    if (++sp->query == 0) {
+        int n = sp->graph->n_nodes;
+        for (int i = 0; i < 2; i++) {
+            for (int v = 0; v < n; v++) {
+                sp->sides[i].reached[v] = 0;
+                sp->sides[i].settled[v] = 0;
+            }
+        }
+        for (int v = 0; v < n; v++) {
+            sp->potential_stamp[v] = 0;
+        }
+        sp->query = 1;
+    }
+    sp->s = s;
+    sp->t = t;
+    sp->settled = 0;
+
+    long long best = LLONG_MAX;
+    reach(sp, forward, backward, s, 0, &best);
+    reach(sp, backward, forward, t, 0, &best);
+
+    while (!pq_isempty(forward->pq) && !pq_isempty(backward->pq)) {
+        long long top_f = pq_first_priority64(forward->pq);
+        long long top_b = pq_first_priority64(backward->pq);
+        if (best != LLONG_MAX && top_f + top_b >= 2 * best) {
+            break;
+        }
+        if (top_f <= top_b) {
+            settle_next(sp, forward, backward, &best);
+        } else {
+            settle_next(sp, backward, forward, &best);
+        }
+    }
+
+    for (int i = 0; i < 2; i++) {
+        while (!pq_isempty(sp->sides[i].pq)) {
+            pq_remove_first(sp->sides[i].pq);
+        }
+    }
+    return best == LLONG_MAX ? DIST_INF : (dist_t)best;
+}
@@ -0,0 +1,28 @@
+/*
+ * This file contains the definition of the interface for point-to-point
+ * shortest-path queries.  You can find descriptions of the functions,
+ * including their parameters and their return values, in query.c.
+ */
+
+#ifndef __QUERY_H
+#define __QUERY_H
+
+#include "graph.h"
+#include "sssp.h"
+
+/*
+ * Structure used to represent a graph prepared for point-to-point queries.
+ */
+struct sp;
+
+/*
+ * Query interface function prototypes.  Refer to query.c for documentation
+ * about each of these functions.
+ */
+struct sp* sp_create(struct graph* graph, int n_landmarks);
+void sp_free(struct sp* sp);
+int sp_num_landmarks(struct sp* sp);
+dist_t sp_query(struct sp* sp, int s, int t);
+int sp_last_settled(struct sp* sp);
+
+#endif
@@ -0,0 +1,298 @@
+/*
+ * This file contains passes that compute a new numbering for the nodes of a
+ * graph, to be applied with graph_permute().  Shortest-path engines touch
+ * dist[v] for every edge they relax, so when the neighbours of a node have
+ * nearby numbers those accesses hit the same cache lines and pages; with
+ * random numbering almost every one is a cache miss on a large graph.
+ *
+ * Both passes number the nodes in breadth-first order, following edges in
+ * both directions, one connected component at a time:
+ *
+ *   - reorder_bfs() starts each component at its lowest-numbered node and
+ *     takes neighbours in adjacency order.
+ *   - reorder_rcm() is reverse Cuthill-McKee.  It starts each component at
+ *     a pseudo-peripheral node found by the George-Liu heuristic, takes the
+ *     new neighbours of each node in increasing order of degree, and
+ *     reverses the whole order at the end.  This keeps the numbers of any
+ *     two adjacent nodes close (a small bandwidth), not just those of a node
+ *     and the one that reached it.
+ *
+ * Each pass returns `order`, where order[i] is the original number of the
+ * node that gets number i, which is also the map back to original numbers.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "reorder.h"
+
+/*
+ * The most breadth-first searches run to look for a pseudo-peripheral node
+ * in each component.
+ */
+#define MAX_SWEEPS 8
+
+/*
+ * State shared by the searches of one pass.  `mark` records the number of
+ * the search that last reached each node.
+ */
+struct reorder {
+    struct graph* graph;
+    struct graph* transpose;
+    int* degree;
+    int* mark;
+    int stamp;
+};
+
+/*
+ * Helper function to sort nodes by increasing degree, breaking ties by node
+ * number, with insertion sort (the lists sorted here are short).
+ */
+static void sort_by_degree(int* nodes, int n, int* degree) {
+    for (int i = 1; i < n; i++) {
+        int v = nodes[i], j = i;
+        while (j > 0 && (degree[nodes[j - 1]] > degree[v] ||
+                (degree[nodes[j - 1]] == degree[v] && nodes[j - 1] > v))) {
+            nodes[j] = nodes[j - 1];
+            j--;
+        }
+        nodes[j] = v;
+    }
+}
+
+/*
+ * Helper function to run a breadth-first search from start over the edges
+ * of the graph in both directions, writing the nodes it reaches to queue in
+ * the order they are reached.  With by_degree, each node's new neighbours
+ * are taken in increasing order of degree.
+ *
+ * Return:
+ *   Returns the number of nodes reached.  *last is set to the index in
+ *   queue of the first node of the last level and *height to the number of
+ *   levels.
+ */
+static int sweep(struct reorder* r, int start, int by_degree, int* queue,
+        int* last, int* height) {
+    struct graph* graphs[] = {r->graph, r->transpose};
+    int stamp = ++r->stamp;
+    int head = 0, tail = 0, level_end = 1;
+    r->mark[start] = stamp;
+    queue[tail++] = start;
+    *last = 0;
+    *height = 1;
+
+    while (head < tail) {
+        if (head == level_end) {
+            *last = head;
+            (*height)++;
+            level_end = tail;
+        }
+        int u = queue[head++];
+        int first = tail;
+        for (int g = 0; g < 2; g++) {
+            struct graph* graph = graphs[g];
+            for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+                int v = graph->targets[e];
+                if (r->mark[v] != stamp) {
+                    r->mark[v] = stamp;
+                    queue[tail++] = v;
+                }
+            }
+        }
+        if (by_degree) {
+            sort_by_degree(queue + first, tail - first, r->degree);
+        }
+    }
+    return tail;
+}
+
+/*
+ * Helper function to find a node at the far edge of start's component: the
+ * lowest-degree node in the last level of a search from start becomes the
+ * new start for as long as that makes the search deeper.
+ */
+static int peripheral_node(struct reorder* r, int start, int* queue) {
+    int last, height;
+    int count = sweep(r, start, 0, queue, &last, &height);
+    for (int i = 1; i < MAX_SWEEPS; i++) {
+        int candidate = queue[last];
+        for (int j = last + 1; j < count; j++) {
+            if (r->degree[queue[j]] < r->degree[candidate]) {
+                candidate = queue[j];
+            }
+        }
+        int candidate_last, candidate_height;
+        sweep(r, candidate, 0, queue, &candidate_last, &candidate_height);
+        if (candidate_height <= height) {
+            break;
+        }
+        start = candidate;
+        height = candidate_height;
+        last = candidate_last;
+    }
+    return start;
+}
+
+/*
+ * Helper function to number the nodes one component at a time.  Components
+ * are started at the first node of `starts` (a permutation of all nodes)
+ * that hasn't been numbered yet.
+ */
+static int* number_components(struct reorder* r, int* starts, int rcm) {
+    int n = r->graph->n_nodes;
+    int* order = malloc((n > 0 ? n : 1) * sizeof(int));
+    int* scratch = malloc((n > 0 ? n : 1) * sizeof(int));
+    char* placed = calloc(n > 0 ? n : 1, 1);
+    assert(order && scratch && placed);
+
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        int start = starts[i];
+        if (placed[start]) {
+            continue;
+        }
+        if (rcm) {
+            start = peripheral_node(r, start, scratch);
+        }
+        int last, height;
+        int size = sweep(r, start, rcm, order + count, &last, &height);
+        for (int j = count; j < count + size; j++) {
+            placed[order[j]] = 1;
+        }
+        count += size;
+    }
+    assert(count == n);
+
+    if (rcm) {
+        for (int i = 0, j = n - 1; i < j; i++, j--) {
+            int v = order[i];
+            order[i] = order[j];
+            order[j] = v;
+        }
+    }
+    free(scratch);
+    free(placed);
+    return order;
+}
+
+/*
+ * Helper function to set up the state for a pass, including each node's
+ * degree counting edges in both directions.
+ */
+static void reorder_init(struct reorder* r, struct graph* graph) {
+    int n = graph->n_nodes;
+    r->graph = graph;
+    r->transpose = graph_transpose(graph);
+    r->degree = malloc((n > 0 ? n : 1) * sizeof(int));
+    r->mark = calloc(n > 0 ? n : 1, sizeof(int));
+    assert(r->degree && r->mark);
+    r->stamp = 0;
+    for (int v = 0; v < n; v++) {
+        r->degree[v] = graph->offsets[v + 1] - graph->offsets[v] +
+            r->transpose->offsets[v + 1] - r->transpose->offsets[v];
+    }
+}
+
+static void reorder_finish(struct reorder* r) {
+    graph_free(r->transpose);
+    free(r->degree);
+    free(r->mark);
+}
+
+/*
+ * This function computes a breadth-first numbering of a graph's nodes.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.
+ *
+ * Return:
+ *   Returns an array of graph->n_nodes entries, where entry i is the node
+ *   that should get number i.  It should be freed with free().
+ */
+int* reorder_bfs(struct graph* graph) {
+    assert(graph);
+    struct reorder r;
+    reorder_init(&r, graph);
+    int* starts = malloc((graph->n_nodes > 0 ? graph->n_nodes : 1) *
+        sizeof(int));
+    assert(starts);
+    for (int v = 0; v < graph->n_nodes; v++) {
+        starts[v] = v;
+    }
+    int* order = number_components(&r, starts, 0);
+    free(starts);
+    reorder_finish(&r);
+    return order;
+}
+
+/*
+ * This function computes a reverse Cuthill-McKee numbering of a graph's
+ * nodes.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.
+ *
+ * Return:
+ *   Returns an array of graph->n_nodes entries, where entry i is the node
+ *   that should get number i.  It should be freed with free().
+ */
+int* reorder_rcm(struct graph* graph) {
+    assert(graph);
+    struct reorder r;
+    reorder_init(&r, graph);
+
+    /*
+     * Components are started from their lowest-degree node, so look at the
+     * nodes in order of degree (a counting sort).
+     */
+    int n = graph->n_nodes, max_degree = 0;
+    for (int v = 0; v < n; v++) {
+        if (r.degree[v] > max_degree) {
+            max_degree = r.degree[v];
+        }
+    }
+    int* count = calloc(max_degree + 2, sizeof(int));
+    int* starts = malloc((n > 0 ? n : 1) * sizeof(int));
+    assert(count && starts);
+    for (int v = 0; v < n; v++) {
+        count[r.degree[v] + 1]++;
+    }
+    for (int d = 0; d <= max_degree; d++) {
+        count[d + 1] += count[d];
+    }
+    for (int v = 0; v < n; v++) {
+        starts[count[r.degree[v]]++] = v;
+    }
+    free(count);
+
+    int* order = number_components(&r, starts, 1);
+    free(starts);
+    reorder_finish(&r);
+    return order;
+}
+
+/*
+ * This function measures how far apart the numbers of adjacent nodes are:
+ * the largest |u - v| over all edges u -> v.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.
+ *
+ * Return:
+ *   Returns the bandwidth, or 0 for a graph with no edges.
+ */
+int reorder_bandwidth(struct graph* graph) {
+    assert(graph);
+    int bandwidth = 0;
+    for (int u = 0; u < graph->n_nodes; u++) {
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            int d = abs(graph->targets[e] - u);
+            if (d > bandwidth) {
+                bandwidth = d;
+            }
+        }
+    }
+    return bandwidth;
+}
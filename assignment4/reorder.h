@@ -0,0 +1,22 @@
+/*
+ * This file contains the definition of the interface for the node
+ * reordering passes, which renumber a graph's nodes so that nodes close to
+ * each other in the graph are close to each other in memory.  You can find
+ * descriptions of the functions, including their parameters and their
+ * return values, in reorder.c.
+ */
+
+#ifndef __REORDER_H
+#define __REORDER_H
+
+#include "graph.h"
+
+/*
+ * Reordering function prototypes.  Refer to reorder.c for documentation
+ * about each of these functions.
+ */
+int* reorder_bfs(struct graph* graph);
+int* reorder_rcm(struct graph* graph);
+int reorder_bandwidth(struct graph* graph);
+
+#endif
@@ -0,0 +1,261 @@
+/*
+ * This file contains a shortest-path query server.  It answers queries on a
+ * graph that is loaded once, using a cache of shortest-path trees (see
+ * cache.c), either over standard input and output or over a Unix domain
+ * socket.
+ *
+ * The protocol is line based.  Each request is one line and gets exactly one
+ * line back:
+ *
+ *   DIST <s> <t>   ->  the distance from s to t, or "inf"
+ *   PATH <s> <t>   ->  the distance, then the nodes of a shortest path from
+ *                      s to t, all separated by spaces, or "inf"
+ *   STATS          ->  "hits <h> misses <m> cached <n>" for the tree cache
+ *   QUIT           ->  "bye", and the connection is closed
+ *   SHUTDOWN       ->  "bye", and the server stops accepting connections
+ *
+ * A malformed request gets a line starting with "error:".
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "server.h"
+
+/*
+ * Helper function to write the path from the tree's source to t, which must
+ * be reachable, using `path` (room for every node) as scratch space.
+ */
+static void print_path(FILE* out, struct sp_tree* tree, int t, int* path,
+        int n) {
+    int length = sssp_path(tree->prev, tree->source, t, path, n);
+    for (int i = 0; i < length; i++) {
+        fprintf(out, " %d", path[i]);
+    }
+}
+
+/*
+ * This function answers requests read from `in`, writing the responses to
+ * `out`, until the end of the input or a QUIT or SHUTDOWN request.  The
+ * output is flushed after every response, so it can be used interactively.
+ *
+ * Params:
+ *   cache - the tree cache to answer from.  May not be NULL.
+ *   in, out - the streams to read requests from and write responses to.
+ *
+ * Return:
+ *   Returns 1 if the input asked for SHUTDOWN, 0 otherwise.
+ */
+int server_handle(struct tree_cache* cache, FILE* in, FILE* out) {
+    assert(cache && in && out);
+    int n = tree_cache_graph(cache)->n_nodes;
+    int* path = NULL;
+    char* line = NULL;
+    size_t capacity = 0;
+    int shutdown = 0;
+
+    while (getline(&line, &capacity, in) >= 0) {
+        char command[16];
+        int s, t, extra;
+        int fields = sscanf(line, "%15s %d %d %n", command, &s, &t, &extra);
+        if (fields < 1) {
+            continue;
+        }
+
+        if (!strcmp(command, "DIST") || !strcmp(command, "PATH")) {
+            if (fields < 3 || line[extra] != '\0') {
+                fprintf(out, "error: usage: %s <s> <t>\n", command);
+            } else if (s < 0 || s >= n || t < 0 || t >= n) {
+                fprintf(out, "error: no such node\n");
+            } else {
+                struct sp_tree* tree = tree_cache_get(cache, s);
+                if (tree->dist[t] == DIST_INF) {
+                    fprintf(out, "inf");
+                } else {
+                    fprintf(out, "%lld", (long long)tree->dist[t]);
+                    if (command[0] == 'P') {
+                        if (path == NULL) {
+                            path = malloc(n * sizeof(int));
+                            assert(path);
+                        }
+                        print_path(out, tree, t, path, n);
+                    }
+                }
+                fprintf(out, "\n");
+                tree_cache_release(cache, tree);
+            }
+        } else if (!strcmp(command, "STATS")) {
+            long hits, misses;
+            int size;
+            tree_cache_stats(cache, &hits, &misses, &size);
+            fprintf(out, "hits %ld misses %ld cached %d\n", hits, misses,
+                size);
+        } else if (!strcmp(command, "QUIT")) {
+            fprintf(out, "bye\n");
+            break;
+        } else if (!strcmp(command, "SHUTDOWN")) {
+            fprintf(out, "bye\n");
+            shutdown = 1;
+            break;
+        } else {
+            fprintf(out, "error: unknown command %s\n", command);
+        }
+        fflush(out);
+    }
+    fflush(out);
+    free(line);
+    free(path);
+    return shutdown;
+}
+
+/*
+ * State shared by the threads of the socket server.
+ */
+struct server {
+    struct tree_cache* cache;
+    int listener;
+    int stopping;
+    int active;
+    pthread_mutex_t lock;
+    pthread_cond_t idle;
+};
+
+struct connection {
+    struct server* server;
+    int fd;
+};
+
+/*
+ * Thread body for one client connection.
+ */
+static void* serve_connection(void* arg) {
+    struct connection* c = arg;
+    struct server* server = c->server;
+    FILE* in = fdopen(c->fd, "r");
+    FILE* out = fdopen(dup(c->fd), "w");
+    if (in && out && server_handle(server->cache, in, out)) {
+        pthread_mutex_lock(&server->lock);
+        if (!server->stopping) {
+            server->stopping = 1;
+            shutdown(server->listener, SHUT_RDWR);
+        }
+        pthread_mutex_unlock(&server->lock);
+    }
+    if (in) {
+        fclose(in);
+    }
+    if (out) {
+        fclose(out);
+    }
+    free(c);
+
+    pthread_mutex_lock(&server->lock);
+    if (--server->active == 0) {
+        pthread_cond_signal(&server->idle);
+    }
+    pthread_mutex_unlock(&server->lock);
+    return NULL;
+}
+
+/*
+ * This function serves requests on a Unix domain socket, one thread per
+ * client connection, until a client sends SHUTDOWN.  It then waits for the
+ * other clients to disconnect before returning.  The socket file is created
+ * (replacing any old one) and removed again at the end.
+ *
+ * Params:
+ *   cache - the tree cache to answer from.  May not be NULL.
+ *   path - the path of the socket.
+ *
+ * Return:
+ *   Returns 0 after a SHUTDOWN request, or -1 if the socket couldn't be set
+ *   up, in which case an error message is printed to stderr.
+ */
+int server_run_socket(struct tree_cache* cache, const char* path) {
+    assert(cache && path);
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "%s: socket path too long\n", path);
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+
+    /*
+     * A client that disconnects early shouldn't kill the server when it
+     * writes the response.
+     */
+    struct sigaction ignore;
+    memset(&ignore, 0, sizeof(ignore));
+    ignore.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &ignore, NULL);
+
+    struct server server;
+    server.cache = cache;
+    server.stopping = 0;
+    server.active = 0;
+    server.listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path);
+    if (server.listener < 0 ||
+            bind(server.listener, (struct sockaddr*)&address,
+                sizeof(address)) != 0 ||
+            listen(server.listener, 64) != 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        if (server.listener >= 0) {
+            close(server.listener);
+        }
+        return -1;
+    }
+    pthread_mutex_init(&server.lock, NULL);
+    pthread_cond_init(&server.idle, NULL);
+
+    for (;;) {
+        int fd = accept(server.listener, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            break;
+        }
+        pthread_mutex_lock(&server.lock);
+        int stopping = server.stopping;
+        if (!stopping) {
+            server.active++;
+        }
+        pthread_mutex_unlock(&server.lock);
+        if (stopping) {
+            close(fd);
+            break;
+        }
+
+        struct connection* c = malloc(sizeof(struct connection));
+        assert(c);
+        c->server = &server;
+        c->fd = fd;
+        pthread_t thread;
+        pthread_create(&thread, NULL, serve_connection, c);
+        pthread_detach(thread);
+    }
+
+    pthread_mutex_lock(&server.lock);
+    while (server.active > 0) {
+        pthread_cond_wait(&server.idle, &server.lock);
+    }
+    pthread_mutex_unlock(&server.lock);
+    pthread_cond_destroy(&server.idle);
+    pthread_mutex_destroy(&server.lock);
+    close(server.listener);
+    unlink(path);
+    return 0;
+}
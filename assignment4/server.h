@@ -0,0 +1,21 @@
+/*
+ * This file contains the definition of the interface for the shortest-path
+ * query server.  You can find descriptions of the functions, including their
+ * parameters and their return values, and of the line protocol in server.c.
+ */
+
+#ifndef __SERVER_H
+#define __SERVER_H
+
+#include <stdio.h>
+
+#include "cache.h"
+
+/*
+ * Query server function prototypes.  Refer to server.c for documentation
+ * about each of these functions.
+ */
+int server_handle(struct tree_cache* cache, FILE* in, FILE* out);
+int server_run_socket(struct tree_cache* cache, const char* path);
+
+#endif
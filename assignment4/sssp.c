@@ -0,0 +1,993 @@
+/*
+ * This file contains single-source shortest-path engines for the CSR graphs
+ * from graph.h.  All edge weights are assumed to be non-negative.
+ *
+ * sssp_dijkstra() is Dijkstra's algorithm driven by the binary-heap priority
+ * queue from pq.c, with lazy deletion instead of decrease-key.
+ *
+ * sssp_delta_stepping() is the delta-stepping algorithm of Meyer and Sanders.
+ * Nodes are kept in buckets of width delta by tentative distance.  The lowest
+ * non-empty bucket is emptied by relaxing the light edges (weight < delta) of
+ * its nodes in parallel until no node re-enters it; the heavy edges of every
+ * node removed from the bucket are then relaxed once, since they can only
+ * reach later buckets.  Distances are lowered with an atomic compare-and-swap,
+ * so threads never lock.
+ *
+ * Several shortest-path trees can share the same distances, and which one an
+ * engine finds depends on the order it relaxes edges in.  Both engines hand
+ * back the predecessors from sssp_canonical_previous() instead, so their
+ * output is identical to each other's and to the matrix version in
+ * dijkstra.c.
+ *
+ * sssp_batch() runs the heap-based engine from many sources at once, one
+ * source per thread at a time, and writes the distances to a file.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "sssp.h"
+#include "pq.h"
+#include "bitset.h"
+
+/*
+ * Frontier nodes are handed to threads in blocks of this many.
+ */
+#define FRONTIER_BLOCK 64
+
+/*
+ * Helper function to lower *p to d atomically if d is smaller.
+ *
+ * Return:
+ *   Returns 1 if *p was lowered, 0 otherwise.
+ */
+static int atomic_min_dist(dist_t* p, dist_t d) {
+    dist_t old = __atomic_load_n(p, __ATOMIC_RELAXED);
+    while (d < old) {
+        if (__atomic_compare_exchange_n(p, &old, d, 1, __ATOMIC_RELAXED,
+                __ATOMIC_RELAXED)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Helper function to run fn(&args[i]) on n threads and wait for all of them.
+ * args is an array of n elements of the given size.
+ */
+static void run_threads(void* (*fn)(void*), void* args, size_t size, int n) {
+    if (n == 1) {
+        fn(args);
+        return;
+    }
+    pthread_t* threads = malloc(n * sizeof(pthread_t));
+    assert(threads);
+    for (int i = 0; i < n; i++) {
+        pthread_create(&threads[i], NULL, fn, (char*)args + i * size);
+    }
+    for (int i = 0; i < n; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+}
+
+/*****************************************************************************
+ **
+ ** Canonical predecessors
+ **
+ *****************************************************************************/
+
+/*
+ * State for one thread of sssp_canonical_previous().  Each thread scans the
+ * outgoing edges of the nodes in [lo, hi).
+ */
+struct previous_range {
+    struct graph* graph;
+    dist_t* dist;
+    int* rank;
+    unsigned long long* best;
+    int lo;
+    int hi;
+    int zero;
+};
+
+/*
+ * Among the positive-weight edges u -> v with dist[u] + w == dist[v], the
+ * matrix version of Dijkstra keeps the one whose tail it settled first, i.e.
+ * the one with the smallest (dist[u], rank[u]), where rank[u] orders nodes at
+ * the same distance (see sssp_canonical_previous()).  Since dist[u] =
+ * dist[v] - w, that is the edge with the largest w, then the smallest rank.
+ * Each candidate is packed into one 64-bit key in that order so the best can
+ * be kept with an atomic minimum.  Zero-weight edges on shortest paths are
+ * only counted here.
+ */
+static void* previous_range(void* arg) {
+    struct previous_range* r = arg;
+    struct graph* graph = r->graph;
+    for (int u = r->lo; u < r->hi; u++) {
+        dist_t du = r->dist[u];
+        if (du == DIST_INF) {
+            continue;
+        }
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            int v = graph->targets[e];
+            int w = graph->weights[e];
+            if (du + w != r->dist[v]) {
+                continue;
+            }
+            if (w == 0) {
+                r->zero |= u != v;
+                continue;
+            }
+            unsigned long long key =
+                (unsigned long long)(unsigned int)(INT_MAX - w) << 32 |
+                (unsigned int)(r->rank ? r->rank[u] : u);
+            unsigned long long old = __atomic_load_n(&r->best[v],
+                __ATOMIC_RELAXED);
+            while (key < old && !__atomic_compare_exchange_n(&r->best[v],
+                    &old, key, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            }
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Helper function to run previous_range() over all nodes, with the nodes
+ * split into ranges with about the same number of edges.
+ *
+ * Return:
+ *   Returns 1 if some zero-weight edge between two different nodes lies on a
+ *   shortest path, 0 otherwise.
+ */
+static int find_best(struct graph* graph, dist_t* dist, int* rank,
+        unsigned long long* best, int n_threads) {
+    int n = graph->n_nodes;
+    struct previous_range* ranges = malloc(n_threads *
+        sizeof(struct previous_range));
+    assert(ranges);
+    memset(best, 0xff, n * sizeof(unsigned long long));
+
+    int u = 0;
+    for (int i = 0; i < n_threads; i++) {
+        long goal = (long)graph->n_edges * (i + 1) / n_threads;
+        ranges[i].graph = graph;
+        ranges[i].dist = dist;
+        ranges[i].rank = rank;
+        ranges[i].best = best;
+        ranges[i].zero = 0;
+        ranges[i].lo = u;
+        while (u < n && (i == n_threads - 1 || graph->offsets[u + 1] <= goal)) {
+            u++;
+        }
+        ranges[i].hi = u;
+    }
+    run_threads(previous_range, ranges, sizeof(struct previous_range),
+        n_threads);
+
+    int zero = 0;
+    for (int i = 0; i < n_threads; i++) {
+        zero |= ranges[i].zero;
+    }
+    free(ranges);
+    return zero;
+}
+
+/*
+ * A node and its distance, for sorting nodes by (distance, index).
+ */
+struct level_node {
+    dist_t dist;
+    int node;
+};
+
+static int level_node_cmp(const void* a, const void* b) {
+    const struct level_node* x = a;
+    const struct level_node* y = b;
+    if (x->dist != y->dist) {
+        return x->dist < y->dist ? -1 : 1;
+    }
+    return x->node - y->node;
+}
+
+static int dist_cmp(const void* a, const void* b) {
+    dist_t x = *(const dist_t*)a, y = *(const dist_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+/*
+ * Helper function to replay the order in which the matrix version of
+ * Dijkstra settles the nodes at each distance that is shared over a
+ * zero-weight edge.  At such a distance d, it repeatedly settles the
+ * lowest-numbered node at d that has been reached so far.  The nodes reached
+ * from the start are those with a positive-weight edge from a closer node
+ * (best[v] is set) and the source; the rest are reached over zero-weight
+ * edges from nodes at d as those are settled, and their predecessor is the
+ * first of those.
+ *
+ * The order is stored in rank[], which starts out as the identity: the
+ * indices of the nodes at d are handed out again in settling order, so rank
+ * stays a permutation and compares nodes at the same distance in the order
+ * they are settled.  Predecessors over zero-weight edges go into prev[].
+ */
+static void zero_weight_order(struct graph* graph, int source, dist_t* dist,
+        unsigned long long* best, int* rank, int* prev) {
+    int n = graph->n_nodes;
+
+    /*
+     * Find the distances shared over zero-weight edges, then every node at
+     * one of those distances.
+     */
+    int n_levels = 0;
+    dist_t* levels = malloc(n * sizeof(dist_t));
+    assert(levels);
+    for (int u = 0; u < n; u++) {
+        if (dist[u] == DIST_INF) {
+            continue;
+        }
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            int v = graph->targets[e];
+            if (graph->weights[e] == 0 && dist[v] == dist[u] && v != u) {
+                levels[n_levels++] = dist[u];
+                break;
+            }
+        }
+    }
+    qsort(levels, n_levels, sizeof(dist_t), dist_cmp);
+
+    int count = 0;
+    struct level_node* nodes = malloc(n * sizeof(struct level_node));
+    assert(nodes);
+    for (int v = 0; v < n; v++) {
+        if (dist[v] != DIST_INF && bsearch(&dist[v], levels, n_levels,
+                sizeof(dist_t), dist_cmp)) {
+            nodes[count].dist = dist[v];
+            nodes[count++].node = v;
+        }
+    }
+    qsort(nodes, count, sizeof(struct level_node), level_node_cmp);
+
+    struct bitset* reached = bitset_create(n);
+    struct pq* pq = pq_create();
+    for (int lo = 0, hi; lo < count; lo = hi) {
+        for (hi = lo; hi < count && nodes[hi].dist == nodes[lo].dist; hi++) {
+            int v = nodes[hi].node;
+            if (best[v] != ~0ULL || v == source) {
+                bitset_set(reached, v);
+                pq_insert(pq, (void*)(long)v, v);
+            }
+        }
+        int next = lo;
+        while (!pq_isempty(pq)) {
+            int u = (int)(long)pq_remove_first(pq);
+            rank[u] = nodes[next++].node;
+            for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+                int v = graph->targets[e];
+                if (graph->weights[e] == 0 && dist[v] == dist[u] &&
+                        !bitset_test(reached, v)) {
+                    bitset_set(reached, v);
+                    prev[v] = u;
+                    pq_insert(pq, (void*)(long)v, v);
+                }
+            }
+        }
+    }
+    pq_free(pq);
+    bitset_free(reached);
+    free(nodes);
+    free(levels);
+}
+
+/*
+ * This function fills in a predecessor array from final shortest-path
+ * distances.  The predecessor of each node v is the tail u of an edge on a
+ * shortest path to v, chosen with the same tie-breaking as the matrix
+ * version of Dijkstra in dijkstra.c, i.e. the u it would settle first.
+ * Without zero-weight edges that is the u with the smallest (dist[u], u).
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.
+ *   source - the node the distances were computed from.
+ *   dist - the final distances, with DIST_INF for unreachable nodes.
+ *   prev - array of graph->n_nodes entries to fill in.  The source's
+ *     predecessor is the source itself and unreachable nodes get -1.
+ *   n_threads - the number of threads to use.
+ */
+void sssp_canonical_previous(struct graph* graph, int source, dist_t* dist,
+        int* prev, int n_threads) {
+    assert(graph && dist && prev);
+    int n = graph->n_nodes;
+    if (n_threads < 1) {
+        n_threads = 1;
+    }
+    if (n_threads > n) {
+        n_threads = n > 0 ? n : 1;
+    }
+
+    unsigned long long* best = malloc((n > 0 ? n : 1) *
+        sizeof(unsigned long long));
+    assert(best);
+    for (int v = 0; v < n; v++) {
+        prev[v] = -1;
+    }
+
+    int* rank = NULL;
+    if (find_best(graph, dist, NULL, best, n_threads)) {
+        /*
+         * Ties between nodes at the same distance may not be broken by index,
+         * so look for the best edges again once the order is known.
+         */
+        rank = malloc(n * sizeof(int));
+        assert(rank);
+        for (int v = 0; v < n; v++) {
+            rank[v] = v;
+        }
+        zero_weight_order(graph, source, dist, best, rank, prev);
+        find_best(graph, dist, rank, best, n_threads);
+
+        int* node = malloc(n * sizeof(int));
+        assert(node);
+        for (int v = 0; v < n; v++) {
+            node[rank[v]] = v;
+        }
+        free(rank);
+        rank = node;
+    }
+
+    for (int v = 0; v < n; v++) {
+        if (best[v] != ~0ULL) {
+            int r = (int)(best[v] & 0xffffffffULL);
+            prev[v] = rank ? rank[r] : r;
+        }
+    }
+    prev[source] = source;
+    free(rank);
+    free(best);
+}
+
+/*****************************************************************************
+ **
+ ** Heap-based Dijkstra
+ **
+ *****************************************************************************/
+
+/*
+ * Helper function to run Dijkstra's algorithm from source, using pq, which
+ * must be an empty queue from pq_create64(0), as the queue.  The queue is
+ * empty again on return, so one can be reused for many runs.
+ */
+static void dijkstra_run(struct graph* graph, int source, dist_t* dist,
+        struct pq* pq) {
+    for (int v = 0; v < graph->n_nodes; v++) {
+        dist[v] = DIST_INF;
+    }
+    dist[source] = 0;
+
+    pq_insert64(pq, (void*)(long)source, 0);
+    while (!pq_isempty(pq)) {
+        dist_t du = pq_first_priority64(pq);
+        int u = (int)(long)pq_remove_first(pq);
+        if (du > dist[u]) {
+            continue;
+        }
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            int v = graph->targets[e];
+            dist_t d = du + graph->weights[e];
+            if (d < dist[v]) {
+                dist[v] = d;
+                pq_insert64(pq, (void*)(long)v, d);
+            }
+        }
+    }
+}
+
+/*
+ * This function computes shortest paths from one node with Dijkstra's
+ * algorithm, using the priority queue from pq.c.  Instead of decreasing a
+ * node's priority, a node is inserted again every time its distance drops,
+ * and stale entries are skipped as they come out of the queue.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.
+ *   source - the node to start from.
+ *   dist - array of graph->n_nodes entries that receives the distances,
+ *     with DIST_INF for unreachable nodes.
+ *   prev - array of graph->n_nodes entries that receives the predecessors
+ *     (see sssp_canonical_previous()), or NULL if they aren't needed.
+ */
+void sssp_dijkstra(struct graph* graph, int source, dist_t* dist, int* prev) {
+    assert(graph && dist);
+    assert(source >= 0 && source < graph->n_nodes);
+
+    struct pq* pq = pq_create64(0);
+    dijkstra_run(graph, source, dist, pq);
+    pq_free(pq);
+
+    if (prev) {
+        sssp_canonical_previous(graph, source, dist, prev, 1);
+    }
+}
+
+/*****************************************************************************
+ **
+ ** Delta-stepping
+ **
+ *****************************************************************************/
+
+/*
+ * A growable list of node indices.
+ */
+struct bucket {
+    int* items;
+    int size;
+    int capacity;
+};
+
+static void bucket_push(struct bucket* b, int v) {
+    if (b->size == b->capacity) {
+        b->capacity = b->capacity ? 2 * b->capacity : 16;
+        b->items = realloc(b->items, b->capacity * sizeof(int));
+        assert(b->items);
+    }
+    b->items[b->size++] = v;
+}
+
+struct delta_state;
+
+/*
+ * Per-thread state.  Each thread keeps its own copy of every bucket so that
+ * pushing a node never needs synchronization, plus the list of nodes it has
+ * removed from the current bucket, whose heavy edges are still to be relaxed.
+ */
+struct delta_thread {
+    struct delta_state* s;
+    int id;
+    struct bucket* buckets;
+    struct bucket removed;
+};
+
+/*
+ * State shared by all threads.  Buckets are indexed cyclically: no edge is
+ * longer than max_weight, so all nodes waiting in buckets are within
+ * max_weight / delta + 1 buckets of the current one.
+ */
+struct delta_state {
+    struct graph* graph;
+    int delta;
+    int n_buckets;
+    int n_threads;
+    dist_t* dist;
+
+    /*
+     * A copy of the adjacency lists with each node's light edges moved in
+     * front of its heavy ones; light_end[u] is where the heavy edges start.
+     */
+    int* targets;
+    int* weights;
+    int* light_end;
+
+    /*
+     * The nodes that have been removed from their bucket, to put each on
+     * only one thread's removed list.  A node is only ever removed from one
+     * bucket, the one its final distance falls in, so one bit is enough.
+     */
+    struct bitset* removed;
+
+    struct delta_thread* threads;
+    pthread_barrier_t barrier;
+
+    /*
+     * The nodes being relaxed in the current phase, gathered from every
+     * thread's copy of the current bucket, and the next block of them to
+     * hand out.
+     */
+    int* frontier;
+    int frontier_size;
+    int frontier_capacity;
+    int next;
+
+    long current;
+    int done;
+};
+
+/*
+ * Helper function to relax edges [lo, hi) of node u, whose distance is du,
+ * filing every node that gets closer into the caller's buckets.
+ */
+static void relax_edges(struct delta_thread* t, dist_t du, int lo, int hi) {
+    struct delta_state* s = t->s;
+    for (int e = lo; e < hi; e++) {
+        int v = s->targets[e];
+        dist_t d = du + s->weights[e];
+        if (atomic_min_dist(&s->dist[v], d)) {
+            bucket_push(&t->buckets[(d / s->delta) % s->n_buckets], v);
+        }
+    }
+}
+
+/*
+ * Helper function, run by thread 0 alone, to move the contents of every
+ * thread's copy of the current bucket into the frontier.
+ */
+static void gather_frontier(struct delta_state* s) {
+    int b = s->current % s->n_buckets;
+    int size = 0;
+    for (int i = 0; i < s->n_threads; i++) {
+        size += s->threads[i].buckets[b].size;
+    }
+    if (size > s->frontier_capacity) {
+        s->frontier_capacity = 2 * size;
+        free(s->frontier);
+        s->frontier = malloc(s->frontier_capacity * sizeof(int));
+        assert(s->frontier);
+    }
+
+    size = 0;
+    for (int i = 0; i < s->n_threads; i++) {
+        struct bucket* bucket = &s->threads[i].buckets[b];
+        if (bucket->size > 0) {
+            memcpy(s->frontier + size, bucket->items,
+                bucket->size * sizeof(int));
+            size += bucket->size;
+        }
+        bucket->size = 0;
+    }
+    s->frontier_size = size;
+    s->next = 0;
+}
+
+/*
+ * Helper function, run by thread 0 alone, to move on to the next non-empty
+ * bucket, or to set s->done if there are none.
+ */
+static void advance_bucket(struct delta_state* s) {
+    for (int k = 1; k < s->n_buckets; k++) {
+        int b = (s->current + k) % s->n_buckets;
+        for (int i = 0; i < s->n_threads; i++) {
+            if (s->threads[i].buckets[b].size > 0) {
+                s->current += k;
+                gather_frontier(s);
+                return;
+            }
+        }
+    }
+    s->done = 1;
+}
+
+/*
+ * Thread body for delta-stepping.  All threads run the same loop and meet at
+ * a barrier between phases; thread 0 does the bookkeeping between them.
+ */
+static void* delta_thread(void* arg) {
+    struct delta_thread* t = arg;
+    struct delta_state* s = t->s;
+    struct graph* graph = s->graph;
+
+    /*
+     * Split the adjacency lists of this thread's share of the nodes into
+     * light and heavy edges.
+     */
+    int n = graph->n_nodes;
+    int lo = (long)n * t->id / s->n_threads;
+    int hi = (long)n * (t->id + 1) / s->n_threads;
+    for (int u = lo; u < hi; u++) {
+        int out = graph->offsets[u];
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            if (graph->weights[e] < s->delta) {
+                s->targets[out] = graph->targets[e];
+                s->weights[out++] = graph->weights[e];
+            }
+        }
+        s->light_end[u] = out;
+        for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            if (graph->weights[e] >= s->delta) {
+                s->targets[out] = graph->targets[e];
+                s->weights[out++] = graph->weights[e];
+            }
+        }
+    }
+    pthread_barrier_wait(&s->barrier);
+
+    while (!s->done) {
+        /*
+         * Relax light edges out of the current bucket until it stays empty.
+         * Nodes whose distance has since dropped into an earlier bucket are
+         * stale copies and are skipped.
+         */
+        while (s->frontier_size > 0) {
+            int i;
+            while ((i = __atomic_fetch_add(&s->next, FRONTIER_BLOCK,
+                    __ATOMIC_RELAXED)) < s->frontier_size) {
+                int end = i + FRONTIER_BLOCK < s->frontier_size ?
+                    i + FRONTIER_BLOCK : s->frontier_size;
+                for (; i < end; i++) {
+                    int u = s->frontier[i];
+                    dist_t du = __atomic_load_n(&s->dist[u], __ATOMIC_RELAXED);
+                    if (du / s->delta != s->current) {
+                        continue;
+                    }
+                    if (bitset_set_atomic(s->removed, u)) {
+                        bucket_push(&t->removed, u);
+                    }
+                    relax_edges(t, du, graph->offsets[u], s->light_end[u]);
+                }
+            }
+            pthread_barrier_wait(&s->barrier);
+            if (t->id == 0) {
+                gather_frontier(s);
+            }
+            pthread_barrier_wait(&s->barrier);
+        }
+
+        /*
+         * The bucket is settled, so heavy edges out of it are relaxed once.
+         */
+        for (int i = 0; i < t->removed.size; i++) {
+            int u = t->removed.items[i];
+            relax_edges(t, s->dist[u], s->light_end[u], graph->offsets[u + 1]);
+        }
+        t->removed.size = 0;
+        pthread_barrier_wait(&s->barrier);
+        if (t->id == 0) {
+            advance_bucket(s);
+        }
+        pthread_barrier_wait(&s->barrier);
+    }
+    return NULL;
+}
+
+/*
+ * This function picks a bucket width for sssp_delta_stepping(): the maximum
+ * edge weight divided by the average out-degree, which keeps the number of
+ * times a node is relaxed close to one while leaving each bucket enough
+ * nodes to split among threads.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.
+ *
+ * Return:
+ *   Returns a bucket width of at least 1.
+ */
+int sssp_default_delta(struct graph* graph) {
+    assert(graph);
+    int max_weight = 0;
+    for (int e = 0; e < graph->n_edges; e++) {
+        if (graph->weights[e] > max_weight) {
+            max_weight = graph->weights[e];
+        }
+    }
+    long degree = graph->n_nodes > 0 ?
+        (graph->n_edges + graph->n_nodes - 1) / graph->n_nodes : 1;
+    int delta = degree > 0 ? max_weight / degree : max_weight;
+    return delta > 0 ? delta : 1;
+}
+
+/*
+ * This function computes shortest paths from one node with parallel
+ * delta-stepping.  The distances and predecessors are identical to those
+ * from sssp_dijkstra().
+ *
+ * A small delta does little wasted work but has many buckets with few nodes
+ * each, so threads spend most of their time waiting at barriers; a large
+ * delta relaxes some nodes more than once.  With delta larger than every
+ * edge weight, all edges are light and the algorithm becomes a parallel
+ * Bellman-Ford.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.
+ *   source - the node to start from.
+ *   delta - the bucket width, at least 1, or 0 to use
+ *     sssp_default_delta().
+ *   n_threads - the number of threads to use.
+ *   dist - array of graph->n_nodes entries that receives the distances,
+ *     with DIST_INF for unreachable nodes.
+ *   prev - array of graph->n_nodes entries that receives the predecessors
+ *     (see sssp_canonical_previous()), or NULL if they aren't needed.
+ */
+void sssp_delta_stepping(struct graph* graph, int source, int delta,
+        int n_threads, dist_t* dist, int* prev) {
+    assert(graph && dist);
+    assert(source >= 0 && source < graph->n_nodes);
+    assert(delta >= 0);
+    if (delta == 0) {
+        delta = sssp_default_delta(graph);
+    }
+    if (n_threads < 1) {
+        n_threads = 1;
+    }
+
+    int n = graph->n_nodes;
+    int max_weight = 0;
+    for (int e = 0; e < graph->n_edges; e++) {
+        assert(graph->weights[e] >= 0);
+        if (graph->weights[e] > max_weight) {
+            max_weight = graph->weights[e];
+        }
+    }
+
+    struct delta_state s;
+    s.graph = graph;
+    s.delta = delta;
+    s.n_buckets = max_weight / delta + 2;
+    s.n_threads = n_threads;
+    s.dist = dist;
+    s.targets = malloc((graph->n_edges > 0 ? graph->n_edges : 1) *
+        sizeof(int));
+    s.weights = malloc((graph->n_edges > 0 ? graph->n_edges : 1) *
+        sizeof(int));
+    s.light_end = malloc(n * sizeof(int));
+    s.removed = bitset_create(n);
+    s.threads = calloc(n_threads, sizeof(struct delta_thread));
+    s.frontier_capacity = 16;
+    s.frontier = malloc(s.frontier_capacity * sizeof(int));
+    assert(s.targets && s.weights && s.light_end && s.threads &&
+        s.frontier);
+    pthread_barrier_init(&s.barrier, NULL, n_threads);
+
+    for (int v = 0; v < n; v++) {
+        dist[v] = DIST_INF;
+    }
+    dist[source] = 0;
+    for (int i = 0; i < n_threads; i++) {
+        s.threads[i].s = &s;
+        s.threads[i].id = i;
+        s.threads[i].buckets = calloc(s.n_buckets, sizeof(struct bucket));
+        assert(s.threads[i].buckets);
+    }
+    s.frontier[0] = source;
+    s.frontier_size = 1;
+    s.next = 0;
+    s.current = 0;
+    s.done = 0;
+
+    run_threads(delta_thread, s.threads, sizeof(struct delta_thread),
+        n_threads);
+
+    pthread_barrier_destroy(&s.barrier);
+    for (int i = 0; i < n_threads; i++) {
+        for (int b = 0; b < s.n_buckets; b++) {
+            free(s.threads[i].buckets[b].items);
+        }
+        free(s.threads[i].buckets);
+        free(s.threads[i].removed.items);
+    }
+    free(s.threads);
+    free(s.frontier);
+    bitset_free(s.removed);
+    free(s.light_end);
+    free(s.weights);
+    free(s.targets);
+
+    if (prev) {
+        sssp_canonical_previous(graph, source, dist, prev, n_threads);
+    }
+}
+
+/*****************************************************************************
+ **
+ ** Batches of sources
+ **
+ *****************************************************************************/
+
+/*
+ * State shared by the threads of sssp_batch().  Sources are handed out one
+ * at a time through `next`, and each thread writes its rows straight to
+ * their place in the file, so rows can finish in any order.
+ */
+struct batch {
+    struct graph* graph;
+    int* sources;
+    int n_sources;
+    int next;
+    int fd;
+    off_t rows;
+    int error;
+};
+
+/*
+ * Per-thread state for sssp_batch().  The distance row and the queue are
+ * reused for every source the thread runs.
+ */
+struct batch_thread {
+    struct batch* batch;
+    dist_t* dist;
+    struct pq* pq;
+};
+
+/*
+ * Helper function to write `size` bytes at `offset` in a file, returning 0
+ * on success.
+ */
+static int pwrite_all(int fd, const void* data, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t written = pwrite(fd, data, size, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data = (const char*)data + written;
+        size -= written;
+        offset += written;
+    }
+    return 0;
+}
+
+static void* batch_thread(void* arg) {
+    struct batch_thread* t = arg;
+    struct batch* b = t->batch;
+    size_t row_size = (size_t)b->graph->n_nodes * sizeof(dist_t);
+    int i;
+    while ((i = __atomic_fetch_add(&b->next, 1, __ATOMIC_RELAXED)) <
+            b->n_sources && !__atomic_load_n(&b->error, __ATOMIC_RELAXED)) {
+        dijkstra_run(b->graph, b->sources[i], t->dist, t->pq);
+        if (pwrite_all(b->fd, t->dist, row_size, b->rows + i * row_size)) {
+            __atomic_store_n(&b->error, errno, __ATOMIC_RELAXED);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * This function computes the distances from each of a list of sources and
+ * writes them to a distance matrix file.  The sources are spread over
+ * threads that share the read-only graph; each thread runs the heap-based
+ * Dijkstra with its own distance row and queue, reused from one source to
+ * the next.
+ *
+ * The file starts with a struct sssp_matrix_header, followed by the list of
+ * sources, padded with zeros to a multiple of 8 bytes, and then one row of
+ * graph->n_nodes distances (of type dist_t, with DIST_INF for unreachable
+ * nodes) per source, in the order of the list.
+ *
+ * Params:
+ *   graph - the graph.  May not be NULL.
+ *   sources - the sources, or NULL for every node in order.
+ *   n_sources - the number of sources.  Ignored if sources is NULL.
+ *   n_threads - the number of threads to use.
+ *   path - the path of the file to write.  An existing file is replaced.
+ *
+ * Return:
+ *   Returns 0 on success or -1 if the file couldn't be written, in which
+ *   case an error message is printed to stderr.
+ */
+int sssp_batch(struct graph* graph, int* sources, int n_sources,
+        int n_threads, const char* path) {
+    assert(graph && path);
+    int* all = NULL;
+    if (sources == NULL) {
+        n_sources = graph->n_nodes;
+        all = malloc((n_sources > 0 ? n_sources : 1) * sizeof(int));
+        assert(all);
+        for (int i = 0; i < n_sources; i++) {
+            all[i] = i;
+        }
+        sources = all;
+    }
+    for (int i = 0; i < n_sources; i++) {
+        assert(sources[i] >= 0 && sources[i] < graph->n_nodes);
+    }
+    if (n_threads < 1) {
+        n_threads = 1;
+    }
+    if (n_threads > n_sources) {
+        n_threads = n_sources > 0 ? n_sources : 1;
+    }
+
+    struct batch b;
+    b.graph = graph;
+    b.sources = sources;
+    b.n_sources = n_sources;
+    b.next = 0;
+    b.error = 0;
+    b.rows = sizeof(struct sssp_matrix_header) +
+        ((n_sources * sizeof(int) + 7) & ~(size_t)7);
+    b.fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (b.fd < 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        free(all);
+        return -1;
+    }
+
+    struct sssp_matrix_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SSSP_MATRIX_MAGIC, sizeof(header.magic));
+    header.version = SSSP_MATRIX_VERSION;
+    header.dist_size = sizeof(dist_t);
+    header.n_nodes = graph->n_nodes;
+    header.n_sources = n_sources;
+    char* head = calloc(b.rows, 1);
+    assert(head);
+    memcpy(head, &header, sizeof(header));
+    memcpy(head + sizeof(header), sources, n_sources * sizeof(int));
+    if (pwrite_all(b.fd, head, b.rows, 0)) {
+        b.error = errno;
+    }
+    free(head);
+
+    struct batch_thread* threads = malloc(n_threads *
+        sizeof(struct batch_thread));
+    assert(threads);
+    for (int i = 0; i < n_threads; i++) {
+        threads[i].batch = &b;
+        threads[i].dist = malloc((graph->n_nodes > 0 ? graph->n_nodes : 1) *
+            sizeof(dist_t));
+        threads[i].pq = pq_create64(0);
+        assert(threads[i].dist);
+    }
+    if (!b.error) {
+        run_threads(batch_thread, threads, sizeof(struct batch_thread),
+            n_threads);
+    }
+    for (int i = 0; i < n_threads; i++) {
+        free(threads[i].dist);
+        pq_free(threads[i].pq);
+    }
+    free(threads);
+    free(all);
+
+    if (close(b.fd) != 0 && !b.error) {
+        b.error = errno;
+    }
+    if (b.error) {
+        fprintf(stderr, "%s: %s\n", path, strerror(b.error));
+        return -1;
+    }
+    return 0;
+}
+
+/*****************************************************************************
+ **
+ ** Paths
+ **
+ *****************************************************************************/
+
+/*
+ * This function writes out the nodes of the shortest path from a source to a
+ * target, found by following predecessors back from the target.  Nothing is
+ * allocated, so it can be called for millions of paths with one buffer.
+ *
+ * Params:
+ *   prev - the predecessors computed from source by one of the engines above
+ *     (or any array in which following predecessors from a reachable node
+ *     leads to the source, and unreachable nodes have -1).
+ *   source - the node the predecessors were computed from.
+ *   target - the node to find the path to.
+ *   path - buffer that receives the path, starting with source and ending
+ *     with target.  May be NULL if capacity is 0.
+ *   capacity - the number of nodes path has room for.
+ *
+ * Return:
+ *   Returns the number of nodes on the path, or -1 if target can't be
+ *   reached.  If that is more than capacity, nothing is written, and the
+ *   call can be repeated with a large enough buffer.
+ */
+int sssp_path(int* prev, int source, int target, int* path, int capacity) {
+    assert(prev && (path || capacity == 0));
+    int length = 1;
+    for (int v = target; v != source; v = prev[v]) {
+        if (prev[v] < 0) {
+            return -1;
+        }
+        length++;
+    }
+    if (length > capacity) {
+        return length;
+    }
+    int i = length;
+    for (int v = target; v != source; v = prev[v]) {
+        path[--i] = v;
+    }
+    path[0] = source;
+    return length;
+}
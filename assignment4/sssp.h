@@ -0,0 +1,63 @@
+/*
+ * This file contains the definition of the interface for the single-source
+ * shortest-path engines that run on the CSR graphs from graph.h.  You can
+ * find descriptions of the functions, including their parameters and their
+ * return values, in sssp.c.
+ */
+
+#ifndef __SSSP_H
+#define __SSSP_H
+
+#include <limits.h>
+
+#include "graph.h"
+
+/*
+ * Type used for path lengths, and the value used for unreachable nodes.
+ * Path lengths are 64 bits wide so that a path of up to 2^31 edges of up to
+ * INT_MAX each can't overflow.
+ */
+typedef long long dist_t;
+#define DIST_INF LLONG_MAX
+
+/*
+ * Returns the length of a path of length d extended by an edge of weight w
+ * (which must not be negative), saturating at DIST_INF so that relaxing an
+ * edge out of an unreachable node stays unreachable.
+ */
+static inline dist_t dist_add(dist_t d, int w) {
+  return d == DIST_INF || (w > 0 && d > DIST_INF - w) ? DIST_INF : d + w;
+}
+
+/*
+ * Header of the distance matrix files written by sssp_batch().  The header
+ * is followed by n_sources ints naming the sources, zero-padded to a
+ * multiple of 8 bytes, and then n_sources rows of n_nodes distances, each
+ * dist_size bytes long.
+ */
+#define SSSP_MATRIX_MAGIC "SPMATRIX"
+#define SSSP_MATRIX_VERSION 1
+
+struct sssp_matrix_header {
+  char magic[8];
+  unsigned int version;
+  unsigned int dist_size;
+  int n_nodes;
+  int n_sources;
+};
+
+/*
+ * Shortest-path engine function prototypes.  Refer to sssp.c for
+ * documentation about each of these functions.
+ */
+void sssp_dijkstra(struct graph* graph, int source, dist_t* dist, int* prev);
+void sssp_delta_stepping(struct graph* graph, int source, int delta,
+  int n_threads, dist_t* dist, int* prev);
+void sssp_canonical_previous(struct graph* graph, int source, dist_t* dist,
+  int* prev, int n_threads);
+int sssp_default_delta(struct graph* graph);
+int sssp_batch(struct graph* graph, int* sources, int n_sources,
+  int n_threads, const char* path);
+int sssp_path(int* prev, int source, int target, int* path, int capacity);
+
+#endif
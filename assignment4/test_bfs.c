@@ -0,0 +1,138 @@
+/*
+ * This is a small program to test the bitset and breadth-first search
+ * against Dijkstra's algorithm on unit-weight graphs.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bitset.h"
+#include "bfs.h"
+#include "gen.h"
+#include "graph.h"
+#include "sssp.h"
+
+/*
+ * Checks one search: depths must be the unit-weight distances, and every
+ * reached node but the source must have a parent one level up with an edge
+ * to it.
+ */
+int check(struct graph* graph, int source, int* depth, int* parent,
+    dist_t* dist) {
+  int ok = 1;
+  for (int v = 0; v < graph->n_nodes && ok; v++) {
+    ok = dist[v] == DIST_INF ? depth[v] == -1 && parent[v] == -1 :
+      depth[v] == dist[v];
+    if (ok && depth[v] > 0) {
+      int u = parent[v], edge = 0;
+      for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+        edge |= graph->targets[e] == v;
+      }
+      ok = edge && depth[u] == depth[v] - 1;
+    }
+  }
+  return ok && parent[source] == source;
+}
+
+int main(int argc, char** argv) {
+  /*
+   * 130 bits, so the last word is partly used.
+   */
+  printf("== Bitset\n");
+  struct bitset* a = bitset_create(130);
+  struct bitset* b = bitset_create(130);
+  bitset_set(a, 0);
+  bitset_set(a, 64);
+  bitset_set(a, 129);
+  printf("  - count (expect 3): %ld\n", bitset_count(a));
+  printf("  - test (expect 1 0 1): %d %d %d\n", bitset_test(a, 64),
+    bitset_test(a, 65), bitset_test(a, 129));
+  printf("  - next (expect 0 64 64 129 -1): %ld %ld %ld %ld %ld\n",
+    bitset_next(a, 0), bitset_next(a, 1), bitset_next(a, 64),
+    bitset_next(a, 65), bitset_next(a, 130));
+  int first = bitset_set_atomic(a, 5);
+  int second = bitset_set_atomic(a, 5);
+  printf("  - atomic set (expect 1 0): %d %d\n", first, second);
+  bitset_unset(a, 5);
+  bitset_fill(b);
+  printf("  - fill (expect 130): %ld\n", bitset_count(b));
+  bitset_andnot(b, a);
+  printf("  - andnot (expect 127 0): %ld %d\n", bitset_count(b),
+    bitset_test(b, 64));
+  bitset_or(b, a);
+  printf("  - or (expect 130): %ld\n", bitset_count(b));
+  bitset_clear(b);
+  bitset_set(b, 64);
+  bitset_and(b, a);
+  printf("  - and (expect 1 64): %ld %ld\n", bitset_count(b),
+    bitset_next(b, 0));
+  bitset_free(a);
+  bitset_free(b);
+
+  /*
+   * 0 -> 1 -> 2 -> 3 with a shortcut 0 -> 2, a cycle back 3 -> 0, and node 4
+   * unreachable.
+   */
+  printf("\n== Small graph\n");
+  int s[] = {0, 1, 2, 0, 3, 4};
+  int t[] = {1, 2, 3, 2, 0, 0};
+  int w[] = {5, 5, 5, 5, 5, 5};
+  struct graph* graph = graph_from_edges(5, 6, s, t, w);
+  struct bfs* bfs = bfs_create(graph);
+  int depth[5], parent[5];
+  for (int mode = 0; mode < 2; mode++) {
+    int reached = bfs_run(bfs, 0, mode, 1, depth, parent);
+    printf("  - %s (expect 4: 0 1 1 2 -1): %d:", mode ? "optimizing" :
+      "top-down", reached);
+    for (int v = 0; v < 5; v++) {
+      printf(" %d", depth[v]);
+    }
+    printf("\n");
+  }
+  printf("  - parents (expect 0 0 0 2 -1): %d %d %d %d %d\n", parent[0],
+    parent[1], parent[2], parent[3], parent[4]);
+  printf("  - levels (expect 3): %d\n", bfs_last_levels(bfs, NULL));
+  bfs_free(bfs);
+  graph_free(graph);
+
+  /*
+   * Random, power-law and grid graphs, big enough for the search to go
+   * bottom-up, searched with 1 to 4 threads.
+   */
+  printf("\n== Generated graphs\n");
+  int searches = 0, failures = 0, went_bottom_up = 0;
+  for (int g = 0; g < 12; g++) {
+    graph = g % 3 == 0 ? gen_random(2000 + 500 * g, 16000, 1, g) :
+      g % 3 == 1 ? gen_rmat(12, 30000, 1, g) : gen_grid(40, 30 + g, 1, g);
+    gen_reweight(graph, GEN_WEIGHTS_UNIT, 1, g);
+    int n = graph->n_nodes;
+    int* d = malloc(n * sizeof(int));
+    int* p = malloc(n * sizeof(int));
+    dist_t* dist = malloc(n * sizeof(dist_t));
+    bfs = bfs_create(graph);
+    for (int q = 0; q < 4; q++) {
+      int source = (q * 7919 + g) % n;
+      sssp_dijkstra(graph, source, dist, NULL);
+      for (int mode = 0; mode < 2; mode++) {
+        bfs_run(bfs, source, mode, 1 + q, d, p);
+        int bottom_up;
+        bfs_last_levels(bfs, &bottom_up);
+        went_bottom_up += bottom_up > 0;
+        failures += !check(graph, source, d, p, dist);
+        searches++;
+      }
+    }
+    bfs_free(bfs);
+    free(d);
+    free(p);
+    free(dist);
+    graph_free(graph);
+  }
+  printf("  - searches (expect 96): %d\n", searches);
+  printf("  - wrong depths or parents (expect 0): %d\n", failures);
+  printf("  - some went bottom-up (expect 1): %d\n", went_bottom_up > 0);
+
+  return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * This is a small program to test contraction hierarchies against full runs
+ * of Dijkstra's algorithm.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ch.h"
+#include "gen.h"
+#include "graph.h"
+#include "sssp.h"
+
+/*
+ * Builds a random graph with n nodes and m edges whose weights are in
+ * [0, max_weight].
+ */
+struct graph* random_graph(int n, int m, int max_weight) {
+  int* sources = malloc(m * sizeof(int));
+  int* targets = malloc(m * sizeof(int));
+  int* weights = malloc(m * sizeof(int));
+  for (int i = 0; i < m; i++) {
+    sources[i] = rand() % n;
+    targets[i] = rand() % n;
+    weights[i] = rand() % (max_weight + 1);
+  }
+  struct graph* graph = graph_from_edges(n, m, sources, targets, weights);
+  free(sources);
+  free(targets);
+  free(weights);
+  return graph;
+}
+
+/*
+ * Runs n_queries random queries on a hierarchy built for the graph and
+ * returns the number answered correctly.
+ */
+int check(struct graph* graph, int n_queries) {
+  int n = graph->n_nodes, ok = 0;
+  struct ch* ch = ch_build(graph);
+  dist_t* dist = malloc(n * sizeof(dist_t));
+  for (int q = 0; q < n_queries; q++) {
+    int s = rand() % n, t = rand() % n;
+    sssp_dijkstra(graph, s, dist, NULL);
+    ok += ch_query(ch, s, t) == dist[t];
+  }
+  free(dist);
+  ch_free(ch);
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  srand(0);
+
+  /*
+   * A path 0 -> 1 -> 2 -> 3 with a more expensive direct edge 0 -> 3.
+   */
+  printf("== Small graph\n");
+  int s[] = {0, 1, 2, 0, 3};
+  int t[] = {1, 2, 3, 3, 4};
+  int w[] = {1, 1, 1, 5, 2};
+  struct graph* graph = graph_from_edges(6, 5, s, t, w);
+  struct ch* ch = ch_build(graph);
+  printf("  - 0 to 3 (expect 3): %lld\n", (long long)ch_query(ch, 0, 3));
+  printf("  - 0 to 4 (expect 5): %lld\n", (long long)ch_query(ch, 0, 4));
+  printf("  - 2 to 2 (expect 0): %lld\n", (long long)ch_query(ch, 2, 2));
+  printf("  - 4 to 0 unreachable (expect 1)? %d\n",
+    ch_query(ch, 4, 0) == DIST_INF);
+  printf("  - 0 to 5 unreachable (expect 1)? %d\n",
+    ch_query(ch, 0, 5) == DIST_INF);
+  ch_free(ch);
+  graph_free(graph);
+
+  /*
+   * A path 0 -> 1 -> 2 with edges of 2e9 each.  Nodes 0 and 2 each have two
+   * more neighbors, so 1 is contracted before them and the path becomes a
+   * shortcut longer than INT_MAX.
+   */
+  printf("\n== Long shortcut\n");
+  int long_s[] = {0, 1, 0, 3, 0, 4, 2, 5, 2, 6};
+  int long_t[] = {1, 2, 3, 0, 4, 0, 5, 2, 6, 2};
+  int long_w[] = {2000000000, 2000000000, 1, 1, 1, 1, 1, 1, 1, 1};
+  graph = graph_from_edges(7, 10, long_s, long_t, long_w);
+  ch = ch_build(graph);
+  printf("  - shortcuts (expect 1): %ld\n", ch_num_shortcuts(ch));
+  printf("  - 0 to 2 (expect 4000000000): %lld\n",
+    (long long)ch_query(ch, 0, 2));
+  printf("  - 3 to 6 (expect 4000000002): %lld\n",
+    (long long)ch_query(ch, 3, 6));
+  ch_free(ch);
+  graph_free(graph);
+
+  printf("\n== Random graphs\n");
+  int ok = 0, total = 0;
+  for (int g = 0; g < 30; g++) {
+    int n = 2 + rand() % 300;
+    graph = random_graph(n, rand() % (4 * n), g % 2 ? 3 : 1000);
+    ok += check(graph, 20);
+    total += 20;
+    graph_free(graph);
+  }
+  printf("  - correct (expect %d): %d\n", total, ok);
+
+  printf("\n== Generated graphs\n");
+  graph = gen_grid(30, 40, 100, 1);
+  printf("  - grid nodes (expect 1200): %d\n", graph->n_nodes);
+  printf("  - grid edges (expect 4660): %d\n", graph->n_edges);
+  printf("  - grid correct (expect 200): %d\n", check(graph, 200));
+  graph_free(graph);
+  graph = gen_geometric(2000, 6, 1);
+  printf("  - geometric correct (expect 200): %d\n", check(graph, 200));
+  graph_free(graph);
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+/*
+ * This is a small program to test the dense-graph engine against the heap
+ * engine, whose predecessors follow the same tie-breaking rules.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "graph.h"
+#include "sssp.h"
+#include "dense.h"
+
+/*
+ * Builds a random graph with n nodes and m edges whose weights are in
+ * [0, max_weight].
+ */
+struct graph* random_graph(int n, int m, int max_weight) {
+  int* sources = malloc(m * sizeof(int));
+  int* targets = malloc(m * sizeof(int));
+  int* weights = malloc(m * sizeof(int));
+  for (int i = 0; i < m; i++) {
+    sources[i] = rand() % n;
+    targets[i] = rand() % n;
+    weights[i] = rand() % (max_weight + 1);
+  }
+  struct graph* graph = graph_from_edges(n, m, sources, targets, weights);
+  free(sources);
+  free(targets);
+  free(weights);
+  return graph;
+}
+
+/*
+ * Returns 1 if both pairs of arrays are equal.
+ */
+int same(int n, dist_t* d1, int* p1, dist_t* d2, int* p2) {
+  for (int v = 0; v < n; v++) {
+    if (d1[v] != d2[v] || p1[v] != p2[v]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+int main(int argc, char** argv) {
+  srand(0);
+  printf("AVX2 %s\n\n", dense_simd_available() ? "available" : "unavailable");
+
+  printf("== Layout\n");
+  struct dense_graph* dense = dense_create(20);
+  printf("  - stride (expect 32): %d\n", dense->stride);
+  printf("  - 64-byte aligned (expect 1): %d\n",
+    (uintptr_t)dense->weights % 64 == 0);
+  printf("  - padding has no edges (expect 1): %d\n",
+    dense->weights[dense->stride + 25] == DENSE_NO_EDGE);
+  dense_free(dense);
+
+  /*
+   * Two equally short paths to node 3: 0 -> 1 -> 3 and 0 -> 2 -> 3.  Node 1
+   * is settled first, so it should be the predecessor.  Parallel edges keep
+   * the lightest.
+   */
+  printf("\n== Small graph\n");
+  int s[] = {0, 0, 2, 1, 3, 0, 0};
+  int t[] = {1, 2, 3, 3, 4, 1, 5};
+  int w[] = {2, 2, 3, 3, 0, 7, INT_MAX - 1};
+  struct graph* graph = graph_from_edges(7, 7, s, t, w);
+  dense = dense_from_graph(graph);
+  dist_t dist[7];
+  int prev[7];
+  for (int simd = 0; simd < 2; simd++) {
+    if (simd) {
+      dense_dijkstra(dense, 0, dist, prev);
+    } else {
+      dense_dijkstra_scalar(dense, 0, dist, prev);
+    }
+    printf("  - %s: dists to 1, 3, 4, 5 (expect 2 5 5 %d): %lld %lld %lld "
+      "%lld\n", simd ? "simd" : "scalar", INT_MAX - 1, (long long)dist[1],
+      (long long)dist[3], (long long)dist[4], (long long)dist[5]);
+    printf("  - %s: prevs of 0, 3, 4, 6 (expect 0 1 3 -1): %d %d %d %d\n",
+      simd ? "simd" : "scalar", prev[0], prev[3], prev[4], prev[6]);
+  }
+  dense_free(dense);
+  graph_free(graph);
+
+  /*
+   * Random graphs from sparse to nearly complete, with many ties when the
+   * weights are small, and sizes that don't fill whole vectors.
+   */
+  printf("\n== Random graphs\n");
+  int graphs = 60, simd_ok = 0, scalar_ok = 0;
+  for (int g = 0; g < graphs; g++) {
+    int n = 1 + rand() % 200;
+    int m = g % 3 == 0 ? rand() % (2 * n) : rand() % (n * n + 1);
+    graph = random_graph(n, m, g % 2 ? 3 : 1000);
+    int source = rand() % n;
+    dist_t* d_ref = malloc(n * sizeof(dist_t));
+    dist_t* d = malloc(n * sizeof(dist_t));
+    int* p_ref = malloc(n * sizeof(int));
+    int* p = malloc(n * sizeof(int));
+    sssp_dijkstra(graph, source, d_ref, p_ref);
+    dense = dense_from_graph(graph);
+    dense_dijkstra(dense, source, d, p);
+    simd_ok += same(n, d_ref, p_ref, d, p);
+    dense_dijkstra_scalar(dense, source, d, p);
+    scalar_ok += same(n, d_ref, p_ref, d, p);
+    dense_free(dense);
+    free(d_ref);
+    free(d);
+    free(p_ref);
+    free(p);
+    graph_free(graph);
+  }
+  printf("  - dense matches heap (expect %d): %d\n", graphs, simd_ok);
+  printf("  - scalar dense matches heap (expect %d): %d\n", graphs,
+    scalar_ok);
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * This is a small program to test edge updates on dynamic graphs and the
+ * repair of shortest-path trees against fresh runs of Dijkstra's algorithm.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+#include "sssp.h"
+#include "dynamic.h"
+
+/*
+ * Builds a random graph with n nodes and m edges whose weights are in
+ * [0, max_weight].
+ */
+struct graph* random_graph(int n, int m, int max_weight) {
+  int* sources = malloc(m * sizeof(int));
+  int* targets = malloc(m * sizeof(int));
+  int* weights = malloc(m * sizeof(int));
+  for (int i = 0; i < m; i++) {
+    sources[i] = rand() % n;
+    targets[i] = rand() % n;
+    weights[i] = rand() % (max_weight + 1);
+  }
+  struct graph* graph = graph_from_edges(n, m, sources, targets, weights);
+  free(sources);
+  free(targets);
+  free(weights);
+  return graph;
+}
+
+/*
+ * Checks a repaired tree against Dijkstra on a snapshot of the graph.  The
+ * distances must match, and every reachable node other than the source must
+ * have a predecessor along a tight edge, with the chain of predecessors
+ * leading back to the source.  Returns 1 if the tree is right.
+ */
+int check_tree(struct dyn_graph* dyn, struct dyn_tree* tree, int source) {
+  struct graph* graph = dyn_graph_snapshot(dyn);
+  int n = graph->n_nodes;
+  dist_t* expected = malloc(n * sizeof(dist_t));
+  sssp_dijkstra(graph, source, expected, NULL);
+  dist_t* dist = dyn_tree_dist(tree);
+  int* prev = dyn_tree_prev(tree);
+  int ok = 1;
+  for (int v = 0; v < n && ok; v++) {
+    if (dist[v] != expected[v]) {
+      ok = 0;
+    } else if (v == source || dist[v] == DIST_INF) {
+      ok = prev[v] == -1;
+    } else {
+      int w = prev[v] < 0 ? -1 : dyn_graph_weight(dyn, prev[v], v);
+      ok = w >= 0 && dist[prev[v]] + w == dist[v];
+      int steps = 0;
+      for (int u = v; ok && u != source; u = prev[u]) {
+        ok = u >= 0 && ++steps <= n;
+      }
+    }
+  }
+  free(expected);
+  graph_free(graph);
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  srand(0);
+
+  printf("== Edges\n");
+  int s[] = {0, 0, 0, 1, 2};
+  int t[] = {1, 2, 2, 2, 3};
+  int w[] = {5, 9, 3, 1, 7};
+  struct graph* graph = graph_from_edges(4, 5, s, t, w);
+  struct dyn_graph* dyn = dyn_graph_create(graph);
+  graph_free(graph);
+  printf("  - weight of 0->2, lightest parallel edge (expect 3): %d\n",
+    dyn_graph_weight(dyn, 0, 2));
+  printf("  - weight of 3->0, missing (expect -1): %d\n",
+    dyn_graph_weight(dyn, 3, 0));
+  dyn_graph_set_edge(dyn, 3, 0, 2);
+  dyn_graph_set_edge(dyn, 0, 1, 4);
+  printf("  - new weights of 3->0 and 0->1 (expect 2 4): %d %d\n",
+    dyn_graph_weight(dyn, 3, 0), dyn_graph_weight(dyn, 0, 1));
+  printf("  - remove 1->2 (expect 1): %d\n", dyn_graph_remove_edge(dyn, 1, 2));
+  printf("  - remove 1->2 again (expect 0): %d\n",
+    dyn_graph_remove_edge(dyn, 1, 2));
+  graph = dyn_graph_snapshot(dyn);
+  printf("  - snapshot edges (expect 4): %d\n", graph->n_edges);
+  graph_free(graph);
+
+  printf("\n== Repair\n");
+  struct dyn_tree* tree = dyn_tree_create(dyn, 0);
+  dist_t* dist = dyn_tree_dist(tree);
+  int* prev = dyn_tree_prev(tree);
+  printf("  - dist to 3, prev of 3 (expect 10 2): %lld %d\n",
+    (long long)dist[3], prev[3]);
+  dyn_graph_set_edge(dyn, 0, 2, 20);
+  printf("  - heavier tree edge, nodes redone (expect 2): %d\n",
+    dyn_tree_repair(tree));
+  printf("  - dist to 2, 3 (expect 20 27): %lld %lld\n", (long long)dist[2],
+    (long long)dist[3]);
+  dyn_graph_set_edge(dyn, 1, 2, 1);
+  dyn_tree_repair(tree);
+  printf("  - new edge 1->2, dist to 3, prev of 2 (expect 12 1): %lld %d\n",
+    (long long)dist[3], prev[2]);
+  dyn_graph_remove_edge(dyn, 2, 3);
+  dyn_tree_repair(tree);
+  printf("  - 2->3 deleted, 3 unreachable (expect 1 -1): %d %d\n",
+    dist[3] == DIST_INF, prev[3]);
+  printf("  - nothing changed, nodes redone (expect 0): %d\n",
+    dyn_tree_repair(tree));
+  dyn_tree_free(tree);
+  dyn_graph_free(dyn);
+
+  /*
+   * Random batches of changes on random graphs.  Small weights make lots of
+   * ties, including zero-weight edges, which is where a repair is most
+   * likely to leave a bad predecessor.
+   */
+  printf("\n== Random graphs\n");
+  int failures = 0, graphs = 40, batches = 30;
+  for (int g = 0; g < graphs; g++) {
+    int n = 20 + rand() % 200;
+    int max_weight = g % 2 ? 3 : 1000;
+    graph = random_graph(n, rand() % (4 * n), max_weight);
+    dyn = dyn_graph_create(graph);
+    graph_free(graph);
+    int source = rand() % n;
+    tree = dyn_tree_create(dyn, source);
+    struct dyn_tree* lazy = dyn_tree_create(dyn, source);
+    for (int b = 0; b < batches; b++) {
+      int size = 1 + rand() % 10;
+      for (int i = 0; i < size; i++) {
+        int u = rand() % n, v = rand() % n;
+        if (rand() % 3 == 0) {
+          dyn_graph_remove_edge(dyn, u, v);
+        } else {
+          dyn_graph_set_edge(dyn, u, v, rand() % (max_weight + 1));
+        }
+      }
+      dyn_tree_repair(tree);
+      failures += !check_tree(dyn, tree, source);
+    }
+    dyn_tree_repair(lazy);
+    failures += !check_tree(dyn, lazy, source);
+    dyn_tree_free(tree);
+    dyn_tree_free(lazy);
+    dyn_graph_free(dyn);
+  }
+  printf("  - %d repairs, wrong trees (expect 0): %d\n",
+    graphs * (batches + 1), failures);
+
+  return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * This is a small program to test the text graph loader in graph.c on
+ * well-formed and malformed files.  The loaders print an error message for
+ * each malformed file, which is expected.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "graph.h"
+
+/*
+ * Writes text to a new temporary file and returns its path, which the
+ * caller should unlink() and free().
+ */
+char* write_file(const char* text) {
+  char* path = strdup("/tmp/test_graph_XXXXXX");
+  int fd = mkstemp(path);
+  FILE* file = fd >= 0 ? fdopen(fd, "w") : NULL;
+  if (file == NULL) {
+    perror("mkstemp");
+    exit(EXIT_FAILURE);
+  }
+  fputs(text, file);
+  fclose(file);
+  return path;
+}
+
+/*
+ * Loads text with graph_load() and returns its number of edges, or -1 if it
+ * failed to load.
+ */
+int load_edges(const char* text, int n_threads) {
+  char* path = write_file(text);
+  struct graph* graph = graph_load(path, n_threads);
+  int n_edges = graph ? graph->n_edges : -1;
+  if (graph) {
+    graph_free(graph);
+  }
+  unlink(path);
+  free(path);
+  return n_edges;
+}
+
+/*
+ * Returns 1 if two graphs have identical CSR arrays.
+ */
+int same_graph(struct graph* a, struct graph* b) {
+  return a->n_nodes == b->n_nodes && a->n_edges == b->n_edges &&
+    !memcmp(a->offsets, b->offsets, (a->n_nodes + 1) * sizeof(int)) &&
+    !memcmp(a->targets, b->targets, a->n_edges * sizeof(int)) &&
+    !memcmp(a->weights, b->weights, a->n_edges * sizeof(int));
+}
+
+int main(int argc, char** argv) {
+  printf("== Small files\n");
+  printf("  - well-formed (expect 2): %d\n",
+    load_edges("3\n2\n0 1 5\n1 2 7\n", 1));
+  printf("  - extra edges ignored (expect 2): %d\n",
+    load_edges("3\n2\n0 1 5\n1 2 7\n2 0 1\n", 1));
+  printf("  - trailing junk ignored (expect 2): %d\n",
+    load_edges("3\n2\n0 1 5\n1 2 7\nfoo\n", 1));
+  printf("  - junk before the last edge (expect -1): %d\n",
+    load_edges("3\n2\n0 1 5\nfoo\n1 2 7\n", 1));
+  printf("  - too few edges (expect -1): %d\n",
+    load_edges("3\n2\n0 1 5\n", 1));
+  printf("  - endpoint out of range (expect -1): %d\n",
+    load_edges("3\n2\n0 1 5\n1 3 7\n", 1));
+  printf("  - malformed header (expect -1): %d\n", load_edges("3\nx\n", 1));
+
+  /*
+   * A file big enough to be split into several chunks, with junk after the
+   * last edge the header asks for, in the same chunk as that edge.
+   */
+  printf("\n== Large file\n");
+  int n_nodes = 1000, n_edges = 400000;
+  size_t capacity = (size_t)n_edges * 20 + 64, length = 0;
+  char* text = malloc(capacity);
+  length += sprintf(text + length, "%d\n%d\n", n_nodes, n_edges);
+  srand(0);
+  for (int i = 0; i < n_edges; i++) {
+    length += sprintf(text + length, "%d %d %d\n", rand() % n_nodes,
+      rand() % n_nodes, rand() % 1000);
+  }
+  sprintf(text + length, "foo\n");
+  char* path = write_file(text);
+  struct graph* reference = graph_load_fscanf(path);
+  int ok = 0;
+  for (int t = 1; t <= 4; t *= 2) {
+    struct graph* graph = graph_load(path, t);
+    ok += graph != NULL && reference != NULL && same_graph(graph, reference);
+    if (graph) {
+      graph_free(graph);
+    }
+  }
+  printf("  - trailing junk, 1, 2 and 4 threads match fscanf (expect 3): %d\n",
+    ok);
+  if (reference) {
+    graph_free(reference);
+  }
+  unlink(path);
+  free(path);
+  free(text);
+
+  return 0;
+}
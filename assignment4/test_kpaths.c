@@ -0,0 +1,188 @@
+/*
+ * This is a small program to test Yen's K-shortest-paths algorithm against
+ * a brute-force enumeration of all loopless paths.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "graph.h"
+#include "sssp.h"
+#include "kpaths.h"
+
+/*
+ * Builds a random graph with n nodes and m edges whose weights are in
+ * [0, max_weight].
+ */
+struct graph* random_graph(int n, int m, int max_weight) {
+  int* sources = malloc(m * sizeof(int));
+  int* targets = malloc(m * sizeof(int));
+  int* weights = malloc(m * sizeof(int));
+  for (int i = 0; i < m; i++) {
+    sources[i] = rand() % n;
+    targets[i] = rand() % n;
+    weights[i] = rand() % (max_weight + 1);
+  }
+  struct graph* graph = graph_from_edges(n, m, sources, targets, weights);
+  free(sources);
+  free(targets);
+  free(weights);
+  return graph;
+}
+
+/*
+ * Returns the weight of the lightest edge u -> v, or -1 if there is none.
+ */
+int edge_weight(struct graph* graph, int u, int v) {
+  for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+    if (graph->targets[e] == v) {
+      return graph->weights[e];
+    }
+  }
+  return -1;
+}
+
+/*
+ * Collects the lengths of all loopless paths from u to t by depth-first
+ * search.
+ */
+void all_paths(struct graph* graph, int u, int t, dist_t length,
+    char* on_path, dist_t* lengths, int* count) {
+  if (u == t) {
+    lengths[(*count)++] = length;
+    return;
+  }
+  on_path[u] = 1;
+  for (int v = 0; v < graph->n_nodes; v++) {
+    int w = edge_weight(graph, u, v);
+    if (w >= 0 && !on_path[v]) {
+      all_paths(graph, v, t, length + w, on_path, lengths, count);
+    }
+  }
+  on_path[u] = 0;
+}
+
+int dist_cmp(const void* a, const void* b) {
+  dist_t x = *(const dist_t*)a, y = *(const dist_t*)b;
+  return (x > y) - (x < y);
+}
+
+/*
+ * Checks that path i of the last search goes from s to t along edges of
+ * the graph without repeating a node, and has the reported length.
+ */
+int valid_path(struct graph* graph, struct ksp* ksp, int i, int s, int t) {
+  int n = graph->n_nodes;
+  int* path = malloc(n * sizeof(int));
+  char* seen = calloc(n, 1);
+  int length = ksp_path(ksp, i, path, n);
+  int ok = length >= 1 && path[0] == s && path[length - 1] == t;
+  dist_t total = 0;
+  for (int j = 0; j < length && ok; j++) {
+    ok = !seen[path[j]];
+    seen[path[j]] = 1;
+    if (j > 0 && ok) {
+      int w = edge_weight(graph, path[j - 1], path[j]);
+      ok = w >= 0;
+      total += w;
+    }
+  }
+  ok = ok && total == ksp_length(ksp, i);
+  free(path);
+  free(seen);
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  srand(0);
+
+  /*
+   * The example from the Wikipedia article on Yen's algorithm, with nodes
+   * C, D, E, F, G, H numbered 0 through 5.
+   */
+  printf("== Example graph\n");
+  int s[] = {0, 0, 1, 2, 2, 2, 3, 3, 4};
+  int t[] = {1, 2, 3, 1, 3, 4, 4, 5, 5};
+  int w[] = {3, 2, 4, 1, 2, 3, 2, 1, 2};
+  struct graph* graph = graph_from_edges(6, 9, s, t, w);
+  struct ksp* ksp = ksp_create(graph);
+  printf("  - paths found (expect 3): %d\n", ksp_find(ksp, 0, 5, 3));
+  printf("  - lengths (expect 5 7 8): %lld %lld %lld\n",
+    (long long)ksp_length(ksp, 0), (long long)ksp_length(ksp, 1),
+    (long long)ksp_length(ksp, 2));
+  int path[6];
+  int length = ksp_path(ksp, 0, path, 6);
+  printf("  - shortest (expect 4: 0 2 3 5): %d:", length);
+  for (int i = 0; i < length; i++) {
+    printf(" %d", path[i]);
+  }
+  printf("\n");
+  printf("  - short buffer (expect 4): %d\n", ksp_path(ksp, 0, path, 2));
+  printf("  - all valid (expect 1): %d\n", valid_path(graph, ksp, 0, 0, 5) &&
+    valid_path(graph, ksp, 1, 0, 5) && valid_path(graph, ksp, 2, 0, 5));
+  int found = ksp_find(ksp, 2, 2, 5);
+  printf("  - s = t (expect 1 0): %d %lld\n", found,
+    (long long)ksp_length(ksp, 0));
+  ksp_free(ksp);
+  graph_free(graph);
+
+  int none_s[] = {0};
+  int none_t[] = {1};
+  int none_w[] = {1};
+  graph = graph_from_edges(3, 1, none_s, none_t, none_w);
+  ksp = ksp_create(graph);
+  printf("  - no path (expect 0): %d\n", ksp_find(ksp, 0, 2, 4));
+  printf("  - single path (expect 1): %d\n", ksp_find(ksp, 0, 1, 4));
+  ksp_free(ksp);
+  graph_free(graph);
+
+  /*
+   * Small random graphs, where every loopless path can be listed, with
+   * parallel edges and plenty of ties.
+   */
+  printf("\n== Random graphs\n");
+  int graphs = 200, failures = 0;
+  dist_t* lengths = malloc(200000 * sizeof(dist_t));
+  for (int g = 0; g < graphs; g++) {
+    int n = 2 + rand() % 7;
+    graph = random_graph(n, rand() % (3 * n), g % 2 ? 3 : 100);
+    int from = rand() % n, to = rand() % n;
+    char on_path[16] = {0};
+    int count = 0;
+    all_paths(graph, from, to, 0, on_path, lengths, &count);
+    qsort(lengths, count, sizeof(dist_t), dist_cmp);
+
+    ksp = ksp_create(graph);
+    int k = 1 + rand() % 30;
+    found = ksp_find(ksp, from, to, k);
+    int ok = found == (count < k ? count : k);
+    for (int i = 0; i < found && ok; i++) {
+      ok = ksp_length(ksp, i) == lengths[i] &&
+        valid_path(graph, ksp, i, from, to);
+    }
+
+    /*
+     * The paths must all be different.
+     */
+    int* a = malloc(n * sizeof(int));
+    int* b = malloc(n * sizeof(int));
+    for (int i = 0; i < found && ok; i++) {
+      for (int j = 0; j < i && ok; j++) {
+        int la = ksp_path(ksp, i, a, n), lb = ksp_path(ksp, j, b, n);
+        ok = la != lb || memcmp(a, b, la * sizeof(int));
+      }
+    }
+    free(a);
+    free(b);
+    failures += !ok;
+    ksp_free(ksp);
+    graph_free(graph);
+  }
+  free(lengths);
+  printf("  - graphs with wrong paths (expect 0): %d\n", failures);
+
+  return 0;
+}
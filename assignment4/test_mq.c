@@ -0,0 +1,116 @@
+/*
+ * This is a small program to test the MultiQueue implementation.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "mq.h"
+
+#define NUM_THREADS 4
+#define PER_THREAD 10000
+
+struct mq* mq;
+int vals[NUM_THREADS * PER_THREAD];
+int seen[NUM_THREADS * PER_THREAD];
+int removed_by[NUM_THREADS];
+
+/*
+ * Each thread inserts its own slice of `vals` and then removes elements until
+ * the MultiQueue is empty, marking every value it removes as seen.
+ */
+void* worker(void* arg) {
+  int id = (int)(long)arg;
+  for (int i = id * PER_THREAD; i < (id + 1) * PER_THREAD; i++) {
+    mq_insert(mq, &vals[i], vals[i]);
+  }
+
+  void* value;
+  int priority;
+  while (mq_remove_first(mq, &value, &priority)) {
+    int* v = value;
+    if (*v != priority) {
+      printf("  -- value %d removed with priority %d\n", *v, priority);
+    }
+    __atomic_add_fetch(&seen[v - vals], 1, __ATOMIC_RELAXED);
+    removed_by[id]++;
+  }
+  return NULL;
+}
+
+int main(int argc, char** argv) {
+  const int n = NUM_THREADS * PER_THREAD;
+  srand(0);
+  for (int i = 0; i < n; i++) {
+    vals[i] = rand() % 100000;
+  }
+
+  /*
+   * With a single sub-queue the two random choices always pick the same
+   * queue, so a MultiQueue behaves like an exact priority queue.
+   */
+  printf("== Single sub-queue: removing in exact order\n");
+  mq = mq_create(1, 1);
+  for (int i = 0; i < 32; i++) {
+    mq_insert(mq, &vals[i], vals[i]);
+  }
+  int in_order = 1, last = -1, priority;
+  while (mq_remove_first(mq, NULL, &priority)) {
+    if (priority < last) {
+      in_order = 0;
+    }
+    last = priority;
+  }
+  printf("  - in order (expect 1)? %d\n", in_order);
+  printf("  - empty (expect 0)? %d\n", mq_size(mq));
+  mq_free(mq);
+
+  /*
+   * With several threads inserting and removing at once, every element should
+   * be removed exactly once.
+   */
+  printf("\n== %d threads inserting and removing %d values each\n",
+    NUM_THREADS, PER_THREAD);
+  mq = mq_create(NUM_THREADS, 2);
+  printf("  - sub-queues (expect %d): %d\n", NUM_THREADS * 2,
+    mq_num_queues(mq));
+
+  pthread_t threads[NUM_THREADS];
+  for (long t = 0; t < NUM_THREADS; t++) {
+    pthread_create(&threads[t], NULL, worker, (void*)t);
+  }
+  for (int t = 0; t < NUM_THREADS; t++) {
+    pthread_join(threads[t], NULL);
+  }
+
+  /*
+   * A thread can see the queue as empty while others are still inserting, so
+   * drain anything left over after all threads have finished.
+   */
+  int total = 0, leftover = 0;
+  void* value;
+  while (mq_remove_first(mq, &value, NULL)) {
+    seen[(int*)value - vals]++;
+    leftover++;
+  }
+  for (int t = 0; t < NUM_THREADS; t++) {
+    total += removed_by[t];
+  }
+
+  int exactly_once = 1;
+  for (int i = 0; i < n; i++) {
+    if (seen[i] != 1) {
+      exactly_once = 0;
+    }
+  }
+  printf("  - removed (expect %d): %d\n", n, total + leftover);
+  printf("  - every value removed exactly once (expect 1)? %d\n",
+    exactly_once);
+  printf("  - empty (expect 0)? %d\n", mq_size(mq));
+  mq_free(mq);
+
+  return 0;
+}
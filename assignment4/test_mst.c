@@ -0,0 +1,182 @@
+/*
+ * This is a small program to test the minimum spanning tree algorithms
+ * against each other and against hand-worked examples.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "graph.h"
+#include "mst.h"
+
+/*
+ * Builds a random graph with n nodes and m edges whose weights are in
+ * [-max_weight, max_weight].
+ */
+struct graph* random_graph(int n, int m, int max_weight) {
+  int* sources = malloc(m * sizeof(int));
+  int* targets = malloc(m * sizeof(int));
+  int* weights = malloc(m * sizeof(int));
+  for (int i = 0; i < m; i++) {
+    sources[i] = rand() % n;
+    targets[i] = rand() % n;
+    weights[i] = rand() % (2 * max_weight + 1) - max_weight;
+  }
+  struct graph* graph = graph_from_edges(n, m, sources, targets, weights);
+  free(sources);
+  free(targets);
+  free(weights);
+  return graph;
+}
+
+int find(int* parent, int x) {
+  while (parent[x] != x) {
+    x = parent[x];
+  }
+  return x;
+}
+
+/*
+ * Checks that a forest uses edges of the graph, has no cycle, and joins
+ * every pair of nodes the graph joins.
+ */
+int valid_forest(struct graph* graph, struct mst_edge* tree, int count) {
+  int n = graph->n_nodes, ok = 1, components = n;
+  int* parent = malloc(n * sizeof(int));
+  for (int v = 0; v < n; v++) {
+    parent[v] = v;
+  }
+  for (int i = 0; i < count && ok; i++) {
+    int u = tree[i].u, v = tree[i].v, found = 0;
+    for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+      found |= graph->targets[e] == v && graph->weights[e] == tree[i].weight;
+    }
+    for (int e = graph->offsets[v]; e < graph->offsets[v + 1]; e++) {
+      found |= graph->targets[e] == u && graph->weights[e] == tree[i].weight;
+    }
+    int a = find(parent, u), b = find(parent, v);
+    ok = found && a != b;
+    parent[a] = b;
+  }
+  for (int v = 0; v < n; v++) {
+    parent[v] = v;
+  }
+  for (int u = 0; u < n; u++) {
+    for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+      int a = find(parent, u), b = find(parent, graph->targets[e]);
+      if (a != b) {
+        parent[a] = b;
+        components--;
+      }
+    }
+  }
+  free(parent);
+  return ok && count == n - components;
+}
+
+int edge_cmp(const void* a, const void* b) {
+  const struct mst_edge* x = a;
+  const struct mst_edge* y = b;
+  if (x->u != y->u) {
+    return x->u - y->u;
+  }
+  return x->v - y->v;
+}
+
+int main(int argc, char** argv) {
+  srand(0);
+
+  /*
+   * A classic five-node example.  The tree is 0-2, 1-2, 3-4 and 1-3.
+   */
+  printf("== Small graph\n");
+  int s[] = {0, 0, 2, 1, 3, 2, 4};
+  int t[] = {1, 2, 1, 3, 2, 4, 3};
+  int w[] = {4, 1, 2, 5, 8, 9, 3};
+  struct graph* graph = graph_from_edges(5, 7, s, t, w);
+  struct mst_edge tree[8];
+  int count = mst_naive(graph, tree);
+  printf("  - naive (expect 4 11): %d %lld\n", count, mst_weight(tree, count));
+  count = mst_prim(graph, tree);
+  printf("  - prim (expect 4 11): %d %lld\n", count, mst_weight(tree, count));
+  count = mst_kruskal(graph, 2, tree);
+  printf("  - kruskal (expect 4 11): %d %lld\n", count,
+    mst_weight(tree, count));
+  printf("  - kruskal order (expect 1 2 3 5): %d %d %d %d\n", tree[0].weight,
+    tree[1].weight, tree[2].weight, tree[3].weight);
+  count = mst_boruvka(graph, 2, tree);
+  printf("  - boruvka (expect 4 11): %d %lld\n", count,
+    mst_weight(tree, count));
+  graph_free(graph);
+
+  /*
+   * Three components, {0, 1, 2}, {3, 4} and {5}, with a negative weight and
+   * a self-loop.
+   */
+  printf("\n== Forest\n");
+  int fs[] = {0, 1, 2, 3, 5};
+  int ft[] = {1, 2, 0, 4, 5};
+  int fw[] = {3, 1, 2, -5, -9};
+  graph = graph_from_edges(6, 5, fs, ft, fw);
+  count = mst_naive(graph, tree);
+  printf("  - naive (expect 3 -2): %d %lld\n", count, mst_weight(tree, count));
+  count = mst_prim(graph, tree);
+  printf("  - prim (expect 3 -2): %d %lld\n", count, mst_weight(tree, count));
+  count = mst_kruskal(graph, 3, tree);
+  printf("  - kruskal (expect 3 -2): %d %lld\n", count,
+    mst_weight(tree, count));
+  count = mst_boruvka(graph, 3, tree);
+  printf("  - boruvka (expect 3 -2): %d %lld\n", count,
+    mst_weight(tree, count));
+  graph_free(graph);
+
+  int none_s[] = {0};
+  graph = graph_from_edges(1, 0, none_s, none_s, none_s);
+  printf("  - one node (expect 0 0 0 0): %d %d %d %d\n",
+    mst_naive(graph, tree), mst_prim(graph, tree),
+    mst_kruskal(graph, 4, tree), mst_boruvka(graph, 4, tree));
+  graph_free(graph);
+
+  /*
+   * Random graphs with many ties, parallel edges and self-loops.  Kruskal
+   * and Borůvka must find exactly the same edges with any number of
+   * threads.
+   */
+  printf("\n== Random graphs\n");
+  int graphs = 200, wrong_weight = 0, invalid = 0, different = 0;
+  for (int g = 0; g < graphs; g++) {
+    int n = 1 + rand() % 200;
+    graph = random_graph(n, rand() % (4 * n), g % 2 ? 3 : 1000);
+    struct mst_edge* trees[4];
+    int counts[4];
+    for (int i = 0; i < 4; i++) {
+      trees[i] = malloc(n * sizeof(struct mst_edge));
+    }
+    int n_threads = 1 + g % 4;
+    counts[0] = mst_naive(graph, trees[0]);
+    counts[1] = mst_prim(graph, trees[1]);
+    counts[2] = mst_kruskal(graph, n_threads, trees[2]);
+    counts[3] = mst_boruvka(graph, n_threads, trees[3]);
+    long long expected = mst_weight(trees[0], counts[0]);
+    for (int i = 0; i < 4; i++) {
+      wrong_weight += mst_weight(trees[i], counts[i]) != expected;
+      invalid += !valid_forest(graph, trees[i], counts[i]);
+    }
+    qsort(trees[2], counts[2], sizeof(struct mst_edge), edge_cmp);
+    qsort(trees[3], counts[3], sizeof(struct mst_edge), edge_cmp);
+    different += counts[2] != counts[3] ||
+      memcmp(trees[2], trees[3], counts[2] * sizeof(struct mst_edge));
+    for (int i = 0; i < 4; i++) {
+      free(trees[i]);
+    }
+    graph_free(graph);
+  }
+  printf("  - trees with the wrong weight (expect 0): %d\n", wrong_weight);
+  printf("  - invalid forests (expect 0): %d\n", invalid);
+  printf("  - kruskal and boruvka differ (expect 0): %d\n", different);
+
+  return 0;
+}
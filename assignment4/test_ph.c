@@ -0,0 +1,150 @@
+/*
+ * This is a small program to test the rank-pairing heap implementation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ph.h"
+
+/*
+ * The number of elements inserted by the random test.
+ */
+#define NUM_RANDOM 2000
+
+int main(int argc, char** argv) {
+  struct ph* a, * b;
+  struct ph_node* handles[32];
+  int* first, * removed;
+  int i, p;
+  const int n = 16, m = 16;
+  int vals[n + m];
+
+  srand(0);
+
+  /*
+   * Fill two heaps with pointers to pseudo-random integer values, using the
+   * value itself as the priority.
+   */
+  a = ph_create();
+  b = ph_create();
+  printf("== Inserting %d values into heap A and %d into heap B\n", n, m);
+  for (i = 0; i < n + m; i++) {
+    vals[i] = rand() % 64;
+    handles[i] = ph_insert(i < n ? a : b, &vals[i], vals[i]);
+  }
+  printf("  - sizes: %d / %d (expected %d / %d)\n", ph_size(a), ph_size(b),
+    n, m);
+
+  /*
+   * Lower every third value (and its priority along with it), so some
+   * elements get cut out of the middle of a tree.  Remove one element from
+   * each heap first so the trees have some depth.
+   */
+  int gone_a = (int*)ph_remove_first(a) - vals;
+  int gone_b = (int*)ph_remove_first(b) - vals;
+  printf("\n== Decreasing priority of every third remaining element\n");
+  for (i = 0; i < n + m; i += 3) {
+    if (i == gone_a || i == gone_b) {
+      continue;
+    }
+    vals[i] -= 64;
+    ph_decrease_priority(i < n ? a : b, handles[i], vals[i]);
+  }
+
+  /*
+   * Melding should move all of B into A.
+   */
+  printf("\n== Melding heap B into heap A\n");
+  ph_meld(a, b);
+  printf("  - sizes: %d / %d (expected %d / 0)\n", ph_size(a), ph_size(b),
+    n + m - 2);
+  printf("  - is B empty (expect 1)? %d\n", ph_isempty(b));
+
+  printf("\n== Removing all from heap A: first / removed / priority\n");
+  int count = 0, in_order = 1, last = 0;
+  while (!ph_isempty(a)) {
+    p = ph_first_priority(a);
+    first = ph_first(a);
+    removed = ph_remove_first(a);
+    printf("  - %4d / %4d / %4d\n", *first, *removed, p);
+    if ((count > 0 && p < last) || *removed != p) {
+      in_order = 0;
+    }
+    last = p;
+    count++;
+  }
+
+  printf("\n== Is heap A empty (expect 1)? %d\n", ph_isempty(a));
+  printf("== Did values come out in order (expect 1)? %d\n", in_order);
+  printf("== Did we see all values we expected (expect 1)? %d\n",
+    count == n + m - 2);
+
+  /*
+   * Re-insert some values so ph_free() has something to free.
+   */
+  for (i = 0; i < n; i++) {
+    ph_insert(a, &vals[i], vals[i]);
+  }
+  ph_free(a);
+  ph_free(b);
+
+  /*
+   * Random inserts, decreases, removals and melds across two heaps, checked
+   * against a plain array of which heap holds each element and with what
+   * priority.  Removals check that the minimum comes out, and deep trees
+   * with many rank changes are built along the way.
+   */
+  printf("\n== Random operations\n");
+  int* heap_of = malloc(NUM_RANDOM * sizeof(int));
+  int* priority = malloc(NUM_RANDOM * sizeof(int));
+  struct ph_node** nodes = malloc(NUM_RANDOM * sizeof(struct ph_node*));
+  struct ph* heaps[2] = {ph_create(), ph_create()};
+  int n_inserted = 0, failures = 0;
+  for (int op = 0; op < 20 * NUM_RANDOM; op++) {
+    int h = rand() % 2, r = rand() % 100;
+    if (r < 40 && n_inserted < NUM_RANDOM) {
+      heap_of[n_inserted] = h;
+      priority[n_inserted] = rand() % 100000;
+      nodes[n_inserted] = ph_insert(heaps[h], (void*)(long)n_inserted,
+        priority[n_inserted]);
+      n_inserted++;
+    } else if (r < 80 && n_inserted > 0) {
+      int k = rand() % n_inserted;
+      if (heap_of[k] >= 0) {
+        priority[k] -= rand() % 1000;
+        ph_decrease_priority(heaps[heap_of[k]], nodes[k], priority[k]);
+      }
+    } else if (r < 99 && !ph_isempty(heaps[h])) {
+      int min = -1;
+      for (int k = 0; k < n_inserted; k++) {
+        if (heap_of[k] == h && (min < 0 || priority[k] < priority[min])) {
+          min = k;
+        }
+      }
+      int p = ph_first_priority(heaps[h]);
+      int k = (int)(long)ph_remove_first(heaps[h]);
+      failures += p != priority[min] || priority[k] != p || heap_of[k] != h;
+      heap_of[k] = -1;
+    } else {
+      ph_meld(heaps[h], heaps[1 - h]);
+      for (int k = 0; k < n_inserted; k++) {
+        heap_of[k] = heap_of[k] < 0 ? -1 : h;
+      }
+    }
+  }
+  int left = 0;
+  for (int k = 0; k < n_inserted; k++) {
+    left += heap_of[k] >= 0;
+  }
+  printf("  - failed removals (expect 0): %d\n", failures);
+  printf("  - sizes add up (expect 1): %d\n",
+    ph_size(heaps[0]) + ph_size(heaps[1]) == left);
+  ph_free(heaps[0]);
+  ph_free(heaps[1]);
+  free(heap_of);
+  free(priority);
+  free(nodes);
+
+  return 0;
+}
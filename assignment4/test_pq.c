@@ -115,7 +115,126 @@ int main(int argc, char** argv) {
   }
 
   pq_free(pq);
-  
+
+  /*
+   * Build a new priority queue in one shot from the first half of the values
+   * and add the second half as a batch.  Everything should still come out in
+   * ascending order.
+   */
+  void* ptrs[n + m];
+  for (i = 0; i < n + m; i++) {
+    ptrs[i] = &vals[i];
+  }
+  memcpy(sorted, vals, (n + m) * sizeof(int));
+  qsort(sorted, n + m, sizeof(int), ascending_int_cmp);
+
+  printf("\n== Building PQ with pq_create_from() and pq_insert_many()\n");
+  pq = pq_create_from(ptrs, vals, n);
+  pq_insert_many(pq, ptrs + n, vals + n, m);
+
+  printf("\n== Removing all from PQ: first / removed / priority (expected)\n");
+  k = 0;
+  while (k < n + m && !pq_isempty(pq)) {
+    p = pq_first_priority(pq);
+    first = pq_first(pq);
+    removed = pq_remove_first(pq);
+    printf("  - %4d / %4d / %4d (%4d)\n", *first, *removed, p, sorted[k]);
+    k++;
+  }
+
+  printf("\n== Is PQ empty (expect 1)? %d\n", pq_isempty(pq));
+  printf("== Did we see all values we expected (expect 1)? %d\n", k == m + n);
+  pq_free(pq);
+
+  /*
+   * Insert values with only a few distinct priorities.  Elements with equal
+   * priorities should come out in the order they were inserted, so the value
+   * stored with each element is its insertion index.
+   */
+  int order[n];
+  for (i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  printf("\n== Checking FIFO order among equal priorities: "
+    "priority / insertion index\n");
+  pq = pq_create();
+  for (i = 0; i < n; i++) {
+    pq_insert(pq, &order[i], i % 4);
+  }
+  int fifo = 1, last_p = -1, last_idx = -1;
+  while (!pq_isempty(pq)) {
+    p = pq_first_priority(pq);
+    removed = pq_remove_first(pq);
+    printf("  - %4d / %4d\n", p, *removed);
+    if (p == last_p && *removed < last_idx) {
+      fifo = 0;
+    }
+    last_p = p;
+    last_idx = *removed;
+  }
+  printf("== Were equal priorities removed in FIFO order (expect 1)? %d\n",
+    fifo);
+  pq_free(pq);
+
+  /*
+   * Use priorities that don't fit in 32 bits.
+   */
+  const long long base = 5000000000LL;
+  printf("\n== Checking 64-bit priorities: priority / insertion index\n");
+  pq = pq_create64(20);
+  for (i = 0; i < n; i++) {
+    pq_insert64(pq, &order[i], base + (n - i) % 3);
+  }
+  fifo = 1;
+  long long last_p64 = -1;
+  last_idx = -1;
+  while (!pq_isempty(pq)) {
+    long long p64 = pq_first_priority64(pq);
+    removed = pq_remove_first(pq);
+    printf("  - %lld / %4d\n", p64, *removed);
+    if (p64 < last_p64 || (p64 == last_p64 && *removed < last_idx) ||
+        p64 < base) {
+      fifo = 0;
+    }
+    last_p64 = p64;
+    last_idx = *removed;
+  }
+  printf("== Were 64-bit priorities removed in order (expect 1)? %d\n",
+    fifo);
+  pq_free(pq);
+
+  /*
+   * Offer all of the values to bounded queues that keep only the smallest
+   * few, one at a time and as a batch.  Both should keep exactly the
+   * smallest values, which come out largest first.
+   */
+  const int bound = 8;
+  memcpy(sorted, vals, (n + m) * sizeof(int));
+  qsort(sorted, n + m, sizeof(int), ascending_int_cmp);
+
+  struct pq* one = pq_create_bounded(bound);
+  struct pq* many = pq_create_bounded(bound);
+  for (i = 0; i < n + m; i++) {
+    pq_offer(one, ptrs[i], vals[i]);
+  }
+  pq_offer_many(many, ptrs, vals, n + m);
+
+  printf("\n== Removing from bounded PQs: pq_offer() / pq_offer_many() "
+    "(expected)\n");
+  k = bound - 1;
+  while (!pq_isempty(one) && !pq_isempty(many)) {
+    int p_one = pq_first_priority(one);
+    int p_many = pq_first_priority(many);
+    pq_remove_first(one);
+    pq_remove_first(many);
+    printf("  - %4d / %4d (%4d)\n", p_one, p_many, sorted[k]);
+    k--;
+  }
+  printf("== Did we see all values we expected (expect 1)? %d\n",
+    k == -1 && pq_isempty(one) && pq_isempty(many));
+  pq_free(one);
+  pq_free(many);
+
   return 0;
 
 }
@@ -0,0 +1,100 @@
+/*
+ * This is a small program to test point-to-point queries against full runs
+ * of Dijkstra's algorithm.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+#include "query.h"
+#include "sssp.h"
+
+/*
+ * Builds a random graph with n nodes and m edges whose weights are in
+ * [0, max_weight].
+ */
+struct graph* random_graph(int n, int m, int max_weight) {
+  int* sources = malloc(m * sizeof(int));
+  int* targets = malloc(m * sizeof(int));
+  int* weights = malloc(m * sizeof(int));
+  for (int i = 0; i < m; i++) {
+    sources[i] = rand() % n;
+    targets[i] = rand() % n;
+    weights[i] = rand() % (max_weight + 1);
+  }
+  struct graph* graph = graph_from_edges(n, m, sources, targets, weights);
+  free(sources);
+  free(targets);
+  free(weights);
+  return graph;
+}
+
+int main(int argc, char** argv) {
+  srand(0);
+
+  printf("== Transpose\n");
+  int s[] = {0, 0, 1, 2, 2};
+  int t[] = {1, 2, 2, 0, 0};
+  int w[] = {5, 3, 1, 7, 4};
+  struct graph* graph = graph_from_edges(3, 5, s, t, w);
+  struct graph* transpose = graph_transpose(graph);
+  printf("  - in-degree of 0 (expect 2): %d\n",
+    transpose->offsets[1] - transpose->offsets[0]);
+  printf("  - edges into 0 (expect 2/4 2/7): %d/%d %d/%d\n",
+    transpose->targets[0], transpose->weights[0], transpose->targets[1],
+    transpose->weights[1]);
+  printf("  - edges into 2 (expect 0/3 1/1): %d/%d %d/%d\n",
+    transpose->targets[3], transpose->weights[3], transpose->targets[4],
+    transpose->weights[4]);
+  graph_free(transpose);
+
+  printf("\n== Small graph\n");
+  struct sp* sp = sp_create(graph, 1);
+  printf("  - 0 to 2 (expect 3): %lld\n", (long long)sp_query(sp, 0, 2));
+  printf("  - 1 to 0 (expect 5): %lld\n", (long long)sp_query(sp, 1, 0));
+  printf("  - 1 to 1 (expect 0): %lld\n", (long long)sp_query(sp, 1, 1));
+  sp_free(sp);
+  graph_free(graph);
+
+  /*
+   * Random graphs with zero-weight edges and unreachable pairs, with and
+   * without landmarks.
+   */
+  printf("\n== Random graphs\n");
+  int landmarks[] = {0, 1, 4};
+  int n_queries = 0, ok[3] = {0, 0, 0}, fewer = 0;
+  for (int g = 0; g < 30; g++) {
+    int n = 2 + rand() % 400;
+    graph = random_graph(n, rand() % (4 * n), g % 2 ? 3 : 1000);
+    dist_t* dist = malloc(n * sizeof(dist_t));
+    struct sp* sps[3];
+    for (int i = 0; i < 3; i++) {
+      sps[i] = sp_create(graph, landmarks[i]);
+    }
+    for (int q = 0; q < 20; q++) {
+      int from = rand() % n, to = rand() % n;
+      sssp_dijkstra(graph, from, dist, NULL);
+      for (int i = 0; i < 3; i++) {
+        ok[i] += sp_query(sps[i], from, to) == dist[to];
+        fewer += sp_last_settled(sps[i]) <= 2 * n;
+      }
+      n_queries++;
+    }
+    for (int i = 0; i < 3; i++) {
+      sp_free(sps[i]);
+    }
+    free(dist);
+    graph_free(graph);
+  }
+  for (int i = 0; i < 3; i++) {
+    printf("  - %d landmarks correct (expect %d): %d\n", landmarks[i],
+      n_queries, ok[i]);
+  }
+  printf("  - settled counts in range (expect %d): %d\n", 3 * n_queries,
+    fewer);
+
+  return 0;
+}
@@ -0,0 +1,173 @@
+/*
+ * This is a small program to test the node reordering passes and
+ * graph_permute().
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+#include "sssp.h"
+#include "gen.h"
+#include "reorder.h"
+
+/*
+ * Builds a random graph with n nodes and m edges whose weights are in
+ * [0, max_weight].
+ */
+struct graph* random_graph(int n, int m, int max_weight) {
+  int* sources = malloc(m * sizeof(int));
+  int* targets = malloc(m * sizeof(int));
+  int* weights = malloc(m * sizeof(int));
+  for (int i = 0; i < m; i++) {
+    sources[i] = rand() % n;
+    targets[i] = rand() % n;
+    weights[i] = rand() % (max_weight + 1);
+  }
+  struct graph* graph = graph_from_edges(n, m, sources, targets, weights);
+  free(sources);
+  free(targets);
+  free(weights);
+  return graph;
+}
+
+/*
+ * Returns 1 if order is a permutation of 0 through n - 1.
+ */
+int is_permutation(int* order, int n) {
+  char* seen = calloc(n > 0 ? n : 1, 1);
+  int ok = 1;
+  for (int i = 0; i < n && ok; i++) {
+    ok = order[i] >= 0 && order[i] < n && !seen[order[i]];
+    if (ok) {
+      seen[order[i]] = 1;
+    }
+  }
+  free(seen);
+  return ok;
+}
+
+/*
+ * Returns a random permutation of 0 through n - 1.
+ */
+int* shuffled(int n) {
+  int* order = malloc(n * sizeof(int));
+  for (int i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  for (int i = n - 1; i > 0; i--) {
+    int j = rand() % (i + 1);
+    int v = order[i];
+    order[i] = order[j];
+    order[j] = v;
+  }
+  return order;
+}
+
+int main(int argc, char** argv) {
+  srand(0);
+
+  /*
+   * A path 3 - 0 - 4 - 1 - 2 (edges pointing both ways in places) plus an
+   * isolated node 5.
+   */
+  printf("== Small graph\n");
+  int s[] = {3, 0, 4, 2, 4};
+  int t[] = {0, 4, 1, 1, 0};
+  int w[] = {1, 2, 3, 4, 5};
+  struct graph* graph = graph_from_edges(6, 5, s, t, w);
+  int* order = reorder_bfs(graph);
+  printf("  - bfs order, out-edges first (expect 0 4 3 1 2 5): "
+    "%d %d %d %d %d %d\n", order[0], order[1], order[2], order[3], order[4],
+    order[5]);
+  free(order);
+  order = reorder_rcm(graph);
+  printf("  - rcm order is a permutation (expect 1): %d\n",
+    is_permutation(order, 6));
+  struct graph* permuted = graph_permute(graph, order);
+  printf("  - rcm bandwidth (expect 1): %d\n", reorder_bandwidth(permuted));
+  printf("  - edges kept (expect 5): %d\n", permuted->n_edges);
+
+  int rank[6];
+  for (int i = 0; i < 6; i++) {
+    rank[order[i]] = i;
+  }
+  int u = rank[0], found = 0;
+  for (int e = permuted->offsets[u]; e < permuted->offsets[u + 1]; e++) {
+    found += permuted->targets[e] == rank[4] && permuted->weights[e] == 2;
+  }
+  printf("  - edge 0 -> 4 renumbered (expect 1): %d\n", found);
+  free(order);
+  graph_free(permuted);
+  graph_free(graph);
+
+  /*
+   * On a grid with its nodes shuffled, both passes should bring the
+   * bandwidth back down to about the width of the grid.
+   */
+  printf("\n== Shuffled grid\n");
+  graph = gen_grid(50, 60, 10, 1);
+  order = shuffled(graph->n_nodes);
+  struct graph* shuffled_grid = graph_permute(graph, order);
+  free(order);
+  printf("  - shuffled bandwidth is large (expect 1): %d\n",
+    reorder_bandwidth(shuffled_grid) > 1000);
+  order = reorder_bfs(shuffled_grid);
+  permuted = graph_permute(shuffled_grid, order);
+  printf("  - bfs bandwidth at most 2 rows (expect 1): %d\n",
+    reorder_bandwidth(permuted) <= 2 * 60);
+  free(order);
+  graph_free(permuted);
+  order = reorder_rcm(shuffled_grid);
+  permuted = graph_permute(shuffled_grid, order);
+  printf("  - rcm bandwidth at most 2 rows (expect 1): %d\n",
+    reorder_bandwidth(permuted) <= 2 * 60);
+  free(order);
+  graph_free(permuted);
+  graph_free(shuffled_grid);
+  graph_free(graph);
+
+  /*
+   * Distances must be the same before and after renumbering, on graphs
+   * with several components.
+   */
+  printf("\n== Random graphs\n");
+  int graphs = 30, failures = 0;
+  for (int g = 0; g < graphs; g++) {
+    int n = 1 + rand() % 300;
+    graph = random_graph(n, rand() % (2 * n), 100);
+    int source = rand() % n;
+    dist_t* dist = malloc(n * sizeof(dist_t));
+    dist_t* permuted_dist = malloc(n * sizeof(dist_t));
+    sssp_dijkstra(graph, source, dist, NULL);
+    for (int pass = 0; pass < 2; pass++) {
+      order = pass ? reorder_rcm(graph) : reorder_bfs(graph);
+      failures += !is_permutation(order, n);
+      permuted = graph_permute(graph, order);
+      int permuted_source = 0;
+      for (int i = 0; i < n; i++) {
+        if (order[i] == source) {
+          permuted_source = i;
+        }
+      }
+      sssp_dijkstra(permuted, permuted_source, permuted_dist, NULL);
+      for (int i = 0; i < n; i++) {
+        if (permuted_dist[i] != dist[order[i]]) {
+          failures++;
+          break;
+        }
+      }
+      free(order);
+      graph_free(permuted);
+    }
+    free(dist);
+    free(permuted_dist);
+    graph_free(graph);
+  }
+  printf("  - %d reorderings, failures (expect 0): %d\n", 2 * graphs,
+    failures);
+
+  return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * This is a small program to test the tree cache and the query server's
+ * line protocol.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "graph.h"
+#include "sssp.h"
+#include "cache.h"
+#include "server.h"
+
+/*
+ * Builds a random graph with n nodes and m edges whose weights are in
+ * [0, max_weight].
+ */
+struct graph* random_graph(int n, int m, int max_weight) {
+  int* sources = malloc(m * sizeof(int));
+  int* targets = malloc(m * sizeof(int));
+  int* weights = malloc(m * sizeof(int));
+  for (int i = 0; i < m; i++) {
+    sources[i] = rand() % n;
+    targets[i] = rand() % n;
+    weights[i] = rand() % (max_weight + 1);
+  }
+  struct graph* graph = graph_from_edges(n, m, sources, targets, weights);
+  free(sources);
+  free(targets);
+  free(weights);
+  return graph;
+}
+
+/*
+ * Runs a session of requests through the server and prints the responses.
+ * Returns what server_handle() returned.
+ */
+int run_session(struct tree_cache* cache, const char* requests) {
+  char output[1024];
+  memset(output, 0, sizeof(output));
+  FILE* in = fmemopen((void*)requests, strlen(requests), "r");
+  FILE* out = fmemopen(output, sizeof(output) - 1, "w");
+  int shutdown = server_handle(cache, in, out);
+  fclose(in);
+  fclose(out);
+  printf("%s", output);
+  return shutdown;
+}
+
+int main(int argc, char** argv) {
+  srand(0);
+  long hits, misses;
+  int size;
+
+  printf("== LRU order\n");
+  int s[] = {0, 0, 1, 2, 3};
+  int t[] = {1, 2, 2, 3, 0};
+  int w[] = {5, 3, 1, 7, 4};
+  struct graph* graph = graph_from_edges(5, 5, s, t, w);
+  struct tree_cache* cache = tree_cache_create(graph, 2);
+  int order[] = {0, 1, 0, 2, 1, 0};
+  for (int i = 0; i < 6; i++) {
+    tree_cache_release(cache, tree_cache_get(cache, order[i]));
+  }
+  tree_cache_stats(cache, &hits, &misses, &size);
+  printf("  - hits/misses/cached (expect 1/5/2): %ld/%ld/%d\n", hits, misses,
+    size);
+
+  struct sp_tree* tree = tree_cache_get(cache, 0);
+  printf("  - dist from 0 to 3 (expect 10): %lld\n",
+    (long long)tree->dist[3]);
+  printf("  - prev of 3, 2 (expect 2 0): %d %d\n", tree->prev[3],
+    tree->prev[2]);
+  printf("  - dist from 0 to 4 is infinite (expect 1): %d\n",
+    tree->dist[4] == DIST_INF);
+
+  /*
+   * A tree that gets evicted while in use must stay readable until it is
+   * released.
+   */
+  tree_cache_release(cache, tree_cache_get(cache, 3));
+  tree_cache_release(cache, tree_cache_get(cache, 4));
+  printf("  - evicted tree still valid (expect 10): %lld\n",
+    (long long)tree->dist[3]);
+  tree_cache_release(cache, tree);
+  tree_cache_free(cache);
+
+  printf("\n== No caching\n");
+  cache = tree_cache_create(graph, 0);
+  for (int i = 0; i < 3; i++) {
+    tree_cache_release(cache, tree_cache_get(cache, 0));
+  }
+  tree_cache_stats(cache, &hits, &misses, &size);
+  printf("  - hits/misses/cached (expect 0/3/0): %ld/%ld/%d\n", hits, misses,
+    size);
+  tree_cache_free(cache);
+
+  printf("\n== Protocol\n");
+  cache = tree_cache_create(graph, 4);
+  printf("  - expect 10, 0 2 3 with 10, inf, inf, hits 2 misses 2 cached 2,"
+    " bye:\n");
+  int shutdown = run_session(cache,
+    "DIST 0 3\nPATH 0 3\nDIST 4 0\nPATH 0 4\nSTATS\nQUIT\nDIST 0 1\n");
+  printf("  - shutdown (expect 0): %d\n", shutdown);
+  printf("  - expect four errors, then bye:\n");
+  shutdown = run_session(cache,
+    "DIST 0\nDIST 0 9\nPATH 1 2 3\nFOO\n\nSHUTDOWN\n");
+  printf("  - shutdown (expect 1): %d\n", shutdown);
+  tree_cache_free(cache);
+  graph_free(graph);
+
+  /*
+   * Check cached trees against fresh runs on random graphs, with a cache
+   * small enough that trees get evicted and recomputed along the way.
+   */
+  printf("\n== Random graphs\n");
+  int failures = 0;
+  int n = 300;
+  graph = random_graph(n, 4 * n, 20);
+  cache = tree_cache_create(graph, 8);
+  dist_t* dist = malloc(n * sizeof(dist_t));
+  int* prev = malloc(n * sizeof(int));
+  for (int q = 0; q < 500; q++) {
+    int source = rand() % 16;
+    tree = tree_cache_get(cache, source);
+    sssp_dijkstra(graph, source, dist, prev);
+    if (memcmp(tree->dist, dist, n * sizeof(dist_t)) ||
+        memcmp(tree->prev, prev, n * sizeof(int))) {
+      failures++;
+    }
+    tree_cache_release(cache, tree);
+  }
+  tree_cache_stats(cache, &hits, &misses, &size);
+  printf("  - trees different from fresh runs (expect 0): %d\n", failures);
+  printf("  - lookups (expect 500): %ld\n", hits + misses);
+  printf("  - cached (expect 8): %d\n", size);
+  free(dist);
+  free(prev);
+  tree_cache_free(cache);
+  graph_free(graph);
+
+  return 0;
+}
@@ -0,0 +1,236 @@
+/*
+ * This is a small program to test the shortest-path engines in sssp.c against
+ * a straightforward O(n^2) version of Dijkstra's algorithm.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "graph.h"
+#include "sssp.h"
+
+/*
+ * Builds a random graph with n nodes and m edges whose weights are in
+ * [0, max_weight].
+ */
+struct graph* random_graph(int n, int m, int max_weight) {
+  int* sources = malloc(m * sizeof(int));
+  int* targets = malloc(m * sizeof(int));
+  int* weights = malloc(m * sizeof(int));
+  for (int i = 0; i < m; i++) {
+    sources[i] = rand() % n;
+    targets[i] = rand() % n;
+    weights[i] = rand() % (max_weight + 1);
+  }
+  struct graph* graph = graph_from_edges(n, m, sources, targets, weights);
+  free(sources);
+  free(targets);
+  free(weights);
+  return graph;
+}
+
+/*
+ * Reference Dijkstra: settles the closest unsettled node (lowest index on
+ * ties) and updates a neighbor's predecessor only on a strict improvement.
+ */
+void reference(struct graph* graph, int source, dist_t* dist, int* prev) {
+  int n = graph->n_nodes;
+  int* done = calloc(n, sizeof(int));
+  for (int v = 0; v < n; v++) {
+    dist[v] = DIST_INF;
+    prev[v] = -1;
+  }
+  dist[source] = 0;
+  prev[source] = source;
+  for (int i = 0; i < n; i++) {
+    int u = -1;
+    for (int v = 0; v < n; v++) {
+      if (!done[v] && (u == -1 || dist[v] < dist[u])) {
+        u = v;
+      }
+    }
+    if (dist[u] == DIST_INF) {
+      break;
+    }
+    done[u] = 1;
+    for (int e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+      int v = graph->targets[e];
+      if (dist[u] + graph->weights[e] < dist[v]) {
+        dist[v] = dist[u] + graph->weights[e];
+        prev[v] = u;
+      }
+    }
+  }
+  free(done);
+}
+
+/*
+ * Returns 1 if both pairs of arrays are equal.
+ */
+int same(int n, dist_t* d1, int* p1, dist_t* d2, int* p2) {
+  for (int v = 0; v < n; v++) {
+    if (d1[v] != d2[v] || p1[v] != p2[v]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+int main(int argc, char** argv) {
+  srand(0);
+
+  /*
+   * Two equally short paths to node 3: 0 -> 1 -> 3 and 0 -> 2 -> 3.  Node 1
+   * is settled first, so it should be the predecessor.
+   */
+  printf("== Small graph with tied paths\n");
+  int s[] = {0, 0, 2, 1, 3};
+  int t[] = {1, 2, 3, 3, 4};
+  int w[] = {2, 2, 3, 3, 0};
+  struct graph* graph = graph_from_edges(6, 5, s, t, w);
+  dist_t dist[6];
+  int prev[6];
+  sssp_delta_stepping(graph, 0, 2, 2, dist, prev);
+  printf("  - dist to 3 (expect 5): %lld\n", (long long)dist[3]);
+  printf("  - prev of 3 (expect 1): %d\n", prev[3]);
+  printf("  - dist to 4 over a zero-weight edge (expect 5): %lld\n",
+    (long long)dist[4]);
+  printf("  - prev of 4 (expect 3): %d\n", prev[4]);
+  printf("  - node 5 unreachable (expect 1)? %d\n",
+    dist[5] == DIST_INF && prev[5] == -1);
+  printf("  - prev of source (expect 0): %d\n", prev[0]);
+  graph_free(graph);
+
+  /*
+   * A chain of edges as heavy as they come, whose lengths would overflow an
+   * int after the first edge.
+   */
+  printf("\n== Long paths\n");
+  int chain_s[] = {0, 1, 2, 3};
+  int chain_t[] = {1, 2, 3, 4};
+  int chain_w[] = {INT_MAX, INT_MAX, INT_MAX, INT_MAX};
+  graph = graph_from_edges(6, 4, chain_s, chain_t, chain_w);
+  sssp_dijkstra(graph, 0, dist, prev);
+  printf("  - heap dist to 4 (expect %lld): %lld\n", 4LL * INT_MAX,
+    (long long)dist[4]);
+  sssp_delta_stepping(graph, 0, 0, 2, dist, prev);
+  printf("  - delta-stepping dist to 4 (expect %lld): %lld\n", 4LL * INT_MAX,
+    (long long)dist[4]);
+  printf("  - saturating add (expect 1 1): %d %d\n",
+    dist_add(DIST_INF, INT_MAX) == DIST_INF,
+    dist_add(DIST_INF - 5, 7) == DIST_INF);
+
+  int nodes[6];
+  int length = sssp_path(prev, 0, 4, nodes, 6);
+  printf("  - path to 4 (expect 5: 0 1 2 3 4): %d:", length);
+  for (int i = 0; i < length; i++) {
+    printf(" %d", nodes[i]);
+  }
+  printf("\n");
+  printf("  - path to 4 in a short buffer (expect 5): %d\n",
+    sssp_path(prev, 0, 4, nodes, 3));
+  printf("  - path to source (expect 1 0): %d %d\n",
+    sssp_path(prev, 0, 0, nodes, 6), nodes[0]);
+  printf("  - path to unreachable 5 (expect -1): %d\n",
+    sssp_path(prev, 0, 5, nodes, 6));
+  graph_free(graph);
+
+  /*
+   * Random graphs, including ones with many zero-weight and tied edges and
+   * unreachable nodes, checked for every engine and several deltas and
+   * thread counts.
+   */
+  printf("\n== Random graphs\n");
+  int n_graphs = 0, heap_ok = 0, delta_ok = 0, n_delta = 0;
+  int deltas[] = {1, 3, 10, 100, 0};
+  for (int g = 0; g < 40; g++) {
+    int n = 1 + rand() % 300;
+    int m = rand() % (4 * n);
+    int max_weight = g % 2 ? 5 : 1000;
+    graph = random_graph(n, m, max_weight);
+    dist_t* d_ref = malloc(n * sizeof(dist_t));
+    dist_t* d = malloc(n * sizeof(dist_t));
+    int* p_ref = malloc(n * sizeof(int));
+    int* p = malloc(n * sizeof(int));
+    int source = rand() % n;
+
+    reference(graph, source, d_ref, p_ref);
+    sssp_dijkstra(graph, source, d, p);
+    heap_ok += same(n, d_ref, p_ref, d, p);
+    for (int i = 0; i < 5; i++) {
+      for (int threads = 1; threads <= 4; threads *= 2) {
+        sssp_delta_stepping(graph, source, deltas[i], threads, d, p);
+        delta_ok += same(n, d_ref, p_ref, d, p);
+        n_delta++;
+      }
+    }
+    n_graphs++;
+
+    free(d_ref);
+    free(d);
+    free(p_ref);
+    free(p);
+    graph_free(graph);
+  }
+  printf("  - heap Dijkstra matches (expect %d): %d\n", n_graphs, heap_ok);
+  printf("  - delta-stepping matches (expect %d): %d\n", n_delta, delta_ok);
+
+  /*
+   * A batch run should write the same rows as one run per source, in the
+   * order the sources were given.
+   */
+  printf("\n== Batch of sources\n");
+  char path[] = "/tmp/test_sssp_XXXXXX";
+  int fd = mkstemp(path);
+  close(fd);
+  int n = 500;
+  graph = random_graph(n, 3 * n, 100);
+  int sources[] = {7, 3, 499, 3, 0, 250};
+  int n_sources = 6;
+  printf("  - written (expect 0): %d\n",
+    sssp_batch(graph, sources, n_sources, 4, path));
+
+  FILE* file = fopen(path, "rb");
+  struct sssp_matrix_header header;
+  int read_sources[6];
+  fread(&header, sizeof(header), 1, file);
+  fread(read_sources, sizeof(int), n_sources, file);
+  printf("  - header ok (expect 1)? %d\n",
+    !memcmp(header.magic, SSSP_MATRIX_MAGIC, 8) &&
+    header.version == SSSP_MATRIX_VERSION &&
+    header.dist_size == sizeof(dist_t) && header.n_nodes == n &&
+    header.n_sources == n_sources &&
+    !memcmp(read_sources, sources, sizeof(sources)));
+
+  int rows_ok = 0;
+  dist_t* row = malloc(n * sizeof(dist_t));
+  dist_t* d = malloc(n * sizeof(dist_t));
+  fseek(file, sizeof(header) + (n_sources * sizeof(int) + 7) / 8 * 8,
+    SEEK_SET);
+  for (int i = 0; i < n_sources; i++) {
+    fread(row, sizeof(dist_t), n, file);
+    sssp_dijkstra(graph, sources[i], d, NULL);
+    rows_ok += !memcmp(row, d, n * sizeof(dist_t));
+  }
+  printf("  - rows match (expect %d): %d\n", n_sources, rows_ok);
+  fclose(file);
+
+  sssp_batch(graph, NULL, 0, 3, path);
+  file = fopen(path, "rb");
+  fread(&header, sizeof(header), 1, file);
+  fseek(file, 0, SEEK_END);
+  printf("  - all sources (expect %d): %d\n", n, header.n_sources);
+  printf("  - file size ok (expect 1)? %d\n", ftell(file) ==
+    (long)(sizeof(header) + n * sizeof(int) + (long)n * n * sizeof(dist_t)));
+  fclose(file);
+  unlink(path);
+  free(row);
+  free(d);
+  graph_free(graph);
+
+  return 0;
+}